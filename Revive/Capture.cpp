@@ -0,0 +1,156 @@
+#include "Capture.h"
+#include "Trace.h"
+
+#include <Windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mutex>
+#include <vector>
+
+// Size of the stdio buffer, the records are small so only flush in large chunks
+#define REV_CAPTURE_BUFFER_SIZE 0x100000
+
+bool g_CaptureEnabled = false;
+
+static std::mutex s_FileMutex;
+static FILE* s_File = nullptr;
+static std::vector<bool> s_Named;
+static uint32_t s_MinorVersion = 0;
+
+// Payloads of the entry points that are running on this thread, innermost last
+static thread_local std::vector<uint8_t> s_Payload;
+
+void Capture::Initialize(const ovrInitParams* params)
+{
+	DWORD value = 0, size = sizeof(DWORD);
+	const char* capture = getenv("REVIVE_CAPTURE");
+	bool enabled = capture ? atoi(capture) != 0 :
+		RegGetValueA(HKEY_CURRENT_USER, "Software\\Revive", "Capture", RRF_RT_REG_DWORD, NULL, &value, &size) == ERROR_SUCCESS && value != 0;
+	if (!enabled || s_File)
+		return;
+
+	char path[MAX_PATH];
+	if (!Trace::GetDefaultPath("Capture", "rvc", path, sizeof(path)))
+		return;
+
+	s_File = fopen(path, "wb");
+	if (!s_File)
+		return;
+	setvbuf(s_File, nullptr, _IOFBF, REV_CAPTURE_BUFFER_SIZE);
+
+	LARGE_INTEGER freq;
+	QueryPerformanceFrequency(&freq);
+	s_MinorVersion = params ? params->RequestedMinorVersion : 0;
+
+	CaptureHeader header = {};
+	header.Magic = REV_CAPTURE_MAGIC;
+	header.Version = REV_CAPTURE_VERSION;
+	header.PointerSize = sizeof(void*);
+	header.MinorVersion = s_MinorVersion;
+	header.InitFlags = params ? params->Flags : 0;
+	header.Frequency = freq.QuadPart;
+	header.Start = Trace::GetTicks();
+	fwrite(&header, sizeof(header), 1, s_File);
+
+	g_CaptureEnabled = true;
+}
+
+void Capture::Shutdown()
+{
+	std::lock_guard<std::mutex> lk(s_FileMutex);
+	g_CaptureEnabled = false;
+	if (s_File)
+		fclose(s_File);
+	s_File = nullptr;
+	s_Named.clear();
+}
+
+uint32_t Capture::Begin()
+{
+	return (uint32_t)s_Payload.size();
+}
+
+void Capture::Record(uint32_t id, int64_t start, int64_t end, uint32_t offset)
+{
+	CaptureRecord record = {};
+	record.Type = CaptureRecord_Call;
+	// An enclosing entry point already wrote its arguments, so replaying it will also replay this call
+	record.Flags = offset > 0 ? CaptureFlag_Nested : 0;
+	record.Id = id;
+	record.ThreadId = GetCurrentThreadId();
+	record.Size = (uint32_t)(s_Payload.size() - offset);
+	record.Start = start;
+	record.End = end;
+
+	{
+		std::lock_guard<std::mutex> lk(s_FileMutex);
+		if (s_File)
+		{
+			if (id >= s_Named.size())
+				s_Named.resize(id + 1);
+			if (!s_Named[id])
+			{
+				const char* name = Trace::GetName(id);
+				CaptureRecord nameRecord = {};
+				nameRecord.Type = CaptureRecord_Name;
+				nameRecord.Id = id;
+				nameRecord.Size = (uint32_t)strlen(name);
+				fwrite(&nameRecord, sizeof(nameRecord), 1, s_File);
+				fwrite(name, 1, nameRecord.Size, s_File);
+				s_Named[id] = true;
+			}
+
+			fwrite(&record, sizeof(record), 1, s_File);
+			if (record.Size)
+				fwrite(s_Payload.data() + offset, 1, record.Size, s_File);
+		}
+	}
+	s_Payload.resize(offset);
+}
+
+void Capture::WriteData(const void* data, size_t size)
+{
+	const uint8_t* bytes = (const uint8_t*)data;
+	s_Payload.insert(s_Payload.end(), bytes, bytes + size);
+}
+
+static uint32_t GetLayerSize(ovrLayerType type)
+{
+	switch (type)
+	{
+	case ovrLayerType_EyeFov: return sizeof(ovrLayerEyeFov);
+	case ovrLayerType_EyeFovDepth: return sizeof(ovrLayerEyeFovDepth);
+	case ovrLayerType_Quad: return sizeof(ovrLayerQuad);
+	case ovrLayerType_EyeMatrix: return sizeof(ovrLayerEyeMatrix);
+	case ovrLayerType_EyeFovMultires: return sizeof(ovrLayerEyeFovMultires);
+	case ovrLayerType_Cylinder: return sizeof(ovrLayerCylinder);
+	case ovrLayerType_Cube: return sizeof(ovrLayerCube);
+	default: return 0;
+	}
+}
+
+void Capture::WriteLayers(ovrLayerHeader const * const * layerPtrList, unsigned int layerCount)
+{
+	Write((uint32_t)layerCount);
+	for (unsigned int i = 0; i < layerCount; i++)
+	{
+		const ovrLayerHeader* header = layerPtrList[i];
+		uint32_t size = header ? GetLayerSize(header->Type) : 0;
+		Write(size);
+		if (!size)
+			continue;
+
+		// Layers are always written in the 1.25 layout, which added a 128-byte reserved parameter
+		// to the header. On older versions the data directly follows the type and flags.
+		ovrLayerHeader newHeader = {};
+		newHeader.Type = header->Type;
+		newHeader.Flags = header->Flags;
+		WriteData(&newHeader, sizeof(ovrLayerHeader));
+
+		const uint8_t* data = (const uint8_t*)header + sizeof(ovrLayerHeader);
+		if (s_MinorVersion < 25)
+			data -= sizeof(ovrLayerHeader::Reserved);
+		WriteData(data, size - sizeof(ovrLayerHeader));
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "CaptureFormat.h"
+#include "OVR_CAPI.h"
+
+#include <type_traits>
+
+// Cached capture state, only written during initialization and shutdown
+extern bool g_CaptureEnabled;
+
+// Serializes the LibOVR entry points into a capture file that ReviveBench can replay.
+// Entry points append their arguments to a per-thread buffer while they run, the TraceScope
+// then writes them as a single record together with the start and end timestamps.
+class Capture
+{
+public:
+	// Enabled through the REVIVE_CAPTURE environment variable or the HKCU\Software\Revive\Capture
+	// registry value, the capture is written next to the trace files.
+	static void Initialize(const ovrInitParams* params);
+	static void Shutdown();
+
+	// Returns the start of the payload of the entry point that is being entered
+	static uint32_t Begin();
+	// Writes the record if the capture is still running, the payload is always removed
+	static void Record(uint32_t id, int64_t start, int64_t end, uint32_t offset);
+
+	static void WriteData(const void* data, size_t size);
+	static void WriteLayers(ovrLayerHeader const * const * layerPtrList, unsigned int layerCount);
+
+	static void Write() { }
+	template<typename T, typename... Args>
+	static void Write(const T& value, const Args&... args)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Only plain data can be captured");
+		WriteData(&value, sizeof(T));
+		Write(args...);
+	}
+};
+
+template<typename T>
+inline uint64_t CaptureHandle(T* handle)
+{
+	return (uint64_t)(uintptr_t)handle;
+}
+
+#define REV_CAPTURE(...) { if (g_CaptureEnabled) Capture::Write(__VA_ARGS__); }
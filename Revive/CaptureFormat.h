@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdint.h>
+
+// A capture starts with a CaptureHeader followed by a stream of records, every record is a
+// CaptureRecord followed by its payload. Records are written when an entry point returns, so
+// nested entry points are written before the entry point that called them.
+#define REV_CAPTURE_MAGIC 0x50435652 // "RVCP"
+#define REV_CAPTURE_VERSION 1
+
+struct CaptureHeader
+{
+	uint32_t Magic;
+	uint32_t Version;
+	uint32_t PointerSize;	// Layers contain pointers, so they can only be replayed by a process of the same bitness
+	uint32_t MinorVersion;	// LibOVR minor version requested by the application
+	uint32_t InitFlags;
+	uint32_t Reserved;
+	int64_t Frequency;		// Ticks per second of the timestamps
+	int64_t Start;			// Ticks at the start of the capture
+};
+
+enum CaptureRecordType
+{
+	CaptureRecord_Name,		// Payload is the name of the entry point, written before its first call
+	CaptureRecord_Call,		// Payload depends on the entry point, empty for entry points that aren't replayed
+};
+
+enum CaptureRecordFlags
+{
+	CaptureFlag_Nested = 1,	// Called by an entry point that is replayed, so it isn't replayed itself
+};
+
+struct CaptureRecord
+{
+	uint16_t Type;
+	uint16_t Flags;
+	uint32_t Id;
+	uint32_t ThreadId;
+	uint32_t Size;
+	int64_t Start;
+	int64_t End;
+};
+
+// Call payloads, handles are written as 64-bit values. Entry points that call other entry points
+// write their arguments before doing so, which allows the nested calls to be flagged.
+// ovr_Create                       session handle
+// ovr_SetTrackingOriginType        ovrTrackingOrigin
+// ovr_GetTrackingState             double absTime, ovrBool latencyMarker, ovrTrackingState
+// ovr_GetInputState                ovrControllerType, ovrInputState
+// ovr_SetControllerVibration       ovrControllerType, float frequency, float amplitude
+// ovr_CreateTextureSwapChain*      ovrTextureSwapChainDesc, swapchain handle
+// ovr_CommitTextureSwapChain       swapchain handle
+// ovr_DestroyTextureSwapChain      swapchain handle
+// ovr_GetPredictedDisplayTime      long long frameIndex
+// ovr_WaitToBeginFrame             long long frameIndex
+// ovr_BeginFrame                   long long frameIndex
+// ovr_EndFrame, ovr_SubmitFrame2   long long frameIndex, uint32_t hasViewScale, ovrViewScaleDesc, uint32_t layerCount,
+//                                  then every layer as a uint32_t size followed by the layer in the 1.25 layout
@@ -1,15 +1,23 @@
 #pragma once
 
 #include "microprofile.h"
+#include "Trace.h"
+#include "StartupTrace.h"
+
+#define REV_TRACE_PASTE0(a, b) a ## b
+#define REV_TRACE_PASTE(a, b) REV_TRACE_PASTE0(a, b)
 
 #if 0
 #include <Windows.h>
 #define REV_TRACE(x) OutputDebugStringA("Revive: " #x "\n");
 #else
-#define REV_TRACE(x) MICROPROFILE_SCOPEI("Revive", #x, 0xff0000);
+#define REV_TRACE(x) \
+	struct REV_TRACE_PASTE(rev_trace_tag_, __LINE__) { static const char* Name() { return #x; } }; \
+	TraceScope<REV_TRACE_PASTE(rev_trace_tag_, __LINE__)> REV_TRACE_PASTE(rev_trace_scope_, __LINE__);
 #endif
 
 extern unsigned int g_MinorVersion;
+extern class FrameClock g_Clock;
 
 #if MICROPROFILE_ENABLED
 extern class ProfileManager g_ProfileManager;
@@ -3,6 +3,7 @@
 #include "Session.h"
 #include "InputManager.h"
 #include "ProfileManager.h"
+#include "FrameClock.h"
 #include "TextureBase.h"
 
 #include "microprofile.h"
@@ -13,9 +14,9 @@
 #include <assert.h>
 #include <openvr.h>
 #include <vector>
-#include <algorithm>
 
 #define REV_LAYER_BIAS 0.0001f
+#define REV_KEY_MIRROR_FRAME_RATE "MirrorFrameRate"
 #define ENABLE_DEPTH_SUBMIT 0
 
 MICROPROFILE_DEFINE(WaitToBeginFrame, "Compositor", "WaitFrame", 0x00ff00);
@@ -23,6 +24,7 @@ MICROPROFILE_DEFINE(BeginFrame, "Compositor", "BeginFrame", 0x00ff00);
 MICROPROFILE_DEFINE(EndFrame, "Compositor", "EndFrame", 0x00ff00);
 MICROPROFILE_DEFINE(BlitLayers, "Compositor", "BlitLayers", 0x00ff00);
 MICROPROFILE_DEFINE(SubmitLayer, "Compositor", "SubmitLayer", 0x00ff00);
+MICROPROFILE_DEFINE(RenderMirror, "Compositor", "RenderMirror", 0x00ff00);
 MICROPROFILE_DEFINE(WaitGetPoses, "Compositor", "WaitGetPoses", 0x00ff00);
 MICROPROFILE_DEFINE(PostPresentHandoff, "Compositor", "PostPresentHandoff", 0x00ff00);
 
@@ -50,7 +52,11 @@ CompositorBase::CompositorBase()
 	: m_ChainCount(0)
 	, m_MirrorTexture(nullptr)
 	, m_OverlayCount(0)
+	, m_OverlayGeneration(0)
+	, m_Overlays()
 	, m_ActiveOverlays()
+	, m_FreeOverlays()
+	, m_LayerBatch()
 	, m_Timeout(100)
 	, m_TimingMode(vr::VRCompositorTimingMode_Explicit_ApplicationPerformsPostPresentHandoff)
 #if MICROPROFILE_ENABLED
@@ -106,14 +112,22 @@ ovrResult CompositorBase::CreateTextureSwapChain(const ovrTextureSwapChainDesc*
 	return ovrSuccess;
 }
 
-ovrResult CompositorBase::CreateMirrorTexture(const ovrMirrorTextureDesc* desc, ovrMirrorTexture* out_MirrorTexture)
+ovrResult CompositorBase::CreateMirrorTexture(ovrSession session, const ovrMirrorTextureDesc* desc, ovrMirrorTexture* out_MirrorTexture)
 {
 	// There can only be one mirror texture at a time
 	if (m_MirrorTexture)
 		return ovrError_RuntimeException;
 
-	// TODO: Support ovrMirrorOptions
+	// The eye selection options are handled by the compositors, the other options don't apply to OpenVR
 	ovrMirrorTexture mirrorTexture = new ovrMirrorTextureData(*desc);
+
+	// The mirror can be rate-limited with a per-application setting, so it competes less with the eye buffers
+	vr::EVRSettingsError error = vr::VRSettingsError_None;
+	float mirrorRate = vr::VRSettings()->GetFloat(session->AppKey, REV_KEY_MIRROR_FRAME_RATE, &error);
+	float displayRate = session->Properties.GetFloat(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_DisplayFrequency_Float);
+	if (error == vr::VRSettingsError_None && mirrorRate > 0.0f && mirrorRate < displayRate)
+		mirrorTexture->FrameInterval = (unsigned int)ceilf(displayRate / mirrorRate);
+
 	TextureBase* texture = CreateTexture();
 	bool success = texture->Init(ovrTexture_2D_External, desc->Width, desc->Height, 1, 1, 1, desc->Format,
 		desc->MiscFlags | ovrTextureMisc_AllowGenerateMips, ovrTextureBind_DX_RenderTarget);
@@ -132,6 +146,7 @@ ovrResult CompositorBase::WaitToBeginFrame(ovrSession session, long long frameIn
 
 	// OVR ignores attempts at waiting multiple frames, so simply wait for the next frame here.
 	vr::VRCompositorError error = vr::VRCompositor()->WaitGetPoses(nullptr, 0, nullptr, 0);
+	g_Clock.Calibrate(session->HmdDesc.DisplayRefreshRate);
 	session->FrameIndex = frameIndex;
 	session->Input->UpdateInputState();
 	return CompositorErrorToOvrError(error);
@@ -165,7 +180,15 @@ ovrResult CompositorBase::EndFrame(ovrSession session, long long frameIndex, con
 		return ovrError_InvalidParameter;
 
 	const ovrLayerHeader* baseLayer = nullptr;
-	std::vector<vr::VROverlayHandle_t> activeOverlays;
+	std::vector<unsigned int> activeOverlays;
+	unsigned int overlayCalls = 0;
+	m_OverlayGeneration++;
+	m_LayerBatch.Clear();
+
+	// Only query the tracking space once per frame and only if we have a world-locked overlay
+	vr::ETrackingUniverseOrigin origin = vr::TrackingUniverseRawAndUncalibrated;
+	bool hasOrigin = false;
+
 	for (uint32_t i = 0; i < layerCount; i++)
 	{
 		if (!layerPtrList[i])
@@ -189,31 +212,36 @@ ovrResult CompositorBase::EndFrame(ovrSession session, long long frameIndex, con
 				vr::Texture_t texture;
 				chain->Submit()->ToVRTexture(texture);
 				vr::VROverlay()->SetOverlayTexture(chain->Overlay, &texture);
+				overlayCalls++;
 			}
-			activeOverlays.push_back(chain->Overlay);
 
-			// Set the layer rendering order and apply a bias between the layers.
-			vr::VROverlay()->SetOverlaySortOrder(chain->Overlay, i);
+			// Look up the shadow state of the overlay, the swapchain may have been used by another compositor
+			if (chain->OverlayIndex >= m_Overlays.size() || m_Overlays[chain->OverlayIndex].Handle != chain->Overlay)
+				chain->OverlayIndex = TrackOverlay(chain->Overlay);
+
+			// Mark the overlay as active in this frame
+			OverlayState& state = m_Overlays[chain->OverlayIndex];
+			if (state.Generation != m_OverlayGeneration)
+				activeOverlays.push_back(chain->OverlayIndex);
+			state.Generation = m_OverlayGeneration;
+
+			// Apply a bias between the layers.
 			OVR::Posef pose = layer.QuadPoseCenter;
 			pose.Translation += pose.Rotate(OVR::Vector3f(0.0f, 0.0f, (float)i * REV_LAYER_BIAS));
-
-			// Transform the overlay.
 			vr::HmdMatrix34_t transform = REV::Matrix4f(pose);
-			vr::VROverlay()->SetOverlayWidthInMeters(chain->Overlay, layer.QuadSize.x);
-			if (layerPtrList[i]->Flags & ovrLayerFlag_HeadLocked)
-				vr::VROverlay()->SetOverlayTransformTrackedDeviceRelative(chain->Overlay, vr::k_unTrackedDeviceIndex_Hmd, &transform);
-			else
-				vr::VROverlay()->SetOverlayTransformAbsolute(chain->Overlay, vr::VRCompositor()->GetTrackingSpace(), &transform);
 
-			// Set the texture and show the overlay.
-			vr::VRTextureBounds_t bounds = ViewportToTextureBounds(layer.Viewport, layer.ColorTexture, layerPtrList[i]->Flags);
-			vr::VROverlay()->SetOverlayTextureBounds(chain->Overlay, &bounds);
+			bool headLocked = (layerPtrList[i]->Flags & ovrLayerFlag_HeadLocked) != 0;
+			if (!headLocked && !hasOrigin)
+			{
+				origin = vr::VRCompositor()->GetTrackingSpace();
+				hasOrigin = true;
+			}
 
-			// Show the overlay, unfortunately we have no control over the order in which
-			// overlays are drawn.
+			// Update the layer rendering order, transform and texture bounds. Unfortunately we have
+			// no control over the order in which overlays are drawn.
 			// TODO: Support ovrLayerFlag_HighQuality for overlays with anisotropic sampling.
-			// TODO: Handle overlay errors.
-			vr::VROverlay()->ShowOverlay(chain->Overlay);
+			vr::VRTextureBounds_t bounds = ViewportToTextureBounds(layer.Viewport, layer.ColorTexture, layerPtrList[i]->Flags);
+			overlayCalls += UpdateOverlay(state, i, layer.QuadSize.x, headLocked, origin, transform, bounds);
 		}
 		else if (layerPtrList[i]->Type == ovrLayerType_EyeFov ||
 			layerPtrList[i]->Type == ovrLayerType_EyeFovDepth ||
@@ -224,19 +252,31 @@ ovrResult CompositorBase::EndFrame(ovrSession session, long long frameIndex, con
 			if (!baseLayer)
 				baseLayer = layerPtrList[i];
 			else
-				BlitLayers(baseLayer, layerPtrList[i]);
+				AddLayerBlits(baseLayer, layerPtrList[i], m_LayerBatch);
 		}
 	}
 
+	// Composit all extra eye layers onto the base layer in a single pass.
+	if (!m_LayerBatch.IsEmpty())
+	{
+		MICROPROFILE_SCOPE(BlitLayers);
+		RenderLayerBlits(m_LayerBatch);
+	}
+
 	// Hide previous overlays that are not part of the current layers.
-	for (vr::VROverlayHandle_t overlay : m_ActiveOverlays)
+	for (unsigned int index : m_ActiveOverlays)
 	{
-		// Find the overlay in the current active overlays, if it was not found then hide it.
 		// TODO: Handle overlay errors.
-		if (std::find(activeOverlays.begin(), activeOverlays.end(), overlay) == activeOverlays.end())
-			vr::VROverlay()->HideOverlay(overlay);
+		OverlayState& state = m_Overlays[index];
+		if (state.Handle != vr::k_ulOverlayHandleInvalid && state.Generation != m_OverlayGeneration && state.Visible)
+		{
+			vr::VROverlay()->HideOverlay(state.Handle);
+			state.Visible = false;
+			overlayCalls++;
+		}
 	}
-	m_ActiveOverlays = activeOverlays;
+	m_ActiveOverlays.swap(activeOverlays);
+	MICROPROFILE_META_CPU("Overlay Calls", overlayCalls);
 
 	vr::EVRCompositorError error = vr::VRCompositorError_None;
 	if (baseLayer)
@@ -248,8 +288,13 @@ ovrResult CompositorBase::EndFrame(ovrSession session, long long frameIndex, con
 		vr::VRCompositor()->PostPresentHandoff();
 	}
 
-	if (m_MirrorTexture && error == vr::VRCompositorError_None)
+	// Only render the mirror if the app actually uses it and it's not rate-limited on this frame
+	if (m_MirrorTexture && m_MirrorTexture->Requested && error == vr::VRCompositorError_None &&
+		m_MirrorTexture->FrameCount++ % m_MirrorTexture->FrameInterval == 0)
+	{
+		MICROPROFILE_SCOPE(RenderMirror);
 		RenderMirrorTexture(m_MirrorTexture);
+	}
 
 #if MICROPROFILE_ENABLED
 	g_ProfileManager.Flip();
@@ -269,6 +314,88 @@ vr::VROverlayHandle_t CompositorBase::CreateOverlay()
 	return handle;
 }
 
+unsigned int CompositorBase::TrackOverlay(vr::VROverlayHandle_t overlay)
+{
+	// Start with an empty shadow state, so all properties are set on the first frame
+	OverlayState state = {};
+	state.Handle = overlay;
+
+	// Reuse the slot of a destroyed overlay if possible
+	if (!m_FreeOverlays.empty())
+	{
+		unsigned int index = m_FreeOverlays.back();
+		m_FreeOverlays.pop_back();
+		m_Overlays[index] = state;
+		return index;
+	}
+
+	m_Overlays.push_back(state);
+	return (unsigned int)m_Overlays.size() - 1;
+}
+
+void CompositorBase::ReleaseOverlay(ovrTextureSwapChain swapChain)
+{
+	// The swapchain may never have been used as an overlay by this compositor
+	unsigned int index = swapChain->OverlayIndex;
+	if (swapChain->Overlay == vr::k_ulOverlayHandleInvalid || index >= m_Overlays.size() ||
+		m_Overlays[index].Handle != swapChain->Overlay)
+		return;
+
+	// The slot can be reused right away, a stale entry in the active overlays is skipped
+	m_Overlays[index].Handle = vr::k_ulOverlayHandleInvalid;
+	m_FreeOverlays.push_back(index);
+}
+
+unsigned int CompositorBase::UpdateOverlay(OverlayState& state, uint32_t sortOrder, float width, bool headLocked,
+	vr::ETrackingUniverseOrigin origin, const vr::HmdMatrix34_t& transform, const vr::VRTextureBounds_t& bounds)
+{
+	// TODO: Handle overlay errors.
+	unsigned int calls = 0;
+	if (!state.Valid || state.SortOrder != sortOrder)
+	{
+		vr::VROverlay()->SetOverlaySortOrder(state.Handle, sortOrder);
+		state.SortOrder = sortOrder;
+		calls++;
+	}
+
+	if (!state.Valid || state.Width != width)
+	{
+		vr::VROverlay()->SetOverlayWidthInMeters(state.Handle, width);
+		state.Width = width;
+		calls++;
+	}
+
+	if (!state.Valid || state.HeadLocked != headLocked || (!headLocked && state.Origin != origin) ||
+		memcmp(&state.Transform, &transform, sizeof(vr::HmdMatrix34_t)) != 0)
+	{
+		if (headLocked)
+			vr::VROverlay()->SetOverlayTransformTrackedDeviceRelative(state.Handle, vr::k_unTrackedDeviceIndex_Hmd, &transform);
+		else
+			vr::VROverlay()->SetOverlayTransformAbsolute(state.Handle, origin, &transform);
+		state.HeadLocked = headLocked;
+		state.Origin = origin;
+		state.Transform = transform;
+		calls++;
+	}
+
+	if (!state.Valid || memcmp(&state.Bounds, &bounds, sizeof(vr::VRTextureBounds_t)) != 0)
+	{
+		vr::VROverlay()->SetOverlayTextureBounds(state.Handle, &bounds);
+		state.Bounds = bounds;
+		calls++;
+	}
+
+	if (!state.Visible)
+	{
+		vr::VROverlay()->ShowOverlay(state.Handle);
+		state.Visible = true;
+		calls++;
+	}
+
+	state.Valid = true;
+	return calls;
+}
+
 vr::VRTextureBounds_t CompositorBase::ViewportToTextureBounds(ovrRecti viewport, ovrTextureSwapChain swapChain, unsigned int flags)
 {
 	vr::VRTextureBounds_t bounds;
@@ -305,10 +432,8 @@ vr::VRTextureBounds_t CompositorBase::ViewportToTextureBounds(ovrRecti viewport,
 	return bounds;
 }
 
-void CompositorBase::BlitLayers(const ovrLayerHeader* dstLayer, const ovrLayerHeader* srcLayer)
+void CompositorBase::AddLayerBlits(const ovrLayerHeader* dstLayer, const ovrLayerHeader* srcLayer, LayerBatch& out_Batch)
 {
-	MICROPROFILE_SCOPE(BlitLayers);
-
 	const ovrLayer_Union& dst = ToUnion(dstLayer);
 	const ovrLayer_Union& src = ToUnion(srcLayer);
 
@@ -347,8 +472,14 @@ void CompositorBase::BlitLayers(const ovrLayerHeader* dstLayer, const ovrLayerHe
 		// Calculate the texture bounds
 		vr::VRTextureBounds_t bounds = ViewportToTextureBounds(src.EyeFov.Viewport[i], srcChain, srcLayer->Flags);
 
-		// Composit the layer
-		RenderTextureSwapChain((vr::EVREye)i, srcTex, dstTex, dst.EyeFov.Viewport[i], bounds, quad);
+		// Record the layer, it will be composited together with all other layers
+		const ovrRecti& viewport = dst.EyeFov.Viewport[i];
+		LayerBlit blit = { srcTex, dstTex,
+			{ viewport.Pos.x, viewport.Pos.y, viewport.Size.w, viewport.Size.h },
+			{ quad.v[0], quad.v[1], quad.v[2], quad.v[3] },
+			{ bounds.uMin, bounds.vMin, bounds.uMax, bounds.vMax }
+		};
+		out_Batch.Add(blit);
 	}
 
 	MICROPROFILE_META_CPU("SwapChain Left", src.EyeFov.ColorTexture[0]->Identifier);
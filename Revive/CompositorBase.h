@@ -1,6 +1,7 @@
 #pragma once
 
 #include "TextureBase.h"
+#include "LayerBatch.h"
 #include "OVR_CAPI.h"
 
 #include <openvr.h>
@@ -18,10 +19,11 @@ public:
 
 	// Texture Swapchain
 	ovrResult CreateTextureSwapChain(const ovrTextureSwapChainDesc* desc, ovrTextureSwapChain* out_TextureSwapChain);
-	virtual void RenderTextureSwapChain(vr::EVREye eye, TextureBase* src, TextureBase* dst, ovrRecti viewport, vr::VRTextureBounds_t bounds, vr::HmdVector4_t quad) = 0;
+	void ReleaseOverlay(ovrTextureSwapChain swapChain);
+	virtual void RenderLayerBlits(LayerBatch& batch) = 0;
 
 	// Mirror Texture
-	ovrResult CreateMirrorTexture(const ovrMirrorTextureDesc* desc, ovrMirrorTexture* out_MirrorTexture);
+	ovrResult CreateMirrorTexture(ovrSession session, const ovrMirrorTextureDesc* desc, ovrMirrorTexture* out_MirrorTexture);
 	virtual void RenderMirrorTexture(ovrMirrorTexture mirrorTexture) = 0;
 
 	ovrResult WaitToBeginFrame(ovrSession session, long long frameIndex);
@@ -42,13 +44,38 @@ protected:
 
 	const ovrLayer_Union& ToUnion(const ovrLayerHeader* layerPtr);
 
-	void BlitLayers(const ovrLayerHeader* dstLayer, const ovrLayerHeader* srcLayer);
+	void AddLayerBlits(const ovrLayerHeader* dstLayer, const ovrLayerHeader* srcLayer, LayerBatch& out_Batch);
 	vr::VRCompositorError SubmitLayer(ovrSession session, const ovrLayerHeader* baseLayer, const ovrViewScaleDesc* viewScaleDesc = nullptr);
 
 private:
+	// Shadow copy of the overlay properties, so we only make IPC calls for properties that changed
+	struct OverlayState
+	{
+		vr::VROverlayHandle_t Handle;
+		uint64_t Generation;		// The last frame in which the overlay was part of the layers
+		bool Visible;
+		bool Valid;					// Whether the properties below have been set at least once
+		uint32_t SortOrder;
+		float Width;
+		vr::ETrackingUniverseOrigin Origin;
+		bool HeadLocked;
+		vr::HmdMatrix34_t Transform;
+		vr::VRTextureBounds_t Bounds;
+	};
+
 	// Overlays
 	unsigned int m_OverlayCount;
-	std::vector<vr::VROverlayHandle_t> m_ActiveOverlays;
+	uint64_t m_OverlayGeneration;
+	std::vector<OverlayState> m_Overlays;
+	std::vector<unsigned int> m_ActiveOverlays;
+	std::vector<unsigned int> m_FreeOverlays;
+
+	// Extra eye layers, recorded during EndFrame and rendered in a single pass
+	LayerBatch m_LayerBatch;
+
+	unsigned int TrackOverlay(vr::VROverlayHandle_t overlay);
+	unsigned int UpdateOverlay(OverlayState& state, uint32_t sortOrder, float width, bool headLocked,
+		vr::ETrackingUniverseOrigin origin, const vr::HmdMatrix34_t& transform, const vr::VRTextureBounds_t& bounds);
 
 	// Frame sync timeout
 	uint32_t m_Timeout;
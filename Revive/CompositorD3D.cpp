@@ -6,9 +6,10 @@
 #include <d3d12.h>
 #include <d3d11on12.h>
 #include <wrl/client.h>
+#include <vector>
+#include <algorithm>
 
-#include "VertexShader.hlsl.h"
-#include "MirrorShader.hlsl.h"
+#include "LayerShader.hlsl.h"
 #include "CompositorShader.hlsl.h"
 
 struct Vertex
@@ -17,8 +18,45 @@ struct Vertex
 	ovrVector2f TexCoord;
 };
 
+struct LayerConstants
+{
+	vr::HmdVector4_t Quad;
+	vr::VRTextureBounds_t Bounds;
+};
+
 extern HMODULE g_D3D11;
 
+// Saves the pipeline state the compositor changes that applications commonly rely on
+class StateBackup
+{
+public:
+	StateBackup(ID3D11DeviceContext* pContext)
+		: m_pContext(pContext)
+	{
+		m_pContext->OMGetBlendState(m_BlendState.GetAddressOf(), m_BlendFactor, &m_SampleMask);
+		m_pContext->IAGetPrimitiveTopology(&m_Topology);
+		m_pContext->RSGetState(m_RasterizerState.GetAddressOf());
+		m_pContext->VSGetConstantBuffers(0, 1, m_Constants.GetAddressOf());
+	}
+
+	~StateBackup()
+	{
+		m_pContext->VSSetConstantBuffers(0, 1, m_Constants.GetAddressOf());
+		m_pContext->RSSetState(m_RasterizerState.Get());
+		m_pContext->OMSetBlendState(m_BlendState.Get(), m_BlendFactor, m_SampleMask);
+		m_pContext->IASetPrimitiveTopology(m_Topology);
+	}
+
+private:
+	ID3D11DeviceContext* m_pContext;
+	Microsoft::WRL::ComPtr<ID3D11BlendState> m_BlendState;
+	float m_BlendFactor[4];
+	uint32_t m_SampleMask;
+	D3D11_PRIMITIVE_TOPOLOGY m_Topology;
+	Microsoft::WRL::ComPtr<ID3D11RasterizerState> m_RasterizerState;
+	Microsoft::WRL::ComPtr<ID3D11Buffer> m_Constants;
+};
+
 CompositorD3D* CompositorD3D::Create(IUnknown* d3dPtr)
 {
 	// Get the device for this context
@@ -59,18 +97,32 @@ CompositorD3D::CompositorD3D(ID3D11Device* pDevice, ID3D11DeviceContext* pContex
 	, m_pQueue(pQueue)
 {
 	// Create the shaders.
-	m_pDevice->CreateVertexShader(g_VertexShader, sizeof(g_VertexShader), NULL, m_VertexShader.GetAddressOf());
-	m_pDevice->CreatePixelShader(g_MirrorShader, sizeof(g_MirrorShader), NULL, m_MirrorShader.GetAddressOf());
+	m_pDevice->CreateVertexShader(g_LayerShader, sizeof(g_LayerShader), NULL, m_LayerShader.GetAddressOf());
 	m_pDevice->CreatePixelShader(g_CompositorShader, sizeof(g_CompositorShader), NULL, m_CompositorShader.GetAddressOf());
 
-	// Create the vertex buffer.
+	// Create the static quad, it's mapped onto each layer by the layer shader.
+	Vertex quad[4] = {
+		{ { 0.0f, 0.0f },{ 0.0f, 0.0f } },
+		{ { 1.0f, 0.0f },{ 1.0f, 0.0f } },
+		{ { 0.0f, 1.0f },{ 0.0f, 1.0f } },
+		{ { 1.0f, 1.0f },{ 1.0f, 1.0f } }
+	};
+	D3D11_SUBRESOURCE_DATA quadData = { quad, 0, 0 };
 	D3D11_BUFFER_DESC bufferDesc;
-	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
 	bufferDesc.ByteWidth = sizeof(Vertex) * 4;
 	bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	bufferDesc.CPUAccessFlags = 0;
 	bufferDesc.MiscFlags = 0;
-	m_pDevice->CreateBuffer(&bufferDesc, nullptr, m_VertexBuffer.GetAddressOf());
+	m_pDevice->CreateBuffer(&bufferDesc, &quadData, m_QuadBuffer.GetAddressOf());
+
+	// Create the per-layer constant buffer.
+	static_assert(sizeof(LayerConstants) % 16 == 0, "Constant buffers need to be aligned to 16 bytes");
+	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.ByteWidth = sizeof(LayerConstants);
+	bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	m_pDevice->CreateBuffer(&bufferDesc, nullptr, m_LayerConstants.GetAddressOf());
 
 	// Create the input layout.
 	D3D11_INPUT_ELEMENT_DESC layout[] =
@@ -80,7 +132,7 @@ CompositorD3D::CompositorD3D(ID3D11Device* pDevice, ID3D11DeviceContext* pContex
 		{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 8,
 		D3D11_INPUT_PER_VERTEX_DATA, 0 },
 	};
-	HRESULT hr = m_pDevice->CreateInputLayout(layout, 2, g_VertexShader, sizeof(g_VertexShader), m_InputLayout.GetAddressOf());
+	HRESULT hr = m_pDevice->CreateInputLayout(layout, 2, g_LayerShader, sizeof(g_LayerShader), m_InputLayout.GetAddressOf());
 
 	// Create state objects.
 	D3D11_BLEND_DESC bm = { 0 };
@@ -120,38 +172,30 @@ TextureBase* CompositorD3D::CreateTexture()
 
 void CompositorD3D::RenderMirrorTexture(ovrMirrorTexture mirrorTexture)
 {
-	// Get the current state objects
-	Microsoft::WRL::ComPtr<ID3D11BlendState> blend_state;
-	float blend_factor[4];
-	uint32_t sample_mask;
-	m_pContext->OMGetBlendState(blend_state.GetAddressOf(), blend_factor, &sample_mask);
-
-	D3D11_PRIMITIVE_TOPOLOGY topology;
-	m_pContext->IAGetPrimitiveTopology(&topology);
-
-	ID3D11RasterizerState* ras_state;
-	m_pContext->RSGetState(&ras_state);
+	// Save the state that we change, it's restored when the scope ends
+	StateBackup backup(m_pContext.Get());
 
 	// Get the mirror texture
 	TextureD3D* texture = (TextureD3D*)mirrorTexture->Texture.get();
 	texture->Acquire();
 
-	// Set the mirror shaders
-	m_pContext->VSSetShader(m_VertexShader.Get(), NULL, 0);
-	m_pContext->PSSetShader(m_MirrorShader.Get(), NULL, 0);
-	m_pContext->PSSetShaderResources(0, ovrEye_Count, m_pMirror);
-
-	// Update the vertex buffer
-	Vertex vertices[4] = {
-		{ { -1.0f,  1.0f },{ 0.0f, 0.0f } },
-		{ {  1.0f,  1.0f },{ 1.0f, 0.0f } },
-		{ { -1.0f, -1.0f },{ 0.0f, 1.0f } },
-		{ {  1.0f, -1.0f },{ 1.0f, 1.0f } }
-	};
-	D3D11_MAPPED_SUBRESOURCE map = { 0 };
-	m_pContext->Map(m_VertexBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &map);
-	memcpy(map.pData, vertices, sizeof(Vertex) * 4);
-	m_pContext->Unmap(m_VertexBuffer.Get(), 0);
+	// Select which eyes to mirror, a single eye covers the whole mirror texture
+	ovrEyeType eyes[ovrEye_Count] = { ovrEye_Left, ovrEye_Right };
+	int eyeCount = ovrEye_Count;
+	if (mirrorTexture->Desc.MirrorOptions & ovrMirrorOption_LeftEyeOnly)
+		eyeCount = 1;
+	else if (mirrorTexture->Desc.MirrorOptions & ovrMirrorOption_RightEyeOnly)
+		eyes[0] = ovrEye_Right, eyeCount = 1;
+
+	// Set the compositor shaders and the static quad
+	uint32_t stride = sizeof(Vertex);
+	uint32_t offset = 0;
+	m_pContext->VSSetShader(m_LayerShader.Get(), NULL, 0);
+	m_pContext->VSSetConstantBuffers(0, 1, m_LayerConstants.GetAddressOf());
+	m_pContext->PSSetShader(m_CompositorShader.Get(), NULL, 0);
+	m_pContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+	m_pContext->IASetInputLayout(m_InputLayout.Get());
+	m_pContext->IASetVertexBuffers(0, 1, m_QuadBuffer.GetAddressOf(), &stride, &offset);
 
 	// Prepare the render target
 	FLOAT clear[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
@@ -164,81 +208,88 @@ void CompositorD3D::RenderMirrorTexture(ovrMirrorTexture mirrorTexture)
 	m_pContext->OMSetBlendState(nullptr, nullptr, -1);
 	m_pContext->RSSetState(nullptr);
 
-	// Set and draw the vertices
-	UINT stride = sizeof(Vertex);
-	UINT offset = 0;
-	m_pContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
-	m_pContext->IASetInputLayout(m_InputLayout.Get());
-	m_pContext->IASetVertexBuffers(0, 1, m_VertexBuffer.GetAddressOf(), &stride, &offset);
-	m_pContext->Draw(4, 0);
-
-	// Restore the state objects
-	m_pContext->RSSetState(ras_state);
-	m_pContext->OMSetBlendState(blend_state.Get(), blend_factor, sample_mask);
-	m_pContext->IASetPrimitiveTopology(topology);
+	// Draw the eyes side-by-side
+	float width = 2.0f / eyeCount;
+	for (int i = 0; i < eyeCount; i++)
+	{
+		LayerConstants constants = {
+			{ -1.0f + i * width, -1.0f + (i + 1) * width, 1.0f, -1.0f },
+			{ 0.0f, 0.0f, 1.0f, 1.0f }
+		};
+		D3D11_MAPPED_SUBRESOURCE map = { 0 };
+		m_pContext->Map(m_LayerConstants.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &map);
+		memcpy(map.pData, &constants, sizeof(LayerConstants));
+		m_pContext->Unmap(m_LayerConstants.Get(), 0);
+		m_pContext->PSSetShaderResources(0, 1, &m_pMirror[eyes[i]]);
+		m_pContext->Draw(4, 0);
+	}
 
 	// Flush and release
 	m_pContext->Flush();
 	texture->Release();
 }
 
-void CompositorD3D::RenderTextureSwapChain(vr::EVREye eye, TextureBase* src, TextureBase* dst, ovrRecti viewport, vr::VRTextureBounds_t bounds, vr::HmdVector4_t quad)
+void CompositorD3D::RenderLayerBlits(LayerBatch& batch)
 {
-	// Get the current state objects
-	Microsoft::WRL::ComPtr<ID3D11BlendState> blend_state;
-	float blend_factor[4];
-	uint32_t sample_mask;
-	m_pContext->OMGetBlendState(blend_state.GetAddressOf(), blend_factor, &sample_mask);
+	// Save the state that we change, it's restored when the scope ends
+	StateBackup backup(m_pContext.Get());
+	batch.Render(this);
+}
 
-	D3D11_PRIMITIVE_TOPOLOGY topology;
-	m_pContext->IAGetPrimitiveTopology(&topology);
+void CompositorD3D::AcquireLayerTexture(TextureBase* texture)
+{
+	((TextureD3D*)texture)->Acquire();
+}
 
-	ID3D11RasterizerState* ras_state;
-	m_pContext->RSGetState(&ras_state);
+void CompositorD3D::ReleaseLayerTexture(TextureBase* texture)
+{
+	((TextureD3D*)texture)->Release();
+}
 
-	// Set the compositor shaders
-	m_pContext->VSSetShader(m_VertexShader.Get(), NULL, 0);
+void CompositorD3D::BeginLayers()
+{
+	// Set the compositor shaders and the static quad
+	uint32_t stride = sizeof(Vertex);
+	uint32_t offset = 0;
+	m_pContext->VSSetShader(m_LayerShader.Get(), NULL, 0);
+	m_pContext->VSSetConstantBuffers(0, 1, m_LayerConstants.GetAddressOf());
 	m_pContext->PSSetShader(m_CompositorShader.Get(), NULL, 0);
-	ID3D11ShaderResourceView* resource = ((TextureD3D*)src)->Resource();
+	m_pContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+	m_pContext->IASetInputLayout(m_InputLayout.Get());
+	m_pContext->IASetVertexBuffers(0, 1, m_QuadBuffer.GetAddressOf(), &stride, &offset);
+	m_pContext->OMSetBlendState(m_BlendState.Get(), nullptr, -1);
+	m_pContext->RSSetState(nullptr);
+}
+
+void CompositorD3D::SetLayerSource(TextureBase* texture)
+{
+	ID3D11ShaderResourceView* resource = ((TextureD3D*)texture)->Resource();
 	m_pContext->PSSetShaderResources(0, 1, &resource);
+}
 
-	// Update the vertex buffer
-	Vertex vertices[4] = {
-		{ { quad.v[0], quad.v[2] },{ bounds.uMin, bounds.vMin } },
-		{ { quad.v[1], quad.v[2] },{ bounds.uMax, bounds.vMin } },
-		{ { quad.v[0], quad.v[3] },{ bounds.uMin, bounds.vMax } },
-		{ { quad.v[1], quad.v[3] },{ bounds.uMax, bounds.vMax } }
-	};
-	D3D11_MAPPED_SUBRESOURCE map = { 0 };
-	m_pContext->Map(m_VertexBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &map);
-	memcpy(map.pData, vertices, sizeof(Vertex) * 4);
-	m_pContext->Unmap(m_VertexBuffer.Get(), 0);
+void CompositorD3D::SetLayerTarget(TextureBase* texture)
+{
+	ID3D11RenderTargetView* target = ((TextureD3D*)texture)->Target();
+	m_pContext->OMSetRenderTargets(1, &target, nullptr);
+}
 
-	// Prepare the render target
-	((TextureD3D*)src)->Acquire();
-	((TextureD3D*)dst)->Acquire();
-	D3D11_VIEWPORT vp = { (float)viewport.Pos.x, (float)viewport.Pos.y, (float)viewport.Size.w, (float)viewport.Size.h, D3D11_MIN_DEPTH, D3D11_MIN_DEPTH };
+void CompositorD3D::DrawLayer(const LayerBlit& blit)
+{
+	D3D11_VIEWPORT vp = { (float)blit.Viewport[0], (float)blit.Viewport[1], (float)blit.Viewport[2], (float)blit.Viewport[3], D3D11_MIN_DEPTH, D3D11_MIN_DEPTH };
 	m_pContext->RSSetViewports(1, &vp);
-	ID3D11RenderTargetView* target = ((TextureD3D*)dst)->Target();
-	m_pContext->OMSetRenderTargets(1, &target, nullptr);
-	m_pContext->OMSetBlendState(m_BlendState.Get(), nullptr, -1);
-	m_pContext->RSSetState(nullptr);
 
-	// Set and draw the vertices
-	uint32_t stride = sizeof(Vertex);
-	uint32_t offset = 0;
-	m_pContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
-	m_pContext->IASetInputLayout(m_InputLayout.Get());
-	m_pContext->IASetVertexBuffers(0, 1, m_VertexBuffer.GetAddressOf(), &stride, &offset);
+	// Update the layer constants and draw the quad
+	LayerConstants constants;
+	memcpy(&constants.Quad, blit.Quad, sizeof(constants.Quad));
+	memcpy(&constants.Bounds, blit.Bounds, sizeof(constants.Bounds));
+	D3D11_MAPPED_SUBRESOURCE map = { 0 };
+	m_pContext->Map(m_LayerConstants.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &map);
+	memcpy(map.pData, &constants, sizeof(LayerConstants));
+	m_pContext->Unmap(m_LayerConstants.Get(), 0);
 	m_pContext->Draw(4, 0);
+}
 
-	// Restore the state objects
-	m_pContext->RSSetState(ras_state);
-	m_pContext->OMSetBlendState(blend_state.Get(), blend_factor, sample_mask);
-	m_pContext->IASetPrimitiveTopology(topology);
-
-	// Flush and release
+void CompositorD3D::EndLayers()
+{
 	m_pContext->Flush();
-	((TextureD3D*)src)->Release();
-	((TextureD3D*)dst)->Release();
 }
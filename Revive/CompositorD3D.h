@@ -7,7 +7,8 @@
 #include <openvr.h>
 
 class CompositorD3D :
-	public CompositorBase
+	public CompositorBase,
+	private LayerRenderer
 {
 public:
 	CompositorD3D(ID3D11Device* pDevice, ID3D11DeviceContext* pContext, ID3D12CommandQueue* pQueue = nullptr);
@@ -19,7 +20,7 @@ public:
 	virtual void Flush() { if (m_pContext) m_pContext->Flush(); };
 	virtual TextureBase* CreateTexture();
 
-	virtual void RenderTextureSwapChain(vr::EVREye eye, TextureBase* src, TextureBase* dst, ovrRecti viewport, vr::VRTextureBounds_t bounds, vr::HmdVector4_t quad);
+	virtual void RenderLayerBlits(LayerBatch& batch);
 	virtual void RenderMirrorTexture(ovrMirrorTexture mirrorTexture);
 
 protected:
@@ -31,12 +32,12 @@ protected:
 	Microsoft::WRL::ComPtr<ID3D12CommandQueue> m_pQueue;
 
 	// Shaders
-	Microsoft::WRL::ComPtr<ID3D11VertexShader> m_VertexShader;
-	Microsoft::WRL::ComPtr<ID3D11PixelShader> m_MirrorShader;
+	Microsoft::WRL::ComPtr<ID3D11VertexShader> m_LayerShader;
 	Microsoft::WRL::ComPtr<ID3D11PixelShader> m_CompositorShader;
 
 	// Input
-	Microsoft::WRL::ComPtr<ID3D11Buffer> m_VertexBuffer;
+	Microsoft::WRL::ComPtr<ID3D11Buffer> m_QuadBuffer;
+	Microsoft::WRL::ComPtr<ID3D11Buffer> m_LayerConstants;
 	Microsoft::WRL::ComPtr<ID3D11InputLayout> m_InputLayout;
 
 	// States
@@ -44,4 +45,14 @@ protected:
 
 	// Mirror
 	ID3D11ShaderResourceView* m_pMirror[ovrEye_Count];
+
+private:
+	// Layer rendering
+	virtual void AcquireLayerTexture(TextureBase* texture);
+	virtual void ReleaseLayerTexture(TextureBase* texture);
+	virtual void BeginLayers();
+	virtual void SetLayerSource(TextureBase* texture);
+	virtual void SetLayerTarget(TextureBase* texture);
+	virtual void DrawLayer(const LayerBlit& blit);
+	virtual void EndLayers();
 };
@@ -38,31 +38,20 @@ void CompositorGL::Flush()
 }
 
 CompositorGL::CompositorGL()
+	: m_mirror()
+	, m_mirrorFB()
 {
-	// Get the mirror textures
-	/*glGenFramebuffers(ovrEye_Count, m_mirrorFB);
-	for (int i = 0; i < ovrEye_Count; i++)
-	{
-		vr::VRCompositor()->GetMirrorTextureGL((vr::EVREye)i, &m_mirror[i].first, &m_mirror[i].second);
-
-		GLint drawFboId = 0, readFboId = 0;
-		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &drawFboId);
-		glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &readFboId);
-
-		glBindFramebuffer(GL_FRAMEBUFFER, m_mirrorFB[i]);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_mirror[i].first, 0);
-		glReadBuffer(GL_COLOR_ATTACHMENT0);
-		glDrawBuffer(GL_COLOR_ATTACHMENT0);
-
-		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, drawFboId);
-		glBindFramebuffer(GL_READ_FRAMEBUFFER, readFboId);
-	}*/
 }
 
 CompositorGL::~CompositorGL()
 {
 	for (int i = 0; i < ovrEye_Count; i++)
-		vr::VRCompositor()->ReleaseSharedGLTexture(m_mirror[i].first, m_mirror[i].second);
+	{
+		if (m_mirrorFB[i])
+			glDeleteFramebuffers(1, &m_mirrorFB[i]);
+		if (m_mirror[i].second)
+			vr::VRCompositor()->ReleaseSharedGLTexture(m_mirror[i].first, m_mirror[i].second);
+	}
 }
 
 TextureBase* CompositorGL::CreateTexture()
@@ -72,37 +61,47 @@ TextureBase* CompositorGL::CreateTexture()
 
 void CompositorGL::RenderMirrorTexture(ovrMirrorTexture mirrorTexture)
 {
-	/*GLint drawFboId = 0, readFboId = 0, texId = 0;
-	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &drawFboId);
-	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &readFboId);
-	glGetIntegerv(GL_TEXTURE_BINDING_2D, &texId);
+	// Select which eyes to mirror, a single eye covers the whole mirror texture
+	ovrEyeType eyes[ovrEye_Count] = { ovrEye_Left, ovrEye_Right };
+	int eyeCount = ovrEye_Count;
+	if (mirrorTexture->Desc.MirrorOptions & ovrMirrorOption_LeftEyeOnly)
+		eyeCount = 1;
+	else if (mirrorTexture->Desc.MirrorOptions & ovrMirrorOption_RightEyeOnly)
+		eyes[0] = ovrEye_Right, eyeCount = 1;
 
 	TextureGL* texture = (TextureGL*)mirrorTexture->Texture.get();
-	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, texture->Framebuffer);
-
-	for (int i = 0; i < ovrEye_Count; i++)
+	GLint width = mirrorTexture->Desc.Width / eyeCount;
+	for (int i = 0; i < eyeCount; i++)
 	{
-		vr::VRCompositor()->LockGLSharedTextureForAccess(m_mirror[i].second);
+		ovrEyeType eye = eyes[i];
 
-		GLint width, height;
-		glBindTexture(GL_TEXTURE_2D, m_mirror[i].first);
-		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
-		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+		// Get the mirror textures the first time they're actually needed
+		if (!m_mirrorFB[eye])
+		{
+			if (vr::VRCompositor()->GetMirrorTextureGL((vr::EVREye)eye, &m_mirror[eye].first, &m_mirror[eye].second) != vr::VRCompositorError_None)
+				continue;
 
-		// Bind the buffer to copy from the compositor to the mirror texture
-		glBindFramebuffer(GL_READ_FRAMEBUFFER, m_mirrorFB[i]);
-		GLint offset = (mirrorTexture->Desc.Width / 2) * i;
-		glBlitFramebuffer(0, 0, width, height, offset, 0, offset + mirrorTexture->Desc.Width / 2, mirrorTexture->Desc.Height, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+			glCreateFramebuffers(1, &m_mirrorFB[eye]);
+			glNamedFramebufferTexture(m_mirrorFB[eye], GL_COLOR_ATTACHMENT0, m_mirror[eye].first, 0);
+			glNamedFramebufferReadBuffer(m_mirrorFB[eye], GL_COLOR_ATTACHMENT0);
+		}
 
-		vr::VRCompositor()->UnlockGLSharedTextureForAccess(m_mirror[i].second);
-	}
+		vr::VRCompositor()->LockGLSharedTextureForAccess(m_mirror[eye].second);
 
-	glBindTexture(GL_TEXTURE_2D, texId);
-	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, drawFboId);
-	glBindFramebuffer(GL_READ_FRAMEBUFFER, readFboId);*/
+		GLint srcWidth, srcHeight;
+		glGetTextureLevelParameteriv(m_mirror[eye].first, 0, GL_TEXTURE_WIDTH, &srcWidth);
+		glGetTextureLevelParameteriv(m_mirror[eye].first, 0, GL_TEXTURE_HEIGHT, &srcHeight);
+
+		// Copy from the compositor to the mirror texture
+		GLint offset = width * i;
+		glBlitNamedFramebuffer(m_mirrorFB[eye], texture->Framebuffer, 0, 0, srcWidth, srcHeight,
+			offset, 0, offset + width, mirrorTexture->Desc.Height, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+
+		vr::VRCompositor()->UnlockGLSharedTextureForAccess(m_mirror[eye].second);
+	}
 }
 
-void CompositorGL::RenderTextureSwapChain(vr::EVREye eye, TextureBase* src, TextureBase* dst, ovrRecti viewport, vr::VRTextureBounds_t bounds, vr::HmdVector4_t quad)
+void CompositorGL::RenderLayerBlits(LayerBatch& batch)
 {
 	// TODO: Support blending multiple scene layers
 }
@@ -17,12 +17,12 @@ public:
 	virtual void Flush() override;
 	virtual TextureBase* CreateTexture() override;
 
-	virtual void RenderTextureSwapChain(vr::EVREye eye, TextureBase* src, TextureBase* dst, ovrRecti viewport, vr::VRTextureBounds_t bounds, vr::HmdVector4_t quad);
+	virtual void RenderLayerBlits(LayerBatch& batch);
 	virtual void RenderMirrorTexture(ovrMirrorTexture mirrorTexture);
 
 protected:
 	std::pair<vr::glUInt_t, vr::glSharedTextureHandle_t> m_mirror[ovrEye_Count];
-	unsigned int m_mirrorFB[ovrEye_Count];
+	unsigned int m_mirrorFB[ovrEye_Count];	// Created on first use
 
 private:
 	static unsigned char gladInitialized;
@@ -22,7 +22,7 @@ void CompositorVk::RenderMirrorTexture(ovrMirrorTexture mirrorTexture)
 	// TODO: Support mirror textures
 }
 
-void CompositorVk::RenderTextureSwapChain(vr::EVREye eye, TextureBase* src, TextureBase* dst, ovrRecti viewport, vr::VRTextureBounds_t bounds, vr::HmdVector4_t quad)
+void CompositorVk::RenderLayerBlits(LayerBatch& batch)
 {
 	// TODO: Support blending multiple scene layers
 }
@@ -13,7 +13,7 @@ public:
 	virtual void Flush() { }
 	virtual TextureBase* CreateTexture();
 
-	virtual void RenderTextureSwapChain(vr::EVREye eye, TextureBase* src, TextureBase* dst, ovrRecti viewport, vr::VRTextureBounds_t bounds, vr::HmdVector4_t quad);
+	virtual void RenderLayerBlits(LayerBatch& batch);
 	virtual void RenderMirrorTexture(ovrMirrorTexture mirrorTexture);
 
 	void SetDevice(VkDevice device) { m_device = device; }
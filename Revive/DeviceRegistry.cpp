@@ -0,0 +1,39 @@
+#include "DeviceRegistry.h"
+#include "Common.h"
+
+#include <algorithm>
+
+MICROPROFILE_DEFINE(UpdateDevices, "Input", "UpdateDevices", 0x00ffff);
+
+DeviceRegistry::DeviceRegistry()
+	: m_Snapshot()
+{
+	Update();
+}
+
+void DeviceRegistry::Update()
+{
+	MICROPROFILE_SCOPE(UpdateDevices);
+
+	std::shared_ptr<Snapshot> snapshot = std::make_shared<Snapshot>();
+
+	for (vr::TrackedDeviceIndex_t i = 0; i < vr::k_unMaxTrackedDeviceCount; i++)
+	{
+		snapshot->Classes[i] = vr::VRSystem()->GetTrackedDeviceClass(i);
+		snapshot->Connected[i] = snapshot->Classes[i] != vr::TrackedDeviceClass_Invalid &&
+			vr::VRSystem()->IsTrackedDeviceConnected(i);
+	}
+
+	snapshot->Hands[ovrHand_Left] = vr::VRSystem()->GetTrackedDeviceIndexForControllerRole(vr::TrackedControllerRole_LeftHand);
+	snapshot->Hands[ovrHand_Right] = vr::VRSystem()->GetTrackedDeviceIndexForControllerRole(vr::TrackedControllerRole_RightHand);
+
+	std::fill_n(snapshot->Trackers, vr::k_unMaxTrackedDeviceCount, vr::k_unTrackedDeviceIndexInvalid);
+	snapshot->TrackerCount = std::min(vr::k_unMaxTrackedDeviceCount, vr::VRSystem()->GetSortedTrackedDeviceIndicesOfClass(
+		vr::TrackedDeviceClass_GenericTracker, snapshot->Trackers, vr::k_unMaxTrackedDeviceCount));
+
+	std::fill_n(snapshot->References, vr::k_unMaxTrackedDeviceCount, vr::k_unTrackedDeviceIndexInvalid);
+	snapshot->ReferenceCount = std::min(vr::k_unMaxTrackedDeviceCount, vr::VRSystem()->GetSortedTrackedDeviceIndicesOfClass(
+		vr::TrackedDeviceClass_TrackingReference, snapshot->References, vr::k_unMaxTrackedDeviceCount));
+
+	std::atomic_store(&m_Snapshot, std::shared_ptr<const Snapshot>(snapshot));
+}
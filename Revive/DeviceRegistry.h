@@ -0,0 +1,41 @@
+#pragma once
+
+#include "OVR_CAPI.h"
+
+#include <openvr.h>
+#include <memory>
+
+// Registry of the tracked device roles and classes.
+// The registry is only rebuilt when devices are (de)activated or change roles, readers get an
+// immutable snapshot so the per-frame paths don't need to query the roles from the runtime.
+class DeviceRegistry
+{
+public:
+	struct Snapshot
+	{
+		vr::TrackedDeviceIndex_t Hands[ovrHand_Count];
+		vr::ETrackedDeviceClass Classes[vr::k_unMaxTrackedDeviceCount];
+		bool Connected[vr::k_unMaxTrackedDeviceCount];
+
+		// Generic trackers and tracking references, unused entries are set to an invalid index
+		uint32_t TrackerCount;
+		vr::TrackedDeviceIndex_t Trackers[vr::k_unMaxTrackedDeviceCount];
+		uint32_t ReferenceCount;
+		vr::TrackedDeviceIndex_t References[vr::k_unMaxTrackedDeviceCount];
+
+		bool IsConnected(vr::TrackedDeviceIndex_t index) const
+		{
+			return index < vr::k_unMaxTrackedDeviceCount && Connected[index];
+		}
+	};
+
+	DeviceRegistry();
+	~DeviceRegistry() { }
+
+	// Rebuilds the snapshot from the runtime and publishes it to the readers
+	void Update();
+	std::shared_ptr<const Snapshot> GetSnapshot() const { return std::atomic_load(&m_Snapshot); }
+
+private:
+	std::shared_ptr<const Snapshot> m_Snapshot;
+};
@@ -0,0 +1,89 @@
+#include "FrameClock.h"
+
+#include <openvr.h>
+#include <Windows.h>
+#include <math.h>
+#include <algorithm>
+
+// Recalibrate if no frame has calibrated the clock in this many seconds, this bounds the drift
+// between the performance counter and the display clock while the application isn't rendering.
+#define REV_CLOCK_MAX_UNCALIBRATED 1.0
+// Small corrections are slewed rather than applied at once, this filters out the jitter in the
+// remaining frame time reported by the compositor.
+#define REV_CLOCK_MAX_SLEW 0.0005
+
+FrameClock::FrameClock()
+	: m_Frequency(1)
+	, m_DisplayFrequency(0.0f)
+	, m_Epoch(0)
+	, m_Base(0)
+	, m_CalibratedTicks(0)
+	, m_LastTicks(0)
+	, m_PredictionID(0)
+{
+	LARGE_INTEGER freq;
+	if (QueryPerformanceFrequency(&freq))
+		m_Frequency = freq.QuadPart;
+
+	// Until the first calibration the clock counts from its creation
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+	m_Epoch = now.QuadPart;
+	m_Base = now.QuadPart;
+}
+
+void FrameClock::Calibrate(float displayFrequency)
+{
+	if (!vr::VRCompositor() || displayFrequency <= 0.0f)
+		return;
+
+	uint32_t predictionID = 0;
+	vr::VRCompositor()->GetLastPosePredictionIDs(&predictionID, nullptr);
+	float remaining = vr::VRCompositor()->GetFrameTimeRemaining();
+
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+
+	// The time base is the same one used to convert absolute times back to prediction IDs
+	double frameDuration = 1.0 / displayFrequency;
+	double time = predictionID * frameDuration + frameDuration - remaining;
+	int64_t epoch = now.QuadPart - (int64_t)(time * m_Frequency);
+
+	// Snap to the new epoch on large corrections, such as the first calibration or a compositor restart
+	int64_t oldEpoch = m_Epoch;
+	int64_t slew = (int64_t)(REV_CLOCK_MAX_SLEW * m_Frequency);
+	bool snap = m_DisplayFrequency <= 0.0f || llabs(epoch - oldEpoch) >= (int64_t)(frameDuration * m_Frequency);
+	if (!snap)
+		epoch = oldEpoch + std::max(-slew, std::min(slew, epoch - oldEpoch));
+
+	// The returned time jumps forward with the epoch, but if the time base went backwards it continues
+	// from the last returned time instead. The remaining difference is slewed away on later calibrations.
+	int64_t base = m_Base;
+	if (snap)
+		base = std::min(epoch, now.QuadPart - m_LastTicks);
+	else
+		base += std::max(-slew, std::min(slew, epoch - base));
+
+	m_Epoch = epoch;
+	m_Base = base;
+	m_PredictionID = predictionID;
+	m_DisplayFrequency = displayFrequency;
+	m_CalibratedTicks = now.QuadPart;
+}
+
+double FrameClock::GetTimeInSeconds()
+{
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+
+	// Only a single thread gets to recalibrate a stale clock
+	int64_t calibrated = m_CalibratedTicks;
+	if (now.QuadPart - calibrated > (int64_t)(REV_CLOCK_MAX_UNCALIBRATED * m_Frequency) &&
+		m_CalibratedTicks.compare_exchange_strong(calibrated, now.QuadPart))
+		Calibrate(m_DisplayFrequency);
+
+	int64_t ticks = now.QuadPart - m_Base;
+	int64_t last = m_LastTicks;
+	while (ticks > last && !m_LastTicks.compare_exchange_weak(last, ticks));
+	return (double)std::max(ticks, last) / m_Frequency;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+// Monotonic clock in the time base of the compositor.
+// The clock is calibrated against the compositor vsync once per frame and otherwise answers from
+// the performance counter, so reading the time doesn't require any round trips to the compositor.
+class FrameClock
+{
+public:
+	FrameClock();
+
+	// Calibrates the clock against the compositor, should be called right after waiting for vsync
+	void Calibrate(float displayFrequency);
+	double GetTimeInSeconds();
+
+	// The pose prediction ID of the frame the clock was last calibrated on
+	uint32_t GetPredictionID() const { return m_PredictionID; }
+
+private:
+	int64_t m_Frequency;
+	std::atomic<float> m_DisplayFrequency;
+
+	// Performance counter value that corresponds to time zero in the compositor time base
+	std::atomic_int64_t m_Epoch;
+	// Performance counter value that corresponds to time zero in the returned times. It follows the
+	// epoch, but lags behind it when the time base jumps backwards so the returned time doesn't.
+	std::atomic_int64_t m_Base;
+	std::atomic_int64_t m_CalibratedTicks;
+	// Last time returned in ticks since the base, ensures the clock never goes backwards while the
+	// base is slewed
+	std::atomic_int64_t m_LastTicks;
+	std::atomic_uint32_t m_PredictionID;
+};
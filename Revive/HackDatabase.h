@@ -0,0 +1,241 @@
+#pragma once
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <bitset>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+// Database of runtime and game quirks, shared between the OpenVR and OpenXR backends.
+//
+// The database is a versioned text file with one rule per line:
+//
+//   version 1
+//   <backend> <hack> [exe=<filename>] [runtime=<name>] [version=<start>-<end>] [enable=0|1]
+//
+// Values containing spaces can be quoted. Version ranges are half-open and written as
+// "major.minor.patch", an empty end means the range is unbounded. A rule with enable=0 enables
+// the hack on everything that does *not* match the rule.
+//
+// The database only depends on the standard library, so the matchers can be evaluated outside
+// of the runtime. The rules are compiled into a bitset once, so queries are a single bit test.
+class HackDatabase
+{
+public:
+	static const uint32_t Version = 1;
+
+	struct Rule
+	{
+		std::string Backend;	// The backend the hack applies to ("vr" or "xr")
+		std::string Hack;		// The name of the hack
+		std::string Filename;	// The filename of the main executable
+		std::string Runtime;	// The name of the runtime or driver
+		uint64_t VersionStart;	// When it started
+		uint64_t VersionEnd;	// When it ended
+		bool UseHack;			// Should it use the hack?
+	};
+
+	std::vector<Rule> Rules;
+
+	// Packs a "major.minor.patch" string the same way as XR_MAKE_VERSION
+	static uint64_t ParseVersion(const std::string& str)
+	{
+		uint64_t major = 0, minor = 0, patch = 0;
+		char dot;
+		std::istringstream stream(str);
+		stream >> major;
+		if (stream >> dot >> minor)
+			stream >> dot >> patch;
+		return ((major & 0xffffULL) << 48) | ((minor & 0xffffULL) << 32) | (patch & 0xffffffffULL);
+	}
+
+	static bool EqualsNoCase(const std::string& a, const char* b)
+	{
+		size_t i = 0;
+		for (; i < a.size() && b[i]; i++)
+		{
+			if (tolower((unsigned char)a[i]) != tolower((unsigned char)b[i]))
+				return false;
+		}
+		return i == a.size() && !b[i];
+	}
+
+	bool Parse(std::istream& stream)
+	{
+		std::vector<Rule> rules;
+		bool versioned = false;
+		std::string line;
+		while (std::getline(stream, line))
+		{
+			std::vector<std::string> tokens;
+			if (!Tokenize(line, tokens))
+				return false;
+			if (tokens.empty())
+				continue;
+
+			if (tokens[0] == "version")
+			{
+				// Refuse to load a database written for a different format
+				if (tokens.size() != 2 || strtoul(tokens[1].c_str(), nullptr, 10) != Version)
+					return false;
+				versioned = true;
+				continue;
+			}
+
+			if (!versioned || tokens.size() < 2)
+				return false;
+
+			Rule rule = { tokens[0], tokens[1], "", "", 0, 0, true };
+			for (size_t i = 2; i < tokens.size(); i++)
+			{
+				size_t split = tokens[i].find('=');
+				if (split == std::string::npos)
+					return false;
+
+				std::string key = tokens[i].substr(0, split);
+				std::string value = tokens[i].substr(split + 1);
+				if (key == "exe")
+					rule.Filename = value;
+				else if (key == "runtime")
+					rule.Runtime = value;
+				else if (key == "enable")
+					rule.UseHack = value != "0";
+				else if (key == "version")
+				{
+					size_t range = value.find('-');
+					if (range == std::string::npos)
+						return false;
+					rule.VersionStart = ParseVersion(value.substr(0, range));
+					rule.VersionEnd = range + 1 < value.size() ? ParseVersion(value.substr(range + 1)) : 0;
+				}
+				else
+					return false;
+			}
+			rules.push_back(rule);
+		}
+
+		if (!versioned)
+			return false;
+
+		Rules = std::move(rules);
+		return true;
+	}
+
+	bool Parse(const char* str)
+	{
+		std::istringstream stream(str);
+		return Parse(stream);
+	}
+
+	bool Load(const std::string& path)
+	{
+		std::ifstream file(path);
+		return file.is_open() && Parse(file);
+	}
+
+	static bool Matches(const Rule& rule, const char* filename, const char* runtime, uint64_t version)
+	{
+		return (rule.Filename.empty() || EqualsNoCase(rule.Filename, filename)) &&
+			(rule.Runtime.empty() || rule.Runtime == runtime) &&
+			rule.VersionStart <= version && (!rule.VersionEnd || version < rule.VersionEnd);
+	}
+
+	// Compiles the rules for a backend into a bitset indexed by the hack enum, the names array
+	// maps every enum value to the name used in the database.
+	template<size_t N>
+	std::bitset<N> Evaluate(const char* backend, const char* (&names)[N],
+		const char* filename, const char* runtime, uint64_t version) const
+	{
+		std::bitset<N> result;
+		for (const Rule& rule : Rules)
+		{
+			if (rule.Backend != backend)
+				continue;
+
+			for (size_t i = 0; i < N; i++)
+			{
+				if (rule.Hack != names[i])
+					continue;
+
+				if (Matches(rule, filename, runtime, version) == rule.UseHack)
+					result.set(i);
+			}
+		}
+		return result;
+	}
+
+#ifdef _WIN32
+	// The database is installed next to the input manifests, the path can be overridden for development.
+	static std::string GetDefaultPath()
+	{
+		const char* devDatabase = getenv("REVIVE_HACK_DATABASE");
+		if (devDatabase)
+			return devDatabase;
+
+		std::vector<char> pathVec;
+		DWORD pathSize = MAX_PATH;
+		LSTATUS status = RegGetValueA(HKEY_LOCAL_MACHINE, "Software\\Revive", "", RRF_RT_REG_SZ | RRF_SUBKEY_WOW6432KEY, NULL, NULL, &pathSize);
+		if (status != ERROR_SUCCESS)
+			return std::string();
+
+		pathVec.resize(pathSize);
+		status = RegGetValueA(HKEY_LOCAL_MACHINE, "Software\\Revive", "", RRF_RT_REG_SZ | RRF_SUBKEY_WOW6432KEY, NULL, pathVec.data(), &pathSize);
+		if (status != ERROR_SUCCESS)
+			return std::string();
+
+		return std::string(pathVec.data()) + "\\Input\\hacks.txt";
+	}
+
+	// Input/hacks.txt is also embedded in the runtime as the HACKS resource at build time, it's used
+	// when the installed database is missing or can't be parsed.
+	bool LoadEmbedded()
+	{
+		HMODULE module = NULL;
+		if (!GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+			(LPCSTR)&HackDatabase::ParseVersion, &module))
+			return false;
+
+		HRSRC resource = FindResource(module, TEXT("HACKS"), RT_RCDATA);
+		HGLOBAL data = resource ? ::LoadResource(module, resource) : NULL;
+		const char* str = data ? (const char*)LockResource(data) : nullptr;
+		if (!str)
+			return false;
+
+		std::istringstream stream(std::string(str, SizeofResource(module, resource)));
+		return Parse(stream);
+	}
+#endif
+
+private:
+	static bool Tokenize(const std::string& line, std::vector<std::string>& tokens)
+	{
+		std::string token;
+		bool quoted = false, empty = true;
+		for (char c : line)
+		{
+			if (c == '#' && !quoted)
+				break;
+			else if (c == '"')
+				quoted = !quoted, empty = false;
+			else if (isspace((unsigned char)c) && !quoted)
+			{
+				if (!empty)
+					tokens.push_back(token);
+				token.clear();
+				empty = true;
+			}
+			else
+				token += c, empty = false;
+		}
+		if (!empty)
+			tokens.push_back(token);
+		return !quoted;
+	}
+};
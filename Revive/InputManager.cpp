@@ -37,7 +37,9 @@ ovrResult InputManager::InputErrorToOvrError(vr::EVRInputError error)
 }
 
 InputManager::InputManager()
-	: m_InputDevices()
+	: ConnectedControllers(0)
+	, Devices()
+	, m_InputDevices()
 	, m_LastError(vr::VRInputError_None)
 	, m_LastPoses()
 	, m_LastHandPose()
@@ -59,8 +61,8 @@ InputManager::InputManager()
 	err = vr::VRInput()->GetActionSetHandle("/actions/touch", &handle);
 	if (err == vr::VRInputError_None)
 	{
-		m_InputDevices.push_back(new OculusTouch(handle, vr::TrackedControllerRole_LeftHand));
-		m_InputDevices.push_back(new OculusTouch(handle, vr::TrackedControllerRole_RightHand));
+		m_InputDevices.push_back(new OculusTouch(handle, vr::TrackedControllerRole_LeftHand, Devices));
+		m_InputDevices.push_back(new OculusTouch(handle, vr::TrackedControllerRole_RightHand, Devices));
 	}
 	m_LastError = err;
 
@@ -122,10 +124,11 @@ void InputManager::UpdateInputState()
 
 void InputManager::UpdateConnectedControllers()
 {
+	std::shared_ptr<const DeviceRegistry::Snapshot> devices = Devices.GetSnapshot();
 	uint32_t types = 0;
 	for (InputDevice* device : m_InputDevices)
 	{
-		if (device->IsConnected())
+		if (device->IsConnected(*devices))
 			types |= device->GetType();
 	}
 	ConnectedControllers = types;
@@ -270,8 +273,8 @@ void InputManager::GetTrackingState(ovrSession session, ovrTrackingState* outSta
 	outState->StatusFlags = TrackedDevicePoseToOVRStatusFlags(poses[vr::k_unTrackedDeviceIndex_Hmd]);
 
 	// Convert the hand poses
-	vr::TrackedDeviceIndex_t hands[] = { vr::VRSystem()->GetTrackedDeviceIndexForControllerRole(vr::TrackedControllerRole_LeftHand),
-		vr::VRSystem()->GetTrackedDeviceIndexForControllerRole(vr::TrackedControllerRole_RightHand) };
+	std::shared_ptr<const DeviceRegistry::Snapshot> devices = Devices.GetSnapshot();
+	const vr::TrackedDeviceIndex_t* hands = devices->Hands;
 	for (int i = 0; i < ovrHand_Count; i++)
 	{
 		if (hands[i] == vr::k_unTrackedDeviceIndexInvalid)
@@ -304,8 +307,8 @@ ovrResult InputManager::GetDevicePoses(ovrSession session, ovrTrackedDeviceType*
 	vr::VRCompositor()->GetPosesForFrame(predictionID, poses, vr::k_unMaxTrackedDeviceCount);
 
 	// Get the generic tracker indices
-	vr::TrackedDeviceIndex_t trackers[vr::k_unMaxTrackedDeviceCount];
-	vr::VRSystem()->GetSortedTrackedDeviceIndicesOfClass(vr::TrackedDeviceClass_GenericTracker, trackers, vr::k_unMaxTrackedDeviceCount);
+	std::shared_ptr<const DeviceRegistry::Snapshot> devices = Devices.GetSnapshot();
+	const vr::TrackedDeviceIndex_t* trackers = devices->Trackers;
 
 	for (int i = 0; i < deviceCount; i++)
 	{
@@ -317,10 +320,10 @@ ovrResult InputManager::GetDevicePoses(ovrSession session, ovrTrackedDeviceType*
 			index = vr::k_unTrackedDeviceIndex_Hmd;
 			break;
 		case ovrTrackedDevice_LTouch:
-			index = vr::VRSystem()->GetTrackedDeviceIndexForControllerRole(vr::TrackedControllerRole_LeftHand);
+			index = devices->Hands[ovrHand_Left];
 			break;
 		case ovrTrackedDevice_RTouch:
-			index = vr::VRSystem()->GetTrackedDeviceIndexForControllerRole(vr::TrackedControllerRole_RightHand);
+			index = devices->Hands[ovrHand_Right];
 			break;
 		case ovrTrackedDevice_Object0:
 			index = trackers[0];
@@ -372,19 +375,21 @@ void InputManager::OculusTouch::HapticsThread(OculusTouch* device)
 
 	while (device->m_bHapticsRunning)
 	{
-		vr::TrackedDeviceIndex_t touch = vr::VRSystem()->GetTrackedDeviceIndexForControllerRole(device->Role);
-
 		float sample = (device->m_Haptics.GetSample() + device->m_Haptics.GetSample()) / 2.0f;
 		if (sample > 0.0f)
+		{
+			vr::TrackedDeviceIndex_t touch = device->m_Devices.GetSnapshot()->Hands[device->GetHand()];
 			vr::VRSystem()->TriggerHapticPulse(touch, 0, (uint16_t)(freq.count() * sample));
+		}
 
 		std::this_thread::sleep_for(freq);
 	}
 }
 
-InputManager::OculusTouch::OculusTouch(vr::VRActionSetHandle_t actionSet, vr::ETrackedControllerRole role)
+InputManager::OculusTouch::OculusTouch(vr::VRActionSetHandle_t actionSet, vr::ETrackedControllerRole role, const DeviceRegistry& devices)
 	: InputDevice(actionSet)
 	, Role(role)
+	, m_Devices(devices)
 	, m_bHapticsRunning(true)
 {
 	/** Returns a handle for any path in the input system. E.g. /user/hand/right */
@@ -428,15 +433,10 @@ ovrControllerType InputManager::OculusTouch::GetType()
 	return (Role == vr::TrackedControllerRole_LeftHand) ? ovrControllerType_LTouch : ovrControllerType_RTouch;
 }
 
-bool InputManager::OculusTouch::IsConnected() const
+bool InputManager::OculusTouch::IsConnected(const DeviceRegistry::Snapshot& devices) const
 {
 	// Check if a role is assigned and connected
-	vr::TrackedDeviceIndex_t index = vr::VRSystem()->GetTrackedDeviceIndexForControllerRole(Role);
-
-	if (index == vr::k_unTrackedDeviceIndexInvalid)
-		return false;
-
-	return vr::VRSystem()->IsTrackedDeviceConnected(index);
+	return devices.IsConnected(devices.Hands[GetHand()]);
 }
 
 bool InputManager::OculusTouch::GetInputState(ovrSession session, ovrInputState* inputState)
@@ -538,19 +538,12 @@ InputManager::OculusRemote::OculusRemote(vr::VRActionSetHandle_t actionSet)
 #undef GET_REMOTE_ACTION
 }
 
-bool InputManager::OculusRemote::IsConnected() const
+bool InputManager::OculusRemote::IsConnected(const DeviceRegistry::Snapshot& devices) const
 {
-	// Check if both roles are assigned and connected
-	vr::TrackedDeviceIndex_t indices[] = {
-		vr::VRSystem()->GetTrackedDeviceIndexForControllerRole(vr::TrackedControllerRole_LeftHand),
-		vr::VRSystem()->GetTrackedDeviceIndexForControllerRole(vr::TrackedControllerRole_RightHand),
-	};
-
 	// If we're missing one of the roles, the remote is used
-	for (vr::TrackedDeviceIndex_t index : indices)
+	for (vr::TrackedDeviceIndex_t index : devices.Hands)
 	{
-		if (index == vr::k_unTrackedDeviceIndexInvalid ||
-			!vr::VRSystem()->IsTrackedDeviceConnected(index))
+		if (!devices.IsConnected(index))
 			return true;
 	}
 	return false;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "HapticsBuffer.h"
+#include "DeviceRegistry.h"
 #include "OVR_CAPI.h"
 #include "Extras/OVR_Math.h"
 
@@ -23,7 +24,7 @@ public:
 
 		// Input
 		virtual ovrControllerType GetType() = 0;
-		virtual bool IsConnected() const = 0;
+		virtual bool IsConnected(const DeviceRegistry::Snapshot& devices) const = 0;
 		virtual bool GetInputState(ovrSession session, ovrInputState* inputState) = 0;
 
 		// Haptics
@@ -69,11 +70,11 @@ public:
 	class OculusTouch : public InputDevice
 	{
 	public:
-		OculusTouch(vr::VRActionSetHandle_t actionSet, vr::ETrackedControllerRole role);
+		OculusTouch(vr::VRActionSetHandle_t actionSet, vr::ETrackedControllerRole role, const DeviceRegistry& devices);
 		virtual ~OculusTouch();
 
 		virtual ovrControllerType GetType();
-		virtual bool IsConnected() const;
+		virtual bool IsConnected(const DeviceRegistry::Snapshot& devices) const;
 		virtual bool GetInputState(ovrSession session, ovrInputState* inputState);
 
 		virtual void SetVibration(float frequency, float amplitude) { m_Haptics.SetConstant(frequency, amplitude); }
@@ -81,6 +82,7 @@ public:
 		virtual void GetVibrationState(ovrHapticsPlaybackState* outState) { *outState = m_Haptics.GetState(); }
 
 		vr::ETrackedControllerRole Role;
+		ovrHandType GetHand() const { return Role == vr::TrackedControllerRole_LeftHand ? ovrHand_Left : ovrHand_Right; }
 
 	private:
 		vr::VRActionHandle_t m_Button_AX;
@@ -104,6 +106,7 @@ public:
 		vr::VRActionHandle_t m_Button_IndexTrigger;
 		vr::VRActionHandle_t m_Button_HandTrigger;
 
+		const DeviceRegistry& m_Devices;
 		HapticsBuffer m_Haptics;
 		std::atomic_bool m_bHapticsRunning;
 
@@ -118,7 +121,7 @@ public:
 		virtual ~OculusRemote() { }
 
 		virtual ovrControllerType GetType() { return ovrControllerType_Remote; }
-		virtual bool IsConnected() const;
+		virtual bool IsConnected(const DeviceRegistry::Snapshot& devices) const;
 		virtual bool GetInputState(ovrSession session, ovrInputState* inputState);
 
 	private:
@@ -139,7 +142,7 @@ public:
 		virtual ~XboxGamepad();
 
 		virtual ovrControllerType GetType() { return ovrControllerType_XBox; }
-		virtual bool IsConnected() const { return true; }
+		virtual bool IsConnected(const DeviceRegistry::Snapshot& devices) const { return true; }
 		virtual bool GetInputState(ovrSession session, ovrInputState* inputState);
 		virtual void SetVibration(float frequency, float amplitude);
 
@@ -168,6 +171,7 @@ public:
 	~InputManager();
 
 	std::atomic_uint32_t ConnectedControllers;
+	DeviceRegistry Devices;
 
 	void LoadActionManifest();
 	void UpdateInputState();
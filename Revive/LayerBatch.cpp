@@ -0,0 +1,49 @@
+#include "LayerBatch.h"
+
+#include <algorithm>
+
+void LayerBatch::Render(LayerRenderer* renderer)
+{
+	if (m_Blits.empty())
+		return;
+
+	// Acquire every texture only once, even if it's used by multiple layers
+	m_Textures.clear();
+	for (const LayerBlit& blit : m_Blits)
+	{
+		for (TextureBase* texture : { blit.Source, blit.Target })
+		{
+			if (std::find(m_Textures.begin(), m_Textures.end(), texture) == m_Textures.end())
+				m_Textures.push_back(texture);
+		}
+	}
+	for (TextureBase* texture : m_Textures)
+		renderer->AcquireLayerTexture(texture);
+
+	renderer->BeginLayers();
+
+	TextureBase* source = nullptr;
+	TextureBase* target = nullptr;
+	for (const LayerBlit& blit : m_Blits)
+	{
+		// Only rebind the textures if they changed since the previous layer
+		if (blit.Source != source)
+		{
+			source = blit.Source;
+			renderer->SetLayerSource(source);
+		}
+
+		if (blit.Target != target)
+		{
+			target = blit.Target;
+			renderer->SetLayerTarget(target);
+		}
+
+		renderer->DrawLayer(blit);
+	}
+
+	renderer->EndLayers();
+
+	for (TextureBase* texture : m_Textures)
+		renderer->ReleaseLayerTexture(texture);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+
+class TextureBase;
+
+// A single eye of an extra eye layer that needs to be composited onto the base layer
+struct LayerBlit
+{
+	TextureBase* Source;
+	TextureBase* Target;
+	int Viewport[4];	// Position and size of the eye in the target
+	float Quad[4];		// Left, right, top and bottom edge of the source fov in the target fov
+	float Bounds[4];	// Texture bounds of the eye in the source as uMin, vMin, uMax, vMax
+};
+
+// Receives the draw calls of a layer batch, implemented by the compositors that can blend layers
+class LayerRenderer
+{
+public:
+	virtual void AcquireLayerTexture(TextureBase* texture) = 0;
+	virtual void ReleaseLayerTexture(TextureBase* texture) = 0;
+
+	// Binds the pipeline state that is shared by all layers
+	virtual void BeginLayers() = 0;
+	virtual void SetLayerSource(TextureBase* texture) = 0;
+	virtual void SetLayerTarget(TextureBase* texture) = 0;
+	virtual void DrawLayer(const LayerBlit& blit) = 0;
+	// Submits all layers, called once per batch
+	virtual void EndLayers() = 0;
+};
+
+// Draw list of the extra eye layers of a frame. It has no graphics API dependencies, so every
+// compositor gets the same batching: each texture is only acquired once and textures are only
+// rebound when they change from one layer to the next.
+class LayerBatch
+{
+public:
+	void Clear() { m_Blits.clear(); }
+	void Add(const LayerBlit& blit) { m_Blits.push_back(blit); }
+	bool IsEmpty() const { return m_Blits.empty(); }
+
+	void Render(LayerRenderer* renderer);
+
+private:
+	std::vector<LayerBlit> m_Blits;
+	std::vector<TextureBase*> m_Textures;
+};
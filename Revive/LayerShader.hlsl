@@ -0,0 +1,12 @@
+cbuffer LayerConstants : register(b0)
+{
+	float4 Quad;	// Left, right, up and down edges of the layer in normalized device coordinates
+	float4 Bounds;	// Texture bounds of the layer (uMin, vMin, uMax, vMax)
+};
+
+float4 main( in float2 pos : POSITION, in float2 uv : TEXCOORD0, out float2 tex : TEXCOORD0) : SV_POSITION
+{
+	// The static quad spans [0,1], so we can map it onto the layer quad and texture bounds
+	tex = lerp(Bounds.xy, Bounds.zw, uv);
+	return float4(lerp(Quad.x, Quad.y, pos.x), lerp(Quad.z, Quad.w, pos.y), 0.0, 1.0);
+}
@@ -0,0 +1,139 @@
+#include "PropertyCache.h"
+#include "Common.h"
+
+#include <string.h>
+
+void PropertyCache::Invalidate(vr::TrackedDeviceIndex_t index)
+{
+	if (index >= vr::k_unMaxTrackedDeviceCount)
+		return;
+
+	std::lock_guard<std::mutex> lk(m_Mutex);
+	m_Devices[index].clear();
+}
+
+void PropertyCache::Invalidate(vr::TrackedDeviceIndex_t index, vr::ETrackedDeviceProperty prop)
+{
+	if (index >= vr::k_unMaxTrackedDeviceCount)
+		return;
+
+	std::lock_guard<std::mutex> lk(m_Mutex);
+	m_Devices[index].erase(prop);
+}
+
+bool PropertyCache::Find(vr::TrackedDeviceIndex_t index, vr::ETrackedDeviceProperty prop, Entry& entry)
+{
+	if (index >= vr::k_unMaxTrackedDeviceCount)
+		return false;
+
+	std::lock_guard<std::mutex> lk(m_Mutex);
+	auto it = m_Devices[index].find(prop);
+	if (it == m_Devices[index].end())
+	{
+		m_Misses.fetch_add(1, std::memory_order_relaxed);
+		MICROPROFILE_META_CPU("Property Misses", 1);
+		return false;
+	}
+
+	m_Hits.fetch_add(1, std::memory_order_relaxed);
+	MICROPROFILE_META_CPU("Property Hits", 1);
+	entry = it->second;
+	return true;
+}
+
+void PropertyCache::Store(vr::TrackedDeviceIndex_t index, vr::ETrackedDeviceProperty prop, const Entry& entry)
+{
+	if (index >= vr::k_unMaxTrackedDeviceCount)
+		return;
+
+	// Don't cache failures that may resolve themselves once the device is ready
+	if (entry.Error == vr::TrackedProp_NotYetAvailable || entry.Error == vr::TrackedProp_PermissionDenied)
+		return;
+
+	std::lock_guard<std::mutex> lk(m_Mutex);
+	m_Devices[index][prop] = entry;
+}
+
+bool PropertyCache::GetBool(vr::TrackedDeviceIndex_t index, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError* error)
+{
+	Entry entry;
+	if (!Find(index, prop, entry))
+	{
+		entry.Bool = vr::VRSystem()->GetBoolTrackedDeviceProperty(index, prop, &entry.Error);
+		Store(index, prop, entry);
+	}
+
+	if (error)
+		*error = entry.Error;
+	return entry.Bool;
+}
+
+float PropertyCache::GetFloat(vr::TrackedDeviceIndex_t index, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError* error)
+{
+	Entry entry;
+	if (!Find(index, prop, entry))
+	{
+		entry.Float = vr::VRSystem()->GetFloatTrackedDeviceProperty(index, prop, &entry.Error);
+		Store(index, prop, entry);
+	}
+
+	if (error)
+		*error = entry.Error;
+	return entry.Float;
+}
+
+int32_t PropertyCache::GetInt32(vr::TrackedDeviceIndex_t index, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError* error)
+{
+	Entry entry;
+	if (!Find(index, prop, entry))
+	{
+		entry.Int32 = vr::VRSystem()->GetInt32TrackedDeviceProperty(index, prop, &entry.Error);
+		Store(index, prop, entry);
+	}
+
+	if (error)
+		*error = entry.Error;
+	return entry.Int32;
+}
+
+uint64_t PropertyCache::GetUint64(vr::TrackedDeviceIndex_t index, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError* error)
+{
+	Entry entry;
+	if (!Find(index, prop, entry))
+	{
+		entry.Uint64 = vr::VRSystem()->GetUint64TrackedDeviceProperty(index, prop, &entry.Error);
+		Store(index, prop, entry);
+	}
+
+	if (error)
+		*error = entry.Error;
+	return entry.Uint64;
+}
+
+uint32_t PropertyCache::GetString(vr::TrackedDeviceIndex_t index, vr::ETrackedDeviceProperty prop, char* value, uint32_t size, vr::ETrackedPropertyError* error)
+{
+	Entry entry;
+	if (!Find(index, prop, entry))
+	{
+		char buffer[vr::k_unMaxPropertyStringSize] = {};
+		uint32_t length = vr::VRSystem()->GetStringTrackedDeviceProperty(index, prop, buffer, sizeof(buffer), &entry.Error);
+		entry.String = length > 0 ? buffer : "";
+		Store(index, prop, entry);
+	}
+
+	if (entry.Error != vr::TrackedProp_Success)
+	{
+		if (error)
+			*error = entry.Error;
+		return 0;
+	}
+
+	// Like the runtime, don't write anything if the buffer is too small
+	uint32_t length = (uint32_t)entry.String.size() + 1;
+	if (value && size >= length)
+		memcpy(value, entry.String.c_str(), length);
+
+	if (error)
+		*error = size >= length ? vr::TrackedProp_Success : vr::TrackedProp_BufferTooSmall;
+	return length;
+}
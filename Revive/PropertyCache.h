@@ -0,0 +1,55 @@
+#pragma once
+
+#include <openvr.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Cache in front of the tracked device properties of IVRSystem.
+// Values are queried lazily and kept until an event tells us that they changed.
+class PropertyCache
+{
+public:
+	PropertyCache() : m_Hits(0), m_Misses(0) { }
+	~PropertyCache() { }
+
+	// Drops all cached properties of a device, or a single property of a device
+	void Invalidate(vr::TrackedDeviceIndex_t index);
+	void Invalidate(vr::TrackedDeviceIndex_t index, vr::ETrackedDeviceProperty prop);
+
+	bool GetBool(vr::TrackedDeviceIndex_t index, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError* error = nullptr);
+	float GetFloat(vr::TrackedDeviceIndex_t index, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError* error = nullptr);
+	int32_t GetInt32(vr::TrackedDeviceIndex_t index, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError* error = nullptr);
+	uint64_t GetUint64(vr::TrackedDeviceIndex_t index, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError* error = nullptr);
+	// Same semantics as IVRSystem, returns the size of the string including the terminator
+	uint32_t GetString(vr::TrackedDeviceIndex_t index, vr::ETrackedDeviceProperty prop, char* value, uint32_t size, vr::ETrackedPropertyError* error = nullptr);
+
+	// Number of lookups answered from the cache and lookups that had to query the runtime
+	uint64_t GetHits() const { return m_Hits; }
+	uint64_t GetMisses() const { return m_Misses; }
+
+private:
+	struct Entry
+	{
+		vr::ETrackedPropertyError Error;
+		union
+		{
+			bool Bool;
+			float Float;
+			int32_t Int32;
+			uint64_t Uint64;
+		};
+		std::string String;
+	};
+
+	bool Find(vr::TrackedDeviceIndex_t index, vr::ETrackedDeviceProperty prop, Entry& entry);
+	void Store(vr::TrackedDeviceIndex_t index, vr::ETrackedDeviceProperty prop, const Entry& entry);
+
+	// Only held while accessing the cache, never while querying the runtime
+	std::mutex m_Mutex;
+	std::unordered_map<int, Entry> m_Devices[vr::k_unMaxTrackedDeviceCount];
+
+	std::atomic_uint64_t m_Hits;
+	std::atomic_uint64_t m_Misses;
+};
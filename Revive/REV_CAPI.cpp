@@ -7,12 +7,14 @@
 #include "CompositorBase.h"
 #include "InputManager.h"
 #include "ProfileManager.h"
+#include "FrameClock.h"
 
 #include <dxgi1_2.h>
 #include <openvr.h>
 #include <Windows.h>
 #include <detours/detours.h>
 #include <list>
+#include <mutex>
 #include <algorithm>
 #include <thread>
 #include <assert.h>
@@ -23,6 +25,7 @@ HMODULE g_D3D11 = nullptr;
 unsigned int g_MinorVersion = OVR_MINOR_VERSION;
 vr::EVRInitError g_InitError = vr::VRInitError_Init_NotInitialized;
 std::list<ovrHmdStruct> g_Sessions;
+FrameClock g_Clock;
 
 #if MICROPROFILE_ENABLED
 ProfileManager g_ProfileManager;
@@ -96,22 +99,22 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_Initialize(const ovrInitParams* params)
 	if (g_InitError == vr::VRInitError_None)
 		return ovrSuccess;
 
+	StartupTrace::Stamp("ovr_Initialize");
+
 #if 0
 	LoadRenderDoc();
 #endif
 	g_D3D11 = LoadLibraryA("d3d11.dll");
 
-	MicroProfileOnThreadCreate("Main");
-	MicroProfileSetForceEnable(true);
-	MicroProfileSetEnableAllGroups(true);
-	MicroProfileSetForceMetaCounters(true);
-	MicroProfileWebServerStart();
+	Trace::Initialize();
+	Capture::Initialize(params);
 
 	g_MinorVersion = params->RequestedMinorVersion;
 
 	DetachDetours();
 
 	vr::VR_Init(&g_InitError, vr::VRApplication_Scene);
+	StartupTrace::Stamp("VR_Init");
 
 	AttachDetours();
 
@@ -129,11 +132,16 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_Initialize(const ovrInitParams* params)
 
 	if (vr::VRCompositor() == nullptr)
 		return ovrError_Timeout;
+	StartupTrace::Stamp("Compositor ready");
+
+	// Give the clock an initial calibration, so it's valid before the first frame
+	g_Clock.Calibrate(vr::VRSystem()->GetFloatTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_DisplayFrequency_Float));
 
 #if MICROPROFILE_ENABLED
 	g_ProfileManager.Initialize();
 #endif
 
+	StartupTrace::Stamp("Initialized");
 	return InitErrorToOvrError(g_InitError);
 }
 
@@ -145,6 +153,8 @@ OVR_PUBLIC_FUNCTION(void) ovr_Shutdown()
 
 	g_Sessions.clear();
 	vr::VR_Shutdown();
+	Trace::Shutdown();
+	Capture::Shutdown();
 	MicroProfileShutdown();
 	g_InitError = vr::VRInitError_Init_NotInitialized;
 	if (g_D3D11)
@@ -217,6 +227,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_Create(ovrSession* pSession, ovrGraphicsLuid*
 	*pSession = nullptr;
 
 	// Initialize the opaque pointer with our own OpenVR-specific struct
+	StartupTrace::Stamp("ovr_Create");
 	g_Sessions.emplace_back();
 
 	// Get the LUID for the OpenVR adapter
@@ -256,6 +267,8 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_Create(ovrSession* pSession, ovrGraphicsLuid*
 	vr::VRCompositor()->SetTrackingSpace(vr::TrackingUniverseSeated);
 
 	*pSession = &g_Sessions.back();
+	REV_CAPTURE(CaptureHandle(*pSession));
+	StartupTrace::Stamp("Created session");
 	return ovrSuccess;
 }
 
@@ -312,6 +325,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetSessionStatus(ovrSession session, ovrSessi
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_SetTrackingOriginType(ovrSession session, ovrTrackingOrigin origin)
 {
 	REV_TRACE(ovr_SetTrackingOriginType);
+	REV_CAPTURE(origin);
 
 	if (!session)
 		return ovrError_InvalidSession;
@@ -345,6 +359,8 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_RecenterTrackingOrigin(ovrSession session)
 
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_SpecifyTrackingOrigin(ovrSession session, ovrPosef originPose)
 {
+	REV_TRACE(ovr_SpecifyTrackingOrigin);
+
 	vr::ChaperoneCalibrationState calibrationState = vr::VRChaperone()->GetCalibrationState();
 	if (calibrationState >= vr::ChaperoneCalibrationState_Error)
 		return ovrSuccess_BoundaryInvalid;
@@ -375,6 +391,8 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_SpecifyTrackingOrigin(ovrSession session, ovr
 
 OVR_PUBLIC_FUNCTION(void) ovr_ClearShouldRecenterFlag(ovrSession session)
 {
+	REV_TRACE(ovr_ClearShouldRecenterFlag);
+
 	if (session)
 		session->Status.ShouldRecenter = false;
 }
@@ -389,6 +407,7 @@ OVR_PUBLIC_FUNCTION(ovrTrackingState) ovr_GetTrackingState(ovrSession session, d
 		return state;
 
 	session->Input->GetTrackingState(session, &state, absTime);
+	REV_CAPTURE(absTime, latencyMarker, state);
 	return state;
 }
 
@@ -457,9 +476,9 @@ OVR_PUBLIC_FUNCTION(ovrTrackerPose) ovr_GetTrackerPose(ovrSession session, unsig
 	}
 
 	// Get the index for this tracker.
-	vr::TrackedDeviceIndex_t trackers[vr::k_unMaxTrackedDeviceCount] = { vr::k_unTrackedDeviceIndexInvalid };
-	vr::VRSystem()->GetSortedTrackedDeviceIndicesOfClass(vr::TrackedDeviceClass_TrackingReference, trackers, vr::k_unMaxTrackedDeviceCount);
-	vr::TrackedDeviceIndex_t index = trackers[trackerPoseIndex];
+	std::shared_ptr<const DeviceRegistry::Snapshot> devices = session->Input->Devices.GetSnapshot();
+	vr::TrackedDeviceIndex_t index = trackerPoseIndex < vr::k_unMaxTrackedDeviceCount ?
+		devices->References[trackerPoseIndex] : vr::k_unTrackedDeviceIndexInvalid;
 
 	// Get the device poses.
 	vr::TrackedDevicePose_t pose;
@@ -472,7 +491,7 @@ OVR_PUBLIC_FUNCTION(ovrTrackerPose) ovr_GetTrackerPose(ovrSession session, unsig
 	tracker.TrackerFlags = 0;
 	if (index != vr::k_unTrackedDeviceIndexInvalid)
 	{
-		if (vr::VRSystem()->IsTrackedDeviceConnected(index))
+		if (devices->IsConnected(index))
 			tracker.TrackerFlags |= ovrTracker_Connected;
 		if (pose.bPoseIsValid)
 			tracker.TrackerFlags |= ovrTracker_PoseTracked;
@@ -547,6 +566,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetInputState(ovrSession session, ovrControll
 	else
 		memcpy(inputState, &state, sizeof(ovrInputState));
 
+	REV_CAPTURE(controllerType, state);
 	return result;
 }
 
@@ -567,6 +587,7 @@ OVR_PUBLIC_FUNCTION(ovrTouchHapticsDesc) ovr_GetTouchHapticsDesc(ovrSession sess
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_SetControllerVibration(ovrSession session, ovrControllerType controllerType, float frequency, float amplitude)
 {
 	REV_TRACE(ovr_SetControllerVibration);
+	REV_CAPTURE(controllerType, frequency, amplitude);
 
 	if (!session)
 		return ovrError_InvalidSession;
@@ -619,8 +640,8 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_TestBoundary(ovrSession session, ovrTrackedDe
 	}
 
 
-	vr::TrackedDeviceIndex_t hands[] = { vr::VRSystem()->GetTrackedDeviceIndexForControllerRole(vr::TrackedControllerRole_LeftHand),
-		vr::VRSystem()->GetTrackedDeviceIndexForControllerRole(vr::TrackedControllerRole_RightHand) };
+	std::shared_ptr<const DeviceRegistry::Snapshot> devices = session->Input->Devices.GetSnapshot();
+	const vr::TrackedDeviceIndex_t* hands = devices->Hands;
 
 	for (int i = 0; i < ovrHand_Count; i++)
 	{
@@ -787,6 +808,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetTextureSwapChainDesc(ovrSession session, o
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_CommitTextureSwapChain(ovrSession session, ovrTextureSwapChain chain)
 {
 	REV_TRACE(ovr_CommitTextureSwapChain);
+	REV_CAPTURE(CaptureHandle(chain));
 
 	if (!chain)
 		return ovrError_InvalidParameter;
@@ -814,11 +836,14 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_CommitTextureSwapChain(ovrSession session, ov
 OVR_PUBLIC_FUNCTION(void) ovr_DestroyTextureSwapChain(ovrSession session, ovrTextureSwapChain chain)
 {
 	REV_TRACE(ovr_DestroyTextureSwapChain);
+	REV_CAPTURE(CaptureHandle(chain));
 
 	if (!chain)
 		return;
 
 	MICROPROFILE_META_CPU("Identifier", chain->Identifier);
+	if (session && session->Compositor)
+		session->Compositor->ReleaseOverlay(chain);
 	vr::VROverlay()->DestroyOverlay(chain->Overlay);
 	delete chain;
 }
@@ -877,6 +902,8 @@ typedef struct OVR_ALIGNAS(4) ovrEyeRenderDesc1_ {
 
 OVR_PUBLIC_FUNCTION(ovrEyeRenderDesc1) ovr_GetRenderDesc(ovrSession session, ovrEyeType eyeType, ovrFovPort fov)
 {
+	REV_TRACE(ovr_GetRenderDesc);
+
 	ovrEyeRenderDesc1 legacy = {};
 	ovrEyeRenderDesc desc = ovr_GetRenderDesc2(session, eyeType, fov);
 	memcpy(&legacy, &desc, sizeof(ovrEyeRenderDesc1));
@@ -888,6 +915,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_WaitToBeginFrame(ovrSession session, long lon
 {
 	REV_TRACE(ovr_WaitToBeginFrame);
 	MICROPROFILE_META_CPU("Wait Frame", (int)frameIndex);
+	REV_CAPTURE(frameIndex);
 
 	if (!session || !session->Compositor)
 		return ovrError_InvalidSession;
@@ -899,6 +927,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_BeginFrame(ovrSession session, long long fram
 {
 	REV_TRACE(ovr_BeginFrame);
 	MICROPROFILE_META_CPU("Begin Frame", (int)frameIndex);
+	REV_CAPTURE(frameIndex);
 
 	if (!session || !session->Compositor)
 		return ovrError_InvalidSession;
@@ -912,19 +941,32 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_EndFrame(ovrSession session, long long frameI
 {
 	REV_TRACE(ovr_EndFrame);
 	MICROPROFILE_META_CPU("End Frame", (int)frameIndex);
+	if (g_CaptureEnabled)
+	{
+		Capture::Write(frameIndex, (uint32_t)(viewScaleDesc != nullptr), viewScaleDesc ? *viewScaleDesc : ovrViewScaleDesc());
+		Capture::WriteLayers(layerPtrList, layerCount);
+	}
 
 	if (!session || !session->Compositor)
 		return ovrError_InvalidSession;
 
 	// Use our own intermediate compositor to convert the frame to OpenVR.
-	return session->Compositor->EndFrame(session, frameIndex, viewScaleDesc, layerPtrList, layerCount);
+	ovrResult result = session->Compositor->EndFrame(session, frameIndex, viewScaleDesc, layerPtrList, layerCount);
+	if (OVR_SUCCESS(result))
+		StartupTrace::Finish("First ovr_EndFrame");
+	return result;
 }
 
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_SubmitFrame2(ovrSession session, long long frameIndex, const ovrViewScaleDesc* viewScaleDesc,
 	ovrLayerHeader const * const * layerPtrList, unsigned int layerCount)
 {
-	REV_TRACE(ovr_SubmitFrame);
+	REV_TRACE(ovr_SubmitFrame2);
 	MICROPROFILE_META_CPU("Submit Frame", (int)frameIndex);
+	if (g_CaptureEnabled)
+	{
+		Capture::Write(frameIndex, (uint32_t)(viewScaleDesc != nullptr), viewScaleDesc ? *viewScaleDesc : ovrViewScaleDesc());
+		Capture::WriteLayers(layerPtrList, layerCount);
+	}
 
 	if (!session || !session->Compositor)
 		return ovrError_InvalidSession;
@@ -937,6 +979,8 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_SubmitFrame2(ovrSession session, long long fr
 	ovrResult result = session->Compositor->EndFrame(session, frameIndex, viewScaleDesc, layerPtrList, layerCount);
 	if (OVR_SUCCESS(result))
 	{
+		StartupTrace::Finish("First ovr_SubmitFrame");
+
 		// Begin the next frame
 		session->Compositor->WaitToBeginFrame(session, frameIndex + 1);
 		session->Compositor->BeginFrame(session, frameIndex + 1);
@@ -952,6 +996,8 @@ typedef struct OVR_ALIGNAS(4) ovrViewScaleDesc1_ {
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_SubmitFrame(ovrSession session, long long frameIndex, const ovrViewScaleDesc1* viewScaleDesc,
 	ovrLayerHeader const * const * layerPtrList, unsigned int layerCount)
 {
+	REV_TRACE(ovr_SubmitFrame);
+
 	if (viewScaleDesc)
 	{
 		ovrViewScaleDesc viewScale;
@@ -1027,8 +1073,8 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetPerfStats(ovrSession session, ovrPerfStats
 	TotalStats.m_nNumDroppedFramesTimedOut -= session->BaseStats.m_nNumDroppedFramesTimedOut;
 	TotalStats.m_nNumReprojectedFramesTimedOut -= session->BaseStats.m_nNumReprojectedFramesTimedOut;
 
-	float fVsyncToPhotons = vr::VRSystem()->GetFloatTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_SecondsFromVsyncToPhotons_Float);
-	float fDisplayFrequency = vr::VRSystem()->GetFloatTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_DisplayFrequency_Float);
+	float fVsyncToPhotons = session->Properties.GetFloat(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_SecondsFromVsyncToPhotons_Float);
+	float fDisplayFrequency = session->Properties.GetFloat(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_DisplayFrequency_Float);
 	float fFrameDuration = 1.0f / fDisplayFrequency;
 	for (int i = 0; i < FrameStatsCount; i++)
 	{
@@ -1093,11 +1139,11 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_ResetPerfStats(ovrSession session)
 OVR_PUBLIC_FUNCTION(double) ovr_GetPredictedDisplayTime(ovrSession session, long long frameIndex)
 {
 	REV_TRACE(ovr_GetPredictedDisplayTime);
+	REV_CAPTURE(frameIndex);
 
 	MICROPROFILE_META_CPU("Predict Frame", (int)frameIndex);
 
-	uint32_t predictionID = 0;
-	vr::VRCompositor()->GetLastPosePredictionIDs(&predictionID, nullptr);
+	uint32_t predictionID = g_Clock.GetPredictionID();
 	predictionID += (uint32_t)(frameIndex - session->FrameIndex);
 	return (double)predictionID / session->HmdDesc.DisplayRefreshRate;
 }
@@ -1106,12 +1152,7 @@ OVR_PUBLIC_FUNCTION(double) ovr_GetTimeInSeconds()
 {
 	REV_TRACE(ovr_GetTimeInSeconds);
 
-	float freq = vr::VRSystem()->GetFloatTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_DisplayFrequency_Float);
-	float elapsed = 1.0f / freq - vr::VRCompositor()->GetFrameTimeRemaining();
-
-	uint32_t predictionID = 0;
-	vr::VRCompositor()->GetLastPosePredictionIDs(&predictionID, nullptr);
-	return (double)predictionID / freq + elapsed;
+	return g_Clock.GetTimeInSeconds();
 }
 
 OVR_PUBLIC_FUNCTION(ovrBool) ovr_GetBool(ovrSession session, const char* propertyName, ovrBool defaultVal)
@@ -1158,9 +1199,11 @@ OVR_PUBLIC_FUNCTION(float) ovr_GetFloat(ovrSession session, const char* property
 	REV_TRACE(ovr_GetFloat);
 
 	if (strcmp(propertyName, "IPD") == 0)
-		return vr::VRSystem()->GetFloatTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_UserIpdMeters_Float);
+		return session ? session->Properties.GetFloat(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_UserIpdMeters_Float) :
+			vr::VRSystem()->GetFloatTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_UserIpdMeters_Float);
 	else if (strcmp(propertyName, "VsyncToNextVsync") == 0)
-		return 1.0f / vr::VRSystem()->GetFloatTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_DisplayFrequency_Float);
+		return 1.0f / (session ? session->Properties.GetFloat(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_DisplayFrequency_Float) :
+			vr::VRSystem()->GetFloatTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_DisplayFrequency_Float));
 	else if (strcmp(propertyName, "CpuStartToGpuEndSeconds") == 0)
 	{
 		vr::Compositor_FrameTiming timing;
@@ -1207,7 +1250,8 @@ OVR_PUBLIC_FUNCTION(unsigned int) ovr_GetFloatArray(ovrSession session, const ch
 			return 0;
 
 		// We only know the horizontal depth
-		values[0] = vr::VRSystem()->GetFloatTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_UserHeadToEyeDepthMeters_Float);
+		values[0] = session ? session->Properties.GetFloat(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_UserHeadToEyeDepthMeters_Float) :
+			vr::VRSystem()->GetFloatTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_UserHeadToEyeDepthMeters_Float);
 		values[1] = OVR_DEFAULT_NECK_TO_EYE_VERTICAL;
 		return 2;
 	}
@@ -1250,6 +1294,22 @@ OVR_PUBLIC_FUNCTION(const char*) ovr_GetString(ovrSession session, const char* p
 {
 	REV_TRACE(ovr_GetString);
 
+	if (strcmp(propertyName, REV_KEY_API_STATS) == 0)
+	{
+		// The string stays valid until the next time the statistics are queried
+		static std::mutex statsMutex;
+		static std::string stats;
+		std::lock_guard<std::mutex> lk(statsMutex);
+		stats = Trace::GetStats();
+		if (session)
+		{
+			char line[128];
+			sprintf_s(line, "Property cache: %llu hits, %llu misses\n", session->Properties.GetHits(), session->Properties.GetMisses());
+			stats += line;
+		}
+		return stats.c_str();
+	}
+
 	if (!session)
 		return defaultVal;
 
@@ -1281,32 +1341,43 @@ OVR_PUBLIC_FUNCTION(ovrBool) ovr_SetString(ovrSession session, const char* prope
 
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_Lookup(const char* name, void** data)
 {
+	REV_TRACE(ovr_Lookup);
+
 	// We don't communicate with the ovrServer.
 	return ovrError_ServiceError;
 }
 
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetExternalCameras(ovrSession session, ovrExternalCamera* cameras, unsigned int* inoutCameraCount)
 {
+	REV_TRACE(ovr_GetExternalCameras);
+
 	// TODO: Support externalcamera.cfg used by the SteamVR Unity plugin
 	return ovrError_NoExternalCameraInfo;
 }
 
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_SetExternalCameraProperties(ovrSession session, const char* name, const ovrCameraIntrinsics* const intrinsics, const ovrCameraExtrinsics* const extrinsics)
 {
+	REV_TRACE(ovr_SetExternalCameraProperties);
+
 	return ovrError_NoExternalCameraInfo;
 }
 
 OVR_PUBLIC_FUNCTION(unsigned int) ovr_GetEnabledCaps(ovrSession session)
 {
+	REV_TRACE(ovr_GetEnabledCaps);
+
 	return 0;
 }
 
 OVR_PUBLIC_FUNCTION(void) ovr_SetEnabledCaps(ovrSession session, unsigned int hmdCaps)
 {
+	REV_TRACE(ovr_SetEnabledCaps);
 }
 
 OVR_PUBLIC_FUNCTION(unsigned int) ovr_GetTrackingCaps(ovrSession session)
 {
+	REV_TRACE(ovr_GetTrackingCaps);
+
 	return 0;
 }
 
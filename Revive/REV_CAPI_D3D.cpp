@@ -29,7 +29,13 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_CreateTextureSwapChainDX(ovrSession session,
 	if (session->Compositor->GetAPI() != vr::TextureType_DirectX)
 		return ovrError_RuntimeException;
 
-	return session->Compositor->CreateTextureSwapChain(desc, out_TextureSwapChain);
+	ovrResult result = session->Compositor->CreateTextureSwapChain(desc, out_TextureSwapChain);
+	if (OVR_SUCCESS(result))
+	{
+		REV_CAPTURE(*desc, CaptureHandle(*out_TextureSwapChain));
+		StartupTrace::StampOnce("First swapchain");
+	}
+	return result;
 }
 
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetTextureSwapChainBufferDX(ovrSession session,
@@ -83,7 +89,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_CreateMirrorTextureDX(ovrSession session,
 	if (session->Compositor->GetAPI() != vr::TextureType_DirectX)
 		return ovrError_RuntimeException;
 
-	return session->Compositor->CreateMirrorTexture(desc, out_MirrorTexture);
+	return session->Compositor->CreateMirrorTexture(session, desc, out_MirrorTexture);
 }
 
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_CreateMirrorTextureWithOptionsDX(ovrSession session,
@@ -115,5 +121,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetMirrorTextureBufferDX(ovrSession session,
 	if (FAILED(hr))
 		return ovrError_InvalidParameter;
 
+	// Start rendering the mirror texture now that the app has access to it
+	mirrorTexture->Requested = true;
 	return ovrSuccess;
 }
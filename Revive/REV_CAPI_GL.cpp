@@ -23,7 +23,13 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_CreateTextureSwapChainGL(ovrSession session,
 	if (session->Compositor->GetAPI() != vr::TextureType_OpenGL)
 		return ovrError_RuntimeException;
 
-	return session->Compositor->CreateTextureSwapChain(desc, out_TextureSwapChain);
+	ovrResult result = session->Compositor->CreateTextureSwapChain(desc, out_TextureSwapChain);
+	if (OVR_SUCCESS(result))
+	{
+		REV_CAPTURE(*desc, CaptureHandle(*out_TextureSwapChain));
+		StartupTrace::StampOnce("First swapchain");
+	}
+	return result;
 }
 
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetTextureSwapChainBufferGL(ovrSession session,
@@ -69,7 +75,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_CreateMirrorTextureGL(ovrSession session,
 	if (session->Compositor->GetAPI() != vr::TextureType_OpenGL)
 		return ovrError_RuntimeException;
 
-	return session->Compositor->CreateMirrorTexture(desc, out_MirrorTexture);
+	return session->Compositor->CreateMirrorTexture(session, desc, out_MirrorTexture);
 }
 
 
@@ -97,5 +103,8 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetMirrorTextureBufferGL(ovrSession session,
 		return ovrError_InvalidParameter;
 
 	*out_TexId = texture->Texture;
+
+	// Start rendering the mirror texture now that the app has access to it
+	mirrorTexture->Requested = true;
 	return ovrSuccess;
 }
@@ -230,7 +230,13 @@ ovr_CreateTextureSwapChainVk(
 	if (session->Compositor->GetAPI() != vr::TextureType_Vulkan)
 		return ovrError_RuntimeException;
 
-	return session->Compositor->CreateTextureSwapChain(desc, out_TextureSwapChain);
+	ovrResult result = session->Compositor->CreateTextureSwapChain(desc, out_TextureSwapChain);
+	if (OVR_SUCCESS(result))
+	{
+		REV_CAPTURE(*desc, CaptureHandle(*out_TextureSwapChain));
+		StartupTrace::StampOnce("First swapchain");
+	}
+	return result;
 }
 
 OVR_PUBLIC_FUNCTION(ovrResult)
@@ -284,7 +290,7 @@ ovr_CreateMirrorTextureWithOptionsVk(
 	if (session->Compositor->GetAPI() != vr::TextureType_Vulkan)
 		return ovrError_RuntimeException;
 
-	return session->Compositor->CreateMirrorTexture(desc, out_MirrorTexture);
+	return session->Compositor->CreateMirrorTexture(session, desc, out_MirrorTexture);
 }
 
 OVR_PUBLIC_FUNCTION(ovrResult)
@@ -307,6 +313,8 @@ ovr_GetMirrorTextureBufferVk(
 
 	*out_Image = texture->Image();
 
+	// Start rendering the mirror texture now that the app has access to it
+	mirrorTexture->Requested = true;
 	return ovrSuccess;
 }
 
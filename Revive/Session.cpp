@@ -2,33 +2,26 @@
 #include "CompositorBase.h"
 #include "InputManager.h"
 #include "REV_Math.h"
+#include "HackDatabase.h"
 
 #include <Windows.h>
 #include <Shlwapi.h>
 #include <openvr.h>
 #include <assert.h>
-#include <map>
 
-struct HackInfo
-{
-	const char* m_filename; // The filename of the main executable
-	const char* m_driver;	// The name of the driver
-	Hack m_hack;            // Which hack is it?
-	bool m_usehack;         // Should it use the hack?
-};
-
-HackInfo g_known_hacks[] = {
-	{ "Stormland.exe", nullptr, HACK_SAME_FOV_FOR_BOTH_EYES, true },
-	{ "ultrawings.exe", nullptr, HACK_FAKE_PRODUCT_NAME, true },
-	{ "AirMech.exe", nullptr, HACK_SLEEP_IN_SESSION_STATUS, true },
-	{ nullptr, "lighthouse", HACK_SPOOF_SENSORS, false },
-	{ "DCVR-Win64-Shipping.exe", nullptr, HACK_DISABLE_STATS, true }
+const char* g_hack_names[HACK_COUNT] = {
+	"HACK_FAKE_PRODUCT_NAME",
+	"HACK_SPOOF_SENSORS",
+	"HACK_RECONSTRUCT_EYE_MATRIX",
+	"HACK_SLEEP_IN_SESSION_STATUS",
+	"HACK_DISABLE_STATS",
+	"HACK_SAME_FOV_FOR_BOTH_EYES",
 };
-std::map<Hack, HackInfo> g_hacks;
 
 ovrHmdStruct::ovrHmdStruct()
 	: AppKey()
 	, StringBuffer()
+	, Properties()
 	, TrackerCount(0)
 	, Status()
 	, ChaperoneBuffer()
@@ -40,6 +33,7 @@ ovrHmdStruct::ovrHmdStruct()
 	, BaseStats()
 	, Compositor(nullptr)
 	, Input(new InputManager())
+	, Hacks()
 {
 	Status.HmdPresent = vr::VR_IsHmdPresent();
 	Status.HmdMounted = true;
@@ -50,22 +44,16 @@ ovrHmdStruct::ovrHmdStruct()
 	GetModuleFileNameA(NULL, filepath, MAX_PATH);
 	char* filename = PathFindFileNameA(filepath);
 
-	vr::VRSystem()->GetStringTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd,
+	char driverVersion[vr::k_unMaxPropertyStringSize] = {};
+	Properties.GetString(vr::k_unTrackedDeviceIndex_Hmd,
 		vr::Prop_TrackingSystemName_String, StringBuffer, sizeof(StringBuffer));
+	Properties.GetString(vr::k_unTrackedDeviceIndex_Hmd,
+		vr::Prop_DriverVersion_String, driverVersion, sizeof(driverVersion));
 
-	for (auto& hack : g_known_hacks)
-	{
-		if ((!hack.m_filename || _stricmp(filename, hack.m_filename) == 0) &&
-			(!hack.m_driver || strcmp(StringBuffer, hack.m_driver) == 0))
-		{
-			if (hack.m_usehack)
-				g_hacks.emplace(hack.m_hack, hack);
-		}
-		else if (!hack.m_usehack)
-		{
-			g_hacks.emplace(hack.m_hack, hack);
-		}
-	}
+	HackDatabase database;
+	if (!database.Load(HackDatabase::GetDefaultPath()))
+		database.LoadEmbedded();
+	Hacks = database.Evaluate("vr", g_hack_names, filename, StringBuffer, HackDatabase::ParseVersion(driverVersion));
 
 	vr::VRApplications()->GetApplicationKeyByProcessId(GetCurrentProcessId(), AppKey, sizeof(AppKey));
 
@@ -90,11 +78,6 @@ ovrHmdStruct::~ovrHmdStruct()
 	vr::VRChaperoneSetup()->CommitWorkingCopy(vr::EChaperoneConfigFile_Live);
 }
 
-bool ovrHmdStruct::UseHack(Hack hack) const
-{
-	return g_hacks.find(hack) != g_hacks.end();
-}
-
 void ovrHmdStruct::UpdateStatus()
 {
 	vr::VREvent_t vrEvent;
@@ -105,6 +88,8 @@ void ovrHmdStruct::UpdateStatus()
 		case vr::VREvent_TrackedDeviceActivated:
 		case vr::VREvent_TrackedDeviceDeactivated:
 		{
+			Properties.Invalidate(vrEvent.trackedDeviceIndex);
+			Input->Devices.Update();
 			vr::ETrackedDeviceClass deviceClass = vr::VRSystem()->GetTrackedDeviceClass(vrEvent.trackedDeviceIndex);
 			if (deviceClass == vr::TrackedDeviceClass_Controller)
 				Input->UpdateConnectedControllers();
@@ -114,8 +99,19 @@ void ovrHmdStruct::UpdateStatus()
 				UpdateHmdDesc();
 		}
 		break;
+		case vr::VREvent_PropertyChanged:
+		{
+			Properties.Invalidate(vrEvent.trackedDeviceIndex, vrEvent.data.property.prop);
+		}
+		break;
+		case vr::VREvent_IpdChanged:
+		{
+			Properties.Invalidate(vrEvent.trackedDeviceIndex, vr::Prop_UserIpdMeters_Float);
+		}
+		break;
 		case vr::VREvent_TrackedDeviceRoleChanged:
 		{
+			Input->Devices.Update();
 			Input->UpdateConnectedControllers();
 		}
 		break;
@@ -162,8 +158,8 @@ void ovrHmdStruct::UpdateHmdDesc()
 	HmdDesc.Type = ovrHmd_CV1;
 
 	// Get HMD name
-	vr::VRSystem()->GetStringTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_ModelNumber_String, HmdDesc.ProductName, 64);
-	vr::VRSystem()->GetStringTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_ManufacturerName_String, HmdDesc.Manufacturer, 64);
+	Properties.GetString(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_ModelNumber_String, HmdDesc.ProductName, 64);
+	Properties.GetString(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_ManufacturerName_String, HmdDesc.Manufacturer, 64);
 
 	// Some games require a fake product name
 	if (UseHack(HACK_FAKE_PRODUCT_NAME))
@@ -174,7 +170,7 @@ void ovrHmdStruct::UpdateHmdDesc()
 	HmdDesc.ProductId = 0;
 
 	// Get serial number
-	vr::VRSystem()->GetStringTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_SerialNumber_String, HmdDesc.SerialNumber, 24);
+	Properties.GetString(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_SerialNumber_String, HmdDesc.SerialNumber, 24);
 
 	// TODO: Get firmware version
 	HmdDesc.FirmwareMajor = 0;
@@ -184,7 +180,7 @@ void ovrHmdStruct::UpdateHmdDesc()
 	HmdDesc.AvailableHmdCaps = 0;
 	HmdDesc.DefaultHmdCaps = 0;
 	HmdDesc.AvailableTrackingCaps = ovrTrackingCap_Orientation | ovrTrackingCap_Position;
-	if (!vr::VRSystem()->GetBoolTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_WillDriftInYaw_Bool))
+	if (!Properties.GetBool(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_WillDriftInYaw_Bool))
 		HmdDesc.AvailableTrackingCaps |= ovrTrackingCap_MagYawCorrection;
 	HmdDesc.DefaultTrackingCaps = ovrTrackingCap_Orientation | ovrTrackingCap_MagYawCorrection | ovrTrackingCap_Position;
 
@@ -211,7 +207,7 @@ void ovrHmdStruct::UpdateHmdDesc()
 
 		if (UseHack(HACK_RECONSTRUCT_EYE_MATRIX))
 		{
-			float ipd = vr::VRSystem()->GetFloatTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_UserIpdMeters_Float);
+			float ipd = Properties.GetFloat(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_UserIpdMeters_Float);
 			desc.HmdToEyePose.Orientation = OVR::Quatf::Identity();
 			desc.HmdToEyePose.Position.x = (eye == ovrEye_Left) ? -ipd / 2.0f : ipd / 2.0f;
 		}
@@ -235,17 +231,18 @@ void ovrHmdStruct::UpdateHmdDesc()
 	// Get the display properties
 	HmdDesc.Resolution = size;
 	HmdDesc.Resolution.w *= 2; // Both eye ports
-	HmdDesc.DisplayRefreshRate = vr::VRSystem()->GetFloatTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_DisplayFrequency_Float);
+	HmdDesc.DisplayRefreshRate = Properties.GetFloat(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_DisplayFrequency_Float);
 }
 
 void ovrHmdStruct::UpdateTrackerDesc()
 {
 	const bool spoofSensors = UseHack(HACK_SPOOF_SENSORS);
-	vr::TrackedDeviceIndex_t trackers[vr::k_unMaxTrackedDeviceCount];
+	std::shared_ptr<const DeviceRegistry::Snapshot> devices = Input->Devices.GetSnapshot();
+	const vr::TrackedDeviceIndex_t* trackers = devices->References;
 	uint32_t count = 3;
 
 	if (!spoofSensors)
-		count = vr::VRSystem()->GetSortedTrackedDeviceIndicesOfClass(vr::TrackedDeviceClass_TrackingReference, trackers, vr::k_unMaxTrackedDeviceCount);
+		count = devices->ReferenceCount;
 
 	// Only update trackers we haven't seen yet, this ensures we don't run into concurrency errors
 	for (uint32_t i = TrackerCount; i < count; i++)
@@ -264,16 +261,16 @@ void ovrHmdStruct::UpdateTrackerDesc()
 			vr::TrackedDeviceIndex_t index = trackers[i];
 
 			// Calculate field-of-view.
-			float left = vr::VRSystem()->GetFloatTrackedDeviceProperty(index, vr::Prop_FieldOfViewLeftDegrees_Float);
-			float right = vr::VRSystem()->GetFloatTrackedDeviceProperty(index, vr::Prop_FieldOfViewRightDegrees_Float);
-			float top = vr::VRSystem()->GetFloatTrackedDeviceProperty(index, vr::Prop_FieldOfViewTopDegrees_Float);
-			float bottom = vr::VRSystem()->GetFloatTrackedDeviceProperty(index, vr::Prop_FieldOfViewBottomDegrees_Float);
+			float left = Properties.GetFloat(index, vr::Prop_FieldOfViewLeftDegrees_Float);
+			float right = Properties.GetFloat(index, vr::Prop_FieldOfViewRightDegrees_Float);
+			float top = Properties.GetFloat(index, vr::Prop_FieldOfViewTopDegrees_Float);
+			float bottom = Properties.GetFloat(index, vr::Prop_FieldOfViewBottomDegrees_Float);
 			desc.FrustumHFovInRadians = (float)OVR::DegreeToRad(left + right);
 			desc.FrustumVFovInRadians = (float)OVR::DegreeToRad(top + bottom);
 
 			// Get the tracking frustum.
-			desc.FrustumNearZInMeters = vr::VRSystem()->GetFloatTrackedDeviceProperty(index, vr::Prop_TrackingRangeMinimumMeters_Float);
-			desc.FrustumFarZInMeters = vr::VRSystem()->GetFloatTrackedDeviceProperty(index, vr::Prop_TrackingRangeMaximumMeters_Float);
+			desc.FrustumNearZInMeters = Properties.GetFloat(index, vr::Prop_TrackingRangeMinimumMeters_Float);
+			desc.FrustumFarZInMeters = Properties.GetFloat(index, vr::Prop_TrackingRangeMaximumMeters_Float);
 		}
 	}
 
@@ -2,8 +2,10 @@
 
 #include <OVR_CAPI.h>
 #include <openvr.h>
+#include "PropertyCache.h"
 #include <memory>
 #include <atomic>
+#include <bitset>
 #include <vector>
 
 // Forward declarations
@@ -39,6 +41,8 @@ enum Hack
 	// Hack: Use the same (mirrored) FOV for both eyes.
 	// Stormland renders certain effects at the wrong depth if the eye FOVs do not match.
 	HACK_SAME_FOV_FOR_BOTH_EYES,
+
+	HACK_COUNT
 };
 
 struct ovrHmdStruct
@@ -48,6 +52,7 @@ struct ovrHmdStruct
 	// Property management
 	char AppKey[vr::k_unMaxApplicationKeyLength];
 	char StringBuffer[vr::k_unMaxPropertyStringSize];
+	PropertyCache Properties;
 
 	// Session status
 	std::atomic_uint32_t TrackerCount;
@@ -68,10 +73,13 @@ struct ovrHmdStruct
 	std::unique_ptr<CompositorBase> Compositor;
 	std::unique_ptr<InputManager> Input;
 
+	// Active hacks
+	std::bitset<HACK_COUNT> Hacks;
+
 	ovrHmdStruct();
 	~ovrHmdStruct();
 
-	bool UseHack(Hack hack) const;
+	bool UseHack(Hack hack) const { return Hacks[hack]; }
 	void UpdateStatus();
 	void UpdateHmdDesc();
 	void UpdateTrackerDesc();
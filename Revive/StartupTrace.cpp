@@ -0,0 +1,173 @@
+#include "StartupTrace.h"
+
+#include <Windows.h>
+#include <Shlobj.h>
+#include <Shlwapi.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// The log is moved aside at the start of a launch once it grows beyond this size
+#define REV_STARTUP_LOG_LIMIT (1024 * 1024)
+
+struct PendingPhase
+{
+	std::string Phase;
+	int64_t Ticks;
+};
+
+static std::atomic_bool s_Finished = false;
+static std::mutex s_Mutex;
+static int64_t s_Frequency = 0;
+static int64_t s_Launch = 0;
+static uint32_t s_ProcessId = 0;
+static std::vector<PendingPhase> s_Pending;
+static std::vector<std::string> s_Stamped;
+
+static bool GetLogPath(char* path, size_t size)
+{
+	char folder[MAX_PATH];
+	if (FAILED(SHGetFolderPathA(NULL, CSIDL_LOCAL_APPDATA, NULL, 0, folder)))
+		return false;
+
+	strcat_s(folder, "\\Revive");
+	if (!PathFileExistsA(folder))
+		CreateDirectoryA(folder, NULL);
+
+	return sprintf_s(path, size, "%s\\Startup.log", folder) > 0;
+}
+
+static void Initialize()
+{
+	if (s_Frequency)
+		return;
+
+	LARGE_INTEGER freq;
+	QueryPerformanceFrequency(&freq);
+	s_Frequency = freq.QuadPart;
+	s_ProcessId = GetCurrentProcessId();
+
+	// The performance counter is system-wide, so the ticks of the injector can be used directly
+	char ticks[32];
+	if (GetEnvironmentVariableA(REV_LAUNCH_TICKS, ticks, sizeof(ticks)))
+		s_Launch = _strtoi64(ticks, nullptr, 10);
+}
+
+static void Write(const char* phase, int64_t ticks)
+{
+	char path[MAX_PATH];
+	if (!GetLogPath(path, sizeof(path)))
+		return;
+
+	char executable[MAX_PATH];
+	GetModuleFileNameA(NULL, executable, MAX_PATH);
+
+	// Log the module that stamped the phase, so the runtime can be distinguished
+	HMODULE handle = NULL;
+	char module[MAX_PATH] = "";
+	if (GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+		(LPCSTR)&s_Mutex, &handle))
+		GetModuleFileNameA(handle, module, MAX_PATH);
+
+	char line[1024];
+	int length = sprintf_s(line, "%lu\t%10.2f ms\t%s\t%s\t%s\r\n", s_ProcessId, (ticks - s_Launch) * 1000.0 / s_Frequency,
+		PathFindFileNameA(executable), PathFindFileNameA(module), phase);
+	if (length <= 0)
+		return;
+
+	// A single append is atomic, so all processes can write to the log without sharing a lock
+	HANDLE file = CreateFileA(path, FILE_APPEND_DATA, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return;
+
+	DWORD written;
+	WriteFile(file, line, (DWORD)length, &written, NULL);
+	CloseHandle(file);
+}
+
+static void Log(const char* phase)
+{
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+
+	Initialize();
+	if (!s_Launch)
+		s_Launch = now.QuadPart;
+
+	if (s_ProcessId)
+		Write(phase, now.QuadPart);
+	else
+		s_Pending.push_back({ phase, now.QuadPart });
+}
+
+void StartupTrace::BeginLaunch()
+{
+	std::lock_guard<std::mutex> lk(s_Mutex);
+	Initialize();
+
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+	s_Launch = now.QuadPart;
+	s_ProcessId = 0;
+	SetEnvironmentVariableA(REV_LAUNCH_TICKS, std::to_string(s_Launch).c_str());
+
+	char path[MAX_PATH];
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if (GetLogPath(path, sizeof(path)) && GetFileAttributesExA(path, GetFileExInfoStandard, &data) &&
+		(data.nFileSizeHigh || data.nFileSizeLow > REV_STARTUP_LOG_LIMIT))
+	{
+		std::string old(path);
+		old.replace(old.rfind(".log"), 4, ".old.log");
+		MoveFileExA(path, old.c_str(), MOVEFILE_REPLACE_EXISTING);
+	}
+}
+
+void StartupTrace::SetProcessId(uint32_t processId)
+{
+	std::lock_guard<std::mutex> lk(s_Mutex);
+	Initialize();
+
+	s_ProcessId = processId;
+	for (const PendingPhase& pending : s_Pending)
+		Write(pending.Phase.c_str(), pending.Ticks);
+	s_Pending.clear();
+}
+
+void StartupTrace::Stamp(const char* phase)
+{
+	if (s_Finished)
+		return;
+
+	std::lock_guard<std::mutex> lk(s_Mutex);
+	Log(phase);
+}
+
+void StartupTrace::StampOnce(const char* phase)
+{
+	if (s_Finished)
+		return;
+
+	std::lock_guard<std::mutex> lk(s_Mutex);
+	for (const std::string& stamped : s_Stamped)
+	{
+		if (stamped == phase)
+			return;
+	}
+	s_Stamped.push_back(phase);
+	Log(phase);
+}
+
+void StartupTrace::Finish(const char* phase)
+{
+	if (s_Finished)
+		return;
+
+	std::lock_guard<std::mutex> lk(s_Mutex);
+	if (!s_Finished)
+		Log(phase);
+	s_Finished = true;
+}
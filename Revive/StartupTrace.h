@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stdint.h>
+
+// Environment variable through which the injector passes its start time to the launched title
+#define REV_LAUNCH_TICKS "REVIVE_LAUNCH_TICKS"
+
+// Appends the startup phases of a title to %LOCALAPPDATA%\Revive\Startup.log, which is shared by
+// the injector and both runtimes. Every line is keyed by the process id of the title and timed
+// from the moment the injector started, so a slow launch can be broken down per title and runtime.
+// Stamping stops after the first frame, so it costs a single branch for the rest of the session.
+class StartupTrace
+{
+public:
+	// Passes the current time to all processes started from this one, the phases are held back
+	// until the process id of the title is known through SetProcessId
+	static void BeginLaunch();
+	// Sets the process id the phases are logged under and writes the held back phases
+	static void SetProcessId(uint32_t processId);
+
+	// Logs a phase with the time since the launch, or since the first phase if not injected
+	static void Stamp(const char* phase);
+	// Logs a phase only the first time it's reached
+	static void StampOnce(const char* phase);
+	// Logs the final phase, any later phases are ignored
+	static void Finish(const char* phase);
+};
@@ -7,6 +7,7 @@ ovrTextureSwapChainData::ovrTextureSwapChainData(ovrTextureSwapChainDesc desc)
 	, SubmitIndex(0)
 	, Desc(desc)
 	, Overlay(vr::k_ulOverlayHandleInvalid)
+	, OverlayIndex(0)
 	, Textures()
 {
 }
@@ -17,6 +18,10 @@ ovrTextureSwapChainData::~ovrTextureSwapChainData()
 
 ovrMirrorTextureData::ovrMirrorTextureData(ovrMirrorTextureDesc desc)
 	: Desc(desc)
+	, Texture()
+	, Requested(false)
+	, FrameInterval(1)
+	, FrameCount(0)
 {
 }
 
@@ -27,6 +27,7 @@ struct ovrTextureSwapChainData
 {
 	ovrTextureSwapChainDesc Desc;
 	vr::VROverlayHandle_t Overlay;
+	unsigned int OverlayIndex;
 
 	unsigned int Identifier;
 	int Length, CurrentIndex, SubmitIndex;
@@ -45,6 +46,10 @@ struct ovrMirrorTextureData
 	ovrMirrorTextureDesc Desc;
 	std::unique_ptr<TextureBase> Texture;
 
+	bool Requested;				// The mirror is only rendered once the app retrieved the buffer
+	unsigned int FrameInterval;	// Render the mirror every n-th frame
+	uint64_t FrameCount;		// Frames submitted since the mirror was created, apps may skip frame indices
+
 	ovrMirrorTextureData(ovrMirrorTextureDesc desc);
 	~ovrMirrorTextureData();
 };
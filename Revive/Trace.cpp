@@ -0,0 +1,377 @@
+#include "Trace.h"
+#include "microprofile.h"
+
+#include <Windows.h>
+#include <Shlobj.h>
+#include <Shlwapi.h>
+#include <intrin.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Number of events kept for every thread, older events are overwritten
+#define REV_TRACE_BUFFER_SIZE 0x10000
+// Maximum number of distinct entry points, the last one is shared when we run out
+#define REV_TRACE_MAX_ENTRY_POINTS 256
+// Histogram buckets, four per power of two, covers durations of up to 2^32 ticks
+#define REV_TRACE_BUCKETS 128
+
+TraceLevel g_TraceLevel = TraceLevel_Off;
+thread_local uint32_t g_TraceDepth = 0;
+
+struct TraceEvent
+{
+	uint32_t Id;
+	int64_t Start;
+	int64_t End;
+};
+
+struct TraceStats
+{
+	std::atomic_uint64_t Count;
+	std::atomic_uint64_t Outermost;
+	std::atomic_uint64_t Total;
+	std::atomic_uint64_t Max;
+	std::atomic_uint32_t Buckets[REV_TRACE_BUCKETS];
+};
+
+struct TraceBuffer
+{
+	DWORD ThreadId;
+	std::atomic_uint32_t Count;
+	TraceEvent Events[REV_TRACE_BUFFER_SIZE];
+	TraceStats Stats[REV_TRACE_MAX_ENTRY_POINTS];
+};
+
+// The buffers are never freed while the runtime is loaded, so events of exited threads can still be exported
+static std::mutex s_BufferMutex;
+static std::vector<std::unique_ptr<TraceBuffer>> s_Buffers;
+static thread_local TraceBuffer* s_ThreadBuffer = nullptr;
+static int64_t s_Frequency = 1;
+
+// Entry points are registered during static initialization, so the mutex can't rely on the
+// initialization order of this translation unit
+static std::mutex& GetNameMutex()
+{
+	static std::mutex mutex;
+	return mutex;
+}
+
+static const char* s_Names[REV_TRACE_MAX_ENTRY_POINTS];
+static std::atomic_uint32_t s_NameCount(0);
+
+static TraceLevel ParseLevel(const char* str)
+{
+	if (_stricmp(str, "full") == 0 || strcmp(str, "2") == 0)
+		return TraceLevel_Full;
+	if (_stricmp(str, "api") == 0 || strcmp(str, "1") == 0)
+		return TraceLevel_Api;
+	return TraceLevel_Off;
+}
+
+static bool GetRegistryFlag(const char* name, DWORD* value)
+{
+	DWORD size = sizeof(DWORD);
+	return RegGetValueA(HKEY_CURRENT_USER, "Software\\Revive", name, RRF_RT_REG_DWORD, NULL, value, &size) == ERROR_SUCCESS;
+}
+
+// Only the owning thread writes to the statistics, so there's no need for an atomic increment
+template<typename T>
+static void Add(std::atomic<T>& counter, T value)
+{
+	counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+static uint32_t GetBucket(uint64_t ticks)
+{
+	if (ticks < 4)
+		return (uint32_t)ticks;
+
+	// The 64-bit intrinsic is only available on 64-bit targets
+	unsigned long msb;
+#if defined(_M_X64) || defined(_M_ARM64)
+	_BitScanReverse64(&msb, ticks);
+#else
+	if (_BitScanReverse(&msb, (unsigned long)(ticks >> 32)))
+		msb += 32;
+	else
+		_BitScanReverse(&msb, (unsigned long)ticks);
+#endif
+	uint32_t bucket = (msb - 1) * 4 + (uint32_t)((ticks >> (msb - 2)) & 3);
+	return std::min(bucket, (uint32_t)REV_TRACE_BUCKETS - 1);
+}
+
+static uint64_t GetBucketLowerBound(uint32_t bucket)
+{
+	if (bucket < 4)
+		return bucket;
+	return (4ULL + bucket % 4) << (bucket / 4 - 1);
+}
+
+void Trace::Initialize()
+{
+	LARGE_INTEGER freq;
+	if (QueryPerformanceFrequency(&freq))
+		s_Frequency = freq.QuadPart;
+
+	DWORD value = 0;
+	const char* level = getenv("REVIVE_TRACE_LEVEL");
+	if (level)
+		g_TraceLevel = ParseLevel(level);
+	else if (GetRegistryFlag("TraceLevel", &value))
+		g_TraceLevel = (TraceLevel)std::min(value, (DWORD)TraceLevel_Full);
+
+	MicroProfileOnThreadCreate("Main");
+	if (g_TraceLevel == TraceLevel_Full)
+	{
+		MicroProfileSetForceEnable(true);
+		MicroProfileSetEnableAllGroups(true);
+		MicroProfileSetForceMetaCounters(true);
+	}
+
+	const char* server = getenv("REVIVE_TRACE_SERVER");
+	if (server ? atoi(server) != 0 : GetRegistryFlag("TraceServer", &value) && value != 0)
+		MicroProfileWebServerStart();
+}
+
+void Trace::Shutdown()
+{
+	if (g_TraceLevel == TraceLevel_Off)
+		return;
+
+	char path[MAX_PATH];
+	if (GetDefaultPath("Trace", "json", path, sizeof(path)))
+		Export(path);
+
+	if (GetDefaultPath("Stats", "txt", path, sizeof(path)))
+	{
+		FILE* file = fopen(path, "w");
+		if (file)
+		{
+			fputs(GetStats().c_str(), file);
+			fclose(file);
+		}
+	}
+}
+
+bool Trace::GetDefaultPath(const char* prefix, const char* extension, char* path, size_t size)
+{
+	const char* devPath = getenv("REVIVE_TRACE_FILE");
+	if (devPath)
+		return sprintf_s(path, size, "%s.%s", devPath, extension) > 0;
+
+	char folder[MAX_PATH];
+	if (FAILED(SHGetFolderPathA(NULL, CSIDL_LOCAL_APPDATA, NULL, 0, folder)))
+		return false;
+
+	strcat_s(folder, "\\Revive");
+	if (!PathFileExistsA(folder))
+		CreateDirectoryA(folder, NULL);
+
+	char filepath[MAX_PATH];
+	GetModuleFileNameA(NULL, filepath, MAX_PATH);
+	PathRemoveExtensionA(filepath);
+
+	SYSTEMTIME time;
+	GetLocalTime(&time);
+	return sprintf_s(path, size, "%s\\%s-%s-%04d%02d%02d-%02d%02d%02d.%s", folder, prefix, PathFindFileNameA(filepath),
+		time.wYear, time.wMonth, time.wDay, time.wHour, time.wMinute, time.wSecond, extension) > 0;
+}
+
+// Copies the recorded events of a buffer in the order they were recorded. The owning thread keeps
+// recording during the copy, so the event count doubles as a sequence counter: events that may
+// have been overwritten while they were copied are dropped.
+static void CopyEvents(const TraceBuffer& buffer, std::vector<TraceEvent>& events)
+{
+	uint32_t count = buffer.Count.load(std::memory_order_acquire);
+	uint32_t begin = count > REV_TRACE_BUFFER_SIZE ? count - REV_TRACE_BUFFER_SIZE : 0;
+	events.clear();
+	for (uint32_t i = begin; i < count; i++)
+		events.push_back(buffer.Events[i % REV_TRACE_BUFFER_SIZE]);
+
+	// The writer may be overwriting the slot of the oldest event that is still counted
+	std::atomic_thread_fence(std::memory_order_acquire);
+	uint32_t end = buffer.Count.load(std::memory_order_relaxed);
+	uint32_t valid = end >= REV_TRACE_BUFFER_SIZE ? end - REV_TRACE_BUFFER_SIZE + 1 : 0;
+	if (valid > begin)
+		events.erase(events.begin(), events.begin() + std::min(valid - begin, count - begin));
+}
+
+bool Trace::Export(const char* path)
+{
+	FILE* file = fopen(path, "w");
+	if (!file)
+		return false;
+
+	DWORD pid = GetCurrentProcessId();
+	bool first = true;
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	std::lock_guard<std::mutex> lk(s_BufferMutex);
+	std::vector<TraceEvent> events;
+	for (const std::unique_ptr<TraceBuffer>& buffer : s_Buffers)
+	{
+		CopyEvents(*buffer, events);
+		for (const TraceEvent& event : events)
+		{
+			fprintf(file, "%s{\"name\":\"%s\",\"cat\":\"Revive\",\"ph\":\"X\",\"pid\":%lu,\"tid\":%lu,\"ts\":%.3f,\"dur\":%.3f}",
+				first ? "" : ",\n", s_Names[event.Id], pid, buffer->ThreadId,
+				event.Start * 1e6 / s_Frequency, (event.End - event.Start) * 1e6 / s_Frequency);
+			first = false;
+		}
+	}
+
+	fprintf(file, "\n]}\n");
+	return fclose(file) == 0;
+}
+
+std::string Trace::GetStats()
+{
+	struct Summary
+	{
+		uint64_t Count;
+		uint64_t Outermost;
+		uint64_t Total;
+		uint64_t Max;
+		uint64_t Buckets[REV_TRACE_BUCKETS];
+	};
+
+	// Merge the shards of all threads
+	uint32_t names = std::min((uint32_t)s_NameCount, (uint32_t)REV_TRACE_MAX_ENTRY_POINTS);
+	std::vector<Summary> summaries(names);
+	{
+		std::lock_guard<std::mutex> lk(s_BufferMutex);
+		for (const std::unique_ptr<TraceBuffer>& buffer : s_Buffers)
+		{
+			for (uint32_t i = 0; i < names; i++)
+			{
+				const TraceStats& stats = buffer->Stats[i];
+				summaries[i].Count += stats.Count;
+				summaries[i].Outermost += stats.Outermost;
+				summaries[i].Total += stats.Total;
+				summaries[i].Max = std::max(summaries[i].Max, (uint64_t)stats.Max);
+				for (uint32_t j = 0; j < REV_TRACE_BUCKETS; j++)
+					summaries[i].Buckets[j] += stats.Buckets[j];
+			}
+		}
+	}
+
+	// Use the submitted frames to show how often an entry point is called per frame, only outermost
+	// calls count since the submit functions are implemented on top of each other
+	uint64_t frames = 0;
+	for (uint32_t i = 0; i < names; i++)
+	{
+		if (strcmp(s_Names[i], "ovr_EndFrame") == 0 || strcmp(s_Names[i], "ovr_SubmitFrame") == 0 ||
+			strcmp(s_Names[i], "ovr_SubmitFrame2") == 0)
+			frames += summaries[i].Outermost;
+	}
+
+	std::vector<uint32_t> order;
+	for (uint32_t i = 0; i < names; i++)
+	{
+		if (summaries[i].Count > 0)
+			order.push_back(i);
+	}
+	std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return summaries[a].Total > summaries[b].Total; });
+
+	char line[256];
+	sprintf_s(line, "%-40s %10s %10s %10s %10s %10s %10s %10s\n", "Entry point", "Calls", "Per frame", "Total ms", "Mean us", "p50 us", "p99 us", "Max us");
+	std::string result = line;
+	for (uint32_t i : order)
+	{
+		const Summary& summary = summaries[i];
+
+		// Report the upper bound of the bucket that contains the percentile
+		double percentiles[] = { 0.5, 0.99 };
+		double values[2] = {};
+		for (int p = 0; p < 2; p++)
+		{
+			uint64_t target = (uint64_t)ceil(summary.Count * percentiles[p]), seen = 0;
+			for (uint32_t j = 0; j < REV_TRACE_BUCKETS; j++)
+			{
+				seen += summary.Buckets[j];
+				if (seen >= target)
+				{
+					values[p] = std::min(GetBucketLowerBound(j + 1), summary.Max) * 1e6 / s_Frequency;
+					break;
+				}
+			}
+		}
+
+		sprintf_s(line, "%-40s %10llu %10.2f %10.3f %10.3f %10.3f %10.3f %10.3f\n", s_Names[i], summary.Count,
+			frames ? (double)summary.Count / frames : 0.0, summary.Total * 1e3 / s_Frequency,
+			summary.Total * 1e6 / s_Frequency / summary.Count, values[0], values[1], summary.Max * 1e6 / s_Frequency);
+		result += line;
+	}
+	return result;
+}
+
+uint32_t Trace::Register(const char* name)
+{
+	std::lock_guard<std::mutex> lk(GetNameMutex());
+	uint32_t count = s_NameCount;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		if (strcmp(s_Names[i], name) == 0)
+			return i;
+	}
+
+	if (count == REV_TRACE_MAX_ENTRY_POINTS)
+		return count - 1;
+
+	s_Names[count] = name;
+	s_NameCount = count + 1;
+	return count;
+}
+
+const char* Trace::GetName(uint32_t id)
+{
+	std::lock_guard<std::mutex> lk(GetNameMutex());
+	return id < s_NameCount ? s_Names[id] : "Unknown";
+}
+
+int64_t Trace::GetTicks()
+{
+	LARGE_INTEGER ticks;
+	QueryPerformanceCounter(&ticks);
+	return ticks.QuadPart;
+}
+
+void Trace::Record(uint32_t id, int64_t start, int64_t end, bool outermost)
+{
+	TraceBuffer* buffer = s_ThreadBuffer;
+	if (!buffer)
+	{
+		buffer = new TraceBuffer();
+		buffer->ThreadId = GetCurrentThreadId();
+
+		std::lock_guard<std::mutex> lk(s_BufferMutex);
+		s_Buffers.emplace_back(buffer);
+		s_ThreadBuffer = buffer;
+	}
+
+	// Only the owning thread writes to the buffer, the fence keeps the write from becoming visible
+	// before the count that tells an exporting thread the slot is being reused
+	uint32_t count = buffer->Count.load(std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	TraceEvent& event = buffer->Events[count % REV_TRACE_BUFFER_SIZE];
+	event.Id = id;
+	event.Start = start;
+	event.End = end;
+	buffer->Count.store(count + 1, std::memory_order_release);
+
+	uint64_t duration = (uint64_t)(end - start);
+	TraceStats& stats = buffer->Stats[id];
+	Add(stats.Count, 1ULL);
+	if (outermost)
+		Add(stats.Outermost, 1ULL);
+	Add(stats.Total, duration);
+	if (duration > stats.Max.load(std::memory_order_relaxed))
+		stats.Max.store(duration, std::memory_order_relaxed);
+	Add(stats.Buckets[GetBucket(duration)], 1U);
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "Capture.h"
+#include "microprofile.h"
+
+#include <atomic>
+#include <stdint.h>
+#include <string>
+
+// Property name that returns the entry point statistics through ovr_GetString
+#define REV_KEY_API_STATS "ReviveApiStats"
+
+enum TraceLevel
+{
+	TraceLevel_Off,		// Nothing is recorded, REV_TRACE is only a branch on the cached level
+	TraceLevel_Api,		// The LibOVR entry points are recorded for export and statistics
+	TraceLevel_Full,	// Also enables all microprofile groups and meta counters
+};
+
+// Cached tracing level, only written once during initialization
+extern TraceLevel g_TraceLevel;
+// Number of recorded entry points the current thread is in, entry points call each other
+extern thread_local uint32_t g_TraceDepth;
+
+// Records the LibOVR entry points into per-thread ring buffers, which can be exported as a
+// Chrome trace. The JSON trace format can also be opened by Perfetto.
+// Every thread also keeps call counts and latency histograms for each entry point, these are
+// only written by the owning thread so recording never takes a lock.
+class Trace
+{
+public:
+	// Reads the tracing level from the REVIVE_TRACE_LEVEL environment variable or the
+	// HKCU\Software\Revive\TraceLevel registry value, the microprofile webserver is only
+	// started if requested through REVIVE_TRACE_SERVER or the TraceServer registry value.
+	static void Initialize();
+	// Exports the recorded events and statistics if tracing is enabled
+	static void Shutdown();
+
+	// Writes all recorded events to a Chrome trace file
+	static bool Export(const char* path);
+	// Summarizes the call counts and latency percentiles of all entry points
+	static std::string GetStats();
+	// Default path of the trace files, can be overridden with REVIVE_TRACE_FILE
+	static bool GetDefaultPath(const char* prefix, const char* extension, char* path, size_t size);
+
+	// Returns the identifier of an entry point, registering it if needed
+	static uint32_t Register(const char* name);
+	static const char* GetName(uint32_t id);
+	static int64_t GetTicks();
+	// Outermost calls aren't nested in another entry point, only those are counted as frames
+	static void Record(uint32_t id, int64_t start, int64_t end, bool outermost);
+};
+
+// Every REV_TRACE site has its own tag type, its identifier is registered during static
+// initialization so the scope doesn't have to check a guarded function-local static on every call.
+template<typename Tag>
+struct TraceEntry
+{
+	static const uint32_t Id;
+#if MICROPROFILE_ENABLED
+	// Only registered with microprofile once the full tracing level asks for it
+	static std::atomic<MicroProfileToken> Token;
+#endif
+};
+
+template<typename Tag>
+const uint32_t TraceEntry<Tag>::Id = Trace::Register(Tag::Name());
+#if MICROPROFILE_ENABLED
+template<typename Tag>
+std::atomic<MicroProfileToken> TraceEntry<Tag>::Token(MICROPROFILE_INVALID_TOKEN);
+#endif
+
+template<typename Tag>
+class TraceScope
+{
+public:
+	TraceScope()
+		: m_Start(0)
+		, m_Capture(UINT32_MAX)
+		, m_Recorded(g_TraceLevel != TraceLevel_Off)
+		, m_Outermost(false)
+	{
+		if (m_Recorded)
+			m_Outermost = g_TraceDepth++ == 0;
+		if (m_Recorded || g_CaptureEnabled)
+			m_Start = Trace::GetTicks();
+		if (g_CaptureEnabled)
+			m_Capture = Capture::Begin();
+#if MICROPROFILE_ENABLED
+		m_Tick = MICROPROFILE_INVALID_TICK;
+		if (g_TraceLevel == TraceLevel_Full)
+			m_Tick = MicroProfileEnter(GetToken());
+#endif
+	}
+
+	~TraceScope()
+	{
+		if (!m_Start)
+			return;
+
+		int64_t end = Trace::GetTicks();
+		if (m_Recorded)
+		{
+			g_TraceDepth--;
+			Trace::Record(TraceEntry<Tag>::Id, m_Start, end, m_Outermost);
+		}
+		// Even if the capture stopped while the entry point ran, its payload still has to be removed
+		if (m_Capture != UINT32_MAX)
+			Capture::Record(TraceEntry<Tag>::Id, m_Start, end, m_Capture);
+#if MICROPROFILE_ENABLED
+		if (m_Tick != MICROPROFILE_INVALID_TICK)
+			MicroProfileLeave(TraceEntry<Tag>::Token, m_Tick);
+#endif
+	}
+
+private:
+	int64_t m_Start;
+	uint32_t m_Capture;
+	bool m_Recorded;
+	bool m_Outermost;
+#if MICROPROFILE_ENABLED
+	uint64_t m_Tick;
+
+	static MicroProfileToken GetToken()
+	{
+		MicroProfileToken token = TraceEntry<Tag>::Token;
+		if (token == MICROPROFILE_INVALID_TOKEN)
+		{
+			// Racing threads get the same token back from microprofile
+			token = MicroProfileGetToken("Revive", Tag::Name(), 0xff0000, MicroProfileTokenTypeCpu);
+			TraceEntry<Tag>::Token = token;
+		}
+		return token;
+	}
+#endif
+};
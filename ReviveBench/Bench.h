@@ -0,0 +1,158 @@
+#pragma once
+
+#include "BenchStats.h"
+
+#include <Windows.h>
+#include <d3d11.h>
+#include <map>
+#include <string>
+#include <vector>
+
+// The runtime exports the current signatures under their versioned names
+#define ovr_GetRenderDesc ovr_GetRenderDesc2
+#define ovr_SubmitFrame ovr_SubmitFrame2
+#include <OVR_CAPI_D3D.h>
+
+// The runtime is loaded at run time so the same driver can be pointed at either backend
+#define OVR_FUNCTIONS(X) \
+	X(ovr_Initialize) \
+	X(ovr_Shutdown) \
+	X(ovr_GetLastErrorInfo) \
+	X(ovr_Create) \
+	X(ovr_Destroy) \
+	X(ovr_GetHmdDesc) \
+	X(ovr_GetSessionStatus) \
+	X(ovr_SetTrackingOriginType) \
+	X(ovr_RecenterTrackingOrigin) \
+	X(ovr_GetFovTextureSize) \
+	X(ovr_GetRenderDesc) \
+	X(ovr_GetTimeInSeconds) \
+	X(ovr_GetPredictedDisplayTime) \
+	X(ovr_GetTrackingState) \
+	X(ovr_GetInputState) \
+	X(ovr_GetPerfStats) \
+	X(ovr_GetFloat) \
+	X(ovr_SetControllerVibration) \
+	X(ovr_CreateTextureSwapChainDX) \
+	X(ovr_CommitTextureSwapChain) \
+	X(ovr_DestroyTextureSwapChain) \
+	X(ovr_WaitToBeginFrame) \
+	X(ovr_BeginFrame) \
+	X(ovr_EndFrame) \
+	X(ovr_SubmitFrame)
+
+struct OVRFunctions
+{
+#define OVR_DECLARE(x) decltype(&x) x;
+	OVR_FUNCTIONS(OVR_DECLARE)
+#undef OVR_DECLARE
+
+	bool Load(HMODULE module);
+};
+
+extern OVRFunctions g_ovr;
+
+struct BenchConfig
+{
+	std::string Runtime;
+	int Frames = 1000;
+	int Warmup = 100;
+	int InputPolls = 1;
+	int TrackingPolls = 1;
+	int PropertyPolls = 0;
+	int EyeLayers = 1;
+	int QuadLayers = 0;
+	int CylinderLayers = 0;
+	int CubeLayers = 0;
+	int DepthLayers = 0;
+	double Budget = 0.0;
+	bool Warp = false;
+	std::wstring Output;
+
+	// Replays a capture instead of running the synthetic frame loop
+	std::wstring Replay;
+	double Speed = 1.0;
+
+	// Runs concurrent sessions that are repeatedly created and destroyed instead
+	int Sessions = 0;
+	int Rounds = 10;
+
+	// Limits on the calls made to a stub runtime by the synthetic frame loop
+	std::wstring Calls;
+	// Tolerance in milliseconds of ovr_GetTimeInSeconds against the predicted display time, on top of a
+	// single frame, zero disables the check
+	double Clock = 0.0;
+};
+
+struct BenchTimer
+{
+	BenchStats Calls;
+	BenchStats Frames;
+	BenchStats Captured;
+	std::map<std::string, uint64_t> Skipped;
+	double Frequency;
+	bool Recording;
+	int ClockErrors;
+
+	// Accumulated for the current frame
+	double Overhead;
+	ULONG64 Cycles;
+};
+
+extern BenchTimer g_Timer;
+
+// Times a single call, blocking calls are recorded but don't count towards the frame overhead
+class BenchScope
+{
+public:
+	BenchScope(const char* name, bool overhead)
+		: m_Name(name)
+		, m_Overhead(overhead)
+	{
+		QueryThreadCycleTime(GetCurrentThread(), &m_Cycles);
+		QueryPerformanceCounter(&m_Start);
+	}
+
+	~BenchScope()
+	{
+		LARGE_INTEGER end;
+		ULONG64 cycles;
+		QueryPerformanceCounter(&end);
+		QueryThreadCycleTime(GetCurrentThread(), &cycles);
+
+		double us = (end.QuadPart - m_Start.QuadPart) * 1000000.0 / g_Timer.Frequency;
+		if (g_Timer.Recording)
+			g_Timer.Calls.Add(m_Name, us);
+		if (m_Overhead)
+		{
+			g_Timer.Overhead += us;
+			g_Timer.Cycles += cycles - m_Cycles;
+		}
+	}
+
+private:
+	const char* m_Name;
+	bool m_Overhead;
+	LARGE_INTEGER m_Start;
+	ULONG64 m_Cycles;
+};
+
+template<typename F, typename... Args>
+auto Timed(const char* name, bool overhead, F function, Args... args) -> decltype(function(args...))
+{
+	BenchScope scope(name, overhead);
+	return function(args...);
+}
+
+#define TIMED(x, ...) Timed(#x, true, g_ovr.x, __VA_ARGS__)
+
+// Ends the current frame, adding its overhead to the frame statistics
+void EndBenchFrame();
+
+bool CreateDevice(const ovrGraphicsLuid& luid, bool warp, ID3D11Device** device);
+ovrResult RunReplay(const BenchConfig& config, int& frames);
+ovrResult RunSessions(const BenchConfig& config, int& frames);
+
+// Checks the call counts a stub runtime wrote to the stats file on shutdown, every line of the limits
+// file holds "<IVRInterface::Method> <max calls> [<max calls per frame>]" and '#' starts a comment
+bool CheckStubCalls(const std::wstring& limits, const char* stats, long long frames);
@@ -0,0 +1,45 @@
+#include "BenchStats.h"
+
+#include <algorithm>
+#include <numeric>
+
+static double Percentile(const std::vector<double>& sorted, double p)
+{
+	size_t index = (size_t)(p * (sorted.size() - 1) + 0.5);
+	return sorted[std::min(index, sorted.size() - 1)];
+}
+
+BenchStats::Summary BenchStats::Summarize(std::vector<double> samples)
+{
+	Summary summary = {};
+	if (samples.empty())
+		return summary;
+
+	std::sort(samples.begin(), samples.end());
+	summary.Count = samples.size();
+	summary.Mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+	summary.P50 = Percentile(samples, 0.50);
+	summary.P90 = Percentile(samples, 0.90);
+	summary.P99 = Percentile(samples, 0.99);
+	summary.Max = samples.back();
+	return summary;
+}
+
+BenchStats::Summary BenchStats::Summarize(const char* name) const
+{
+	auto it = m_Samples.find(name);
+	if (it == m_Samples.end())
+		return Summary();
+	return Summarize(it->second);
+}
+
+void BenchStats::Write(FILE* file, const char* indent) const
+{
+	size_t i = 0;
+	for (auto& it : m_Samples)
+	{
+		Summary s = Summarize(it.second);
+		fprintf(file, "%s\"%s\": { \"count\": %zu, \"mean\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f }%s\n",
+			indent, it.first.c_str(), s.Count, s.Mean, s.P50, s.P90, s.P99, s.Max, ++i < m_Samples.size() ? "," : "");
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <map>
+#include <string>
+#include <vector>
+
+// Collects timing samples and writes their distributions as JSON
+class BenchStats
+{
+public:
+	struct Summary
+	{
+		size_t Count;
+		double Mean;
+		double P50;
+		double P90;
+		double P99;
+		double Max;
+	};
+
+	void Add(const char* name, double value) { m_Samples[name].push_back(value); }
+	bool Empty() const { return m_Samples.empty(); }
+	Summary Summarize(const char* name) const;
+
+	// Writes one object per series, the caller provides the surrounding document
+	void Write(FILE* file, const char* indent) const;
+
+	static Summary Summarize(std::vector<double> samples);
+
+private:
+	std::map<std::string, std::vector<double>> m_Samples;
+};
@@ -0,0 +1,378 @@
+#include "Bench.h"
+#include "../Revive/CaptureFormat.h"
+
+#include <wrl/client.h>
+#include <stdio.h>
+#include <string.h>
+
+using Microsoft::WRL::ComPtr;
+
+class CaptureReader
+{
+public:
+	CaptureReader(const uint8_t* data, size_t size)
+		: m_Data(data)
+		, m_Size(size)
+		, m_Offset(0)
+	{
+	}
+
+	template<typename T>
+	bool Read(T& value)
+	{
+		return Read(&value, sizeof(T));
+	}
+
+	bool Read(void* value, size_t size)
+	{
+		if (m_Offset + size > m_Size)
+			return false;
+		memcpy(value, m_Data + m_Offset, size);
+		m_Offset += size;
+		return true;
+	}
+
+	const uint8_t* Skip(size_t size)
+	{
+		if (m_Offset + size > m_Size)
+			return nullptr;
+		const uint8_t* data = m_Data + m_Offset;
+		m_Offset += size;
+		return data;
+	}
+
+private:
+	const uint8_t* m_Data;
+	size_t m_Size;
+	size_t m_Offset;
+};
+
+struct ReplayState
+{
+	const CaptureHeader* Header;
+	ovrSession Session;
+	ComPtr<ID3D11Device> Device;
+	std::map<uint64_t, ovrTextureSwapChain> Chains;
+	bool Warp;
+};
+
+static ovrTextureSwapChain FindChain(ReplayState& state, ovrTextureSwapChain captured)
+{
+	auto it = state.Chains.find((uint64_t)(uintptr_t)captured);
+	return it != state.Chains.end() ? it->second : nullptr;
+}
+
+// Replaces the swapchain handles of the application with the ones created by the replay
+static bool RemapLayer(ReplayState& state, ovrLayer_Union& layer)
+{
+	switch (layer.Header.Type)
+	{
+	case ovrLayerType_EyeFov:
+	case ovrLayerType_EyeFovDepth:
+	case ovrLayerType_EyeMatrix:
+	case ovrLayerType_EyeFovMultires:
+		// All eye layers start with the same members
+		for (int eye = 0; eye < ovrEye_Count; eye++)
+			layer.EyeFov.ColorTexture[eye] = FindChain(state, layer.EyeFov.ColorTexture[eye]);
+		if (layer.Header.Type == ovrLayerType_EyeFovDepth)
+		{
+			for (int eye = 0; eye < ovrEye_Count; eye++)
+				layer.EyeFovDepth.DepthTexture[eye] = FindChain(state, layer.EyeFovDepth.DepthTexture[eye]);
+		}
+		return layer.EyeFov.ColorTexture[ovrEye_Left] != nullptr;
+	case ovrLayerType_Quad:
+		layer.Quad.ColorTexture = FindChain(state, layer.Quad.ColorTexture);
+		return layer.Quad.ColorTexture != nullptr;
+	case ovrLayerType_Cylinder:
+		layer.Cylinder.ColorTexture = FindChain(state, layer.Cylinder.ColorTexture);
+		return layer.Cylinder.ColorTexture != nullptr;
+	case ovrLayerType_Cube:
+		layer.Cube.CubeMapTexture = FindChain(state, layer.Cube.CubeMapTexture);
+		return layer.Cube.CubeMapTexture != nullptr;
+	default:
+		return false;
+	}
+}
+
+static ovrResult ReplayFrame(ReplayState& state, const char* name, CaptureReader& reader)
+{
+	long long frameIndex;
+	uint32_t hasViewScale, layerCount;
+	ovrViewScaleDesc viewScale;
+	if (!reader.Read(frameIndex) || !reader.Read(hasViewScale) || !reader.Read(viewScale) || !reader.Read(layerCount))
+		return ovrError_InvalidParameter;
+
+	std::vector<ovrLayer_Union> layers(layerCount);
+	std::vector<const ovrLayerHeader*> layerPtrs(layerCount);
+	for (uint32_t i = 0; i < layerCount; i++)
+	{
+		uint32_t size;
+		const uint8_t* data;
+		if (!reader.Read(size) || !(data = reader.Skip(size)))
+			return ovrError_InvalidParameter;
+
+		layers[i] = {};
+		memcpy(&layers[i], data, size < sizeof(ovrLayer_Union) ? size : sizeof(ovrLayer_Union));
+		layerPtrs[i] = size && RemapLayer(state, layers[i]) ? &layers[i].Header : nullptr;
+	}
+
+	const ovrViewScaleDesc* viewScaleDesc = hasViewScale ? &viewScale : nullptr;
+	if (strcmp(name, "ovr_EndFrame") == 0)
+		return Timed(name, true, g_ovr.ovr_EndFrame, state.Session, frameIndex, viewScaleDesc, layerPtrs.data(), layerCount);
+	return Timed(name, true, g_ovr.ovr_SubmitFrame, state.Session, frameIndex, viewScaleDesc, layerPtrs.data(), layerCount);
+}
+
+static void DestroySession(ReplayState& state)
+{
+	if (!state.Session)
+		return;
+
+	for (auto& it : state.Chains)
+		g_ovr.ovr_DestroyTextureSwapChain(state.Session, it.second);
+	state.Chains.clear();
+	state.Device.Reset();
+	g_ovr.ovr_Destroy(state.Session);
+	state.Session = nullptr;
+}
+
+// Returns false if the call isn't replayed
+static bool ReplayCall(ReplayState& state, const std::string& name, const CaptureRecord& record, CaptureReader& reader, ovrResult& result)
+{
+	result = ovrSuccess;
+	const char* label = name.c_str();
+	if (name == "ovr_Create")
+	{
+		// Only a single session is replayed at a time
+		DestroySession(state);
+
+		ovrGraphicsLuid luid;
+		result = Timed(label, true, g_ovr.ovr_Create, &state.Session, &luid);
+		if (OVR_SUCCESS(result) && !CreateDevice(luid, state.Warp, &state.Device))
+			result = ovrError_IncompatibleGPU;
+		return true;
+	}
+	if (name == "ovr_Destroy")
+	{
+		DestroySession(state);
+		return true;
+	}
+
+	// Everything else requires a session
+	if (!state.Session)
+		return false;
+
+	if (name == "ovr_GetSessionStatus")
+	{
+		ovrSessionStatus status;
+		result = Timed(label, true, g_ovr.ovr_GetSessionStatus, state.Session, &status);
+	}
+	else if (name == "ovr_SetTrackingOriginType")
+	{
+		ovrTrackingOrigin origin;
+		if (reader.Read(origin))
+			result = Timed(label, true, g_ovr.ovr_SetTrackingOriginType, state.Session, origin);
+	}
+	else if (name == "ovr_RecenterTrackingOrigin")
+	{
+		result = Timed(label, true, g_ovr.ovr_RecenterTrackingOrigin, state.Session);
+	}
+	else if (name == "ovr_GetTrackingState")
+	{
+		double absTime;
+		ovrBool latencyMarker;
+		if (!reader.Read(absTime) || !reader.Read(latencyMarker))
+			return false;
+
+		// Both runtimes use the performance counter as their time base, so keep the same distance
+		// between the call and the requested time
+		if (absTime > 0.0)
+		{
+			LARGE_INTEGER now;
+			QueryPerformanceCounter(&now);
+			absTime += now.QuadPart / g_Timer.Frequency - (double)record.Start / state.Header->Frequency;
+		}
+		Timed(label, true, g_ovr.ovr_GetTrackingState, state.Session, absTime, latencyMarker);
+	}
+	else if (name == "ovr_GetInputState")
+	{
+		ovrControllerType controllerType;
+		ovrInputState input;
+		if (reader.Read(controllerType))
+			result = Timed(label, true, g_ovr.ovr_GetInputState, state.Session, controllerType, &input);
+	}
+	else if (name == "ovr_SetControllerVibration")
+	{
+		ovrControllerType controllerType;
+		float frequency, amplitude;
+		if (reader.Read(controllerType) && reader.Read(frequency) && reader.Read(amplitude))
+			result = Timed(label, true, g_ovr.ovr_SetControllerVibration, state.Session, controllerType, frequency, amplitude);
+	}
+	else if (name == "ovr_CreateTextureSwapChainDX" || name == "ovr_CreateTextureSwapChainGL" || name == "ovr_CreateTextureSwapChainVk")
+	{
+		// Every swapchain is replayed as a D3D11 swapchain, regardless of the API of the application
+		ovrTextureSwapChainDesc desc;
+		uint64_t handle;
+		if (!reader.Read(desc) || !reader.Read(handle))
+			return false;
+
+		ovrTextureSwapChain chain = nullptr;
+		result = Timed(label, true, g_ovr.ovr_CreateTextureSwapChainDX, state.Session, (IUnknown*)state.Device.Get(), &desc, &chain);
+		if (OVR_SUCCESS(result))
+			state.Chains[handle] = chain;
+	}
+	else if (name == "ovr_CommitTextureSwapChain" || name == "ovr_DestroyTextureSwapChain")
+	{
+		uint64_t handle;
+		if (!reader.Read(handle))
+			return false;
+
+		auto it = state.Chains.find(handle);
+		if (it == state.Chains.end())
+			return false;
+
+		if (name == "ovr_CommitTextureSwapChain")
+		{
+			result = Timed(label, true, g_ovr.ovr_CommitTextureSwapChain, state.Session, it->second);
+		}
+		else
+		{
+			Timed(label, true, g_ovr.ovr_DestroyTextureSwapChain, state.Session, it->second);
+			state.Chains.erase(it);
+		}
+	}
+	else if (name == "ovr_GetPredictedDisplayTime" || name == "ovr_WaitToBeginFrame" || name == "ovr_BeginFrame")
+	{
+		long long frameIndex;
+		if (!reader.Read(frameIndex))
+			return false;
+
+		if (name == "ovr_GetPredictedDisplayTime")
+			Timed(label, true, g_ovr.ovr_GetPredictedDisplayTime, state.Session, frameIndex);
+		else if (name == "ovr_WaitToBeginFrame")
+			result = Timed(label, false, g_ovr.ovr_WaitToBeginFrame, state.Session, frameIndex);
+		else
+			result = Timed(label, true, g_ovr.ovr_BeginFrame, state.Session, frameIndex);
+	}
+	else if (name == "ovr_EndFrame" || name == "ovr_SubmitFrame2")
+	{
+		result = ReplayFrame(state, label, reader);
+		EndBenchFrame();
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
+// Waits until the time of the record, scaled by the replay speed
+static void WaitForRecord(const CaptureHeader& header, const CaptureRecord& record, double speed, int64_t replayStart)
+{
+	if (speed <= 0.0)
+		return;
+
+	double target = (record.Start - header.Start) / (double)header.Frequency / speed;
+	for (;;)
+	{
+		LARGE_INTEGER now;
+		QueryPerformanceCounter(&now);
+		double remaining = target - (now.QuadPart - replayStart) / g_Timer.Frequency;
+		if (remaining <= 0.0)
+			break;
+
+		// Sleep while there's plenty of time left, then spin for accuracy
+		if (remaining > 0.002)
+			Sleep((DWORD)((remaining - 0.001) * 1000.0));
+		else
+			YieldProcessor();
+	}
+}
+
+ovrResult RunReplay(const BenchConfig& config, int& frames)
+{
+	FILE* file = _wfopen(config.Replay.c_str(), L"rb");
+	if (!file)
+	{
+		printf("Unable to open capture %ls\n", config.Replay.c_str());
+		return ovrError_InvalidParameter;
+	}
+
+	std::vector<uint8_t> data;
+	uint8_t buffer[0x10000];
+	size_t read;
+	while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		data.insert(data.end(), buffer, buffer + read);
+	fclose(file);
+
+	CaptureReader reader(data.data(), data.size());
+	const CaptureHeader* header = (const CaptureHeader*)reader.Skip(sizeof(CaptureHeader));
+	if (!header || header->Magic != REV_CAPTURE_MAGIC || header->Version != REV_CAPTURE_VERSION)
+	{
+		printf("Invalid capture file\n");
+		return ovrError_InvalidParameter;
+	}
+
+	// Layers contain pointers, so their layout depends on the bitness of the application
+	if (header->PointerSize != sizeof(void*))
+	{
+		printf("Captures of %u-bit applications can't be replayed by a %u-bit process\n",
+			header->PointerSize * 8, (uint32_t)sizeof(void*) * 8);
+		return ovrError_InvalidParameter;
+	}
+
+	ReplayState state = {};
+	state.Header = header;
+	state.Warp = config.Warp;
+
+	std::map<uint32_t, std::string> names;
+	LARGE_INTEGER replayStart;
+	QueryPerformanceCounter(&replayStart);
+	g_Timer.Recording = true;
+	g_Timer.Overhead = 0.0;
+	g_Timer.Cycles = 0;
+
+	ovrResult result = ovrSuccess;
+	frames = 0;
+	CaptureRecord record;
+	while (OVR_SUCCESS(result) && reader.Read(record))
+	{
+		const uint8_t* payload = reader.Skip(record.Size);
+		if (!payload)
+			break;
+
+		if (record.Type == CaptureRecord_Name)
+		{
+			names[record.Id] = std::string((const char*)payload, record.Size);
+			continue;
+		}
+
+		const std::string& name = names[record.Id];
+		g_Timer.Captured.Add(name.c_str(), (record.End - record.Start) * 1000000.0 / header->Frequency);
+		if (record.Flags & CaptureFlag_Nested)
+			continue;
+
+		WaitForRecord(*header, record, config.Speed, replayStart.QuadPart);
+
+		CaptureReader args(payload, record.Size);
+		if (ReplayCall(state, name, record, args, result))
+		{
+			if (name == "ovr_EndFrame" || name == "ovr_SubmitFrame2")
+				frames++;
+		}
+		else
+		{
+			g_Timer.Skipped[name]++;
+		}
+	}
+	g_Timer.Recording = false;
+
+	if (OVR_FAILURE(result))
+	{
+		ovrErrorInfo info;
+		g_ovr.ovr_GetLastErrorInfo(&info);
+		printf("Replay failed with %d: %s\n", result, info.ErrorString);
+	}
+
+	DestroySession(state);
+	return result;
+}
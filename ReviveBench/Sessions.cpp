@@ -0,0 +1,115 @@
+#include "Bench.h"
+
+#include <wrl/client.h>
+#include <stdio.h>
+#include <atomic>
+#include <thread>
+
+using Microsoft::WRL::ComPtr;
+
+// The calls aren't timed, the timer is shared by the whole process and not thread-safe
+static ovrResult RunSessionRound(const BenchConfig& config, int& frames)
+{
+	ovrSession session;
+	ovrGraphicsLuid luid;
+	ovrResult result = g_ovr.ovr_Create(&session, &luid);
+	if (OVR_FAILURE(result))
+		return result;
+
+	ComPtr<ID3D11Device> device;
+	if (!CreateDevice(luid, config.Warp, &device))
+	{
+		g_ovr.ovr_Destroy(session);
+		return ovrError_IncompatibleGPU;
+	}
+
+	ovrHmdDesc hmd = g_ovr.ovr_GetHmdDesc(session);
+	ovrSizei eyeSize = g_ovr.ovr_GetFovTextureSize(session, ovrEye_Left, hmd.DefaultEyeFov[ovrEye_Left], 1.0f);
+
+	ovrTextureSwapChainDesc desc = {};
+	desc.Type = ovrTexture_2D;
+	desc.Format = OVR_FORMAT_R8G8B8A8_UNORM_SRGB;
+	desc.ArraySize = 1;
+	desc.Width = eyeSize.w * 2;
+	desc.Height = eyeSize.h;
+	desc.MipLevels = 1;
+	desc.SampleCount = 1;
+	desc.BindFlags = ovrTextureBind_DX_RenderTarget;
+
+	ovrTextureSwapChain chain = nullptr;
+	result = g_ovr.ovr_CreateTextureSwapChainDX(session, (IUnknown*)device.Get(), &desc, &chain);
+
+	ovrLayerEyeFov layer = {};
+	layer.Header.Type = ovrLayerType_EyeFov;
+	layer.ColorTexture[ovrEye_Left] = chain;
+	for (int eye = 0; eye < ovrEye_Count; eye++)
+	{
+		layer.Viewport[eye] = { { eye * eyeSize.w, 0 }, eyeSize };
+		layer.Fov[eye] = hmd.DefaultEyeFov[eye];
+		layer.RenderPose[eye].Orientation.w = 1.0f;
+	}
+	const ovrLayerHeader* layerPtr = &layer.Header;
+
+	// Each session runs its own frame loop, events for the other sessions are routed to them
+	for (long long frameIndex = 0; OVR_SUCCESS(result) && frameIndex < config.Frames; frameIndex++)
+	{
+		ovrSessionStatus status;
+		result = g_ovr.ovr_GetSessionStatus(session, &status);
+		if (OVR_FAILURE(result) || status.ShouldQuit)
+			break;
+
+		result = g_ovr.ovr_WaitToBeginFrame(session, frameIndex);
+		if (OVR_SUCCESS(result))
+			result = g_ovr.ovr_BeginFrame(session, frameIndex);
+		if (OVR_SUCCESS(result))
+			result = g_ovr.ovr_CommitTextureSwapChain(session, chain);
+		if (OVR_SUCCESS(result))
+			result = g_ovr.ovr_EndFrame(session, frameIndex, nullptr, &layerPtr, 1);
+		if (OVR_SUCCESS(result))
+			frames++;
+	}
+
+	if (chain)
+		g_ovr.ovr_DestroyTextureSwapChain(session, chain);
+	device.Reset();
+	g_ovr.ovr_Destroy(session);
+
+	// The handle must be rejected once the session is gone, even after its slot has been reused
+	ovrSessionStatus status;
+	if (OVR_SUCCESS(result) && g_ovr.ovr_GetSessionStatus(session, &status) != ovrError_InvalidSession)
+	{
+		printf("Destroyed session %p is still accepted\n", session);
+		result = ovrError_RuntimeException;
+	}
+	return result;
+}
+
+ovrResult RunSessions(const BenchConfig& config, int& frames)
+{
+	std::atomic<int> total(0);
+	std::atomic<ovrResult> failure(ovrSuccess);
+	std::vector<std::thread> threads;
+	for (int i = 0; i < config.Sessions; i++)
+	{
+		threads.emplace_back([&config, &total, &failure]()
+		{
+			for (int round = 0; round < config.Rounds && OVR_SUCCESS(failure); round++)
+			{
+				int count = 0;
+				ovrResult result = RunSessionRound(config, count);
+				total += count;
+				if (OVR_FAILURE(result))
+				{
+					failure = result;
+					printf("Session round failed with %d\n", result);
+				}
+			}
+		});
+	}
+
+	for (std::thread& thread : threads)
+		thread.join();
+
+	frames = total;
+	return failure;
+}
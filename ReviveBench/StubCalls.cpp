@@ -0,0 +1,67 @@
+#include "Bench.h"
+
+#include <fstream>
+#include <sstream>
+
+// Reads "<name> <count>" lines as written by the stub runtimes on shutdown
+static bool LoadStubCalls(const char* path, std::map<std::string, uint64_t>& calls)
+{
+	std::ifstream file(path);
+	if (!file.is_open())
+		return false;
+
+	std::string name;
+	uint64_t count;
+	while (file >> name >> count)
+		calls[name] = count;
+	return true;
+}
+
+bool CheckStubCalls(const std::wstring& limits, const char* stats, long long frames)
+{
+	std::map<std::string, uint64_t> calls;
+	if (!stats || !LoadStubCalls(stats, calls))
+	{
+		printf("Unable to read the stub call counts, set the stats variable of the stub runtime\n");
+		return false;
+	}
+
+	std::ifstream file(limits);
+	if (!file.is_open())
+	{
+		printf("Unable to open %ls\n", limits.c_str());
+		return false;
+	}
+
+	bool passed = true;
+	std::string line;
+	while (std::getline(file, line))
+	{
+		size_t comment = line.find('#');
+		if (comment != std::string::npos)
+			line.erase(comment);
+
+		std::string name;
+		uint64_t max = 0, perFrame = 0;
+		std::istringstream stream(line);
+		if (!(stream >> name))
+			continue;
+		if (!(stream >> max))
+		{
+			printf("Invalid call limit: %s\n", line.c_str());
+			return false;
+		}
+		stream >> perFrame;
+
+		// Methods that were never called don't show up in the counts
+		uint64_t count = calls.count(name) ? calls[name] : 0;
+		uint64_t limit = max + perFrame * frames;
+		if (count > limit)
+		{
+			printf("%s was called %llu times, expected at most %llu + %llu per frame over %lld frames\n",
+				name.c_str(), (unsigned long long)count, (unsigned long long)max, (unsigned long long)perFrame, frames);
+			passed = false;
+		}
+	}
+	return passed;
+}
@@ -0,0 +1,537 @@
+#include "Bench.h"
+
+#include <Shlwapi.h>
+#include <dxgi.h>
+#include <math.h>
+#include <wrl/client.h>
+#include <stdio.h>
+#include <string.h>
+
+using Microsoft::WRL::ComPtr;
+
+// Expand the name first, the runtime exports some functions under their versioned name
+#define OVR_STRINGIFY(x) #x
+#define OVR_EXPORT_NAME(x) OVR_STRINGIFY(x)
+
+OVRFunctions g_ovr;
+BenchTimer g_Timer;
+
+bool OVRFunctions::Load(HMODULE module)
+{
+#define OVR_LOAD(x) x = (decltype(&x))GetProcAddress(module, OVR_EXPORT_NAME(x)); \
+	if (!x) { printf("Runtime does not export %s\n", OVR_EXPORT_NAME(x)); return false; }
+	OVR_FUNCTIONS(OVR_LOAD)
+#undef OVR_LOAD
+	return true;
+}
+
+void EndBenchFrame()
+{
+	if (g_Timer.Recording)
+	{
+		g_Timer.Frames.Add("overhead", g_Timer.Overhead);
+		g_Timer.Frames.Add("cycles", (double)g_Timer.Cycles);
+	}
+	g_Timer.Overhead = 0.0;
+	g_Timer.Cycles = 0;
+}
+
+std::string EscapeJson(const std::string& str)
+{
+	std::string escaped;
+	for (char c : str)
+	{
+		if (c == '\\' || c == '"')
+			escaped += '\\';
+		escaped += c;
+	}
+	return escaped;
+}
+
+std::string EscapeJson(const std::wstring& wstr)
+{
+	char str[MAX_PATH];
+	WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), -1, str, MAX_PATH, NULL, NULL);
+	return EscapeJson(std::string(str));
+}
+
+bool CreateDevice(const ovrGraphicsLuid& luid, bool warp, ID3D11Device** device)
+{
+	// Match the adapter the runtime asked for, stub runtimes may not report one
+	ComPtr<IDXGIAdapter1> adapter;
+	ComPtr<IDXGIFactory1> factory;
+	if (!warp && SUCCEEDED(CreateDXGIFactory1(IID_PPV_ARGS(&factory))))
+	{
+		ComPtr<IDXGIAdapter1> candidate;
+		for (UINT i = 0; factory->EnumAdapters1(i, &candidate) != DXGI_ERROR_NOT_FOUND; i++)
+		{
+			DXGI_ADAPTER_DESC1 desc;
+			if (SUCCEEDED(candidate->GetDesc1(&desc)) && memcmp(&desc.AdapterLuid, &luid, sizeof(LUID)) == 0)
+			{
+				adapter = candidate;
+				break;
+			}
+		}
+	}
+
+	if (!warp)
+	{
+		D3D_DRIVER_TYPE type = adapter ? D3D_DRIVER_TYPE_UNKNOWN : D3D_DRIVER_TYPE_HARDWARE;
+		if (SUCCEEDED(D3D11CreateDevice(adapter.Get(), type, nullptr, 0, nullptr, 0, D3D11_SDK_VERSION, device, nullptr, nullptr)))
+			return true;
+		printf("Unable to create a hardware device, falling back to WARP\n");
+	}
+
+	// WARP allows the benchmark to run on headless build machines
+	return SUCCEEDED(D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_WARP, nullptr, 0, nullptr, 0, D3D11_SDK_VERSION, device, nullptr, nullptr));
+}
+
+ovrTextureSwapChain CreateSwapChain(ovrSession session, ID3D11Device* device, ovrTextureType type, ovrTextureFormat format, int width, int height, std::vector<ovrTextureSwapChain>& chains)
+{
+	ovrTextureSwapChainDesc desc = {};
+	desc.Type = type;
+	desc.Format = format;
+	desc.ArraySize = type == ovrTexture_Cube ? 6 : 1;
+	desc.Width = width;
+	desc.Height = height;
+	desc.MipLevels = 1;
+	desc.SampleCount = 1;
+	desc.StaticImage = ovrFalse;
+	if (format == OVR_FORMAT_D32_FLOAT)
+		desc.BindFlags = ovrTextureBind_DX_DepthStencil;
+	else
+		desc.BindFlags = ovrTextureBind_DX_RenderTarget;
+
+	ovrTextureSwapChain chain = nullptr;
+	if (OVR_FAILURE(TIMED(ovr_CreateTextureSwapChainDX, session, (IUnknown*)device, &desc, &chain)))
+		return nullptr;
+	chains.push_back(chain);
+	return chain;
+}
+
+void WriteReport(FILE* file, const BenchConfig& config, ovrResult result, int frames)
+{
+	fprintf(file, "{\n");
+	fprintf(file, "\t\"runtime\": \"%s\",\n", EscapeJson(config.Runtime).c_str());
+	fprintf(file, "\t\"result\": %d,\n", result);
+	fprintf(file, "\t\"frames\": %d,\n", frames);
+	if (config.Sessions > 0)
+	{
+		fprintf(file, "\t\"sessions\": %d,\n", config.Sessions);
+		fprintf(file, "\t\"rounds\": %d,\n", config.Rounds);
+	}
+	else if (config.Replay.empty())
+	{
+		fprintf(file, "\t\"warmup\": %d,\n", config.Warmup);
+		fprintf(file, "\t\"input_polls\": %d,\n", config.InputPolls);
+		fprintf(file, "\t\"tracking_polls\": %d,\n", config.TrackingPolls);
+		fprintf(file, "\t\"property_polls\": %d,\n", config.PropertyPolls);
+		fprintf(file, "\t\"layers\": { \"eye\": %d, \"quad\": %d, \"cylinder\": %d, \"cube\": %d, \"depth\": %d },\n",
+			config.EyeLayers, config.QuadLayers, config.CylinderLayers, config.CubeLayers, config.DepthLayers);
+	}
+	else
+	{
+		fprintf(file, "\t\"replay\": \"%s\",\n", EscapeJson(config.Replay).c_str());
+		fprintf(file, "\t\"speed\": %.3f,\n", config.Speed);
+		fprintf(file, "\t\"skipped\": {");
+		size_t i = 0;
+		for (auto& it : g_Timer.Skipped)
+			fprintf(file, "%s \"%s\": %llu", i++ ? "," : "", it.first.c_str(), it.second);
+		fprintf(file, " },\n");
+
+		// Durations of the same calls in the application the capture was made from
+		fprintf(file, "\t\"captured\": {\n");
+		g_Timer.Captured.Write(file, "\t\t");
+		fprintf(file, "\t},\n");
+	}
+	fprintf(file, "\t\"budget_us\": %.3f,\n", config.Budget * 1000.0);
+	fprintf(file, "\t\"frame\": {\n");
+	g_Timer.Frames.Write(file, "\t\t");
+	fprintf(file, "\t},\n");
+	fprintf(file, "\t\"calls\": {\n");
+	g_Timer.Calls.Write(file, "\t\t");
+	fprintf(file, "\t}\n");
+	fprintf(file, "}\n");
+}
+
+ovrResult RunBench(const BenchConfig& config, int& frames)
+{
+	ovrSession session;
+	ovrGraphicsLuid luid;
+	ovrResult result = TIMED(ovr_Create, &session, &luid);
+	if (OVR_FAILURE(result))
+		return result;
+
+	ComPtr<ID3D11Device> device;
+	if (!CreateDevice(luid, config.Warp, &device))
+	{
+		printf("Unable to create a D3D11 device\n");
+		g_ovr.ovr_Destroy(session);
+		return ovrError_IncompatibleGPU;
+	}
+
+	ovrHmdDesc hmd = TIMED(ovr_GetHmdDesc, session);
+	ovrEyeRenderDesc renderDesc[ovrEye_Count];
+	ovrSizei eyeSize[ovrEye_Count];
+	for (int eye = 0; eye < ovrEye_Count; eye++)
+	{
+		renderDesc[eye] = TIMED(ovr_GetRenderDesc, session, (ovrEyeType)eye, hmd.DefaultEyeFov[eye]);
+		eyeSize[eye] = TIMED(ovr_GetFovTextureSize, session, (ovrEyeType)eye, hmd.DefaultEyeFov[eye], 1.0f);
+	}
+
+	// Both eyes share a single texture, rendered side-by-side
+	ovrRecti viewports[ovrEye_Count] = {
+		{ { 0, 0 }, eyeSize[ovrEye_Left] },
+		{ { eyeSize[ovrEye_Left].w, 0 }, eyeSize[ovrEye_Right] },
+	};
+	int eyeWidth = eyeSize[ovrEye_Left].w + eyeSize[ovrEye_Right].w;
+	int eyeHeight = eyeSize[ovrEye_Left].h > eyeSize[ovrEye_Right].h ? eyeSize[ovrEye_Left].h : eyeSize[ovrEye_Right].h;
+
+	// Matches ovrMatrix4f_Projection for a right-handed projection with a near plane of 0.1 and a far plane of 100
+	const float zNear = 0.1f, zFar = 100.0f;
+	ovrTimewarpProjectionDesc projection;
+	projection.Projection22 = zFar / (zNear - zFar);
+	projection.Projection23 = (zFar * zNear) / (zNear - zFar);
+	projection.Projection32 = -1.0f;
+
+	std::vector<ovrTextureSwapChain> chains;
+	std::vector<ovrLayer_Union> layers;
+	ovrRecti quadViewport = { { 0, 0 }, { 512, 512 } };
+	ovrPosef front = { { 0.0f, 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f } };
+	bool created = true;
+
+	for (int i = 0; i < config.EyeLayers; i++)
+	{
+		ovrLayer_Union layer = {};
+		layer.Header.Type = ovrLayerType_EyeFov;
+		layer.EyeFov.ColorTexture[ovrEye_Left] = CreateSwapChain(session, device.Get(), ovrTexture_2D, OVR_FORMAT_R8G8B8A8_UNORM_SRGB, eyeWidth, eyeHeight, chains);
+		created &= layer.EyeFov.ColorTexture[ovrEye_Left] != nullptr;
+		layers.push_back(layer);
+	}
+	for (int i = 0; i < config.DepthLayers; i++)
+	{
+		ovrLayer_Union layer = {};
+		layer.Header.Type = ovrLayerType_EyeFovDepth;
+		layer.EyeFovDepth.ColorTexture[ovrEye_Left] = CreateSwapChain(session, device.Get(), ovrTexture_2D, OVR_FORMAT_R8G8B8A8_UNORM_SRGB, eyeWidth, eyeHeight, chains);
+		layer.EyeFovDepth.DepthTexture[ovrEye_Left] = CreateSwapChain(session, device.Get(), ovrTexture_2D, OVR_FORMAT_D32_FLOAT, eyeWidth, eyeHeight, chains);
+		layer.EyeFovDepth.ProjectionDesc = projection;
+		created &= layer.EyeFovDepth.ColorTexture[ovrEye_Left] && layer.EyeFovDepth.DepthTexture[ovrEye_Left];
+		layers.push_back(layer);
+	}
+	for (int i = 0; i < config.QuadLayers; i++)
+	{
+		ovrLayer_Union layer = {};
+		layer.Header.Type = ovrLayerType_Quad;
+		layer.Quad.ColorTexture = CreateSwapChain(session, device.Get(), ovrTexture_2D, OVR_FORMAT_R8G8B8A8_UNORM_SRGB, 512, 512, chains);
+		layer.Quad.Viewport = quadViewport;
+		layer.Quad.QuadPoseCenter = front;
+		layer.Quad.QuadSize = { 1.0f, 1.0f };
+		created &= layer.Quad.ColorTexture != nullptr;
+		layers.push_back(layer);
+	}
+	for (int i = 0; i < config.CylinderLayers; i++)
+	{
+		ovrLayer_Union layer = {};
+		layer.Header.Type = ovrLayerType_Cylinder;
+		layer.Cylinder.ColorTexture = CreateSwapChain(session, device.Get(), ovrTexture_2D, OVR_FORMAT_R8G8B8A8_UNORM_SRGB, 512, 512, chains);
+		layer.Cylinder.Viewport = quadViewport;
+		layer.Cylinder.CylinderPoseCenter = front;
+		layer.Cylinder.CylinderRadius = 1.0f;
+		layer.Cylinder.CylinderAngle = 1.0f;
+		layer.Cylinder.CylinderAspectRatio = 1.0f;
+		created &= layer.Cylinder.ColorTexture != nullptr;
+		layers.push_back(layer);
+	}
+	for (int i = 0; i < config.CubeLayers; i++)
+	{
+		ovrLayer_Union layer = {};
+		layer.Header.Type = ovrLayerType_Cube;
+		layer.Cube.CubeMapTexture = CreateSwapChain(session, device.Get(), ovrTexture_Cube, OVR_FORMAT_R8G8B8A8_UNORM_SRGB, 512, 512, chains);
+		layer.Cube.Orientation = { 0.0f, 0.0f, 0.0f, 1.0f };
+		created &= layer.Cube.CubeMapTexture != nullptr;
+		layers.push_back(layer);
+	}
+
+	std::vector<const ovrLayerHeader*> layerPtrs;
+	for (const ovrLayer_Union& layer : layers)
+		layerPtrs.push_back(&layer.Header);
+
+	if (!created)
+	{
+		result = ovrError_TextureSwapChainInvalid;
+		printf("Unable to create the texture swap chains\n");
+	}
+
+	ovrViewScaleDesc viewScale = {};
+	viewScale.HmdSpaceToWorldScaleInMeters = 1.0f;
+	for (int eye = 0; eye < ovrEye_Count; eye++)
+		viewScale.HmdToEyePose[eye] = renderDesc[eye].HmdToEyePose;
+
+	LARGE_INTEGER lastBegin = {};
+	double lastSensorTime = 0.0;
+	frames = 0;
+	for (long long frameIndex = 0; OVR_SUCCESS(result) && frameIndex < config.Warmup + config.Frames; frameIndex++)
+	{
+		g_Timer.Recording = frameIndex >= config.Warmup;
+		g_Timer.Overhead = 0.0;
+		g_Timer.Cycles = 0;
+
+		ovrSessionStatus status;
+		result = TIMED(ovr_GetSessionStatus, session, &status);
+		if (OVR_FAILURE(result) || status.ShouldQuit)
+			break;
+
+		result = Timed("ovr_WaitToBeginFrame", false, g_ovr.ovr_WaitToBeginFrame, session, frameIndex);
+		if (OVR_FAILURE(result))
+			break;
+
+		result = TIMED(ovr_BeginFrame, session, frameIndex);
+		if (OVR_FAILURE(result))
+			break;
+
+		LARGE_INTEGER begin;
+		QueryPerformanceCounter(&begin);
+		if (g_Timer.Recording && lastBegin.QuadPart)
+			g_Timer.Frames.Add("interval", (begin.QuadPart - lastBegin.QuadPart) * 1000000.0 / g_Timer.Frequency);
+		lastBegin = begin;
+
+		// Poll the way an application would while simulating and rendering the frame
+		double displayTime = TIMED(ovr_GetPredictedDisplayTime, session, frameIndex);
+		ovrTrackingState tracking = {};
+		for (int i = 0; i < config.TrackingPolls; i++)
+			tracking = TIMED(ovr_GetTrackingState, session, displayTime, ovrTrue);
+		for (int i = 0; i < config.InputPolls; i++)
+		{
+			ovrInputState input;
+			TIMED(ovr_GetInputState, session, ovrControllerType_Active, &input);
+		}
+		for (int i = 0; i < config.PropertyPolls; i++)
+		{
+			ovrPerfStats perf;
+			TIMED(ovr_GetPerfStats, session, &perf);
+			TIMED(ovr_GetFloat, session, OVR_KEY_IPD, OVR_DEFAULT_IPD);
+		}
+		double sensorTime = Timed("ovr_GetTimeInSeconds", true, g_ovr.ovr_GetTimeInSeconds);
+
+		// The clock may never go backwards and should be within a frame of the display time it predicts
+		if (config.Clock > 0.0)
+		{
+			double error = fabs(sensorTime - displayTime);
+			if (sensorTime < lastSensorTime || error > 1.0 / hmd.DisplayRefreshRate + config.Clock / 1000.0)
+				g_Timer.ClockErrors++;
+			if (g_Timer.Recording)
+				g_Timer.Frames.Add("clock_error", error * 1000000.0);
+			lastSensorTime = sensorTime;
+		}
+
+		for (ovrLayer_Union& layer : layers)
+		{
+			if (layer.Header.Type == ovrLayerType_EyeFov || layer.Header.Type == ovrLayerType_EyeFovDepth)
+			{
+				for (int eye = 0; eye < ovrEye_Count; eye++)
+				{
+					layer.EyeFov.Viewport[eye] = viewports[eye];
+					layer.EyeFov.Fov[eye] = hmd.DefaultEyeFov[eye];
+					layer.EyeFov.RenderPose[eye] = tracking.HeadPose.ThePose;
+				}
+				layer.EyeFov.SensorSampleTime = sensorTime;
+			}
+		}
+
+		for (ovrTextureSwapChain chain : chains)
+			TIMED(ovr_CommitTextureSwapChain, session, chain);
+
+		result = TIMED(ovr_EndFrame, session, frameIndex, &viewScale, layerPtrs.data(), (unsigned int)layerPtrs.size());
+		if (OVR_FAILURE(result))
+			break;
+
+		if (g_Timer.Recording)
+			frames++;
+		EndBenchFrame();
+	}
+	g_Timer.Recording = false;
+
+	if (OVR_FAILURE(result))
+	{
+		ovrErrorInfo info;
+		g_ovr.ovr_GetLastErrorInfo(&info);
+		printf("Frame loop failed with %d: %s\n", result, info.ErrorString);
+	}
+
+	for (ovrTextureSwapChain chain : chains)
+		g_ovr.ovr_DestroyTextureSwapChain(session, chain);
+	device.Reset();
+	g_ovr.ovr_Destroy(session);
+	return result;
+}
+
+int wmain(int argc, wchar_t *argv[]) {
+	char moduleDir[MAX_PATH];
+	GetModuleFileNameA(NULL, moduleDir, MAX_PATH);
+	PathRemoveFileSpecA(moduleDir);
+
+	BenchConfig config;
+	bool openxr = false;
+	for (int i = 1; i < argc; i++)
+	{
+		bool hasValue = i + 1 < argc;
+		if (wcscmp(argv[i], L"/openxr") == 0)
+			openxr = true;
+		else if (wcscmp(argv[i], L"/warp") == 0)
+			config.Warp = true;
+		else if (wcscmp(argv[i], L"/runtime") == 0 && hasValue)
+		{
+			char path[MAX_PATH];
+			WideCharToMultiByte(CP_UTF8, 0, argv[++i], -1, path, MAX_PATH, NULL, NULL);
+			config.Runtime = path;
+		}
+		else if (wcscmp(argv[i], L"/output") == 0 && hasValue)
+			config.Output = argv[++i];
+		else if (wcscmp(argv[i], L"/frames") == 0 && hasValue)
+			config.Frames = _wtoi(argv[++i]);
+		else if (wcscmp(argv[i], L"/warmup") == 0 && hasValue)
+			config.Warmup = _wtoi(argv[++i]);
+		else if (wcscmp(argv[i], L"/input") == 0 && hasValue)
+			config.InputPolls = _wtoi(argv[++i]);
+		else if (wcscmp(argv[i], L"/tracking") == 0 && hasValue)
+			config.TrackingPolls = _wtoi(argv[++i]);
+		else if (wcscmp(argv[i], L"/properties") == 0 && hasValue)
+			config.PropertyPolls = _wtoi(argv[++i]);
+		else if (wcscmp(argv[i], L"/eye") == 0 && hasValue)
+			config.EyeLayers = _wtoi(argv[++i]);
+		else if (wcscmp(argv[i], L"/quad") == 0 && hasValue)
+			config.QuadLayers = _wtoi(argv[++i]);
+		else if (wcscmp(argv[i], L"/cylinder") == 0 && hasValue)
+			config.CylinderLayers = _wtoi(argv[++i]);
+		else if (wcscmp(argv[i], L"/cube") == 0 && hasValue)
+			config.CubeLayers = _wtoi(argv[++i]);
+		else if (wcscmp(argv[i], L"/depth") == 0 && hasValue)
+			config.DepthLayers = _wtoi(argv[++i]);
+		else if (wcscmp(argv[i], L"/budget") == 0 && hasValue)
+			config.Budget = _wtof(argv[++i]);
+		else if (wcscmp(argv[i], L"/replay") == 0 && hasValue)
+			config.Replay = argv[++i];
+		else if (wcscmp(argv[i], L"/speed") == 0 && hasValue)
+			config.Speed = _wtof(argv[++i]);
+		else if (wcscmp(argv[i], L"/sessions") == 0 && hasValue)
+			config.Sessions = _wtoi(argv[++i]);
+		else if (wcscmp(argv[i], L"/rounds") == 0 && hasValue)
+			config.Rounds = _wtoi(argv[++i]);
+		else if (wcscmp(argv[i], L"/calls") == 0 && hasValue)
+			config.Calls = argv[++i];
+		else if (wcscmp(argv[i], L"/clock") == 0 && hasValue)
+			config.Clock = _wtof(argv[++i]);
+		else
+		{
+			printf("usage: ReviveBench.exe [/openxr] [/runtime <dll>] [/warp] [/frames <n>] [/warmup <n>]\n"
+				"\t[/input <polls>] [/tracking <polls>] [/properties <polls>]\n"
+				"\t[/eye <n>] [/quad <n>] [/cylinder <n>] [/cube <n>] [/depth <n>]\n"
+				"\t[/replay <capture> [/speed <factor>]] [/sessions <n> [/rounds <n>]] [/budget <ms>] [/calls <limits>]\n"
+				"\t[/clock <ms>] [/output <json>]\n");
+			return -1;
+		}
+	}
+
+	int layerCount = config.EyeLayers + config.QuadLayers + config.CylinderLayers + config.CubeLayers + config.DepthLayers;
+	if (config.Frames <= 0 || config.Warmup < 0 || layerCount > ovrMaxLayerCount)
+	{
+		printf("Invalid configuration, at most %d layers can be submitted\n", ovrMaxLayerCount);
+		return -1;
+	}
+
+	// Only the OpenXR backend validates session handles, the OpenVR backend would crash on a stale one
+	if (config.Sessions > 0 && (!openxr || config.Rounds <= 0))
+	{
+		printf("Invalid configuration, /sessions requires /openxr and at least one round\n");
+		return -1;
+	}
+
+	// The call limits and clock checks are relative to the frames of the synthetic frame loop
+	if ((!config.Calls.empty() || config.Clock > 0.0) && (config.Sessions > 0 || !config.Replay.empty()))
+	{
+		printf("Invalid configuration, /calls and /clock can't be combined with /replay or /sessions\n");
+		return -1;
+	}
+
+	if (config.Runtime.empty())
+	{
+		if (openxr)
+			config.Runtime = moduleDir + std::string("\\LibReviveXR64.dll");
+		else
+			config.Runtime = moduleDir + std::string("\\LibRevive64.dll");
+	}
+
+	// The OpenVR backend expects the OpenVR API to be loaded alongside it
+	if (!openxr)
+		LoadLibraryA((moduleDir + std::string("\\openvr_api64.dll")).c_str());
+
+	HMODULE runtime = LoadLibraryExA(config.Runtime.c_str(), NULL, LOAD_WITH_ALTERED_SEARCH_PATH);
+	if (!runtime)
+	{
+		printf("Unable to load runtime %s: %lu\n", config.Runtime.c_str(), GetLastError());
+		return -1;
+	}
+
+	if (!g_ovr.Load(runtime))
+		return -1;
+
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	g_Timer.Frequency = (double)frequency.QuadPart;
+
+	ovrInitParams params = {};
+	params.Flags = ovrInit_RequestVersion;
+	params.RequestedMinorVersion = OVR_MINOR_VERSION;
+	ovrResult result = TIMED(ovr_Initialize, &params);
+	if (OVR_FAILURE(result))
+	{
+		printf("Unable to initialize the runtime: %d\n", result);
+		return -1;
+	}
+
+	int frames = 0;
+	if (config.Sessions > 0)
+		result = RunSessions(config, frames);
+	else if (config.Replay.empty())
+		result = RunBench(config, frames);
+	else
+		result = RunReplay(config, frames);
+	g_ovr.ovr_Shutdown();
+
+	FILE* file = stdout;
+	if (!config.Output.empty())
+	{
+		file = _wfopen(config.Output.c_str(), L"w");
+		if (!file)
+		{
+			printf("Unable to open %ls\n", config.Output.c_str());
+			return -1;
+		}
+	}
+	WriteReport(file, config, result, frames);
+	if (file != stdout)
+		fclose(file);
+
+	if (OVR_FAILURE(result) || (config.Replay.empty() && frames < config.Frames))
+		return -1;
+
+	// A non-zero exit code lets build scripts fail on a regression
+	BenchStats::Summary overhead = g_Timer.Frames.Summarize("overhead");
+	if (config.Budget > 0.0 && overhead.P99 > config.Budget * 1000.0)
+	{
+		printf("Frame overhead p99 of %.3fus exceeds the budget of %.3fms\n", overhead.P99, config.Budget);
+		return 1;
+	}
+
+	if (g_Timer.ClockErrors > 0)
+	{
+		printf("ovr_GetTimeInSeconds went backwards or was off by more than a frame on %d frames\n", g_Timer.ClockErrors);
+		return 1;
+	}
+
+	// The stub runtimes write their call counts when the runtime shuts them down
+	if (!config.Calls.empty() && !CheckStubCalls(config.Calls, getenv(openxr ? "REVIVE_STUB_STATS" : "REVIVE_VR_STUB_STATS"),
+		config.Warmup + config.Frames))
+		return 1;
+	return 0;
+}
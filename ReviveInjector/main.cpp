@@ -1,5 +1,7 @@
 #include <string>
 #include <codecvt>
+#include <future>
+#include <thread>
 #include <vector>
 
 #include <Windows.h>
@@ -10,12 +12,24 @@
 #include <openvr.h>
 #include <detours/detours.h>
 
+#include "../Revive/StartupTrace.h"
+
 extern FILE* g_LogFile;
 #define LOG(x, ...) if (g_LogFile) fprintf(g_LogFile, x, __VA_ARGS__); \
 					printf(x, __VA_ARGS__); \
 					fflush(g_LogFile);
 
 FILE* g_LogFile = NULL;
+LARGE_INTEGER g_Frequency, g_Start;
+
+// Logs the time since the injector was started, so slow launch phases can be identified
+void LogPhase(const char* phase)
+{
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+	LOG("[%8.2f ms] %s\n", (now.QuadPart - g_Start.QuadPart) * 1000.0 / g_Frequency.QuadPart, phase);
+	StartupTrace::Stamp(phase);
+}
 
 bool GetOculusBasePath(PWCHAR path, DWORD length)
 {
@@ -173,13 +187,92 @@ private:
 	std::vector<const char*> ptrs;
 };
 
+// Everything needed to launch an application, so the library paths don't need to be resolved on every launch.
+// The runtime DLLs aren't part of the plan, since the installed runtime can change between launches. Neither is
+// the working directory, it's derived from the command without touching the file system.
+struct LaunchPlan
+{
+	std::wstring Arguments;
+	std::wstring Root;
+	std::wstring Command;
+	std::wstring Executable;
+	ULONGLONG Modified;
+};
+
+// Reads the unresolved library or base path from the registry, this is cheap enough to validate cached plans.
+// Resolving the volume to its mount point isn't needed, the executable would be gone if the mount point changed.
+std::wstring GetLaunchRoot(const wchar_t* option, const wchar_t* guid)
+{
+	wchar_t value[MAX_PATH] = { 0 };
+	DWORD size = sizeof(value);
+	if (wcscmp(option, L"/base") == 0)
+	{
+		if (RegGetValueW(HKEY_LOCAL_MACHINE, L"Software\\Oculus VR, LLC\\Oculus", L"Base", RRF_RT_REG_SZ | RRF_SUBKEY_WOW6432KEY, NULL, value, &size) != ERROR_SUCCESS)
+			return std::wstring();
+		return value;
+	}
+
+	std::wstring keyPath = L"Software\\Oculus VR, LLC\\Oculus\\Libraries\\" + std::wstring(guid);
+	if (RegGetValueW(HKEY_CURRENT_USER, keyPath.c_str(), L"Path", RRF_RT_REG_SZ, NULL, value, &size) != ERROR_SUCCESS)
+		return std::wstring();
+	return value;
+}
+
+ULONGLONG GetLastWriteTime(const wchar_t* path)
+{
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if (!GetFileAttributesExW(path, GetFileExInfoStandard, &data))
+		return 0;
+	return ((ULONGLONG)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+}
+
+std::wstring GetProfileString(const wchar_t* cache, const wchar_t* section, const wchar_t* key)
+{
+	wchar_t value[4096] = { 0 };
+	GetPrivateProfileStringW(section, key, L"", value, 4096, cache);
+	return value;
+}
+
+bool LoadLaunchPlan(const wchar_t* cache, const std::wstring& section, const std::wstring& arguments, const std::wstring& root, LaunchPlan& plan)
+{
+	plan.Arguments = GetProfileString(cache, section.c_str(), L"Arguments");
+	if (plan.Arguments != arguments)
+		return false;
+
+	// The plan is stale if the library was moved
+	plan.Root = GetProfileString(cache, section.c_str(), L"Root");
+	if (root.empty() || plan.Root != root)
+		return false;
+
+	plan.Command = GetProfileString(cache, section.c_str(), L"Command");
+	plan.Executable = GetProfileString(cache, section.c_str(), L"Executable");
+	plan.Modified = wcstoull(GetProfileString(cache, section.c_str(), L"Modified").c_str(), nullptr, 10);
+
+	// The plan is stale if the application was updated or moved
+	return !plan.Command.empty() && plan.Modified != 0 && GetLastWriteTime(plan.Executable.c_str()) == plan.Modified;
+}
+
+void SaveLaunchPlan(const wchar_t* cache, const std::wstring& section, const LaunchPlan& plan)
+{
+	WritePrivateProfileStringW(section.c_str(), L"Arguments", plan.Arguments.c_str(), cache);
+	WritePrivateProfileStringW(section.c_str(), L"Root", plan.Root.c_str(), cache);
+	WritePrivateProfileStringW(section.c_str(), L"Command", plan.Command.c_str(), cache);
+	WritePrivateProfileStringW(section.c_str(), L"Executable", plan.Executable.c_str(), cache);
+	WritePrivateProfileStringW(section.c_str(), L"Modified", std::to_wstring(plan.Modified).c_str(), cache);
+}
+
 int wmain(int argc, wchar_t *argv[]) {
+	QueryPerformanceFrequency(&g_Frequency);
+	QueryPerformanceCounter(&g_Start);
+	StartupTrace::BeginLaunch();
+
 	if (argc < 2) {
 		printf("usage: ReviveInjector.exe <executable path>\n");
 		return -1;
 	}
 
 	WCHAR LogPath[MAX_PATH];
+	WCHAR CachePath[MAX_PATH] = { 0 };
 	if (SUCCEEDED(SHGetFolderPath(NULL, CSIDL_LOCAL_APPDATA, NULL, 0, LogPath)))
 	{
 		wcsncat(LogPath, L"\\Revive", MAX_PATH);
@@ -188,17 +281,46 @@ int wmain(int argc, wchar_t *argv[]) {
 		if (!exists)
 			exists = CreateDirectory(LogPath, NULL);
 
+		if (exists)
+		{
+			wcsncpy(CachePath, LogPath, MAX_PATH);
+			wcsncat(CachePath, L"\\LaunchCache.ini", MAX_PATH);
+		}
+
 		wcsncat(LogPath, L"\\ReviveInjector.txt", MAX_PATH);
 		if (exists)
 			g_LogFile = _wfopen(LogPath, L"w");
 	}
 
 	LOG("Launched injector with: %ls\n", GetCommandLine());
+	LogPhase("Started");
 
 	char moduleDir[MAX_PATH];
 	GetModuleFileNameA(NULL, moduleDir, MAX_PATH);
 	PathRemoveFileSpecA(moduleDir);
 
+	// Look for a cached plan for this application and library, it only takes a single registry read to validate
+	std::wstring cacheSection, arguments, root;
+	for (int i = 1; i < argc; i++)
+	{
+		if ((wcscmp(argv[i], L"/app") == 0 || wcscmp(argv[i], L"/library") == 0) && i + 1 < argc)
+			cacheSection += argv[i + 1] + std::wstring(L"@");
+		if (CachePath[0] && (wcscmp(argv[i], L"/base") == 0 || (wcscmp(argv[i], L"/library") == 0 && i + 1 < argc)))
+			root = GetLaunchRoot(argv[i], argv[i + 1]);
+
+		// No trailing separator, the profile functions would strip it from the cached arguments
+		if (!arguments.empty())
+			arguments += L" ";
+		arguments += argv[i];
+	}
+
+	LaunchPlan plan;
+	bool cached = CachePath[0] && !cacheSection.empty() && LoadLaunchPlan(CachePath, cacheSection, arguments, root, plan);
+
+	// Identifying the application is slow, so OpenVR is initialized while the process is being created
+	std::promise<DWORD> processId;
+	std::thread identify;
+
 	bool debug = false;
 	StringArray dlls;
 	std::string appKey;
@@ -219,12 +341,16 @@ int wmain(int argc, wchar_t *argv[]) {
 		}
 		else if (wcscmp(argv[i], L"/base") == 0)
 		{
-			if (!GetOculusBasePath(path, MAX_PATH))
+			if (!cached && !GetOculusBasePath(path, MAX_PATH))
 				return -1;
 		}
 		else if (wcscmp(argv[i], L"/library") == 0)
 		{
-			if (!GetLibraryPath(path, MAX_PATH, argv[++i]))
+			i++;
+			if (cached)
+				continue;
+
+			if (!GetLibraryPath(path, MAX_PATH, argv[i]))
 			{
 				if (!GetDefaultLibraryPath(path, MAX_PATH))
 				{
@@ -237,7 +363,7 @@ int wmain(int argc, wchar_t *argv[]) {
 		{
 			debug = true;
 		}
-		else
+		else if (!cached)
 		{
 			// Concatenate all other arguments
 			wcsncat(path, argv[i], MAX_PATH);
@@ -245,6 +371,41 @@ int wmain(int argc, wchar_t *argv[]) {
 		}
 	}
 
+	if (!appKey.empty())
+	{
+		identify = std::thread([&appKey](std::future<DWORD> pid)
+		{
+			vr::EVRInitError err;
+			vr::VR_Init(&err, vr::VRApplication_Utility);
+			DWORD id = pid.get();
+			if (err == vr::VRInitError_None)
+			{
+				if (id && vr::VRApplications()->IdentifyApplication(id, appKey.c_str()) == vr::VRApplicationError_None)
+					LOG("Identified application as: %s\n", appKey.c_str());
+				vr::VR_Shutdown();
+			}
+			LogPhase("Identified");
+		}, processId.get_future());
+	}
+
+	// Make sure the identification thread is finished before returning
+	struct IdentifyGuard
+	{
+		std::promise<DWORD>& ProcessId;
+		std::thread& Thread;
+		bool Set;
+		~IdentifyGuard()
+		{
+			if (!Set)
+				ProcessId.set_value(0);
+			if (Thread.joinable())
+				Thread.join();
+		}
+	} guard = { processId, identify, false };
+
+	if (cached)
+		wcsncpy(path, plan.Command.c_str(), MAX_PATH);
+
 	if (dlls.empty())
 	{
 		if (vr::VR_IsRuntimeInstalled())
@@ -259,6 +420,7 @@ int wmain(int argc, wchar_t *argv[]) {
 	}
 	
 	LOG("Command for injector is: %ls\n", path);
+	LogPhase(cached ? "Resolved from cache" : "Resolved");
 
 	STARTUPINFO si;
 	PROCESS_INFORMATION pi;
@@ -270,7 +432,7 @@ int wmain(int argc, wchar_t *argv[]) {
 	wcsncpy(workingDir, path, MAX_PATH);
 
 	// Remove extension
-	wchar_t* ext = wcsstr(workingDir, L".exe");
+	wchar_t* ext = StrStrIW(workingDir, L".exe");
 	if (ext)
 		*ext = L'\0';
 
@@ -287,6 +449,8 @@ int wmain(int argc, wchar_t *argv[]) {
 		LOG("Failed to create process\n");
 		return -1;
 	}
+	StartupTrace::SetProcessId(pi.dwProcessId);
+	LogPhase("Created process");
 
 	if (debug)
 	{
@@ -304,17 +468,29 @@ int wmain(int argc, wchar_t *argv[]) {
 	}
 
 	LOG("Succesfully injected!\n");
+	LogPhase("Resumed process");
 
-	if (!appKey.empty())
+	// Hand the process to the identification thread, it can finish while the plan is saved
+	processId.set_value(pi.dwProcessId);
+	guard.Set = true;
+	CloseHandle(pi.hThread);
+	CloseHandle(pi.hProcess);
+
+	// Only plans for executables can be validated, so don't cache anything else
+	wchar_t* exe = StrStrIW(path, L".exe");
+	if (!cached && CachePath[0] && !cacheSection.empty() && !root.empty() && exe)
 	{
-		vr::EVRInitError err;
-		vr::VR_Init(&err, vr::VRApplication_Utility);
-		if (err == vr::VRInitError_None)
-		{
-			if (vr::VRApplications()->IdentifyApplication(pi.dwProcessId, appKey.c_str()) == vr::VRApplicationError_None)
-				LOG("Identified application as: %s\n", appKey.c_str());
-			vr::VR_Shutdown();
-		}
+		plan.Arguments = arguments;
+		plan.Root = root;
+		plan.Command = path;
+		plan.Executable = std::wstring(path, exe + 4);
+		plan.Modified = GetLastWriteTime(plan.Executable.c_str());
+		if (plan.Modified)
+			SaveLaunchPlan(CachePath, cacheSection, plan);
 	}
+
+	if (identify.joinable())
+		identify.join();
+	LogPhase("Finished");
 	return 0;
 }
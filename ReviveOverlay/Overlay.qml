@@ -49,32 +49,21 @@ Rectangle {
         font.pixelSize: 56
     }
 
-    ListModel {
-        id: coverModel
-
-        ListElement {
-            coverURL: "SupportAssets/oculus-worlds/cover_square_image.jpg"
-            libraryId: "0"
-            appKey: "oculus-worlds"
-            appId: "1112064135564993"
-        }
-        ListElement {
-            coverURL: "SupportAssets/oculus-dreamdeck-nux/cover_square_image.jpg"
-            libraryId: "0"
-            appKey: "oculus-dreamdeck-nux"
-            appId: "919445174798085"
-        }
-        ListElement {
-            coverURL: "SupportAssets/oculus-touch-tutorial/cover_square_image.jpg"
-            libraryId: "0"
-            appKey: "oculus-touch-tutorial"
-            appId: "1184903171584429"
+    Connections {
+        target: Revive
+        onLaunchFailed: {
+            // Launches are asynchronous, so failures are only known once the injector exits
+            failSound.play();
+            heartbeat.stop();
         }
-        ListElement {
-            coverURL: "SupportAssets/oculus-first-contact/cover_square_image.jpg"
-            libraryId: "0"
-            appKey: "oculus-first-contact"
-            appId: "1217155751659625"
+    }
+
+    Connections {
+        target: Scanner
+        onApplicationFound: {
+            // Add the application to the Revive manifest if it isn't registered yet or was updated
+            if (app.updated || !Revive.isApplicationInstalled(app.canonicalName))
+                Oculus.generateManifest(app, app.library);
         }
     }
 
@@ -116,6 +105,8 @@ Rectangle {
                 id: coverImage
                 anchors.fill: parent
                 fillMode: Image.Pad
+                asynchronous: true
+                sourceSize: Qt.size(coverGrid.cellWidth, coverGrid.cellHeight)
                 source: coverURL
                 MouseArea {
                     id: coverArea
@@ -175,7 +166,7 @@ Rectangle {
         cellHeight: 384
         cellWidth: 384
         anchors.fill: parent
-        model: coverModel
+        model: Scanner
         delegate: coverDelegate
         highlight: coverHighlight
         highlightFollowsCurrentItem: false
@@ -243,7 +234,7 @@ Rectangle {
 
         onButtonAChanged: {
             if (buttonA && OpenVR.gamepadFocus && coverGrid.currentIndex != -1) {
-                var cover = coverModel.get(coverGrid.currentIndex);
+                var cover = Scanner.get(coverGrid.currentIndex);
                 activateSound.play();
                 Revive.launchApplication(cover.appKey);
             }
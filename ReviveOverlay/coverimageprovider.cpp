@@ -0,0 +1,84 @@
+#include "coverimageprovider.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QSaveFile>
+
+CCoverImageResponse::CCoverImageResponse(const QString &sourcePath, const QString &cachePath, const QSize &size)
+	: m_strSourcePath(sourcePath)
+	, m_strCachePath(cachePath)
+	, m_size(size)
+{
+	// The response is deleted by the QML engine
+	setAutoDelete(false);
+}
+
+QQuickTextureFactory *CCoverImageResponse::textureFactory() const
+{
+	return QQuickTextureFactory::textureFactoryForImage(m_image);
+}
+
+QString CCoverImageResponse::errorString() const
+{
+	return m_strError;
+}
+
+void CCoverImageResponse::run()
+{
+	QFileInfo source(m_strSourcePath);
+	QFileInfo cache(m_strCachePath);
+
+	// Use the cached thumbnail unless the cover was updated since it was created
+	if (cache.exists() && (!source.exists() || cache.lastModified() >= source.lastModified()))
+	{
+		if (m_image.load(m_strCachePath))
+		{
+			emit finished();
+			return;
+		}
+	}
+
+	QImageReader reader(m_strSourcePath);
+	QSize size = reader.size();
+	if (size.isValid() && (size.width() > m_size.width() || size.height() > m_size.height()))
+	{
+		// Let the decoder downscale the image, this avoids decoding the full size image for JPEGs
+		size.scale(m_size, Qt::KeepAspectRatio);
+		reader.setScaledSize(size);
+	}
+
+	if (!reader.read(&m_image))
+	{
+		m_strError = reader.errorString();
+		emit finished();
+		return;
+	}
+
+	QSaveFile file(m_strCachePath);
+	if (!file.open(QIODevice::WriteOnly) || !m_image.save(&file, "JPG", 90) || !file.commit())
+		qWarning("Couldn't write cover thumbnail: %s", qUtf8Printable(m_strCachePath));
+
+	emit finished();
+}
+
+CCoverImageProvider::CCoverImageProvider(const QString &basePath, const QString &cachePath)
+	: m_strBasePath(basePath)
+	, m_strCachePath(cachePath)
+{
+	QDir().mkpath(m_strCachePath);
+
+	// Don't let the covers compete with the library scanner for the global thread pool
+	m_pool.setMaxThreadCount(2);
+}
+
+QQuickImageResponse *CCoverImageProvider::requestImageResponse(const QString &id, const QSize &requestedSize)
+{
+	QSize size = requestedSize.isValid() ? requestedSize : QSize(COVER_SIZE, COVER_SIZE);
+	QString source = m_strBasePath + "CoreData/Software/StoreAssets/" + id + "_assets/cover_square_image.jpg";
+	QString cache = m_strCachePath + QString("%1-%2x%3.jpg").arg(id).arg(size.width()).arg(size.height());
+
+	CCoverImageResponse *response = new CCoverImageResponse(source, cache, size);
+	m_pool.start(response);
+	return response;
+}
@@ -0,0 +1,44 @@
+#ifndef COVERIMAGEPROVIDER_H
+#define COVERIMAGEPROVIDER_H
+
+#include <QImage>
+#include <QQuickAsyncImageProvider>
+#include <QRunnable>
+#include <QThreadPool>
+
+// Size of the cover tiles in the library grid
+#define COVER_SIZE 384
+
+// Decodes a cover on the thread pool, downscaling it to the tile size and caching the result on disk
+class CCoverImageResponse : public QQuickImageResponse, public QRunnable
+{
+public:
+	CCoverImageResponse(const QString &sourcePath, const QString &cachePath, const QSize &size);
+
+	virtual QQuickTextureFactory *textureFactory() const;
+	virtual QString errorString() const;
+	virtual void run();
+
+private:
+	QString m_strSourcePath;
+	QString m_strCachePath;
+	QSize m_size;
+	QImage m_image;
+	QString m_strError;
+};
+
+// Provides the covers of the Oculus library as image://cover/<canonicalName>
+class CCoverImageProvider : public QQuickAsyncImageProvider
+{
+public:
+	CCoverImageProvider(const QString &basePath, const QString &cachePath);
+
+	virtual QQuickImageResponse *requestImageResponse(const QString &id, const QSize &requestedSize);
+
+private:
+	QString m_strBasePath;
+	QString m_strCachePath;
+	QThreadPool m_pool;
+};
+
+#endif // COVERIMAGEPROVIDER_H
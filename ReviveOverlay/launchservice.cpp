@@ -0,0 +1,102 @@
+#include "launchservice.h"
+
+// Time in milliseconds after which a launcher that's still running is no longer tracked
+#define LAUNCH_TIMEOUT 30000
+
+CLaunchService::CLaunchService(QObject *parent)
+	: BaseClass(parent)
+	, m_iTimeout(LAUNCH_TIMEOUT)
+{
+}
+
+CLaunchService::~CLaunchService()
+{
+	// Don't leave any launchers behind
+	for (const LaunchState& launch : m_launches)
+	{
+		launch.Process->disconnect(this);
+		launch.Process->kill();
+		launch.Process->waitForFinished(1000);
+	}
+}
+
+bool CLaunchService::Launch(const QString &key, const QString &program, const QString &args)
+{
+	if (m_launches.contains(key))
+	{
+		qDebug("Already launching: %s", qUtf8Printable(key));
+		return false;
+	}
+
+	LaunchState launch;
+	launch.Process = new QProcess(this);
+	launch.Timer = new QTimer(this);
+	m_launches[key] = launch;
+
+	connect(launch.Process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this,
+		[this, key](int exitCode, QProcess::ExitStatus exitStatus) { OnFinished(key, exitCode, exitStatus); });
+	connect(launch.Process, &QProcess::errorOccurred, this, [this, key](QProcess::ProcessError error) { OnError(key, error); });
+
+	launch.Timer->setSingleShot(true);
+	connect(launch.Timer, &QTimer::timeout, this, [this, key]() { OnTimeout(key); });
+	launch.Timer->start(m_iTimeout);
+
+	qDebug("Launching: %s %s", qUtf8Printable(program), qUtf8Printable(args));
+	launch.Process->setProgram(program);
+#ifdef Q_OS_WIN
+	launch.Process->setNativeArguments(args);
+#else
+	launch.Process->setArguments(QProcess::splitCommand(args));
+#endif
+	emit LaunchStarted(key);
+	launch.Process->start();
+	return true;
+}
+
+void CLaunchService::OnFinished(const QString &key, int exitCode, QProcess::ExitStatus exitStatus)
+{
+	if (!m_launches.contains(key))
+		return;
+
+	if (exitStatus != QProcess::NormalExit)
+		emit LaunchFailed(key, "Crashed");
+	else if (exitCode != 0)
+		emit LaunchFailed(key, QString("Exited with code %1").arg(exitCode));
+	else
+		emit LaunchFinished(key);
+	Finish(key);
+}
+
+void CLaunchService::OnError(const QString &key, QProcess::ProcessError error)
+{
+	// Other errors are followed by the finished signal
+	if (error != QProcess::FailedToStart || !m_launches.contains(key))
+		return;
+
+	emit LaunchFailed(key, m_launches[key].Process->errorString());
+	Finish(key);
+}
+
+void CLaunchService::OnTimeout(const QString &key)
+{
+	if (!m_launches.contains(key))
+		return;
+
+	// The injector may legitimately keep running, e.g. while it waits for the application, so don't
+	// kill it. Let it run on its own and allow the application to be launched again.
+	qWarning("Launcher still running, no longer tracking it: %s", qUtf8Printable(key));
+	LaunchState launch = m_launches.take(key);
+	launch.Timer->deleteLater();
+	launch.Process->disconnect(this);
+	launch.Process->setParent(Q_NULLPTR);
+	connect(launch.Process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+		launch.Process, &QObject::deleteLater);
+	emit LaunchFinished(key);
+}
+
+void CLaunchService::Finish(const QString &key)
+{
+	LaunchState launch = m_launches.take(key);
+	launch.Timer->deleteLater();
+	launch.Process->deleteLater();
+}
@@ -0,0 +1,47 @@
+#ifndef LAUNCHSERVICE_H
+#define LAUNCHSERVICE_H
+
+#include <QMap>
+#include <QObject>
+#include <QProcess>
+#include <QTimer>
+
+// Runs launcher processes without blocking the GUI thread, at most one per key
+class CLaunchService : public QObject
+{
+	Q_OBJECT
+	typedef QObject BaseClass;
+
+public:
+	CLaunchService(QObject *parent = Q_NULLPTR);
+	virtual ~CLaunchService();
+
+	// Returns false if the key is already being launched
+	bool Launch(const QString &key, const QString &program, const QString &args);
+	bool IsLaunching(const QString &key) const { return m_launches.contains(key); }
+
+	// Launchers that are still running after the timeout are reported as finished and left running
+	void SetTimeout(int msec) { m_iTimeout = msec; }
+
+signals:
+	void LaunchStarted(const QString &key);
+	void LaunchFinished(const QString &key);
+	void LaunchFailed(const QString &key, const QString &error);
+
+private:
+	struct LaunchState
+	{
+		QProcess *Process;
+		QTimer *Timer;
+	};
+
+	void OnFinished(const QString &key, int exitCode, QProcess::ExitStatus exitStatus);
+	void OnError(const QString &key, QProcess::ProcessError error);
+	void OnTimeout(const QString &key);
+	void Finish(const QString &key);
+
+	QMap<QString, LaunchState> m_launches;
+	int m_iTimeout;
+};
+
+#endif // LAUNCHSERVICE_H
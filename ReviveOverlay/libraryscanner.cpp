@@ -0,0 +1,521 @@
+#include "libraryscanner.h"
+#include "revivemanifestcontroller.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QUrl>
+#include <QtConcurrent>
+
+// Increment when the fields of LibraryEntry change to discard old indices
+#define LIBRARY_INDEX_VERSION 1
+
+// Page used to look up the title of an application by its id
+#define DEFAULT_TITLE_URL "https://www.oculus.com/experiences/rift/"
+
+// Time in milliseconds a library needs to be unchanged before it's scanned again
+#define LIBRARY_CHANGE_DELAY 1000
+
+CLibraryScanner *s_pSharedLibraryScanner = NULL;
+
+CLibraryScanner *CLibraryScanner::SharedInstance()
+{
+	if (!s_pSharedLibraryScanner)
+	{
+		s_pSharedLibraryScanner = new CLibraryScanner();
+	}
+	return s_pSharedLibraryScanner;
+}
+
+static LibraryEntry ParseManifest(const QFileInfo& info)
+{
+	LibraryEntry entry = {};
+	entry.Path = info.absoluteFilePath();
+	entry.Modified = info.lastModified().toMSecsSinceEpoch();
+	entry.Size = info.size();
+
+	QFile file(entry.Path);
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		// Make sure the manifest is parsed again on the next scan
+		qWarning("Couldn't open manifest: %s", qUtf8Printable(entry.Path));
+		entry.Modified = -1;
+		return entry;
+	}
+
+	QJsonObject manifest = QJsonDocument::fromJson(file.readAll()).object();
+	entry.IsApp = manifest["packageType"].toString() == "APP" && !manifest["isCore"].toBool() && !manifest["thirdParty"].toBool();
+	if (!entry.IsApp)
+		return entry;
+
+	entry.CanonicalName = manifest["canonicalName"].toString();
+	entry.AppId = manifest["appId"].toVariant().toString();
+	entry.LaunchParameters = manifest["launchParameters"].toString();
+
+	// Find the true executable for Unreal Engine games
+	static const QRegularExpression shipping("-Shipping.exe$", QRegularExpression::CaseInsensitiveOption);
+	static const QRegularExpression binaries(R"(Binaries(\\|\/)Win64(\\|\/)(.*)\.exe)", QRegularExpression::CaseInsensitiveOption);
+	QString launch = manifest["launchFile"].toString();
+	QJsonObject files = manifest["files"].toObject();
+	for (auto it = files.begin(); it != files.end(); ++it)
+	{
+		// Check if the executable is in the binaries folder
+		if (binaries.match(it.key()).hasMatch())
+		{
+			launch = it.key();
+
+			// If we found the shipping executable we can immediately stop looking
+			if (shipping.match(it.key()).hasMatch())
+				break;
+		}
+	}
+
+	// Replace the forward slashes with backslashes as used by Windows
+	entry.LaunchFile = launch.replace('/', '\\');
+	return entry;
+}
+
+// Runs on the thread pool, the index is a snapshot so it can be read without locking
+struct ManifestLoader
+{
+	typedef LibraryEntry result_type;
+
+	QHash<QString, LibraryEntry> Index;
+
+	LibraryEntry operator()(const QString& path) const
+	{
+		QFileInfo info(path);
+		auto it = Index.find(path);
+		if (it != Index.end() && it->Modified == info.lastModified().toMSecsSinceEpoch() && it->Size == info.size())
+			return *it;
+		return ParseManifest(info);
+	}
+};
+
+CLibraryScanner::CLibraryScanner()
+	: BaseClass()
+	, m_bIndexChanged(false)
+	, m_strTitleURL(DEFAULT_TITLE_URL)
+{
+	// Allows the titles to be looked up on a local server
+	QByteArray titleURL = qgetenv("REVIVE_TITLE_URL");
+	if (!titleURL.isEmpty())
+		m_strTitleURL = QString::fromUtf8(titleURL);
+
+	m_changeTimer.setSingleShot(true);
+	m_changeTimer.setInterval(LIBRARY_CHANGE_DELAY);
+	connect(&m_changeTimer, &QTimer::timeout, this, &CLibraryScanner::OnLibrariesChanged);
+	connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, &CLibraryScanner::OnDirectoryChanged);
+
+	// The support applications are always available
+	AddCover({ "SupportAssets/oculus-worlds/cover_square_image.jpg", "0", "oculus-worlds", "1112064135564993" });
+	AddCover({ "SupportAssets/oculus-dreamdeck-nux/cover_square_image.jpg", "0", "oculus-dreamdeck-nux", "919445174798085" });
+	AddCover({ "SupportAssets/oculus-touch-tutorial/cover_square_image.jpg", "0", "oculus-touch-tutorial", "1184903171584429" });
+	AddCover({ "SupportAssets/oculus-first-contact/cover_square_image.jpg", "0", "oculus-first-contact", "1217155751659625" });
+}
+
+CLibraryScanner::~CLibraryScanner()
+{
+}
+
+bool CLibraryScanner::Init()
+{
+	QString path = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/Revive/";
+	if (!QDir().mkpath(path))
+		return false;
+
+	m_strIndexPath = path + "LibraryIndex.json";
+	m_strTitlesPath = path + "Titles.json";
+	m_strCoverPath = path + "Covers/";
+	LoadTitles();
+	return LoadIndex();
+}
+
+int CLibraryScanner::rowCount(const QModelIndex &parent) const
+{
+	return parent.isValid() ? 0 : m_covers.size();
+}
+
+QVariant CLibraryScanner::data(const QModelIndex &index, int role) const
+{
+	if (!index.isValid() || index.row() >= m_covers.size())
+		return QVariant();
+
+	const Cover& cover = m_covers[index.row()];
+	switch (role)
+	{
+	case CoverRole_URL: return cover.URL;
+	case CoverRole_LibraryId: return cover.LibraryId;
+	case CoverRole_AppKey: return cover.AppKey;
+	case CoverRole_AppId: return cover.AppId;
+	}
+	return QVariant();
+}
+
+QHash<int, QByteArray> CLibraryScanner::roleNames() const
+{
+	QHash<int, QByteArray> roles;
+	roles[CoverRole_URL] = "coverURL";
+	roles[CoverRole_LibraryId] = "libraryId";
+	roles[CoverRole_AppKey] = "appKey";
+	roles[CoverRole_AppId] = "appId";
+	return roles;
+}
+
+QVariantMap CLibraryScanner::get(int row) const
+{
+	QVariantMap map;
+	if (row < 0 || row >= m_covers.size())
+		return map;
+
+	const Cover& cover = m_covers[row];
+	map["coverURL"] = cover.URL;
+	map["libraryId"] = cover.LibraryId;
+	map["appKey"] = cover.AppKey;
+	map["appId"] = cover.AppId;
+	return map;
+}
+
+void CLibraryScanner::scanLibrary(const QString &library, const QString &libraryURL)
+{
+	Scan& scan = m_scans[library];
+	QString libraryPath = QUrl(libraryURL).toLocalFile();
+	scan.LibraryURL = libraryURL;
+	scan.ManifestPath = libraryPath + "Manifests/";
+	int generation = ++scan.Generation;
+	qDebug("Scanning library: %s", qUtf8Printable(scan.ManifestPath));
+
+	WatchLibrary(library, libraryPath);
+
+	// List the manifests on the thread pool as well, the library may be on a slow drive
+	QString path = scan.ManifestPath;
+	QFutureWatcher<QStringList>* watcher = new QFutureWatcher<QStringList>(this);
+	connect(watcher, &QFutureWatcher<QStringList>::finished, this, [this, watcher, library, generation]()
+	{
+		ParseManifests(library, generation, watcher->result());
+		watcher->deleteLater();
+	});
+	watcher->setFuture(QtConcurrent::run([path]()
+	{
+		QStringList files;
+		for (const QFileInfo& info : QDir(path).entryInfoList(QStringList("*.json"), QDir::Files))
+			files << info.absoluteFilePath();
+		return files;
+	}));
+}
+
+void CLibraryScanner::WatchLibrary(const QString &library, const QString &path)
+{
+	// Directories that are removed are no longer watched, so add them again on every scan
+	QStringList watched = m_watcher.directories();
+	for (QString dir : { path, path + "Manifests", path + "Software" })
+	{
+		dir = QDir::cleanPath(dir);
+		if (watched.contains(dir) || !QFileInfo::exists(dir))
+			continue;
+
+		if (m_watcher.addPath(dir))
+			m_watchedPaths[dir] = library;
+		else
+			qWarning("Couldn't watch library directory: %s", qUtf8Printable(dir));
+	}
+}
+
+void CLibraryScanner::OnDirectoryChanged(const QString &path)
+{
+	if (!m_watchedPaths.contains(path))
+		return;
+
+	// Restart the timer so bursts of changes only result in a single scan
+	m_changedLibraries.insert(m_watchedPaths[path]);
+	m_changeTimer.start();
+}
+
+void CLibraryScanner::OnLibrariesChanged()
+{
+	for (const QString& library : m_changedLibraries)
+		scanLibrary(library, m_scans[library].LibraryURL);
+	m_changedLibraries.clear();
+}
+
+void CLibraryScanner::ParseManifests(const QString &library, int generation, const QStringList &files)
+{
+	// A newer scan of the same library has already been started
+	Scan& scan = m_scans[library];
+	if (scan.Generation != generation)
+		return;
+
+	scan.Files = QSet<QString>(files.begin(), files.end());
+	scan.Apps.clear();
+
+	// Results are added to the model as soon as they're ready
+	QFutureWatcher<LibraryEntry>* watcher = new QFutureWatcher<LibraryEntry>(this);
+	connect(watcher, &QFutureWatcher<LibraryEntry>::resultsReadyAt, this, [this, watcher, library, generation](int begin, int end)
+	{
+		if (m_scans[library].Generation != generation)
+			return;
+		for (int i = begin; i < end; i++)
+			AddEntry(library, watcher->resultAt(i));
+	});
+	connect(watcher, &QFutureWatcher<LibraryEntry>::finished, this, [this, watcher, library, generation]()
+	{
+		if (m_scans[library].Generation == generation)
+			FinishScan(library);
+		watcher->deleteLater();
+	});
+	watcher->setFuture(QtConcurrent::mapped(files, ManifestLoader{ m_index }));
+}
+
+void CLibraryScanner::AddEntry(const QString &library, const LibraryEntry &entry)
+{
+	auto it = m_index.find(entry.Path);
+	bool changed = it == m_index.end() || it->Modified != entry.Modified || it->Size != entry.Size;
+	if (changed)
+	{
+		m_index[entry.Path] = entry;
+		m_bIndexChanged = true;
+	}
+
+	if (!entry.IsApp || entry.CanonicalName.isEmpty())
+		return;
+
+	Scan& scan = m_scans[library];
+	scan.Apps.insert(entry.CanonicalName);
+
+	// Keep the existing covers so a rescan doesn't reset the grid
+	bool added = FindCover(library, entry.CanonicalName) < 0;
+	if (added)
+	{
+		// Covers are downscaled and cached by the cover image provider
+		AddCover({ "image://cover/" + entry.CanonicalName, library, entry.CanonicalName, entry.AppId });
+	}
+
+	// After the first scan only report applications that were installed or updated
+	if (scan.Initialized && !added && !changed)
+		return;
+
+	qDebug("Found application: %s", qUtf8Printable(entry.CanonicalName));
+
+	QVariantMap app;
+	app["canonicalName"] = entry.CanonicalName;
+	app["appId"] = entry.AppId;
+	app["launchFile"] = entry.LaunchFile;
+	app["launchParameters"] = entry.LaunchParameters;
+	app["library"] = library;
+	app["updated"] = scan.Initialized && !added;
+	emit ApplicationFound(app);
+}
+
+void CLibraryScanner::FinishScan(const QString &library)
+{
+	Scan& scan = m_scans[library];
+
+	// Remove the covers of applications that are no longer in the library
+	for (int i = m_covers.size() - 1; i >= 0; i--)
+	{
+		if (m_covers[i].LibraryId == library && !scan.Apps.contains(m_covers[i].AppKey))
+		{
+			QString appKey = m_covers[i].AppKey;
+			beginRemoveRows(QModelIndex(), i, i);
+			m_covers.remove(i);
+			endRemoveRows();
+
+			// The application may have been moved to another library
+			qDebug("Application removed: %s", qUtf8Printable(appKey));
+			if (!hasManifest(appKey))
+				CReviveManifestController::SharedInstance()->removeManifest(appKey);
+		}
+	}
+	scan.Initialized = true;
+
+	// Forget manifests that were deleted
+	for (auto it = m_index.begin(); it != m_index.end();)
+	{
+		if (it.key().startsWith(scan.ManifestPath) && !scan.Files.contains(it.key()))
+		{
+			it = m_index.erase(it);
+			m_bIndexChanged = true;
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	qDebug("Finished scanning library: %s (%d applications)", qUtf8Printable(scan.ManifestPath), scan.Apps.size());
+	if (m_bIndexChanged)
+		SaveIndex();
+	PruneCovers();
+	emit ScanFinished(library);
+}
+
+int CLibraryScanner::FindCover(const QString &library, const QString &appKey) const
+{
+	for (int i = 0; i < m_covers.size(); i++)
+	{
+		if (m_covers[i].LibraryId == library && m_covers[i].AppKey == appKey)
+			return i;
+	}
+	return -1;
+}
+
+void CLibraryScanner::AddCover(const Cover &cover)
+{
+	beginInsertRows(QModelIndex(), m_covers.size(), m_covers.size());
+	m_covers.append(cover);
+	endInsertRows();
+}
+
+void CLibraryScanner::PruneCovers()
+{
+	if (m_strCoverPath.isEmpty())
+		return;
+
+	// All libraries are scanned on startup, so wait until they've all finished before deciding which
+	// applications are gone
+	QSet<QString> apps;
+	for (const Scan& scan : m_scans)
+	{
+		if (!scan.Initialized)
+			return;
+		apps.unite(scan.Apps);
+	}
+
+	// Thumbnails are named <canonicalName>-<width>x<height>.jpg
+	static const QRegularExpression thumbnail(R"(^(.*)-\d+x\d+\.jpg$)");
+	for (const QString& file : QDir(m_strCoverPath).entryList(QStringList("*.jpg"), QDir::Files))
+	{
+		QRegularExpressionMatch match = thumbnail.match(file);
+		if (!match.hasMatch() || apps.contains(match.captured(1)))
+			continue;
+
+		qDebug("Removing cover thumbnail: %s", qUtf8Printable(file));
+		if (!QFile::remove(m_strCoverPath + file))
+			qWarning("Couldn't remove cover thumbnail: %s", qUtf8Printable(file));
+	}
+}
+
+bool CLibraryScanner::hasManifest(const QString &canonicalName) const
+{
+	// Only check for the smaller mini file since we only want to verify whether it exists
+	for (const QString& url : CReviveManifestController::SharedInstance()->GetLibrariesURL())
+	{
+		if (QFileInfo::exists(QUrl(url).toLocalFile() + "Manifests/" + canonicalName + ".json.mini"))
+			return true;
+	}
+	return false;
+}
+
+bool CLibraryScanner::LoadIndex()
+{
+	QFile file(m_strIndexPath);
+	if (!file.open(QIODevice::ReadOnly))
+		return true;
+
+	QJsonObject index = QJsonDocument::fromJson(file.readAll()).object();
+	if (index["version"].toInt() != LIBRARY_INDEX_VERSION)
+		return true;
+
+	QJsonObject entries = index["entries"].toObject();
+	for (auto it = entries.begin(); it != entries.end(); ++it)
+	{
+		QJsonObject obj = it.value().toObject();
+		LibraryEntry entry = {};
+		entry.Path = it.key();
+		entry.Modified = (qint64)obj["modified"].toDouble();
+		entry.Size = (qint64)obj["size"].toDouble();
+		entry.IsApp = obj["app"].toBool();
+		entry.CanonicalName = obj["canonicalName"].toString();
+		entry.AppId = obj["appId"].toString();
+		entry.LaunchFile = obj["launchFile"].toString();
+		entry.LaunchParameters = obj["launchParameters"].toString();
+		m_index[entry.Path] = entry;
+	}
+
+	qDebug("Loaded library index: %d manifests", m_index.size());
+	return true;
+}
+
+bool CLibraryScanner::SaveIndex()
+{
+	QJsonObject entries;
+	for (const LibraryEntry& entry : m_index)
+	{
+		QJsonObject obj;
+		obj["modified"] = (double)entry.Modified;
+		obj["size"] = (double)entry.Size;
+		obj["app"] = entry.IsApp;
+		if (entry.IsApp)
+		{
+			obj["canonicalName"] = entry.CanonicalName;
+			obj["appId"] = entry.AppId;
+			obj["launchFile"] = entry.LaunchFile;
+			obj["launchParameters"] = entry.LaunchParameters;
+		}
+		entries[entry.Path] = obj;
+	}
+
+	QJsonObject index;
+	index["version"] = LIBRARY_INDEX_VERSION;
+	index["entries"] = entries;
+
+	QSaveFile file(m_strIndexPath);
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		qWarning("Couldn't open library index for writing");
+		return false;
+	}
+	file.write(QJsonDocument(index).toJson(QJsonDocument::Compact));
+	if (!file.commit())
+		return false;
+
+	m_bIndexChanged = false;
+	return true;
+}
+
+QString CLibraryScanner::getTitle(const QString &canonicalName) const
+{
+	return m_titles.value(canonicalName);
+}
+
+void CLibraryScanner::setTitle(const QString &canonicalName, const QString &title)
+{
+	if (m_titles.value(canonicalName) == title)
+		return;
+
+	m_titles[canonicalName] = title;
+	SaveTitles();
+}
+
+bool CLibraryScanner::LoadTitles()
+{
+	QFile file(m_strTitlesPath);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	QJsonObject titles = QJsonDocument::fromJson(file.readAll()).object();
+	for (auto it = titles.begin(); it != titles.end(); ++it)
+		m_titles[it.key()] = it.value().toString();
+	return true;
+}
+
+bool CLibraryScanner::SaveTitles()
+{
+	QJsonObject titles;
+	for (auto it = m_titles.begin(); it != m_titles.end(); ++it)
+		titles[it.key()] = it.value();
+
+	QSaveFile file(m_strTitlesPath);
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		qWarning("Couldn't open title cache for writing");
+		return false;
+	}
+	file.write(QJsonDocument(titles).toJson());
+	return file.commit();
+}
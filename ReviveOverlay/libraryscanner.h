@@ -0,0 +1,128 @@
+#ifndef LIBRARYSCANNER_H
+#define LIBRARYSCANNER_H
+
+#include <QAbstractListModel>
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+#include <QVariantMap>
+#include <QVector>
+
+// Result of parsing an Oculus manifest, only the fields needed to generate the Revive manifest are kept
+struct LibraryEntry
+{
+	QString Path;
+	qint64 Modified;
+	qint64 Size;
+	bool IsApp;
+	QString CanonicalName;
+	QString AppId;
+	QString LaunchFile;
+	QString LaunchParameters;
+};
+
+class CLibraryScanner : public QAbstractListModel
+{
+	Q_OBJECT
+	typedef QAbstractListModel BaseClass;
+
+	Q_PROPERTY(QString TitleURL READ GetTitleURL CONSTANT)
+
+public:
+	static CLibraryScanner *SharedInstance();
+
+	enum ECoverRole
+	{
+		CoverRole_URL = Qt::UserRole + 1,
+		CoverRole_LibraryId,
+		CoverRole_AppKey,
+		CoverRole_AppId,
+	};
+
+public:
+	CLibraryScanner();
+	virtual ~CLibraryScanner();
+
+	bool Init();
+	QString GetTitleURL() { return m_strTitleURL; }
+	QString GetCoverPath() { return m_strCoverPath; }
+
+	virtual int rowCount(const QModelIndex &parent = QModelIndex()) const;
+	virtual QVariant data(const QModelIndex &index, int role) const;
+	virtual QHash<int, QByteArray> roleNames() const;
+
+	Q_INVOKABLE QVariantMap get(int row) const;
+	Q_INVOKABLE void scanLibrary(const QString &library, const QString &libraryURL);
+	Q_INVOKABLE bool hasManifest(const QString &canonicalName) const;
+	Q_INVOKABLE QString getTitle(const QString &canonicalName) const;
+	Q_INVOKABLE void setTitle(const QString &canonicalName, const QString &title);
+
+signals:
+	void ApplicationFound(const QVariantMap &app);
+	void ScanFinished(const QString &library);
+
+protected slots:
+	void OnDirectoryChanged(const QString &path);
+	void OnLibrariesChanged();
+
+private:
+	struct Cover
+	{
+		QString URL;
+		QString LibraryId;
+		QString AppKey;
+		QString AppId;
+	};
+
+	struct Scan
+	{
+		QString LibraryURL;
+		QString ManifestPath;
+		int Generation;
+
+		// Once the first scan finished only the changes are reported
+		bool Initialized;
+		QSet<QString> Files;
+		QSet<QString> Apps;
+	};
+
+	void WatchLibrary(const QString &library, const QString &path);
+	void ParseManifests(const QString &library, int generation, const QStringList &files);
+	void AddEntry(const QString &library, const LibraryEntry &entry);
+	void FinishScan(const QString &library);
+	int FindCover(const QString &library, const QString &appKey) const;
+	void AddCover(const Cover &cover);
+	void PruneCovers();
+
+	bool LoadIndex();
+	bool SaveIndex();
+	bool LoadTitles();
+	bool SaveTitles();
+
+	QVector<Cover> m_covers;
+	QHash<QString, Scan> m_scans;
+
+	// Changes are collected until the library has been quiet for a while, e.g. during an update
+	QFileSystemWatcher m_watcher;
+	QHash<QString, QString> m_watchedPaths;
+	QSet<QString> m_changedLibraries;
+	QTimer m_changeTimer;
+
+	// Parsed manifests keyed by path, only reparsed when their modification time or size changes
+	QHash<QString, LibraryEntry> m_index;
+	QString m_strIndexPath;
+	bool m_bIndexChanged;
+
+	// Titles scraped from the store, so they only need to be requested once
+	QHash<QString, QString> m_titles;
+	QString m_strTitlesPath;
+	QString m_strTitleURL;
+
+	// Thumbnails written by the cover image provider, pruned once every library has been scanned
+	QString m_strCoverPath;
+};
+
+#endif // LIBRARYSCANNER_H
@@ -3,6 +3,8 @@
 #include "revivemanifestcontroller.h"
 #include "windowsservices.h"
 #include "oculusoauthtokencontroller.h"
+#include "libraryscanner.h"
+#include "coverimageprovider.h"
 #include <qt_windows.h>
 
 #include <QApplication>
@@ -83,11 +85,17 @@ int main(int argc, char *argv[])
 	if (!COculusOauthTokenController::SharedInstance()->Init())
 		qDebug("Failed to initialize the Oculus OAuth token");
 
+	if (!CLibraryScanner::SharedInstance()->Init())
+		qDebug("Failed to initialize the library scanner");
+
 	// Create a QML engine.
 	QQmlEngine qmlEngine;
+	qmlEngine.addImageProvider("cover", new CCoverImageProvider(CReviveManifestController::SharedInstance()->GetBasePath(),
+		CLibraryScanner::SharedInstance()->GetCoverPath()));
 	qmlEngine.rootContext()->setContextProperty("Revive", CReviveManifestController::SharedInstance());
 	qmlEngine.rootContext()->setContextProperty("OpenVR", COpenVROverlayController::SharedInstance());
 	qmlEngine.rootContext()->setContextProperty("Platform", COculusOauthTokenController::SharedInstance());
+	qmlEngine.rootContext()->setContextProperty("Scanner", CLibraryScanner::SharedInstance());
 
 	QQmlComponent qmlComponent( &qmlEngine, QUrl("qrc:/Overlay.qml"));
 	if (qmlComponent.isError())
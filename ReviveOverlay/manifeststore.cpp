@@ -0,0 +1,127 @@
+#include "manifeststore.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+
+CManifestStore::CManifestStore(const QString &path, IManifestRegistrar *registrar, QObject *parent)
+	: BaseClass(parent)
+	, m_strPath(path)
+	, m_pRegistrar(registrar)
+	, m_bForceRegister(false)
+{
+	m_saveTimer.setSingleShot(true);
+	m_saveTimer.setInterval(MANIFEST_SAVE_DELAY);
+	connect(&m_saveTimer, &QTimer::timeout, this, &CManifestStore::Flush);
+}
+
+CManifestStore::~CManifestStore()
+{
+}
+
+bool CManifestStore::Load()
+{
+	QFile file(m_strPath);
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		qWarning("Couldn't open manifest file for reading");
+		return false;
+	}
+
+	QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+	m_manifest = doc.object();
+
+	// Index the applications by key, this also drops any duplicate entries
+	m_applications.clear();
+	for (QJsonValue app : m_manifest["applications"].toArray())
+	{
+		QJsonObject obj = app.toObject();
+		m_applications[obj["app_key"].toString()] = obj;
+	}
+
+	return true;
+}
+
+bool CManifestStore::Save()
+{
+	m_saveTimer.stop();
+	m_pendingKeys.clear();
+
+	QJsonArray apps;
+	for (const QJsonObject& obj : m_applications)
+		apps.append(obj);
+	m_manifest["applications"] = apps;
+
+	// Skip the write and the OpenVR round trip if OpenVR already has the same manifest
+	QByteArray json = QJsonDocument(m_manifest).toJson();
+	QByteArray hash = QCryptographicHash::hash(json, QCryptographicHash::Sha1);
+	if (hash == m_registeredHash && !m_bForceRegister)
+		return true;
+
+	// Write to a temporary file first so the manifest is replaced atomically
+	QSaveFile file(m_strPath);
+	if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size() || !file.commit())
+	{
+		qWarning("Couldn't write manifest file");
+		return false;
+	}
+
+	m_bForceRegister = false;
+	if (m_pRegistrar->AddApplicationManifest(m_strPath))
+		m_registeredHash = hash;
+	else
+		m_registeredHash.clear();
+
+	return true;
+}
+
+void CManifestStore::Flush()
+{
+	if (!m_pendingKeys.isEmpty())
+		Save();
+}
+
+bool CManifestStore::Register()
+{
+	if (!m_pRegistrar->AddApplicationManifest(m_strPath))
+		return false;
+
+	m_registeredHash = QCryptographicHash::hash(QJsonDocument(m_manifest).toJson(), QCryptographicHash::Sha1);
+	return true;
+}
+
+void CManifestStore::Add(const QString &appKey, const QJsonObject &app)
+{
+	// Re-adding an unchanged application means OpenVR lost it, so register the manifest again
+	if (!m_pendingKeys.contains(appKey) && m_applications.value(appKey) == app)
+		m_bForceRegister = true;
+
+	m_applications[appKey] = app;
+	ScheduleSave(appKey);
+}
+
+void CManifestStore::Remove(const QString &appKey)
+{
+	m_applications.remove(appKey);
+	ScheduleSave(appKey);
+}
+
+bool CManifestStore::IsInstalled(const QString &appKey)
+{
+	// OpenVR doesn't know about changes that haven't been saved yet
+	if (!m_pendingKeys.contains(appKey))
+		return m_pRegistrar->IsApplicationInstalled(appKey);
+
+	return m_applications.contains(appKey);
+}
+
+void CManifestStore::ScheduleSave(const QString &appKey)
+{
+	m_pendingKeys.insert(appKey);
+
+	// Don't restart an active timer, a long library scan should still be saved periodically
+	if (!m_saveTimer.isActive())
+		m_saveTimer.start();
+}
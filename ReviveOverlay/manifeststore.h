@@ -0,0 +1,66 @@
+#ifndef MANIFESTSTORE_H
+#define MANIFESTSTORE_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QMap>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+
+// Time in milliseconds during which manifest changes are collected before they're written
+#define MANIFEST_SAVE_DELAY 500
+
+// Receives the manifest once it has been written, implemented on top of IVRApplications
+class IManifestRegistrar
+{
+public:
+	virtual ~IManifestRegistrar() { }
+
+	virtual bool AddApplicationManifest(const QString &path) = 0;
+	virtual bool IsApplicationInstalled(const QString &appKey) = 0;
+};
+
+// Keeps the applications of the Revive manifest in memory, changes are batched and written once
+// the save timer expires. The manifest is only registered again when its contents changed.
+class CManifestStore : public QObject
+{
+	Q_OBJECT
+	typedef QObject BaseClass;
+
+public:
+	CManifestStore(const QString &path, IManifestRegistrar *registrar, QObject *parent = Q_NULLPTR);
+	virtual ~CManifestStore();
+
+	bool Load();
+	bool Save();
+	// Writes the pending changes immediately
+	void Flush();
+	// Registers the manifest as it is on disk
+	bool Register();
+
+	void Add(const QString &appKey, const QJsonObject &app);
+	void Remove(const QString &appKey);
+	bool IsInstalled(const QString &appKey);
+
+	bool HasApplication(const QString &appKey) const { return m_applications.contains(appKey); }
+	QJsonObject GetApplication(const QString &appKey) const { return m_applications.value(appKey); }
+	QString GetPath() const { return m_strPath; }
+	void SetSaveDelay(int msec) { m_saveTimer.setInterval(msec); }
+
+private:
+	void ScheduleSave(const QString &appKey);
+
+	QString m_strPath;
+	IManifestRegistrar *m_pRegistrar;
+	QJsonObject m_manifest;
+	QMap<QString, QJsonObject> m_applications;
+
+	QTimer m_saveTimer;
+	QSet<QString> m_pendingKeys;
+	QByteArray m_registeredHash;
+	bool m_bForceRegister;
+};
+
+#endif // MANIFESTSTORE_H
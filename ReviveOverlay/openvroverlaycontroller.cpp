@@ -4,6 +4,8 @@
 #include "openvroverlaycontroller.h"
 #include "trayiconcontroller.h"
 #include "qquickwindowscaled.h"
+#include "overlaypresenter.h"
+#include "overlayrenderer.h"
 
 #include <QOpenGLFramebufferObjectFormat>
 #include <QOpenGLFunctions>
@@ -41,8 +43,11 @@ COpenVROverlayController::COpenVROverlayController()
 	, m_pOpenGLContext( NULL )
 	, m_pRenderControl( NULL )
 	, m_pOffscreenSurface ( NULL )
-	, m_pFbo( NULL )
+	, m_pThumbnailTexture( NULL )
 	, m_pWindow( NULL )
+	, m_pRenderThread( NULL )
+	, m_pRenderer( NULL )
+	, m_pPresenter( NULL )
 	, m_pPumpEventsTimer( NULL )
 	, m_lastMouseButtons( 0 )
 	, m_ulOverlayHandle( vr::k_ulOverlayHandleInvalid )
@@ -138,15 +143,14 @@ bool COpenVROverlayController::Init()
 	QImage image(":/revive_overlay.png");
 	m_pThumbnailTexture = new QOpenGLTexture(image);
 
-	// When Quick says there is a need to render, we will not render immediately. Instead,
-	// a timer with a small interval is used to get better performance.
-	m_pUpdateTimer = new QTimer( this );
-	m_pUpdateTimer->setSingleShot( true );
-	m_pUpdateTimer->setInterval( 5 );
-	connect( m_pUpdateTimer, &QTimer::timeout, this, &COpenVROverlayController::OnSceneChanged );
+	// The presenter decides when the scene is rendered, the window is mirrored even without OpenVR
+	m_pPresenter = new COverlayPresenter( this );
+	connect( m_pPresenter, &COverlayPresenter::RenderRequested, this, &COpenVROverlayController::OnSceneChanged );
+	connect( m_pPresenter, &COverlayPresenter::VisibilityChanged, this, &COpenVROverlayController::UpdatePumpInterval );
 
-	connect( m_pRenderControl, &QQuickRenderControl::renderRequested, this, &COpenVROverlayController::OnRequestUpdate);
-	connect( m_pRenderControl, &QQuickRenderControl::sceneChanged, this, &COpenVROverlayController::OnRequestUpdate);
+	connect( m_pRenderControl, &QQuickRenderControl::renderRequested, m_pPresenter, &COverlayPresenter::RequestUpdate );
+	connect( m_pRenderControl, &QQuickRenderControl::sceneChanged, m_pPresenter, &COverlayPresenter::RequestUpdate );
+	connect( m_pWindow, &QWindow::visibleChanged, m_pPresenter, &COverlayPresenter::SetWindowVisible );
 
 	// Loading the OpenVR Runtime
 	bSuccess = ConnectToVRRuntime();
@@ -181,7 +185,7 @@ bool COpenVROverlayController::Init()
 
 		m_pPumpEventsTimer = new QTimer( this );
 		connect(m_pPumpEventsTimer, SIGNAL( timeout() ), this, SLOT( OnTimeoutPumpEvents() ) );
-		m_pPumpEventsTimer->setInterval( 20 );
+		m_pPresenter->SetOverlay( vr::VROverlay(), m_ulOverlayHandle, m_ulOverlayThumbnailHandle );
 		m_pPumpEventsTimer->start();
 	}
 	else
@@ -197,13 +201,28 @@ bool COpenVROverlayController::Init()
 //-----------------------------------------------------------------------------
 void COpenVROverlayController::Shutdown()
 {
+	if( m_pRenderThread )
+	{
+		// The render thread quits once it released its resources
+		QMetaObject::invokeMethod( m_pRenderer, "Cleanup", Qt::BlockingQueuedConnection );
+		m_pRenderThread->wait();
+		delete m_pRenderer;
+		delete m_pRenderThread;
+		m_pRenderer = NULL;
+		m_pRenderThread = NULL;
+	}
+
+	if( m_pPresenter )
+		m_pPresenter->SetOverlay( NULL, vr::k_ulOverlayHandleInvalid, vr::k_ulOverlayHandleInvalid );
 	DisconnectFromVRRuntime();
 
 	delete m_pWindow;
 	delete m_pRenderControl;
-	delete m_pFbo;
 	delete m_pOffscreenSurface;
+
+	// The renderer destroys the thumbnail with the context current, otherwise it's still current on this thread
 	delete m_pThumbnailTexture;
+	m_pThumbnailTexture = NULL;
 
 	if( m_pOpenGLContext )
 	{
@@ -219,50 +238,32 @@ void COpenVROverlayController::Shutdown()
 //-----------------------------------------------------------------------------
 void COpenVROverlayController::OnSceneChanged()
 {
-	// skip rendering if the overlay and window aren't visible
-	const bool overlayVisible = vr::VROverlay() && (vr::VROverlay()->IsOverlayVisible(m_ulOverlayHandle) || vr::VROverlay()->IsOverlayVisible(m_ulOverlayThumbnailHandle));
-	if(!overlayVisible && !m_pWindow->isVisible())
+	if( !m_pRenderer )
 		return;
 
-	if (!m_pOpenGLContext->makeCurrent(m_pOffscreenSurface))
-		return;
-
-	// Polish, synchronize and render the next frame (into our fbo).  In this example
-	// everything happens on the same thread and therefore all three steps are performed
-	// in succession from here. In a threaded setup the render() call would happen on a
-	// separate thread.
+	// Polish on the GUI thread, then let the render thread synchronize and render the frame
 	m_pRenderControl->polishItems();
-	m_pRenderControl->sync();
-	m_pRenderControl->render();
-
-	m_pWindow->resetOpenGLState();
-	QOpenGLFramebufferObject::bindDefault();
-
-	m_pOpenGLContext->functions()->glFlush();
-	uintptr_t unTexture = m_pFbo->texture();
-	if( vr::VROverlay() && unTexture != 0 )
-	{
-		vr::Texture_t texture = {(void*)unTexture, vr::TextureType_OpenGL, vr::ColorSpace_Auto };
-		vr::VROverlay()->SetOverlayTexture( m_ulOverlayHandle, &texture );
-	}
+	m_pRenderer->RequestRender( m_pWindow->isVisible() );
+}
 
-	if (!m_pOpenGLContext->makeCurrent(m_pWindow))
-		return;
 
-	QRect target(QPoint(), m_pWindow->size());
-	QRect source(QPoint(), m_pWindow->renderTargetSize());
-	QOpenGLFramebufferObject::blitFramebuffer(nullptr, target, m_pFbo, source, GL_COLOR_BUFFER_BIT, GL_LINEAR);
-	m_pOpenGLContext->swapBuffers(m_pWindow);
+//-----------------------------------------------------------------------------
+// Purpose:
+//-----------------------------------------------------------------------------
+bool COpenVROverlayController::GetGamepadFocus()
+{
+	return m_bGamepadFocus && m_pPresenter->IsDashboardVisible();
 }
 
 
 //-----------------------------------------------------------------------------
-// Purpose:
+// Purpose: OpenVR has no way to wait for events, so only poll them at a high
+//			rate while the user can interact with the dashboard
 //-----------------------------------------------------------------------------
-void COpenVROverlayController::OnRequestUpdate()
+void COpenVROverlayController::UpdatePumpInterval()
 {
-	if (!m_pUpdateTimer->isActive())
-		m_pUpdateTimer->start();
+	if( m_pPumpEventsTimer )
+		m_pPumpEventsTimer->setInterval( m_pPresenter->IsOverlayVisible() ? 20 : 100 );
 }
 
 
@@ -275,7 +276,8 @@ void COpenVROverlayController::OnTimeoutPumpEvents()
 		return;
 
 	vr::VREvent_t vrEvent;
-	while( vr::VROverlay()->PollNextOverlayEvent( m_ulOverlayHandle, &vrEvent, sizeof( vrEvent )  ) )
+	// The presenter handles the visibility events before they're returned
+	while( m_pPresenter->PollNextOverlayEvent( m_ulOverlayHandle, &vrEvent ) )
 	{
 		switch( vrEvent.eventType )
 		{
@@ -295,7 +297,7 @@ void COpenVROverlayController::OnTimeoutPumpEvents()
 				m_ptLastMouse = ptNewMouse;
 
 				QCoreApplication::sendEvent( m_pWindow, &mouseEvent );
-				OnRequestUpdate();
+				m_pPresenter->RequestUpdate();
 			}
 			break;
 
@@ -357,12 +359,6 @@ void COpenVROverlayController::OnTimeoutPumpEvents()
 			}
 			break;
 
-		case vr::VREvent_OverlayShown:
-			{
-				m_pWindow->update();
-			}
-			break;
-
 		case vr::VREvent_OverlayHidden:
 			{
 				m_lastMouseButtons = 0;
@@ -408,16 +404,9 @@ void COpenVROverlayController::OnTimeoutPumpEvents()
 
 	if( m_ulOverlayThumbnailHandle != vr::k_ulOverlayHandleInvalid )
 	{
-		while( vr::VROverlay()->PollNextOverlayEvent( m_ulOverlayThumbnailHandle, &vrEvent, sizeof( vrEvent)  ) )
+		// Only the visibility of the thumbnail matters, which the presenter keeps track of
+		while( m_pPresenter->PollNextOverlayEvent( m_ulOverlayThumbnailHandle, &vrEvent ) )
 		{
-			switch( vrEvent.eventType )
-			{
-			case vr::VREvent_OverlayShown:
-				{
-					m_pWindow->update();
-				}
-				break;
-			}
 		}
 	}
 
@@ -429,16 +418,10 @@ void COpenVROverlayController::OnTimeoutPumpEvents()
 //-----------------------------------------------------------------------------
 void COpenVROverlayController::SetQuickItem( QQuickItem *pItem )
 {
-	m_pFbo = new QOpenGLFramebufferObject( pItem->width(), pItem->height(),  QOpenGLFramebufferObject::CombinedDepthStencil );
-	m_pWindow->setRenderTarget(m_pFbo);
-
 	// The root item is ready. Associate it with the window.
 	pItem->setParentItem(m_pWindow->contentItem());
 
-	// Initialize the render control and our OpenGL resources.
-	m_pOpenGLContext->makeCurrent(m_pOffscreenSurface);
-	m_pRenderControl->initialize(m_pOpenGLContext);
-
+	// Set up the overlay before the render thread starts submitting frames to it
 	if( vr::VROverlay() )
 	{
 		vr::HmdVector2_t vecWindowSize =
@@ -449,6 +432,19 @@ void COpenVROverlayController::SetQuickItem( QQuickItem *pItem )
 		vr::VROverlay()->SetOverlayMouseScale( m_ulOverlayHandle, &vecWindowSize );
 	}
 
+	// Hand the context over to the render thread, which initializes the render control and our OpenGL resources.
+	m_pOpenGLContext->doneCurrent();
+	m_pRenderThread = new QThread();
+	m_pRenderer = new COverlayRenderer( m_pOpenGLContext, m_pOffscreenSurface, m_pRenderControl, m_pWindow, m_pThumbnailTexture );
+	m_pThumbnailTexture = NULL;
+	m_pRenderer->moveToThread( m_pRenderThread );
+	// The texture has to be submitted while the context is current, the presenter serializes it with the GUI thread
+	connect( m_pRenderer, &COverlayRenderer::FrameRendered, m_pPresenter, &COverlayPresenter::SubmitFrame, Qt::DirectConnection );
+	m_pOpenGLContext->moveToThread( m_pRenderThread );
+	m_pRenderControl->prepareThread( m_pRenderThread );
+	m_pRenderThread->start();
+	QMetaObject::invokeMethod( m_pRenderer, "Initialize", Qt::BlockingQueuedConnection, Q_ARG( QSize, QSize( pItem->width(), pItem->height() ) ) );
+
 	if (!QCoreApplication::arguments().contains("-compositor"))
 		m_pWindow->show();
 }
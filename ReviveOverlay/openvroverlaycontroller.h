@@ -23,6 +23,9 @@
 #include <QQuickItem>
 #include <QOpenGLTexture>
 
+class COverlayPresenter;
+class COverlayRenderer;
+
 class COpenVROverlayController : public QObject
 {
 	Q_OBJECT
@@ -48,7 +51,7 @@ public:
 	QString GetVRDriverString();
 	QString GetVRDisplayString();
 	QString GetName() { return m_strName; }
-	bool GetGamepadFocus() { return m_bGamepadFocus && vr::VROverlay()->IsDashboardVisible(); }
+	bool GetGamepadFocus();
 	bool GetLoading() { return m_bLoading; }
 	void SetLoading(bool loading) { m_bLoading = loading; emit LoadingChanged(); }
 	QString GetRuntimeURL() { return m_strRuntimeURL; }
@@ -59,7 +62,6 @@ public:
 public slots:
 	void OnSceneChanged();
 	void OnTimeoutPumpEvents();
-	void OnRequestUpdate();
 
 protected:
 
@@ -71,6 +73,7 @@ private:
 	bool ConnectToVRRuntime();
 	void DisconnectFromVRRuntime();
 	void UpdateThumbnail();
+	void UpdatePumpInterval();
 
 	QString m_strVRDriver;
 	QString m_strVRDisplay;
@@ -87,16 +90,19 @@ private:
 
 	QOpenGLContext *m_pOpenGLContext;
 	QQuickRenderControl *m_pRenderControl;
-	QOpenGLFramebufferObject *m_pFbo;
 	QOffscreenSurface *m_pOffscreenSurface;
 	QOpenGLTexture *m_pThumbnailTexture;
 
 	QTimer *m_pPumpEventsTimer;
-	QTimer *m_pUpdateTimer;
 
 	// the window we're drawing into the texture
 	QQuickWindow *m_pWindow;
 
+	// the scene is rendered on a separate thread, but only while the presenter says it's visible somewhere
+	QThread *m_pRenderThread;
+	COverlayRenderer *m_pRenderer;
+	COverlayPresenter *m_pPresenter;
+
 	QPointF m_ptLastMouse;
 	Qt::MouseButtons m_lastMouseButtons;
 	bool m_bGamepadFocus;
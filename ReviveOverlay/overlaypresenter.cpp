@@ -0,0 +1,114 @@
+#include "overlaypresenter.h"
+
+COverlayPresenter::COverlayPresenter(QObject *parent)
+	: BaseClass(parent)
+	, m_pOverlay(NULL)
+	, m_ulOverlayHandle(vr::k_ulOverlayHandleInvalid)
+	, m_ulThumbnailHandle(vr::k_ulOverlayHandleInvalid)
+	, m_bOverlayVisible(false)
+	, m_bThumbnailVisible(false)
+	, m_bWindowVisible(false)
+	, m_bPendingUpdate(false)
+{
+	// When Quick says there is a need to render, we will not render immediately. Instead,
+	// a timer with a small interval is used to get better performance.
+	m_updateTimer.setSingleShot(true);
+	m_updateTimer.setInterval(OVERLAY_UPDATE_DELAY);
+	connect(&m_updateTimer, &QTimer::timeout, this, &COverlayPresenter::OnUpdateTimer);
+}
+
+COverlayPresenter::~COverlayPresenter()
+{
+}
+
+void COverlayPresenter::SetOverlay(vr::IVROverlay *pOverlay, vr::VROverlayHandle_t ulOverlayHandle, vr::VROverlayHandle_t ulThumbnailHandle)
+{
+	{
+		QMutexLocker lock(&m_mutex);
+		m_pOverlay = pOverlay;
+		m_ulOverlayHandle = ulOverlayHandle;
+		m_ulThumbnailHandle = ulThumbnailHandle;
+		m_bOverlayVisible = pOverlay && pOverlay->IsOverlayVisible(ulOverlayHandle);
+		m_bThumbnailVisible = pOverlay && ulThumbnailHandle != vr::k_ulOverlayHandleInvalid && pOverlay->IsOverlayVisible(ulThumbnailHandle);
+	}
+
+	emit VisibilityChanged();
+	if (m_bPendingUpdate)
+		RequestUpdate();
+}
+
+bool COverlayPresenter::IsDashboardVisible()
+{
+	QMutexLocker lock(&m_mutex);
+	return m_pOverlay && m_pOverlay->IsDashboardVisible();
+}
+
+bool COverlayPresenter::PollNextOverlayEvent(vr::VROverlayHandle_t ulOverlayHandle, vr::VREvent_t *pEvent)
+{
+	{
+		// Don't hold the lock while the event is handled, that may wait for the render thread
+		QMutexLocker lock(&m_mutex);
+		if (!m_pOverlay || !m_pOverlay->PollNextOverlayEvent(ulOverlayHandle, pEvent, sizeof(vr::VREvent_t)))
+			return false;
+	}
+
+	bool *pVisible = NULL;
+	if (ulOverlayHandle == m_ulOverlayHandle)
+		pVisible = &m_bOverlayVisible;
+	else if (ulOverlayHandle == m_ulThumbnailHandle)
+		pVisible = &m_bThumbnailVisible;
+
+	if (pVisible && (pEvent->eventType == vr::VREvent_OverlayShown || pEvent->eventType == vr::VREvent_OverlayHidden))
+	{
+		*pVisible = pEvent->eventType == vr::VREvent_OverlayShown;
+		emit VisibilityChanged();
+
+		// The overlay may still show an old frame, so render a new one whenever it's shown
+		if (*pVisible)
+			RequestUpdate();
+	}
+	return true;
+}
+
+void COverlayPresenter::RequestUpdate()
+{
+	// Don't start the timer while hidden, otherwise animations keep waking up the GUI thread
+	if (!IsVisible())
+	{
+		m_bPendingUpdate = true;
+		return;
+	}
+
+	if (!m_updateTimer.isActive())
+		m_updateTimer.start();
+}
+
+void COverlayPresenter::SetWindowVisible(bool bVisible)
+{
+	m_bWindowVisible = bVisible;
+	if (bVisible && m_bPendingUpdate)
+		RequestUpdate();
+}
+
+void COverlayPresenter::SubmitFrame(uint unTexture)
+{
+	QMutexLocker lock(&m_mutex);
+	if (m_pOverlay)
+	{
+		vr::Texture_t texture = { (void*)(uintptr_t)unTexture, vr::TextureType_OpenGL, vr::ColorSpace_Auto };
+		m_pOverlay->SetOverlayTexture(m_ulOverlayHandle, &texture);
+	}
+}
+
+void COverlayPresenter::OnUpdateTimer()
+{
+	// The overlay may have been hidden while the timer was running, the scene is rendered once it's shown
+	if (!IsVisible())
+	{
+		m_bPendingUpdate = true;
+		return;
+	}
+
+	m_bPendingUpdate = false;
+	emit RenderRequested();
+}
@@ -0,0 +1,67 @@
+#ifndef OVERLAYPRESENTER_H
+#define OVERLAYPRESENTER_H
+
+#include <openvr.h>
+
+#include <QMutex>
+#include <QObject>
+#include <QTimer>
+
+// Time in milliseconds during which scene changes are collected before a frame is rendered
+#define OVERLAY_UPDATE_DELAY 5
+
+// Decides when the dashboard scene is rendered and presents the frames to the dashboard overlay. Frames are
+// only rendered while the overlay, its thumbnail or the desktop window is visible, changes made while they're
+// all hidden are rendered once one of them is shown.
+//
+// The frames are submitted on the render thread while the GUI thread polls the overlay events, IVROverlay
+// isn't thread-safe so every call to it goes through the presenter and is serialized.
+class COverlayPresenter : public QObject
+{
+	Q_OBJECT
+	typedef QObject BaseClass;
+
+public:
+	COverlayPresenter(QObject *parent = Q_NULLPTR);
+	virtual ~COverlayPresenter();
+
+	// Starts presenting to the overlay, its thumbnail is only used for its visibility
+	void SetOverlay(vr::IVROverlay *pOverlay, vr::VROverlayHandle_t ulOverlayHandle, vr::VROverlayHandle_t ulThumbnailHandle);
+
+	bool IsVisible() const { return IsOverlayVisible() || m_bWindowVisible; }
+	bool IsOverlayVisible() const { return m_bOverlayVisible || m_bThumbnailVisible; }
+	bool IsDashboardVisible();
+
+	// Returns the next event of the overlay or its thumbnail, the visibility is updated before it's returned
+	bool PollNextOverlayEvent(vr::VROverlayHandle_t ulOverlayHandle, vr::VREvent_t *pEvent);
+
+public slots:
+	void RequestUpdate();
+	void SetWindowVisible(bool bVisible);
+
+	// Called on the render thread while the context is current
+	void SubmitFrame(uint unTexture);
+
+signals:
+	// The scene should be rendered now
+	void RenderRequested();
+	// The overlay or its thumbnail was shown or hidden
+	void VisibilityChanged();
+
+private slots:
+	void OnUpdateTimer();
+
+private:
+	QMutex m_mutex;
+	vr::IVROverlay *m_pOverlay;
+	vr::VROverlayHandle_t m_ulOverlayHandle;
+	vr::VROverlayHandle_t m_ulThumbnailHandle;
+
+	QTimer m_updateTimer;
+	bool m_bOverlayVisible;
+	bool m_bThumbnailVisible;
+	bool m_bWindowVisible;
+	bool m_bPendingUpdate;
+};
+
+#endif // OVERLAYPRESENTER_H
@@ -0,0 +1,94 @@
+#include "overlayrenderer.h"
+
+#include <QCoreApplication>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLFunctions>
+#include <QOpenGLTexture>
+#include <QQuickRenderControl>
+#include <QQuickWindow>
+#include <QThread>
+
+COverlayRenderer::COverlayRenderer(QOpenGLContext *pContext, QOffscreenSurface *pSurface, QQuickRenderControl *pRenderControl,
+	QQuickWindow *pWindow, QOpenGLTexture *pThumbnailTexture)
+	: BaseClass()
+	, m_pOpenGLContext(pContext)
+	, m_pOffscreenSurface(pSurface)
+	, m_pRenderControl(pRenderControl)
+	, m_pWindow(pWindow)
+	, m_pFbo(NULL)
+	, m_pThumbnailTexture(pThumbnailTexture)
+{
+}
+
+COverlayRenderer::~COverlayRenderer()
+{
+}
+
+void COverlayRenderer::RequestRender(bool bMirror)
+{
+	// The GUI thread has to be blocked while the render thread synchronizes the scene graph
+	QMutexLocker lock(&m_mutex);
+	QMetaObject::invokeMethod(this, "Render", Qt::QueuedConnection, Q_ARG(bool, bMirror));
+	m_syncDone.wait(&m_mutex);
+}
+
+void COverlayRenderer::Initialize(const QSize &size)
+{
+	m_pOpenGLContext->makeCurrent(m_pOffscreenSurface);
+	m_pFbo = new QOpenGLFramebufferObject(size, QOpenGLFramebufferObject::CombinedDepthStencil);
+	m_pWindow->setRenderTarget(m_pFbo);
+	m_pRenderControl->initialize(m_pOpenGLContext);
+	m_pOpenGLContext->doneCurrent();
+}
+
+void COverlayRenderer::Render(bool bMirror)
+{
+	QMutexLocker lock(&m_mutex);
+	if (!m_pOpenGLContext->makeCurrent(m_pOffscreenSurface))
+	{
+		m_syncDone.wakeOne();
+		return;
+	}
+
+	// Let the GUI thread continue as soon as the scene graph is synchronized
+	m_pRenderControl->sync();
+	m_syncDone.wakeOne();
+	lock.unlock();
+
+	m_pRenderControl->render();
+
+	m_pWindow->resetOpenGLState();
+	QOpenGLFramebufferObject::bindDefault();
+
+	m_pOpenGLContext->functions()->glFlush();
+	if (m_pFbo->texture() != 0)
+		emit FrameRendered(m_pFbo->texture());
+
+	// Only mirror the dashboard to the desktop window if it's actually visible
+	if (bMirror && m_pOpenGLContext->makeCurrent(m_pWindow))
+	{
+		QRect target(QPoint(), m_pWindow->size());
+		QRect source(QPoint(), m_pWindow->renderTargetSize());
+		QOpenGLFramebufferObject::blitFramebuffer(nullptr, target, m_pFbo, source, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+		m_pOpenGLContext->swapBuffers(m_pWindow);
+	}
+
+	m_pOpenGLContext->doneCurrent();
+}
+
+void COverlayRenderer::Cleanup()
+{
+	m_pOpenGLContext->makeCurrent(m_pOffscreenSurface);
+	m_pRenderControl->invalidate();
+	delete m_pFbo;
+	m_pFbo = NULL;
+	delete m_pThumbnailTexture;
+	m_pThumbnailTexture = NULL;
+	m_pOpenGLContext->doneCurrent();
+
+	// Hand the context back so it can be destroyed on the GUI thread
+	m_pOpenGLContext->moveToThread(QCoreApplication::instance()->thread());
+	QThread::currentThread()->quit();
+}
@@ -0,0 +1,52 @@
+#ifndef OVERLAYRENDERER_H
+#define OVERLAYRENDERER_H
+
+#include <QMutex>
+#include <QObject>
+#include <QSize>
+#include <QWaitCondition>
+
+class QOffscreenSurface;
+class QOpenGLContext;
+class QOpenGLFramebufferObject;
+class QOpenGLTexture;
+class QQuickRenderControl;
+class QQuickWindow;
+
+// Renders the dashboard scene on its own thread, every frame is handed to the overlay through FrameRendered
+class COverlayRenderer : public QObject
+{
+	Q_OBJECT
+	typedef QObject BaseClass;
+
+public:
+	// Takes ownership of the thumbnail texture, it's destroyed together with the other OpenGL resources
+	COverlayRenderer(QOpenGLContext *pContext, QOffscreenSurface *pSurface, QQuickRenderControl *pRenderControl,
+		QQuickWindow *pWindow, QOpenGLTexture *pThumbnailTexture);
+	virtual ~COverlayRenderer();
+
+	// Called on the GUI thread, blocks until the scene has been synchronized with the render thread
+	void RequestRender(bool bMirror);
+
+public slots:
+	void Initialize(const QSize &size);
+	void Render(bool bMirror);
+	void Cleanup();
+
+signals:
+	// Emitted on the render thread while the context is current, so the texture can be submitted
+	void FrameRendered(uint texture);
+
+private:
+	QOpenGLContext *m_pOpenGLContext;
+	QOffscreenSurface *m_pOffscreenSurface;
+	QQuickRenderControl *m_pRenderControl;
+	QQuickWindow *m_pWindow;
+	QOpenGLFramebufferObject *m_pFbo;
+	QOpenGLTexture *m_pThumbnailTexture;
+
+	QMutex m_mutex;
+	QWaitCondition m_syncDone;
+};
+
+#endif // OVERLAYRENDERER_H
@@ -9,9 +9,7 @@
 #include <QCoreApplication>
 #include <QDir>
 #include <QFileInfo>
-#include <QJsonArray>
 #include <QJsonDocument>
-#include <QProcess>
 #include <QSettings>
 #include <QUrl>
 
@@ -206,11 +204,21 @@ bool GetOculusBasePath(wchar_t* path, uint32_t length)
 CReviveManifestController::CReviveManifestController()
 	: BaseClass()
 	, m_appFile(QCoreApplication::applicationDirPath() + "/app.vrmanifest")
-	, m_manifestFile(QCoreApplication::applicationDirPath() + "/revive.vrmanifest")
 	, m_supportFile(QCoreApplication::applicationDirPath() + "/support.vrmanifest")
+	, m_store(QCoreApplication::applicationDirPath() + "/revive.vrmanifest", this)
 	, m_bLibraryFound(false)
 	, m_bUseOpenXR(false)
 {
+	// Report the launches of applications to QML by their canonical name
+	auto canonicalName = [](const QString& key) { return key.startsWith(AppPrefix) ? key.mid(strlen(AppPrefix)) : key; };
+	connect(&m_launcher, &CLaunchService::LaunchStarted, this, [this, canonicalName](const QString& key) { emit LaunchStarted(canonicalName(key)); });
+	connect(&m_launcher, &CLaunchService::LaunchFinished, this, [this, canonicalName](const QString& key) { emit LaunchFinished(canonicalName(key)); });
+	connect(&m_launcher, &CLaunchService::LaunchFailed, this, [this, canonicalName](const QString& key, const QString& error)
+	{
+		qWarning("Failed to launch %s: %s", qUtf8Printable(key), qUtf8Printable(error));
+		emit LaunchFailed(canonicalName(key), error);
+	});
+
 	m_supportArgs["revive.app.oculus-dreamdeck-nux"] = R"(/base Support\oculus-dreamdeck-nux\Dreamdeck\Binaries\Win64\Dreamdeck-Win64-Shipping.exe -vr -dreamdeck=NUX)";
 	m_supportArgs["revive.app.oculus-touch-tutorial"] = R"(/base Support\oculus-touch-tutorial\WindowsNoEditor\TouchNUX\Binaries\Win64\TouchNUX-Win64-Shipping.exe -gamemode=nux)";
 	m_supportArgs["revive.app.oculus-first-contact"] = R"(/base Support\oculus-touch-tutorial\WindowsNoEditor\TouchNUX\Binaries\Win64\TouchNUX-Win64-Shipping.exe -gamemode="experienceonly")";
@@ -223,15 +231,17 @@ CReviveManifestController::~CReviveManifestController()
 
 bool CReviveManifestController::Init()
 {
-	bool bSuccess = LoadDocument();
+	bool bSuccess = m_store.Load();
 
 	if (!bSuccess)
-	{
-		QJsonArray applications;
-		m_manifest["applications"] = applications;
+		bSuccess = m_store.Save();
+#ifndef DEBUG
+	else
+		m_store.Register();
+#endif
 
-		bSuccess = SaveDocument();
-	}
+	// Don't lose any changes that are still waiting for the save timer
+	connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &CReviveManifestController::FlushDocument);
 
 #ifndef DEBUG
 	// Add application and support manifest
@@ -289,11 +299,16 @@ bool CReviveManifestController::Init()
 }
 
 bool CReviveManifestController::AddApplicationManifest(QFile& file)
+{
+	return AddApplicationManifest(file.fileName());
+}
+
+bool CReviveManifestController::AddApplicationManifest(const QString& path)
 {
 	if (!vr::VRApplications())
 		return false;
 
-	QFileInfo info(file);
+	QFileInfo info(path);
 	QString filePath = QDir::toNativeSeparators(info.absoluteFilePath());
 	vr::EVRApplicationError error = vr::VRApplications()->AddApplicationManifest(qPrintable(filePath));
 	if (error != vr::VRApplicationError_None)
@@ -307,86 +322,40 @@ bool CReviveManifestController::AddApplicationManifest(QFile& file)
 	return true;
 }
 
-bool CReviveManifestController::LoadDocument()
+void CReviveManifestController::FlushDocument()
 {
-	if (!m_manifestFile.open(QIODevice::ReadOnly))
-	{
-		qWarning("Couldn't open manifest file for reading");
-		return false;
-	}
-
-	QJsonDocument doc = QJsonDocument::fromJson(m_manifestFile.readAll());
-	m_manifest = doc.object();
-	m_manifestFile.close();
-
-#ifndef DEBUG
-	AddApplicationManifest(m_manifestFile);
-#endif
-
-	return true;
-}
-
-bool CReviveManifestController::SaveDocument()
-{
-	if (!m_manifestFile.open(QIODevice::WriteOnly))
-	{
-		qWarning("Couldn't open manifest file for writing");
-		return false;
-	}
-
-	QJsonDocument doc(m_manifest);
-	m_manifestFile.write(doc.toJson());
-	m_manifestFile.close();
-
-	AddApplicationManifest(m_manifestFile);
-
-	return true;
+	m_store.Flush();
 }
 
 bool CReviveManifestController::addManifest(const QString &canonicalName, const QString &manifest)
 {
 	qDebug("Adding manifest: %s", qUtf8Printable(canonicalName));
 	QJsonDocument doc = QJsonDocument::fromJson(manifest.toUtf8());
-	QJsonArray apps = m_manifest["applications"].toArray();
+	QString appKey = AppPrefix + canonicalName;
 	QJsonObject obj = doc.object();
-	obj["app_key"] = AppPrefix + canonicalName;
-	apps.append(obj);
-	m_manifest["applications"] = apps;
-	return SaveDocument();
+	obj["app_key"] = appKey;
+	m_store.Add(appKey, obj);
+	return true;
 }
 
 bool CReviveManifestController::removeManifest(const QString &canonicalName)
 {
 	qDebug("Removing manifest: %s", qUtf8Printable(canonicalName));
 	QString appKey = AppPrefix + canonicalName;
-	QJsonArray apps = m_manifest["applications"].toArray();
-	for (auto it = apps.begin(); it != apps.end(); ++it)
-	{
-		QJsonObject obj = it->toObject();
-		if (obj["app_key"] == appKey)
-		{
-			apps.erase(it);
-			break;
-		}
-	}
-	m_manifest["applications"] = apps;
-	return SaveDocument();
+	m_store.Remove(appKey);
+	return true;
 }
 
-bool CReviveManifestController::LaunchInjector(const QString& args)
+bool CReviveManifestController::LaunchInjector(const QString& args, const QString& key)
 {
-	// Launch the injector with the arguments
-	QProcess injector;
-	injector.setProgram(QCoreApplication::applicationDirPath() + "/ReviveInjector.exe");
-	if (m_bUseOpenXR)
-		injector.setNativeArguments("/openxr " + args);
-	else
-		injector.setNativeArguments(args);
-	injector.start();
+	// Pressing launch again while the injector is still running isn't an error
+	QString launchKey = key.isEmpty() ? args : key;
+	if (m_launcher.IsLaunching(launchKey))
+		return true;
 
-	if (!injector.waitForFinished())
-		return false;
-	return injector.exitCode() == 0;
+	// Launch the injector with the arguments, the result is reported through the launch signals
+	QString program = QCoreApplication::applicationDirPath() + "/ReviveInjector.exe";
+	return m_launcher.Launch(launchKey, program, m_bUseOpenXR ? "/openxr " + args : args);
 }
 
 bool CReviveManifestController::LaunchSupportApp(const QString& appKey)
@@ -394,7 +363,7 @@ bool CReviveManifestController::LaunchSupportApp(const QString& appKey)
 	if (!m_supportArgs.contains(appKey))
 		return false;
 
-	return LaunchInjector(m_supportArgs[appKey]);
+	return LaunchInjector(m_supportArgs[appKey], appKey);
 }
 
 bool CReviveManifestController::launchApplication(const QString &canonicalName)
@@ -408,12 +377,15 @@ bool CReviveManifestController::launchApplication(const QString &canonicalName)
 	if (multiplayerAppKeys.indexOf(canonicalName) != -1 && !COculusOauthTokenController::SharedInstance()->Connected())
 		CTrayIconController::SharedInstance()->ShowInformation(TrayInfo_OculusAccessTokenNotFound);
 
+	// OpenVR needs to know about the application before it can be launched
+	FlushDocument();
+
 	if (!m_bUseOpenXR && vr::VRApplications())
 	{
 		// Refresh the manifest after launching the application to aid application identification
 		vr::EVRApplicationError error = vr::VRApplications()->LaunchApplication(qPrintable(appKey));
 		if (error == vr::VRApplicationError_None)
-			return AddApplicationManifest(m_manifestFile);
+			return m_store.Register();
 		else
 			qWarning("Failed to launch application through OpenVR, falling back to injector: %s (%s)", qUtf8Printable(appKey), vr::VRApplications()->GetApplicationsErrorNameFromEnum(error));
 	}
@@ -422,24 +394,21 @@ bool CReviveManifestController::launchApplication(const QString &canonicalName)
 		return true;
 
 	// Search for the app in the cached manifest
-	for (QJsonValue app : m_manifest["applications"].toArray())
-	{
-		if (app["app_key"].toString() == appKey)
-			return LaunchInjector(app["arguments"].toString());
-	}
+	if (m_store.HasApplication(appKey))
+		return LaunchInjector(m_store.GetApplication(appKey)["arguments"].toString(), appKey);
 	return false;
 }
 
 bool CReviveManifestController::isApplicationInstalled(const QString &canonicalName)
 {
 	QString appKey = AppPrefix + canonicalName;
-	if (vr::VRApplications())
-		return vr::VRApplications()->IsApplicationInstalled(qPrintable(appKey));
+	if (!vr::VRApplications())
+		return m_store.HasApplication(appKey);
 
-	for (QJsonValue app : m_manifest["applications"].toArray())
-	{
-		if (app["app_key"].toString() == appKey)
-			return true;
-	}
-	return false;
+	return m_store.IsInstalled(appKey);
+}
+
+bool CReviveManifestController::IsApplicationInstalled(const QString& appKey)
+{
+	return vr::VRApplications() && vr::VRApplications()->IsApplicationInstalled(qPrintable(appKey));
 }
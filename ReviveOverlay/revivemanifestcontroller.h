@@ -4,11 +4,13 @@
 #include <QObject>
 #include <QFile>
 #include <QDir>
-#include <QJsonObject>
 #include <QSystemTrayIcon>
 #include <QMap>
 
-class CReviveManifestController : public QObject
+#include "launchservice.h"
+#include "manifeststore.h"
+
+class CReviveManifestController : public QObject, private IManifestRegistrar
 {
 	Q_OBJECT
 	typedef QObject BaseClass; 
@@ -31,7 +33,8 @@ public:
 	virtual ~CReviveManifestController();
 
 	bool Init();
-	bool LaunchInjector(const QString& args);
+	bool LaunchInjector(const QString& args, const QString& key = QString());
+	void FlushDocument();
 	void UseOpenXR(bool enabled) { m_bUseOpenXR = enabled; }
 	bool UsingOpenXR() const { return m_bUseOpenXR; }
 
@@ -51,21 +54,24 @@ public:
 signals:
 	void LibraryChanged();
 	void BaseChanged();
+	void LaunchStarted(const QString &canonicalName);
+	void LaunchFinished(const QString &canonicalName);
+	void LaunchFailed(const QString &canonicalName, const QString &error);
 
 private:
-	bool LoadDocument();
-	bool SaveDocument();
 	bool GetDefaultLibraryPath(wchar_t* path, uint32_t length);
 	bool GetLibraries(QStringList &id_array, QStringList & path_array);
 	bool AddApplicationManifest(QFile& file);
+	bool AddApplicationManifest(const QString& path) override;
+	bool IsApplicationInstalled(const QString& appKey) override;
 	bool LaunchSupportApp(const QString& appKey);
 
 	QFile m_appFile;
-	QFile m_manifestFile;
 	QFile m_supportFile;
 	QDir m_appManifests;
-	QJsonObject m_manifest;
+	CManifestStore m_store;
 	QMap<QString, QString> m_supportArgs;
+	CLaunchService m_launcher;
 
 	bool m_bLibraryFound;
 	QString m_strLibraryURL;
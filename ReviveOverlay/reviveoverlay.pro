@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT       += core gui widgets sql
+QT       += core gui widgets sql concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += quick
 
@@ -13,16 +13,28 @@ TEMPLATE = app
 
 
 SOURCES += main.cpp\
+    coverimageprovider.cpp \
+    launchservice.cpp \
+    libraryscanner.cpp \
+    manifeststore.cpp \
     oculusoauthtokencontroller.cpp \
     openvroverlaycontroller.cpp \
+    overlaypresenter.cpp \
+    overlayrenderer.cpp \
     qquickwindowscaled.cpp \
     revivemanifestcontroller.cpp \
     trayiconcontroller.cpp \
     windowsservices.cpp
 
 HEADERS  += \
+    coverimageprovider.h \
+    launchservice.h \
+    libraryscanner.h \
+    manifeststore.h \
     oculusoauthtokencontroller.h \
     openvroverlaycontroller.h \
+    overlaypresenter.h \
+    overlayrenderer.h \
     qquickwindowscaled.h \
     revivemanifestcontroller.h \
     trayiconcontroller.h \
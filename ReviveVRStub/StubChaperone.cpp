@@ -0,0 +1,296 @@
+#include "StubCore.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+
+static void GetPlayArea(float* width, float* depth)
+{
+	StubCore& core = StubCore::Get();
+	if (width)
+		*width = core.Script.Bounds[0];
+	if (depth)
+		*depth = core.Script.Bounds[1];
+}
+
+// The play area is a rectangle centered on the standing origin
+static void GetPlayAreaQuad(vr::HmdQuad_t* rect)
+{
+	float width, depth;
+	GetPlayArea(&width, &depth);
+	float x = width / 2.0f, z = depth / 2.0f;
+	rect->vCorners[0] = { -x, 0.0f, z };
+	rect->vCorners[1] = { x, 0.0f, z };
+	rect->vCorners[2] = { x, 0.0f, -z };
+	rect->vCorners[3] = { -x, 0.0f, -z };
+}
+
+class StubChaperone : public vr::IVRChaperone
+{
+public:
+	StubChaperone()
+		: m_ForceVisible(false)
+	{
+	}
+
+	virtual vr::ChaperoneCalibrationState GetCalibrationState() { STUB_CALL(); return vr::ChaperoneCalibrationState_OK; }
+
+	virtual bool GetPlayAreaSize(float* pSizeX, float* pSizeZ)
+	{
+		STUB_CALL();
+		GetPlayArea(pSizeX, pSizeZ);
+		return true;
+	}
+
+	virtual bool GetPlayAreaRect(vr::HmdQuad_t* rect)
+	{
+		STUB_CALL();
+		if (!rect)
+			return false;
+		GetPlayAreaQuad(rect);
+		return true;
+	}
+
+	virtual void ReloadInfo() { STUB_CALL(); }
+	virtual void SetSceneColor(vr::HmdColor_t color) { STUB_CALL(); }
+
+	virtual void GetBoundsColor(vr::HmdColor_t* pOutputColorArray, int nNumOutputColors, float flCollisionBoundsFadeDistance, vr::HmdColor_t* pOutputCameraColor)
+	{
+		STUB_CALL();
+		for (int i = 0; pOutputColorArray && i < nNumOutputColors; i++)
+			pOutputColorArray[i] = { 0.0f, 1.0f, 1.0f, 1.0f };
+		if (pOutputCameraColor)
+			*pOutputCameraColor = { 0.0f, 1.0f, 1.0f, 1.0f };
+	}
+
+	virtual bool AreBoundsVisible() { STUB_CALL(); return m_ForceVisible; }
+	virtual void ForceBoundsVisible(bool bForce) { STUB_CALL(); m_ForceVisible = bForce; }
+	virtual void ResetZeroPose(vr::ETrackingUniverseOrigin eTrackingUniverseOrigin) { STUB_CALL(); }
+
+private:
+	bool m_ForceVisible;
+};
+
+// Keeps a working copy of the zero poses, committing it only replaces the live copy in memory
+class StubChaperoneSetup : public vr::IVRChaperoneSetup
+{
+public:
+	StubChaperoneSetup()
+		: m_Initialized(false)
+	{
+	}
+
+	virtual bool CommitWorkingCopy(vr::EChaperoneConfigFile configFile)
+	{
+		STUB_CALL();
+		std::lock_guard<std::mutex> lk(m_Mutex);
+		Init();
+		m_Live[0] = m_Working[0];
+		m_Live[1] = m_Working[1];
+		return true;
+	}
+
+	virtual void RevertWorkingCopy()
+	{
+		STUB_CALL();
+		std::lock_guard<std::mutex> lk(m_Mutex);
+		Init();
+		m_Working[0] = m_Live[0];
+		m_Working[1] = m_Live[1];
+	}
+
+	virtual bool GetWorkingPlayAreaSize(float* pSizeX, float* pSizeZ)
+	{
+		STUB_CALL();
+		GetPlayArea(pSizeX, pSizeZ);
+		return true;
+	}
+
+	virtual bool GetWorkingPlayAreaRect(vr::HmdQuad_t* rect)
+	{
+		STUB_CALL();
+		if (!rect)
+			return false;
+		GetPlayAreaQuad(rect);
+		return true;
+	}
+
+	virtual bool GetWorkingCollisionBoundsInfo(vr::HmdQuad_t* pQuadsBuffer, uint32_t* punQuadsCount)
+	{
+		STUB_CALL();
+		return GetCollisionBounds(pQuadsBuffer, punQuadsCount);
+	}
+
+	virtual bool GetLiveCollisionBoundsInfo(vr::HmdQuad_t* pQuadsBuffer, uint32_t* punQuadsCount)
+	{
+		STUB_CALL();
+		return GetCollisionBounds(pQuadsBuffer, punQuadsCount);
+	}
+
+	virtual bool GetWorkingSeatedZeroPoseToRawTrackingPose(vr::HmdMatrix34_t* pmatSeatedZeroPoseToRawTrackingPose)
+	{
+		STUB_CALL();
+		std::lock_guard<std::mutex> lk(m_Mutex);
+		Init();
+		*pmatSeatedZeroPoseToRawTrackingPose = m_Working[0];
+		return true;
+	}
+
+	virtual bool GetWorkingStandingZeroPoseToRawTrackingPose(vr::HmdMatrix34_t* pmatStandingZeroPoseToRawTrackingPose)
+	{
+		STUB_CALL();
+		std::lock_guard<std::mutex> lk(m_Mutex);
+		Init();
+		*pmatStandingZeroPoseToRawTrackingPose = m_Working[1];
+		return true;
+	}
+
+	virtual void SetWorkingPlayAreaSize(float sizeX, float sizeZ) { STUB_CALL(); }
+	virtual void SetWorkingCollisionBoundsInfo(vr::HmdQuad_t* pQuadsBuffer, uint32_t unQuadsCount) { STUB_CALL(); }
+	virtual void SetWorkingPerimeter(vr::HmdVector2_t* pPointBuffer, uint32_t unPointCount) { STUB_CALL(); }
+
+	virtual void SetWorkingSeatedZeroPoseToRawTrackingPose(const vr::HmdMatrix34_t* pMatSeatedZeroPoseToRawTrackingPose)
+	{
+		STUB_CALL();
+		std::lock_guard<std::mutex> lk(m_Mutex);
+		Init();
+		m_Working[0] = *pMatSeatedZeroPoseToRawTrackingPose;
+	}
+
+	virtual void SetWorkingStandingZeroPoseToRawTrackingPose(const vr::HmdMatrix34_t* pMatStandingZeroPoseToRawTrackingPose)
+	{
+		STUB_CALL();
+		std::lock_guard<std::mutex> lk(m_Mutex);
+		Init();
+		m_Working[1] = *pMatStandingZeroPoseToRawTrackingPose;
+	}
+
+	virtual void ReloadFromDisk(vr::EChaperoneConfigFile configFile) { STUB_CALL(); }
+
+	virtual bool GetLiveSeatedZeroPoseToRawTrackingPose(vr::HmdMatrix34_t* pmatSeatedZeroPoseToRawTrackingPose)
+	{
+		STUB_CALL();
+		std::lock_guard<std::mutex> lk(m_Mutex);
+		Init();
+		*pmatSeatedZeroPoseToRawTrackingPose = m_Live[0];
+		return true;
+	}
+
+	// The live configuration is exported as the text of both zero poses, real runtimes export JSON
+	virtual bool ExportLiveToBuffer(char* pBuffer, uint32_t* pnBufferLength)
+	{
+		STUB_CALL();
+		if (!pnBufferLength)
+			return false;
+
+		std::string text;
+		{
+			std::lock_guard<std::mutex> lk(m_Mutex);
+			Init();
+			char value[32];
+			for (const vr::HmdMatrix34_t& pose : m_Live)
+			{
+				for (int i = 0; i < 12; i++)
+				{
+					snprintf(value, sizeof(value), "%.9g ", pose.m[i / 4][i % 4]);
+					text += value;
+				}
+			}
+		}
+
+		uint32_t size = *pnBufferLength;
+		*pnBufferLength = StubCopyString(text, pBuffer, size);
+		return !pBuffer || size >= *pnBufferLength;
+	}
+
+	virtual bool ImportFromBufferToWorking(const char* pBuffer, uint32_t nImportFlags)
+	{
+		STUB_CALL();
+		if (!pBuffer)
+			return false;
+
+		vr::HmdMatrix34_t poses[2];
+		const char* next = pBuffer;
+		for (vr::HmdMatrix34_t& pose : poses)
+		{
+			for (int i = 0; i < 12; i++)
+			{
+				char* end;
+				pose.m[i / 4][i % 4] = strtof(next, &end);
+				if (end == next)
+					return false;
+				next = end;
+			}
+		}
+
+		std::lock_guard<std::mutex> lk(m_Mutex);
+		Init();
+		m_Working[0] = poses[0];
+		m_Working[1] = poses[1];
+		return true;
+	}
+
+	virtual void ShowWorkingSetPreview() { STUB_CALL(); }
+	virtual void HideWorkingSetPreview() { STUB_CALL(); }
+	virtual void RoomSetupStarting() { STUB_CALL(); }
+
+private:
+	std::mutex m_Mutex;
+	bool m_Initialized;
+
+	// Seated and standing zero poses
+	vr::HmdMatrix34_t m_Working[2];
+	vr::HmdMatrix34_t m_Live[2];
+
+	// Called with the setup mutex held, the zero poses are only known once the script is loaded
+	void Init()
+	{
+		if (m_Initialized)
+			return;
+
+		m_Live[0] = StubCore::Get().GetSeatedToStanding();
+		m_Live[1] = StubMath::ToMatrix(StubMath::Identity());
+		m_Working[0] = m_Live[0];
+		m_Working[1] = m_Live[1];
+		m_Initialized = true;
+	}
+
+	static bool GetCollisionBounds(vr::HmdQuad_t* quads, uint32_t* count)
+	{
+		if (!count)
+			return false;
+
+		// Four walls around the play area
+		uint32_t size = *count;
+		*count = 4;
+		if (!quads || size < 4)
+			return quads == nullptr;
+
+		vr::HmdQuad_t rect;
+		GetPlayAreaQuad(&rect);
+		for (int i = 0; i < 4; i++)
+		{
+			const vr::HmdVector3_t& a = rect.vCorners[i];
+			const vr::HmdVector3_t& b = rect.vCorners[(i + 1) % 4];
+			quads[i].vCorners[0] = a;
+			quads[i].vCorners[1] = b;
+			quads[i].vCorners[2] = { b.v[0], 2.4f, b.v[2] };
+			quads[i].vCorners[3] = { a.v[0], 2.4f, a.v[2] };
+		}
+		return true;
+	}
+};
+
+vr::IVRChaperone* GetStubChaperone()
+{
+	static StubChaperone s_Chaperone;
+	return &s_Chaperone;
+}
+
+vr::IVRChaperoneSetup* GetStubChaperoneSetup()
+{
+	static StubChaperoneSetup s_ChaperoneSetup;
+	return &s_ChaperoneSetup;
+}
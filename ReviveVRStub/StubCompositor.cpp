@@ -0,0 +1,328 @@
+#include "StubCore.h"
+
+#include <Windows.h>
+#include <string.h>
+#include <algorithm>
+
+// Number of frames kept for GetFrameTiming
+#define STUB_TIMING_HISTORY 128
+
+class StubCompositor : public vr::IVRCompositor
+{
+public:
+	StubCompositor()
+		: m_RenderPoses()
+		, m_GamePoses()
+		, m_Timings()
+		, m_Presents(0)
+		, m_Submitted{}
+		, m_TimingMode(vr::VRCompositorTimingMode_Implicit)
+		, m_Session(0)
+	{
+	}
+
+	virtual void SetTrackingSpace(vr::ETrackingUniverseOrigin eOrigin)
+	{
+		STUB_CALL();
+		StubCore& core = StubCore::Get();
+		std::lock_guard<std::mutex> lk(core.Mutex);
+		core.TrackingSpace = eOrigin;
+	}
+
+	virtual vr::ETrackingUniverseOrigin GetTrackingSpace()
+	{
+		STUB_CALL();
+		StubCore& core = StubCore::Get();
+		std::lock_guard<std::mutex> lk(core.Mutex);
+		return core.TrackingSpace;
+	}
+
+	virtual vr::EVRCompositorError WaitGetPoses(vr::TrackedDevicePose_t* pRenderPoseArray, uint32_t unRenderPoseArrayCount,
+		vr::TrackedDevicePose_t* pGamePoseArray, uint32_t unGamePoseArrayCount)
+	{
+		STUB_CALL();
+		StubCore& core = StubCore::Get();
+		double start = core.Now();
+		uint32_t frame = core.BeginFrame();
+
+		// Render poses are predicted for the vsync the frame will be displayed at, game poses a frame later
+		std::lock_guard<std::mutex> lk(core.Mutex);
+		Sync();
+		for (uint32_t i = 0; i < vr::k_unMaxTrackedDeviceCount; i++)
+		{
+			m_RenderPoses[i] = core.GetPose(i, core.TrackingSpace, core.GetVsyncTime(frame + 1));
+			m_GamePoses[i] = core.GetPose(i, core.TrackingSpace, core.GetVsyncTime(frame + 2));
+		}
+		if (pRenderPoseArray)
+			memcpy(pRenderPoseArray, m_RenderPoses, std::min(unRenderPoseArrayCount, vr::k_unMaxTrackedDeviceCount) * sizeof(vr::TrackedDevicePose_t));
+		if (pGamePoseArray)
+			memcpy(pGamePoseArray, m_GamePoses, std::min(unGamePoseArrayCount, vr::k_unMaxTrackedDeviceCount) * sizeof(vr::TrackedDevicePose_t));
+
+		vr::Compositor_FrameTiming& timing = m_Timings[frame % STUB_TIMING_HISTORY];
+		memset(&timing, 0, sizeof(timing));
+		timing.m_nSize = sizeof(vr::Compositor_FrameTiming);
+		timing.m_nFrameIndex = frame;
+		timing.m_flSystemTimeInSeconds = core.GetVsyncTime(frame);
+		timing.m_flClientFrameIntervalMs = (float)(core.GetPeriod() * 1000.0);
+		timing.m_flWaitGetPosesCalledMs = (float)((start - core.GetVsyncTime(frame - 1)) * 1000.0);
+		timing.m_flNewPosesReadyMs = (float)((core.Now() - core.GetVsyncTime(frame - 1)) * 1000.0);
+		timing.m_HmdPose = m_RenderPoses[vr::k_unTrackedDeviceIndex_Hmd];
+		m_Submitted[vr::Eye_Left] = m_Submitted[vr::Eye_Right] = false;
+		return vr::VRCompositorError_None;
+	}
+
+	virtual vr::EVRCompositorError GetLastPoses(vr::TrackedDevicePose_t* pRenderPoseArray, uint32_t unRenderPoseArrayCount,
+		vr::TrackedDevicePose_t* pGamePoseArray, uint32_t unGamePoseArrayCount)
+	{
+		STUB_CALL();
+		std::lock_guard<std::mutex> lk(StubCore::Get().Mutex);
+		if (pRenderPoseArray)
+			memcpy(pRenderPoseArray, m_RenderPoses, std::min(unRenderPoseArrayCount, vr::k_unMaxTrackedDeviceCount) * sizeof(vr::TrackedDevicePose_t));
+		if (pGamePoseArray)
+			memcpy(pGamePoseArray, m_GamePoses, std::min(unGamePoseArrayCount, vr::k_unMaxTrackedDeviceCount) * sizeof(vr::TrackedDevicePose_t));
+		return vr::VRCompositorError_None;
+	}
+
+	virtual vr::EVRCompositorError GetLastPoseForTrackedDeviceIndex(vr::TrackedDeviceIndex_t unDeviceIndex, vr::TrackedDevicePose_t* pOutputPose, vr::TrackedDevicePose_t* pOutputGamePose)
+	{
+		STUB_CALL();
+		if (unDeviceIndex >= vr::k_unMaxTrackedDeviceCount)
+			return vr::VRCompositorError_IndexOutOfRange;
+
+		std::lock_guard<std::mutex> lk(StubCore::Get().Mutex);
+		if (pOutputPose)
+			*pOutputPose = m_RenderPoses[unDeviceIndex];
+		if (pOutputGamePose)
+			*pOutputGamePose = m_GamePoses[unDeviceIndex];
+		return vr::VRCompositorError_None;
+	}
+
+	virtual vr::EVRCompositorError Submit(vr::EVREye eEye, const vr::Texture_t* pTexture, const vr::VRTextureBounds_t* pBounds, vr::EVRSubmitFlags nSubmitFlags)
+	{
+		STUB_CALL();
+		if (eEye != vr::Eye_Left && eEye != vr::Eye_Right)
+			return vr::VRCompositorError_IndexOutOfRange;
+		if (!pTexture || !pTexture->handle)
+			return vr::VRCompositorError_InvalidTexture;
+		if (pBounds && (pBounds->uMin == pBounds->uMax || pBounds->vMin == pBounds->vMax))
+			return vr::VRCompositorError_InvalidBounds;
+
+		// The images are accepted as is, nothing is ever displayed
+		StubCore& core = StubCore::Get();
+		std::lock_guard<std::mutex> lk(core.Mutex);
+		Sync();
+		if (core.GetFrameIndex() == 0)
+			return vr::VRCompositorError_RequestFailed;
+		if (m_Submitted[eEye])
+			return vr::VRCompositorError_AlreadySubmitted;
+		m_Submitted[eEye] = true;
+		if (m_Submitted[vr::Eye_Left] && m_Submitted[vr::Eye_Right])
+			Present();
+		return vr::VRCompositorError_None;
+	}
+
+	virtual void ClearLastSubmittedFrame() { STUB_CALL(); }
+
+	virtual void PostPresentHandoff()
+	{
+		STUB_CALL();
+		std::lock_guard<std::mutex> lk(StubCore::Get().Mutex);
+		if (m_Submitted[vr::Eye_Left] || m_Submitted[vr::Eye_Right])
+			Present();
+	}
+
+	virtual bool GetFrameTiming(vr::Compositor_FrameTiming* pTiming, uint32_t unFramesAgo)
+	{
+		STUB_CALL();
+		StubCore& core = StubCore::Get();
+		std::lock_guard<std::mutex> lk(core.Mutex);
+		uint32_t frame = core.GetFrameIndex();
+		if (!pTiming || unFramesAgo >= std::min(frame, (uint32_t)STUB_TIMING_HISTORY))
+			return false;
+
+		uint32_t size = pTiming->m_nSize ? std::min(pTiming->m_nSize, (uint32_t)sizeof(vr::Compositor_FrameTiming)) : sizeof(vr::Compositor_FrameTiming);
+		memcpy(pTiming, &m_Timings[(frame - unFramesAgo) % STUB_TIMING_HISTORY], size);
+		pTiming->m_nSize = size;
+		return true;
+	}
+
+	virtual uint32_t GetFrameTimings(vr::Compositor_FrameTiming* pTiming, uint32_t nFrames)
+	{
+		STUB_CALL();
+		StubCore& core = StubCore::Get();
+		std::lock_guard<std::mutex> lk(core.Mutex);
+		uint32_t frame = core.GetFrameIndex();
+		uint32_t count = std::min(nFrames, std::min(frame, (uint32_t)STUB_TIMING_HISTORY));
+
+		// Oldest frame first
+		for (uint32_t i = 0; i < count; i++)
+			pTiming[i] = m_Timings[(frame - count + 1 + i) % STUB_TIMING_HISTORY];
+		return count;
+	}
+
+	virtual float GetFrameTimeRemaining()
+	{
+		STUB_CALL();
+		StubCore& core = StubCore::Get();
+		return (float)std::max(core.GetVsyncTime(core.GetFrameIndex() + 1) - core.Now(), 0.0);
+	}
+
+	virtual void GetCumulativeStats(vr::Compositor_CumulativeStats* pStats, uint32_t nStatsSizeInBytes)
+	{
+		STUB_CALL();
+		if (!pStats)
+			return;
+
+		StubCore& core = StubCore::Get();
+		std::lock_guard<std::mutex> lk(core.Mutex);
+		Sync();
+		vr::Compositor_CumulativeStats stats = {};
+		stats.m_nPid = GetCurrentProcessId();
+		stats.m_nNumFramePresents = m_Presents;
+		stats.m_nNumFrames = core.GetFrameIndex();
+		stats.m_nNumDroppedFrames = core.GetFrameIndex() - m_Presents;
+		stats.m_nNumFramePresentsOnStartup = std::min(m_Presents, 1u);
+		memcpy(pStats, &stats, std::min(nStatsSizeInBytes, (uint32_t)sizeof(stats)));
+	}
+
+	virtual void FadeToColor(float fSeconds, float fRed, float fGreen, float fBlue, float fAlpha, bool bBackground) { STUB_CALL(); }
+	virtual vr::HmdColor_t GetCurrentFadeColor(bool bBackground) { STUB_CALL(); vr::HmdColor_t color = {}; return color; }
+	virtual void FadeGrid(float fSeconds, bool bFadeGridIn) { STUB_CALL(); }
+	virtual float GetCurrentGridAlpha() { STUB_CALL(); return 0.0f; }
+	virtual vr::EVRCompositorError SetSkyboxOverride(const vr::Texture_t* pTextures, uint32_t unTextureCount) { STUB_CALL(); return vr::VRCompositorError_None; }
+	virtual void ClearSkyboxOverride() { STUB_CALL(); }
+	virtual void CompositorBringToFront() { STUB_CALL(); }
+	virtual void CompositorGoToBack() { STUB_CALL(); }
+	virtual void CompositorQuit() { STUB_CALL(); }
+	virtual bool IsFullscreen() { STUB_CALL(); return false; }
+	virtual uint32_t GetCurrentSceneFocusProcess() { STUB_CALL(); return GetCurrentProcessId(); }
+	virtual uint32_t GetLastFrameRenderer() { STUB_CALL(); return GetCurrentProcessId(); }
+	virtual bool CanRenderScene() { STUB_CALL(); return true; }
+	virtual void ShowMirrorWindow() { STUB_CALL(); }
+	virtual void HideMirrorWindow() { STUB_CALL(); }
+	virtual bool IsMirrorWindowVisible() { STUB_CALL(); return false; }
+	virtual void CompositorDumpImages() { STUB_CALL(); }
+	virtual bool ShouldAppRenderWithLowResources() { STUB_CALL(); return false; }
+	virtual void ForceInterleavedReprojectionOn(bool bOverride) { STUB_CALL(); }
+	virtual void ForceReconnectProcess() { STUB_CALL(); }
+	virtual void SuspendRendering(bool bSuspend) { STUB_CALL(); }
+
+	// There is no compositor output to mirror
+	virtual vr::EVRCompositorError GetMirrorTextureD3D11(vr::EVREye eEye, void* pD3D11DeviceOrResource, void** ppD3D11ShaderResourceView)
+	{
+		STUB_CALL();
+		if (ppD3D11ShaderResourceView)
+			*ppD3D11ShaderResourceView = nullptr;
+		return vr::VRCompositorError_RequestFailed;
+	}
+
+	virtual void ReleaseMirrorTextureD3D11(void* pD3D11ShaderResourceView) { STUB_CALL(); }
+
+	virtual vr::EVRCompositorError GetMirrorTextureGL(vr::EVREye eEye, vr::glUInt_t* pglTextureId, vr::glSharedTextureHandle_t* pglSharedTextureHandle)
+	{
+		STUB_CALL();
+		return vr::VRCompositorError_RequestFailed;
+	}
+
+	virtual bool ReleaseSharedGLTexture(vr::glUInt_t glTextureId, vr::glSharedTextureHandle_t glSharedTextureHandle) { STUB_CALL(); return false; }
+	virtual void LockGLSharedTextureForAccess(vr::glSharedTextureHandle_t glSharedTextureHandle) { STUB_CALL(); }
+	virtual void UnlockGLSharedTextureForAccess(vr::glSharedTextureHandle_t glSharedTextureHandle) { STUB_CALL(); }
+	virtual uint32_t GetVulkanInstanceExtensionsRequired(char* pchValue, uint32_t unBufferSize) { STUB_CALL(); return 0; }
+	virtual uint32_t GetVulkanDeviceExtensionsRequired(VkPhysicalDevice_T* pPhysicalDevice, char* pchValue, uint32_t unBufferSize) { STUB_CALL(); return 0; }
+
+	virtual void SetExplicitTimingMode(vr::EVRCompositorTimingMode eTimingMode)
+	{
+		STUB_CALL();
+		m_TimingMode = eTimingMode;
+	}
+
+	virtual vr::EVRCompositorError SubmitExplicitTimingData()
+	{
+		STUB_CALL();
+		if (m_TimingMode == vr::VRCompositorTimingMode_Implicit)
+			return vr::VRCompositorError_RequestFailed;
+		return vr::VRCompositorError_None;
+	}
+
+	virtual bool IsMotionSmoothingEnabled() { STUB_CALL(); return false; }
+	virtual bool IsMotionSmoothingSupported() { STUB_CALL(); return false; }
+	virtual bool IsCurrentSceneFocusAppLoading() { STUB_CALL(); return false; }
+
+	virtual vr::EVRCompositorError SetStageOverride_Async(const char* pchRenderModelPath, const vr::HmdMatrix34_t* pTransform,
+		const vr::Compositor_StageRenderSettings* pRenderSettings, uint32_t nSizeOfRenderSettings)
+	{
+		STUB_CALL();
+		return vr::VRCompositorError_None;
+	}
+
+	virtual void ClearStageOverride() { STUB_CALL(); }
+	virtual bool GetCompositorBenchmarkResults(vr::Compositor_BenchmarkResults* pBenchmarkResults, uint32_t nSizeOfBenchmarkResults) { STUB_CALL(); return false; }
+
+	// Prediction IDs are the frame indices, so poses of any frame can be reproduced from the script
+	virtual vr::EVRCompositorError GetLastPosePredictionIDs(uint32_t* pRenderPosePredictionID, uint32_t* pGamePosePredictionID)
+	{
+		STUB_CALL();
+		uint32_t frame = StubCore::Get().GetFrameIndex();
+		if (pRenderPosePredictionID)
+			*pRenderPosePredictionID = frame;
+		if (pGamePosePredictionID)
+			*pGamePosePredictionID = frame + 1;
+		return vr::VRCompositorError_None;
+	}
+
+	virtual vr::EVRCompositorError GetPosesForFrame(uint32_t unPosePredictionID, vr::TrackedDevicePose_t* pPoseArray, uint32_t unPoseArrayCount)
+	{
+		STUB_CALL();
+		StubCore& core = StubCore::Get();
+		std::lock_guard<std::mutex> lk(core.Mutex);
+		if (unPosePredictionID > core.GetFrameIndex() + 1)
+			return vr::VRCompositorError_RequestFailed;
+
+		for (uint32_t i = 0; i < unPoseArrayCount; i++)
+			pPoseArray[i] = core.GetPose(i, core.TrackingSpace, core.GetVsyncTime(unPosePredictionID + 1));
+		return vr::VRCompositorError_None;
+	}
+
+private:
+	vr::TrackedDevicePose_t m_RenderPoses[vr::k_unMaxTrackedDeviceCount];
+	vr::TrackedDevicePose_t m_GamePoses[vr::k_unMaxTrackedDeviceCount];
+	vr::Compositor_FrameTiming m_Timings[STUB_TIMING_HISTORY];
+	uint32_t m_Presents;
+	bool m_Submitted[2];
+	vr::EVRCompositorTimingMode m_TimingMode;
+	uint32_t m_Session;
+
+	// Drops the state of a previous initialization, called with the core mutex held
+	void Sync()
+	{
+		StubCore& core = StubCore::Get();
+		if (m_Session == core.GetSession())
+			return;
+
+		memset(m_RenderPoses, 0, sizeof(m_RenderPoses));
+		memset(m_GamePoses, 0, sizeof(m_GamePoses));
+		memset(m_Timings, 0, sizeof(m_Timings));
+		m_Presents = 0;
+		m_Submitted[vr::Eye_Left] = m_Submitted[vr::Eye_Right] = false;
+		m_Session = core.GetSession();
+	}
+
+	// Called with the core mutex held
+	void Present()
+	{
+		StubCore& core = StubCore::Get();
+		vr::Compositor_FrameTiming& timing = m_Timings[core.GetFrameIndex() % STUB_TIMING_HISTORY];
+		if (timing.m_nNumFramePresents == 0)
+		{
+			timing.m_flSubmitFrameMs = (float)((core.Now() - core.GetVsyncTime(core.GetFrameIndex() - 1)) * 1000.0);
+			m_Presents++;
+		}
+		timing.m_nNumFramePresents++;
+	}
+};
+
+vr::IVRCompositor* GetStubCompositor()
+{
+	static StubCompositor s_Compositor;
+	return &s_Compositor;
+}
@@ -0,0 +1,234 @@
+#include "StubCore.h"
+
+#include <Windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <memory>
+
+static std::mutex s_CallMutex;
+static std::map<std::string, std::unique_ptr<StubCall>> s_Calls;
+
+static int64_t GetTicks()
+{
+	LARGE_INTEGER ticks;
+	QueryPerformanceCounter(&ticks);
+	return ticks.QuadPart;
+}
+
+static int64_t GetFrequency()
+{
+	static int64_t s_Frequency = 0;
+	if (!s_Frequency)
+	{
+		LARGE_INTEGER freq;
+		QueryPerformanceFrequency(&freq);
+		s_Frequency = freq.QuadPart;
+	}
+	return s_Frequency;
+}
+
+void StubDelay(double seconds)
+{
+	int64_t target = GetTicks() + (int64_t)(seconds * GetFrequency());
+	if (seconds > 0.002)
+		Sleep((DWORD)(seconds * 1000.0) - 1);
+	while (GetTicks() < target)
+		YieldProcessor();
+}
+
+/* Call statistics */
+
+void StubCall::Enter()
+{
+	Count.fetch_add(1, std::memory_order_relaxed);
+	int64_t latency = Latency.load(std::memory_order_relaxed);
+	if (latency > 0)
+		StubDelay((double)latency / GetFrequency());
+}
+
+StubCall& GetStubCall(const char* name)
+{
+	// Report the method under the interface it implements
+	std::string key(name);
+	if (key.compare(0, 4, "Stub") == 0)
+		key.replace(0, 4, "IVR");
+
+	std::lock_guard<std::mutex> lk(s_CallMutex);
+	std::unique_ptr<StubCall>& call = s_Calls[key];
+	if (!call)
+		call.reset(new StubCall());
+	return *call;
+}
+
+/* Simulated system */
+
+StubCore& StubCore::Get()
+{
+	static StubCore s_Core;
+	return s_Core;
+}
+
+StubCore::StubCore()
+	: TrackingSpace(vr::TrackingUniverseSeated)
+	, Connected{}
+	, m_Start(0)
+	, m_Session(0)
+	, m_FrameIndex(0)
+	, m_NextEvent(0)
+{
+}
+
+void StubCore::Init()
+{
+	std::lock_guard<std::mutex> lk(Mutex);
+	Script = StubScript();
+	const char* path = getenv("REVIVE_VR_STUB_SCRIPT");
+	if (path && !Script.Load(path))
+		fprintf(stderr, "ReviveVRStub: failed to load script %s\n", path);
+
+	for (auto& it : Script.Latencies)
+		GetStubCall(it.first.c_str()).Latency = (int64_t)(it.second * GetFrequency() / 1000.0);
+
+	TrackingSpace = vr::TrackingUniverseSeated;
+	std::fill(Connected, Connected + STUB_DEVICE_COUNT, true);
+	m_Start = GetTicks();
+	m_Session++;
+	m_FrameIndex = 0;
+	m_NextEvent = 0;
+}
+
+void StubCore::Shutdown()
+{
+	const char* stats = getenv("REVIVE_VR_STUB_STATS");
+	FILE* file = stats ? fopen(stats, "w") : nullptr;
+	{
+		std::lock_guard<std::mutex> lk(s_CallMutex);
+		for (auto& it : s_Calls)
+		{
+			if (file)
+				fprintf(file, "%s %llu\n", it.first.c_str(), (unsigned long long)it.second->Count.load());
+
+			// The next initialization starts with fresh counters, so the traffic of a single run can be asserted on
+			it.second->Count = 0;
+			it.second->Latency = 0;
+		}
+	}
+	if (file)
+		fclose(file);
+}
+
+double StubCore::Now() const
+{
+	return (double)(GetTicks() - m_Start) / GetFrequency();
+}
+
+uint32_t StubCore::BeginFrame()
+{
+	uint32_t frame;
+	double stall = 0.0;
+	{
+		std::lock_guard<std::mutex> lk(Mutex);
+		frame = ++m_FrameIndex;
+		auto it = Script.Stalls.find(frame);
+		if (it != Script.Stalls.end())
+			stall = it->second / 1000.0;
+	}
+
+	if (Script.VSync)
+	{
+		double wait = GetVsyncTime(frame) - Now();
+		if (wait > 0.0)
+			StubDelay(wait);
+	}
+	if (stall > 0.0)
+		StubDelay(stall);
+	return frame;
+}
+
+double StubCore::GetLastVsync() const
+{
+	// Without vsync the display runs as fast as frames are started
+	if (!Script.VSync)
+		return GetVsyncTime(m_FrameIndex);
+	return floor(Now() / GetPeriod()) * GetPeriod();
+}
+
+vr::HmdMatrix34_t StubCore::GetSeatedToStanding() const
+{
+	return StubMath::Translation(0.0f, Script.FloorHeight, 0.0f);
+}
+
+vr::TrackedDevicePose_t StubCore::GetPose(vr::TrackedDeviceIndex_t device, vr::ETrackingUniverseOrigin origin, double time)
+{
+	vr::TrackedDevicePose_t pose = {};
+	if (device >= STUB_DEVICE_COUNT || !Connected[device])
+	{
+		pose.eTrackingResult = vr::TrackingResult_Uninitialized;
+		return pose;
+	}
+
+	// Velocities are taken from the difference over a millisecond
+	const double delta = 0.001;
+	StubPose current = Script.GetPose(device, time);
+	StubPose next = Script.GetPose(device, time + delta);
+	if (origin != vr::TrackingUniverseSeated)
+	{
+		current.Position.v[1] += Script.FloorHeight;
+		next.Position.v[1] += Script.FloorHeight;
+	}
+
+	for (int i = 0; i < 3; i++)
+		pose.vVelocity.v[i] = (float)((next.Position.v[i] - current.Position.v[i]) / delta);
+
+	// Angular velocity from the rotation between both orientations
+	vr::HmdQuaternionf_t diff = StubMath::Multiply(next.Orientation, StubMath::Conjugate(current.Orientation));
+	float s = diff.w < 0.0f ? -2.0f : 2.0f;
+	pose.vAngularVelocity = { (float)(s * diff.x / delta), (float)(s * diff.y / delta), (float)(s * diff.z / delta) };
+
+	pose.mDeviceToAbsoluteTracking = StubMath::ToMatrix(current);
+	pose.eTrackingResult = vr::TrackingResult_Running_OK;
+	pose.bPoseIsValid = true;
+	pose.bDeviceIsConnected = true;
+	return pose;
+}
+
+bool StubCore::PollEvent(vr::VREvent_t* event, uint32_t size)
+{
+	std::lock_guard<std::mutex> lk(Mutex);
+	if (m_NextEvent >= Script.Events.size())
+		return false;
+
+	double now = Now();
+	const StubScript::Event& next = Script.Events[m_NextEvent];
+	if (next.Time > now)
+		return false;
+	m_NextEvent++;
+
+	if (next.Device < STUB_DEVICE_COUNT)
+	{
+		if (next.Type == vr::VREvent_TrackedDeviceActivated)
+			Connected[next.Device] = true;
+		else if (next.Type == vr::VREvent_TrackedDeviceDeactivated)
+			Connected[next.Device] = false;
+	}
+
+	if (event)
+	{
+		memset(event, 0, std::min(size, (uint32_t)sizeof(vr::VREvent_t)));
+		event->eventType = next.Type;
+		event->trackedDeviceIndex = next.Device;
+		event->eventAgeSeconds = (float)(now - next.Time);
+	}
+	return true;
+}
+
+uint32_t StubCopyString(const std::string& value, char* buffer, uint32_t size)
+{
+	uint32_t required = (uint32_t)value.size() + 1;
+	if (buffer && size > 0)
+		strncpy_s(buffer, size, value.c_str(), _TRUNCATE);
+	return required;
+}
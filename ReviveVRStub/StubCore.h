@@ -0,0 +1,79 @@
+#pragma once
+
+#include "StubScript.h"
+
+#include <openvr.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+
+// Per-method call counter and injected latency
+struct StubCall
+{
+	std::atomic_uint64_t Count;
+	std::atomic_int64_t Latency;
+
+	void Enter();
+};
+
+// Counters are never freed, so the static references held by the methods stay valid
+StubCall& GetStubCall(const char* name);
+
+// Counts the call under the name of the interface method, eg. StubSystem::PollNextEvent is
+// counted as IVRSystem::PollNextEvent
+#define STUB_CALL() \
+	static StubCall& __stub_call = GetStubCall(__FUNCTION__); \
+	__stub_call.Enter();
+
+// Shared state of the simulated system, reset every time the client core is initialized
+class StubCore
+{
+public:
+	static StubCore& Get();
+
+	std::mutex Mutex;
+	StubScript Script;
+	vr::ETrackingUniverseOrigin TrackingSpace;
+	bool Connected[STUB_DEVICE_COUNT];
+
+	void Init();
+	void Shutdown();
+
+	// Seconds since initialization, all script times are relative to this clock
+	double Now() const;
+	double GetPeriod() const { return 1.0 / Script.RefreshRate; }
+
+	// Starts the next frame and returns its index, blocks until its vsync when enabled
+	uint32_t BeginFrame();
+	uint32_t GetFrameIndex() const { return m_FrameIndex; }
+	uint32_t GetSession() const { return m_Session; }
+	double GetVsyncTime(uint32_t frame) const { return frame * GetPeriod(); }
+	double GetLastVsync() const;
+
+	vr::TrackedDevicePose_t GetPose(vr::TrackedDeviceIndex_t device, vr::ETrackingUniverseOrigin origin, double time);
+	vr::HmdMatrix34_t GetSeatedToStanding() const;
+	bool PollEvent(vr::VREvent_t* event, uint32_t size);
+
+private:
+	StubCore();
+
+	int64_t m_Start;
+	uint32_t m_Session;
+	uint32_t m_FrameIndex;
+	size_t m_NextEvent;
+};
+
+// Sleeps for most of the interval and spins for the remainder
+void StubDelay(double seconds);
+
+vr::IVRSystem* GetStubSystem();
+vr::IVRCompositor* GetStubCompositor();
+vr::IVROverlay* GetStubOverlay();
+vr::IVRInput* GetStubInput();
+vr::IVRChaperone* GetStubChaperone();
+vr::IVRChaperoneSetup* GetStubChaperoneSetup();
+vr::IVRSettings* GetStubSettings();
+vr::IVRApplications* GetStubApplications();
+
+// Copies a string into a caller-provided buffer and returns the required size including the terminator
+uint32_t StubCopyString(const std::string& value, char* buffer, uint32_t size);
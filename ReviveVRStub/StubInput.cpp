@@ -0,0 +1,381 @@
+#include "StubCore.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+
+// Actions are not bound to devices, their values are looked up by name in the script
+class StubInput : public vr::IVRInput
+{
+public:
+	StubInput()
+		: m_SyncTime(0.0)
+		, m_PrevSyncTime(0.0)
+		, m_DominantHand(vr::TrackedControllerRole_RightHand)
+	{
+		m_Names.push_back("");
+	}
+
+	virtual vr::EVRInputError SetActionManifestPath(const char* pchActionManifestPath)
+	{
+		STUB_CALL();
+		FILE* file = pchActionManifestPath ? fopen(pchActionManifestPath, "r") : nullptr;
+		if (!file)
+			return vr::VRInputError_InvalidParam;
+		fclose(file);
+		return vr::VRInputError_None;
+	}
+
+	virtual vr::EVRInputError GetActionSetHandle(const char* pchActionSetName, vr::VRActionSetHandle_t* pHandle)
+	{
+		STUB_CALL();
+		return GetHandle(pchActionSetName, pHandle);
+	}
+
+	virtual vr::EVRInputError GetActionHandle(const char* pchActionName, vr::VRActionHandle_t* pHandle)
+	{
+		STUB_CALL();
+		return GetHandle(pchActionName, pHandle);
+	}
+
+	virtual vr::EVRInputError GetInputSourceHandle(const char* pchInputSourcePath, vr::VRInputValueHandle_t* pHandle)
+	{
+		STUB_CALL();
+		return GetHandle(pchInputSourcePath, pHandle);
+	}
+
+	virtual vr::EVRInputError UpdateActionState(vr::VRActiveActionSet_t* pSets, uint32_t unSizeOfVRSelectedActionSet_t, uint32_t unSetCount)
+	{
+		STUB_CALL();
+		if (unSizeOfVRSelectedActionSet_t != sizeof(vr::VRActiveActionSet_t))
+			return vr::VRInputError_InvalidParam;
+		if (!pSets || unSetCount == 0)
+			return vr::VRInputError_NoActiveActionSet;
+
+		std::lock_guard<std::mutex> lk(m_Mutex);
+		m_PrevSyncTime = m_SyncTime;
+		m_SyncTime = StubCore::Get().Now();
+		return vr::VRInputError_None;
+	}
+
+	virtual vr::EVRInputError GetDigitalActionData(vr::VRActionHandle_t action, vr::InputDigitalActionData_t* pActionData, uint32_t unActionDataSize,
+		vr::VRInputValueHandle_t ulRestrictToDevice)
+	{
+		STUB_CALL();
+		if (!pActionData || unActionDataSize != sizeof(vr::InputDigitalActionData_t))
+			return vr::VRInputError_InvalidParam;
+
+		vr::HmdVector2_t current, previous;
+		double age;
+		vr::EVRInputError err = GetValues(action, ulRestrictToDevice, current, previous, age);
+		if (err != vr::VRInputError_None)
+			return err;
+
+		pActionData->bActive = true;
+		pActionData->activeOrigin = ulRestrictToDevice;
+		pActionData->bState = current.v[0] != 0.0f;
+		pActionData->bChanged = pActionData->bState != (previous.v[0] != 0.0f);
+		pActionData->fUpdateTime = (float)-age;
+		return vr::VRInputError_None;
+	}
+
+	virtual vr::EVRInputError GetAnalogActionData(vr::VRActionHandle_t action, vr::InputAnalogActionData_t* pActionData, uint32_t unActionDataSize,
+		vr::VRInputValueHandle_t ulRestrictToDevice)
+	{
+		STUB_CALL();
+		if (!pActionData || unActionDataSize != sizeof(vr::InputAnalogActionData_t))
+			return vr::VRInputError_InvalidParam;
+
+		vr::HmdVector2_t current, previous;
+		double age;
+		vr::EVRInputError err = GetValues(action, ulRestrictToDevice, current, previous, age);
+		if (err != vr::VRInputError_None)
+			return err;
+
+		pActionData->bActive = true;
+		pActionData->activeOrigin = ulRestrictToDevice;
+		pActionData->x = current.v[0];
+		pActionData->y = current.v[1];
+		pActionData->z = 0.0f;
+		pActionData->deltaX = current.v[0] - previous.v[0];
+		pActionData->deltaY = current.v[1] - previous.v[1];
+		pActionData->deltaZ = 0.0f;
+		pActionData->fUpdateTime = (float)-age;
+		return vr::VRInputError_None;
+	}
+
+	virtual vr::EVRInputError GetPoseActionDataRelativeToNow(vr::VRActionHandle_t action, vr::ETrackingUniverseOrigin eOrigin, float fPredictedSecondsFromNow,
+		vr::InputPoseActionData_t* pActionData, uint32_t unActionDataSize, vr::VRInputValueHandle_t ulRestrictToDevice)
+	{
+		STUB_CALL();
+		StubCore& core = StubCore::Get();
+		return GetPose(action, eOrigin, core.Now() + fPredictedSecondsFromNow, pActionData, unActionDataSize, ulRestrictToDevice);
+	}
+
+	virtual vr::EVRInputError GetPoseActionDataForNextFrame(vr::VRActionHandle_t action, vr::ETrackingUniverseOrigin eOrigin, vr::InputPoseActionData_t* pActionData,
+		uint32_t unActionDataSize, vr::VRInputValueHandle_t ulRestrictToDevice)
+	{
+		STUB_CALL();
+		StubCore& core = StubCore::Get();
+		return GetPose(action, eOrigin, core.GetVsyncTime(core.GetFrameIndex() + 1), pActionData, unActionDataSize, ulRestrictToDevice);
+	}
+
+	// Skeletal input is not simulated
+	virtual vr::EVRInputError GetSkeletalActionData(vr::VRActionHandle_t action, vr::InputSkeletalActionData_t* pActionData, uint32_t unActionDataSize)
+	{
+		STUB_CALL();
+		if (!pActionData || unActionDataSize != sizeof(vr::InputSkeletalActionData_t))
+			return vr::VRInputError_InvalidParam;
+		memset(pActionData, 0, unActionDataSize);
+		return vr::VRInputError_None;
+	}
+
+	virtual vr::EVRInputError GetDominantHand(vr::ETrackedControllerRole* peDominantHand)
+	{
+		STUB_CALL();
+		*peDominantHand = m_DominantHand;
+		return vr::VRInputError_None;
+	}
+
+	virtual vr::EVRInputError SetDominantHand(vr::ETrackedControllerRole eDominantHand)
+	{
+		STUB_CALL();
+		m_DominantHand = eDominantHand;
+		return vr::VRInputError_None;
+	}
+
+	virtual vr::EVRInputError GetBoneCount(vr::VRActionHandle_t action, uint32_t* pBoneCount) { STUB_CALL(); return vr::VRInputError_InvalidSkeleton; }
+	virtual vr::EVRInputError GetBoneHierarchy(vr::VRActionHandle_t action, vr::BoneIndex_t* pParentIndices, uint32_t unIndexArayCount) { STUB_CALL(); return vr::VRInputError_InvalidSkeleton; }
+	virtual vr::EVRInputError GetBoneName(vr::VRActionHandle_t action, vr::BoneIndex_t nBoneIndex, char* pchBoneName, uint32_t unNameBufferSize) { STUB_CALL(); return vr::VRInputError_InvalidSkeleton; }
+
+	virtual vr::EVRInputError GetSkeletalReferenceTransforms(vr::VRActionHandle_t action, vr::EVRSkeletalTransformSpace eTransformSpace,
+		vr::EVRSkeletalReferencePose eReferencePose, vr::VRBoneTransform_t* pTransformArray, uint32_t unTransformArrayCount)
+	{
+		STUB_CALL();
+		return vr::VRInputError_InvalidSkeleton;
+	}
+
+	virtual vr::EVRInputError GetSkeletalTrackingLevel(vr::VRActionHandle_t action, vr::EVRSkeletalTrackingLevel* pSkeletalTrackingLevel)
+	{
+		STUB_CALL();
+		*pSkeletalTrackingLevel = vr::VRSkeletalTracking_Estimated;
+		return vr::VRInputError_None;
+	}
+
+	virtual vr::EVRInputError GetSkeletalBoneData(vr::VRActionHandle_t action, vr::EVRSkeletalTransformSpace eTransformSpace,
+		vr::EVRSkeletalMotionRange eMotionRange, vr::VRBoneTransform_t* pTransformArray, uint32_t unTransformArrayCount)
+	{
+		STUB_CALL();
+		return vr::VRInputError_NoData;
+	}
+
+	virtual vr::EVRInputError GetSkeletalSummaryData(vr::VRActionHandle_t action, vr::EVRSummaryType eSummaryType, vr::VRSkeletalSummaryData_t* pSkeletalSummaryData)
+	{
+		STUB_CALL();
+		return vr::VRInputError_NoData;
+	}
+
+	virtual vr::EVRInputError GetSkeletalBoneDataCompressed(vr::VRActionHandle_t action, vr::EVRSkeletalMotionRange eMotionRange, void* pvCompressedData,
+		uint32_t unCompressedSize, uint32_t* punRequiredCompressedSize)
+	{
+		STUB_CALL();
+		return vr::VRInputError_NoData;
+	}
+
+	virtual vr::EVRInputError DecompressSkeletalBoneData(const void* pvCompressedBuffer, uint32_t unCompressedBufferSize, vr::EVRSkeletalTransformSpace eTransformSpace,
+		vr::VRBoneTransform_t* pTransformArray, uint32_t unTransformArrayCount)
+	{
+		STUB_CALL();
+		return vr::VRInputError_InvalidCompressedData;
+	}
+
+	virtual vr::EVRInputError TriggerHapticVibrationAction(vr::VRActionHandle_t action, float fStartSecondsFromNow, float fDurationSeconds, float fFrequency,
+		float fAmplitude, vr::VRInputValueHandle_t ulRestrictToDevice)
+	{
+		STUB_CALL();
+		std::lock_guard<std::mutex> lk(m_Mutex);
+		return action < m_Names.size() ? vr::VRInputError_None : vr::VRInputError_InvalidHandle;
+	}
+
+	virtual vr::EVRInputError GetActionOrigins(vr::VRActionSetHandle_t actionSetHandle, vr::VRActionHandle_t digitalActionHandle, vr::VRInputValueHandle_t* originsOut,
+		uint32_t originOutCount)
+	{
+		STUB_CALL();
+		if (originsOut)
+			memset(originsOut, 0, originOutCount * sizeof(vr::VRInputValueHandle_t));
+		return vr::VRInputError_None;
+	}
+
+	virtual vr::EVRInputError GetOriginLocalizedName(vr::VRInputValueHandle_t origin, char* pchNameArray, uint32_t unNameArraySize, int32_t unStringSectionsToInclude)
+	{
+		STUB_CALL();
+		std::lock_guard<std::mutex> lk(m_Mutex);
+		if (origin >= m_Names.size())
+			return vr::VRInputError_InvalidHandle;
+		if (StubCopyString(m_Names[origin], pchNameArray, unNameArraySize) > unNameArraySize)
+			return vr::VRInputError_BufferTooSmall;
+		return vr::VRInputError_None;
+	}
+
+	virtual vr::EVRInputError GetOriginTrackedDeviceInfo(vr::VRInputValueHandle_t origin, vr::InputOriginInfo_t* pOriginInfo, uint32_t unOriginInfoSize)
+	{
+		STUB_CALL();
+		if (!pOriginInfo || unOriginInfoSize != sizeof(vr::InputOriginInfo_t))
+			return vr::VRInputError_InvalidParam;
+
+		std::lock_guard<std::mutex> lk(m_Mutex);
+		if (origin >= m_Names.size())
+			return vr::VRInputError_InvalidHandle;
+
+		memset(pOriginInfo, 0, sizeof(vr::InputOriginInfo_t));
+		pOriginInfo->devicePath = origin;
+		pOriginInfo->trackedDeviceIndex = GetDevice(origin);
+		return vr::VRInputError_None;
+	}
+
+	virtual vr::EVRInputError GetActionBindingInfo(vr::VRActionHandle_t action, vr::InputBindingInfo_t* pOriginInfo, uint32_t unBindingInfoSize,
+		uint32_t unBindingInfoCount, uint32_t* punReturnedBindingInfoCount)
+	{
+		STUB_CALL();
+		if (punReturnedBindingInfoCount)
+			*punReturnedBindingInfoCount = 0;
+		return vr::VRInputError_None;
+	}
+
+	virtual vr::EVRInputError ShowActionOrigins(vr::VRActionSetHandle_t actionSetHandle, vr::VRActionHandle_t ulActionHandle) { STUB_CALL(); return vr::VRInputError_None; }
+
+	virtual vr::EVRInputError ShowBindingsForActionSet(vr::VRActiveActionSet_t* pSets, uint32_t unSizeOfVRSelectedActionSet_t, uint32_t unSetCount,
+		vr::VRInputValueHandle_t originToHighlight)
+	{
+		STUB_CALL();
+		return vr::VRInputError_None;
+	}
+
+	virtual vr::EVRInputError GetComponentStateForBinding(const char* pchRenderModelName, const char* pchComponentName, const vr::InputBindingInfo_t* pOriginInfo,
+		uint32_t unBindingInfoSize, uint32_t unBindingInfoCount, vr::RenderModel_ComponentState_t* pComponentState)
+	{
+		STUB_CALL();
+		return vr::VRInputError_NoData;
+	}
+
+	virtual bool IsUsingLegacyInput() { STUB_CALL(); return false; }
+
+	virtual vr::EVRInputError OpenBindingUI(const char* pchAppKey, vr::VRActionSetHandle_t ulActionSetHandle, vr::VRInputValueHandle_t ulDeviceHandle, bool bShowOnDesktop)
+	{
+		STUB_CALL();
+		return vr::VRInputError_None;
+	}
+
+	virtual vr::EVRInputError GetBindingVariant(vr::VRInputValueHandle_t ulDevicePath, char* pchVariantArray, uint32_t unVariantArraySize)
+	{
+		STUB_CALL();
+		StubCopyString("", pchVariantArray, unVariantArraySize);
+		return vr::VRInputError_None;
+	}
+
+private:
+	std::mutex m_Mutex;
+
+	// Action sets, actions and input sources share a single namespace of handles
+	std::vector<std::string> m_Names;
+	std::map<std::string, uint64_t> m_Handles;
+
+	double m_SyncTime;
+	double m_PrevSyncTime;
+	vr::ETrackedControllerRole m_DominantHand;
+
+	vr::EVRInputError GetHandle(const char* name, uint64_t* handle)
+	{
+		if (!name || !handle || name[0] != '/')
+			return vr::VRInputError_InvalidParam;
+
+		std::lock_guard<std::mutex> lk(m_Mutex);
+		auto it = m_Handles.find(name);
+		if (it == m_Handles.end())
+		{
+			it = m_Handles.emplace(name, m_Names.size()).first;
+			m_Names.push_back(name);
+		}
+		*handle = it->second;
+		return vr::VRInputError_None;
+	}
+
+	// Called with the input mutex held
+	vr::TrackedDeviceIndex_t GetDevice(vr::VRInputValueHandle_t source)
+	{
+		const std::string& path = m_Names[source];
+		if (path == "/user/head")
+			return vr::k_unTrackedDeviceIndex_Hmd;
+		if (path == "/user/hand/left")
+			return 1;
+		if (path == "/user/hand/right")
+			return 2;
+		return vr::k_unTrackedDeviceIndexInvalid;
+	}
+
+	// Returns the input values at the last two calls to UpdateActionState, keys restricted to an input source take priority
+	vr::EVRInputError GetValues(vr::VRActionHandle_t action, vr::VRInputValueHandle_t source, vr::HmdVector2_t& current, vr::HmdVector2_t& previous, double& age)
+	{
+		std::string key;
+		double sync, prevSync;
+		{
+			std::lock_guard<std::mutex> lk(m_Mutex);
+			if (action == vr::k_ulInvalidActionHandle || action >= m_Names.size())
+				return vr::VRInputError_InvalidHandle;
+			if (source >= m_Names.size())
+				return vr::VRInputError_InvalidDevice;
+
+			key = m_Names[action];
+			if (source != vr::k_ulInvalidInputValueHandle)
+				key += "@" + m_Names[source];
+			sync = m_SyncTime;
+			prevSync = m_PrevSyncTime;
+		}
+
+		StubCore& core = StubCore::Get();
+		std::lock_guard<std::mutex> lk(core.Mutex);
+		const StubScript& script = core.Script;
+		current = script.GetValue(key, sync);
+		previous = script.GetValue(key, prevSync);
+		if (source != vr::k_ulInvalidInputValueHandle && current.v[0] == 0.0f && current.v[1] == 0.0f && previous.v[0] == 0.0f && previous.v[1] == 0.0f)
+		{
+			key.erase(key.find('@'));
+			current = script.GetValue(key, sync);
+			previous = script.GetValue(key, prevSync);
+		}
+		age = core.Now() - sync;
+		return vr::VRInputError_None;
+	}
+
+	vr::EVRInputError GetPose(vr::VRActionHandle_t action, vr::ETrackingUniverseOrigin origin, double time, vr::InputPoseActionData_t* pActionData,
+		uint32_t unActionDataSize, vr::VRInputValueHandle_t source)
+	{
+		if (!pActionData || unActionDataSize != sizeof(vr::InputPoseActionData_t))
+			return vr::VRInputError_InvalidParam;
+
+		vr::TrackedDeviceIndex_t device;
+		{
+			std::lock_guard<std::mutex> lk(m_Mutex);
+			if (action == vr::k_ulInvalidActionHandle || action >= m_Names.size())
+				return vr::VRInputError_InvalidHandle;
+			if (source >= m_Names.size())
+				return vr::VRInputError_InvalidDevice;
+			device = source != vr::k_ulInvalidInputValueHandle ? GetDevice(source) : vr::k_unTrackedDeviceIndexInvalid;
+		}
+
+		StubCore& core = StubCore::Get();
+		std::lock_guard<std::mutex> lk(core.Mutex);
+		pActionData->bActive = device < STUB_DEVICE_COUNT && core.Connected[device];
+		pActionData->activeOrigin = source;
+		pActionData->pose = core.GetPose(device, origin, time);
+		return vr::VRInputError_None;
+	}
+};
+
+vr::IVRInput* GetStubInput()
+{
+	static StubInput s_Input;
+	return &s_Input;
+}
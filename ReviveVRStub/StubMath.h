@@ -0,0 +1,107 @@
+#pragma once
+
+#include <openvr.h>
+#include <math.h>
+
+// Rigid transform in the tracking space, OpenVR only exposes poses as matrices
+struct StubPose
+{
+	vr::HmdQuaternionf_t Orientation;
+	vr::HmdVector3_t Position;
+};
+
+namespace StubMath
+{
+	inline StubPose Identity()
+	{
+		StubPose pose = { { 1.0f, 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } };
+		return pose;
+	}
+
+	inline vr::HmdQuaternionf_t Multiply(const vr::HmdQuaternionf_t& a, const vr::HmdQuaternionf_t& b)
+	{
+		vr::HmdQuaternionf_t q;
+		q.x = a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y;
+		q.y = a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x;
+		q.z = a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w;
+		q.w = a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z;
+		return q;
+	}
+
+	inline vr::HmdQuaternionf_t Conjugate(const vr::HmdQuaternionf_t& q)
+	{
+		vr::HmdQuaternionf_t c = { q.w, -q.x, -q.y, -q.z };
+		return c;
+	}
+
+	inline vr::HmdVector3_t Rotate(const vr::HmdQuaternionf_t& q, const vr::HmdVector3_t& v)
+	{
+		vr::HmdQuaternionf_t p = { 0.0f, v.v[0], v.v[1], v.v[2] };
+		vr::HmdQuaternionf_t r = Multiply(Multiply(q, p), Conjugate(q));
+		vr::HmdVector3_t result = { r.x, r.y, r.z };
+		return result;
+	}
+
+	// Transforms the child pose from the parent space into the space the parent is expressed in
+	inline StubPose Transform(const StubPose& parent, const StubPose& child)
+	{
+		StubPose pose;
+		vr::HmdVector3_t p = Rotate(parent.Orientation, child.Position);
+		pose.Position = { parent.Position.v[0] + p.v[0], parent.Position.v[1] + p.v[1], parent.Position.v[2] + p.v[2] };
+		pose.Orientation = Multiply(parent.Orientation, child.Orientation);
+		return pose;
+	}
+
+	inline vr::HmdQuaternionf_t Normalize(const vr::HmdQuaternionf_t& q)
+	{
+		float length = sqrtf(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+		if (length <= 0.0f)
+			return Identity().Orientation;
+		vr::HmdQuaternionf_t n = { q.w / length, q.x / length, q.y / length, q.z / length };
+		return n;
+	}
+
+	// Linear interpolation of the position and normalized interpolation of the orientation
+	inline StubPose Lerp(const StubPose& a, const StubPose& b, float t)
+	{
+		// Take the shortest path between the orientations
+		float dot = a.Orientation.x * b.Orientation.x + a.Orientation.y * b.Orientation.y +
+			a.Orientation.z * b.Orientation.z + a.Orientation.w * b.Orientation.w;
+		float s = dot < 0.0f ? -1.0f : 1.0f;
+
+		StubPose pose;
+		for (int i = 0; i < 3; i++)
+			pose.Position.v[i] = a.Position.v[i] + (b.Position.v[i] - a.Position.v[i]) * t;
+		pose.Orientation.x = a.Orientation.x + (s * b.Orientation.x - a.Orientation.x) * t;
+		pose.Orientation.y = a.Orientation.y + (s * b.Orientation.y - a.Orientation.y) * t;
+		pose.Orientation.z = a.Orientation.z + (s * b.Orientation.z - a.Orientation.z) * t;
+		pose.Orientation.w = a.Orientation.w + (s * b.Orientation.w - a.Orientation.w) * t;
+		pose.Orientation = Normalize(pose.Orientation);
+		return pose;
+	}
+
+	inline vr::HmdMatrix34_t ToMatrix(const StubPose& pose)
+	{
+		const vr::HmdQuaternionf_t& q = pose.Orientation;
+		vr::HmdMatrix34_t m;
+		m.m[0][0] = 1.0f - 2.0f * (q.y * q.y + q.z * q.z);
+		m.m[0][1] = 2.0f * (q.x * q.y - q.z * q.w);
+		m.m[0][2] = 2.0f * (q.x * q.z + q.y * q.w);
+		m.m[1][0] = 2.0f * (q.x * q.y + q.z * q.w);
+		m.m[1][1] = 1.0f - 2.0f * (q.x * q.x + q.z * q.z);
+		m.m[1][2] = 2.0f * (q.y * q.z - q.x * q.w);
+		m.m[2][0] = 2.0f * (q.x * q.z - q.y * q.w);
+		m.m[2][1] = 2.0f * (q.y * q.z + q.x * q.w);
+		m.m[2][2] = 1.0f - 2.0f * (q.x * q.x + q.y * q.y);
+		for (int i = 0; i < 3; i++)
+			m.m[i][3] = pose.Position.v[i];
+		return m;
+	}
+
+	inline vr::HmdMatrix34_t Translation(float x, float y, float z)
+	{
+		StubPose pose = Identity();
+		pose.Position = { x, y, z };
+		return ToMatrix(pose);
+	}
+}
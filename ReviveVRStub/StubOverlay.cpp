@@ -0,0 +1,650 @@
+#include "StubCore.h"
+
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+
+// Maximum number of events queued per overlay, older events are dropped when nobody polls them
+#define STUB_OVERLAY_EVENTS 64
+
+// Overlays only keep their properties, nothing is ever composited
+struct StubOverlayState
+{
+	std::string Key;
+	std::string Name;
+	uint32_t Flags;
+	bool Visible;
+	bool Textured;
+	float Color[3];
+	float Alpha;
+	float TexelAspect;
+	float Width;
+	float Curvature;
+	uint32_t SortOrder;
+	vr::EColorSpace ColorSpace;
+	vr::VRTextureBounds_t Bounds;
+	vr::VROverlayTransformType TransformType;
+	vr::ETrackingUniverseOrigin Origin;
+	vr::TrackedDeviceIndex_t Device;
+	vr::VROverlayHandle_t Parent;
+	vr::HmdMatrix34_t Transform;
+	vr::VROverlayInputMethod InputMethod;
+	vr::HmdVector2_t MouseScale;
+	uint32_t RenderingPid;
+	std::vector<vr::VREvent_t> Events;
+};
+
+class StubOverlay : public vr::IVROverlay
+{
+public:
+	StubOverlay()
+		: m_NextHandle(1)
+	{
+	}
+
+	virtual vr::EVROverlayError FindOverlay(const char* pchOverlayKey, vr::VROverlayHandle_t* pOverlayHandle)
+	{
+		STUB_CALL();
+		std::lock_guard<std::mutex> lk(m_Mutex);
+		for (auto& it : m_Overlays)
+		{
+			if (it.second.Key == pchOverlayKey)
+			{
+				*pOverlayHandle = it.first;
+				return vr::VROverlayError_None;
+			}
+		}
+		*pOverlayHandle = vr::k_ulOverlayHandleInvalid;
+		return vr::VROverlayError_UnknownOverlay;
+	}
+
+	virtual vr::EVROverlayError CreateOverlay(const char* pchOverlayKey, const char* pchOverlayName, vr::VROverlayHandle_t* pOverlayHandle)
+	{
+		STUB_CALL();
+		if (!pchOverlayKey || !pchOverlayName || !pOverlayHandle)
+			return vr::VROverlayError_InvalidParameter;
+		if (strlen(pchOverlayKey) >= vr::k_unVROverlayMaxKeyLength)
+			return vr::VROverlayError_KeyTooLong;
+		if (strlen(pchOverlayName) >= vr::k_unVROverlayMaxNameLength)
+			return vr::VROverlayError_NameTooLong;
+
+		std::lock_guard<std::mutex> lk(m_Mutex);
+		return Create(pchOverlayKey, pchOverlayName, pOverlayHandle);
+	}
+
+	virtual vr::EVROverlayError DestroyOverlay(vr::VROverlayHandle_t ulOverlayHandle)
+	{
+		STUB_CALL();
+		std::lock_guard<std::mutex> lk(m_Mutex);
+		return m_Overlays.erase(ulOverlayHandle) ? vr::VROverlayError_None : vr::VROverlayError_InvalidHandle;
+	}
+
+	virtual uint32_t GetOverlayKey(vr::VROverlayHandle_t ulOverlayHandle, char* pchValue, uint32_t unBufferSize, vr::EVROverlayError* pError)
+	{
+		STUB_CALL();
+		std::lock_guard<std::mutex> lk(m_Mutex);
+		StubOverlayState* overlay = Find(ulOverlayHandle, pError);
+		return overlay ? StubCopyString(overlay->Key, pchValue, unBufferSize) : 0;
+	}
+
+	virtual uint32_t GetOverlayName(vr::VROverlayHandle_t ulOverlayHandle, char* pchValue, uint32_t unBufferSize, vr::EVROverlayError* pError)
+	{
+		STUB_CALL();
+		std::lock_guard<std::mutex> lk(m_Mutex);
+		StubOverlayState* overlay = Find(ulOverlayHandle, pError);
+		return overlay ? StubCopyString(overlay->Name, pchValue, unBufferSize) : 0;
+	}
+
+	virtual vr::EVROverlayError SetOverlayName(vr::VROverlayHandle_t ulOverlayHandle, const char* pchName)
+	{
+		STUB_CALL();
+		return Set(ulOverlayHandle, [&](StubOverlayState& o) { o.Name = pchName; });
+	}
+
+	virtual vr::EVROverlayError GetOverlayImageData(vr::VROverlayHandle_t ulOverlayHandle, void* pvBuffer, uint32_t unBufferSize, uint32_t* punWidth, uint32_t* punHeight)
+	{
+		STUB_CALL();
+		return vr::VROverlayError_RequestFailed;
+	}
+
+	virtual const char* GetOverlayErrorNameFromEnum(vr::EVROverlayError error)
+	{
+		STUB_CALL();
+		return error == vr::VROverlayError_None ? "VROverlayError_None" : "VROverlayError";
+	}
+
+	virtual vr::EVROverlayError SetOverlayRenderingPid(vr::VROverlayHandle_t ulOverlayHandle, uint32_t unPID)
+	{
+		STUB_CALL();
+		return Set(ulOverlayHandle, [&](StubOverlayState& o) { o.RenderingPid = unPID; });
+	}
+
+	virtual uint32_t GetOverlayRenderingPid(vr::VROverlayHandle_t ulOverlayHandle)
+	{
+		STUB_CALL();
+		uint32_t pid = 0;
+		Get(ulOverlayHandle, [&](const StubOverlayState& o) { pid = o.RenderingPid; });
+		return pid;
+	}
+
+	virtual vr::EVROverlayError SetOverlayFlag(vr::VROverlayHandle_t ulOverlayHandle, vr::VROverlayFlags eOverlayFlag, bool bEnabled)
+	{
+		STUB_CALL();
+		return Set(ulOverlayHandle, [&](StubOverlayState& o) { o.Flags = bEnabled ? o.Flags | eOverlayFlag : o.Flags & ~(uint32_t)eOverlayFlag; });
+	}
+
+	virtual vr::EVROverlayError GetOverlayFlag(vr::VROverlayHandle_t ulOverlayHandle, vr::VROverlayFlags eOverlayFlag, bool* pbEnabled)
+	{
+		STUB_CALL();
+		return Get(ulOverlayHandle, [&](const StubOverlayState& o) { *pbEnabled = (o.Flags & eOverlayFlag) != 0; });
+	}
+
+	virtual vr::EVROverlayError GetOverlayFlags(vr::VROverlayHandle_t ulOverlayHandle, uint32_t* pFlags)
+	{
+		STUB_CALL();
+		return Get(ulOverlayHandle, [&](const StubOverlayState& o) { *pFlags = o.Flags; });
+	}
+
+	virtual vr::EVROverlayError SetOverlayColor(vr::VROverlayHandle_t ulOverlayHandle, float fRed, float fGreen, float fBlue)
+	{
+		STUB_CALL();
+		return Set(ulOverlayHandle, [&](StubOverlayState& o) { o.Color[0] = fRed; o.Color[1] = fGreen; o.Color[2] = fBlue; });
+	}
+
+	virtual vr::EVROverlayError GetOverlayColor(vr::VROverlayHandle_t ulOverlayHandle, float* pfRed, float* pfGreen, float* pfBlue)
+	{
+		STUB_CALL();
+		return Get(ulOverlayHandle, [&](const StubOverlayState& o) { *pfRed = o.Color[0]; *pfGreen = o.Color[1]; *pfBlue = o.Color[2]; });
+	}
+
+	virtual vr::EVROverlayError SetOverlayAlpha(vr::VROverlayHandle_t ulOverlayHandle, float fAlpha)
+	{
+		STUB_CALL();
+		return Set(ulOverlayHandle, [&](StubOverlayState& o) { o.Alpha = fAlpha; });
+	}
+
+	virtual vr::EVROverlayError GetOverlayAlpha(vr::VROverlayHandle_t ulOverlayHandle, float* pfAlpha)
+	{
+		STUB_CALL();
+		return Get(ulOverlayHandle, [&](const StubOverlayState& o) { *pfAlpha = o.Alpha; });
+	}
+
+	virtual vr::EVROverlayError SetOverlayTexelAspect(vr::VROverlayHandle_t ulOverlayHandle, float fTexelAspect)
+	{
+		STUB_CALL();
+		return Set(ulOverlayHandle, [&](StubOverlayState& o) { o.TexelAspect = fTexelAspect; });
+	}
+
+	virtual vr::EVROverlayError GetOverlayTexelAspect(vr::VROverlayHandle_t ulOverlayHandle, float* pfTexelAspect)
+	{
+		STUB_CALL();
+		return Get(ulOverlayHandle, [&](const StubOverlayState& o) { *pfTexelAspect = o.TexelAspect; });
+	}
+
+	virtual vr::EVROverlayError SetOverlaySortOrder(vr::VROverlayHandle_t ulOverlayHandle, uint32_t unSortOrder)
+	{
+		STUB_CALL();
+		return Set(ulOverlayHandle, [&](StubOverlayState& o) { o.SortOrder = unSortOrder; });
+	}
+
+	virtual vr::EVROverlayError GetOverlaySortOrder(vr::VROverlayHandle_t ulOverlayHandle, uint32_t* punSortOrder)
+	{
+		STUB_CALL();
+		return Get(ulOverlayHandle, [&](const StubOverlayState& o) { *punSortOrder = o.SortOrder; });
+	}
+
+	virtual vr::EVROverlayError SetOverlayWidthInMeters(vr::VROverlayHandle_t ulOverlayHandle, float fWidthInMeters)
+	{
+		STUB_CALL();
+		if (fWidthInMeters < 0.0f)
+			return vr::VROverlayError_InvalidParameter;
+		return Set(ulOverlayHandle, [&](StubOverlayState& o) { o.Width = fWidthInMeters; });
+	}
+
+	virtual vr::EVROverlayError GetOverlayWidthInMeters(vr::VROverlayHandle_t ulOverlayHandle, float* pfWidthInMeters)
+	{
+		STUB_CALL();
+		return Get(ulOverlayHandle, [&](const StubOverlayState& o) { *pfWidthInMeters = o.Width; });
+	}
+
+	virtual vr::EVROverlayError SetOverlayCurvature(vr::VROverlayHandle_t ulOverlayHandle, float fCurvature)
+	{
+		STUB_CALL();
+		return Set(ulOverlayHandle, [&](StubOverlayState& o) { o.Curvature = fCurvature; });
+	}
+
+	virtual vr::EVROverlayError GetOverlayCurvature(vr::VROverlayHandle_t ulOverlayHandle, float* pfCurvature)
+	{
+		STUB_CALL();
+		return Get(ulOverlayHandle, [&](const StubOverlayState& o) { *pfCurvature = o.Curvature; });
+	}
+
+	virtual vr::EVROverlayError SetOverlayTextureColorSpace(vr::VROverlayHandle_t ulOverlayHandle, vr::EColorSpace eTextureColorSpace)
+	{
+		STUB_CALL();
+		return Set(ulOverlayHandle, [&](StubOverlayState& o) { o.ColorSpace = eTextureColorSpace; });
+	}
+
+	virtual vr::EVROverlayError GetOverlayTextureColorSpace(vr::VROverlayHandle_t ulOverlayHandle, vr::EColorSpace* peTextureColorSpace)
+	{
+		STUB_CALL();
+		return Get(ulOverlayHandle, [&](const StubOverlayState& o) { *peTextureColorSpace = o.ColorSpace; });
+	}
+
+	virtual vr::EVROverlayError SetOverlayTextureBounds(vr::VROverlayHandle_t ulOverlayHandle, const vr::VRTextureBounds_t* pOverlayTextureBounds)
+	{
+		STUB_CALL();
+		if (!pOverlayTextureBounds)
+			return vr::VROverlayError_InvalidParameter;
+		return Set(ulOverlayHandle, [&](StubOverlayState& o) { o.Bounds = *pOverlayTextureBounds; });
+	}
+
+	virtual vr::EVROverlayError GetOverlayTextureBounds(vr::VROverlayHandle_t ulOverlayHandle, vr::VRTextureBounds_t* pOverlayTextureBounds)
+	{
+		STUB_CALL();
+		return Get(ulOverlayHandle, [&](const StubOverlayState& o) { *pOverlayTextureBounds = o.Bounds; });
+	}
+
+	virtual vr::EVROverlayError GetOverlayTransformType(vr::VROverlayHandle_t ulOverlayHandle, vr::VROverlayTransformType* peTransformType)
+	{
+		STUB_CALL();
+		return Get(ulOverlayHandle, [&](const StubOverlayState& o) { *peTransformType = o.TransformType; });
+	}
+
+	virtual vr::EVROverlayError SetOverlayTransformAbsolute(vr::VROverlayHandle_t ulOverlayHandle, vr::ETrackingUniverseOrigin eTrackingOrigin,
+		const vr::HmdMatrix34_t* pmatTrackingOriginToOverlayTransform)
+	{
+		STUB_CALL();
+		return Set(ulOverlayHandle, [&](StubOverlayState& o)
+		{
+			o.TransformType = vr::VROverlayTransform_Absolute;
+			o.Origin = eTrackingOrigin;
+			o.Transform = *pmatTrackingOriginToOverlayTransform;
+		});
+	}
+
+	virtual vr::EVROverlayError GetOverlayTransformAbsolute(vr::VROverlayHandle_t ulOverlayHandle, vr::ETrackingUniverseOrigin* peTrackingOrigin,
+		vr::HmdMatrix34_t* pmatTrackingOriginToOverlayTransform)
+	{
+		STUB_CALL();
+		return Get(ulOverlayHandle, [&](const StubOverlayState& o) { *peTrackingOrigin = o.Origin; *pmatTrackingOriginToOverlayTransform = o.Transform; });
+	}
+
+	virtual vr::EVROverlayError SetOverlayTransformTrackedDeviceRelative(vr::VROverlayHandle_t ulOverlayHandle, vr::TrackedDeviceIndex_t unTrackedDevice,
+		const vr::HmdMatrix34_t* pmatTrackedDeviceToOverlayTransform)
+	{
+		STUB_CALL();
+		return Set(ulOverlayHandle, [&](StubOverlayState& o)
+		{
+			o.TransformType = vr::VROverlayTransform_TrackedDeviceRelative;
+			o.Device = unTrackedDevice;
+			o.Transform = *pmatTrackedDeviceToOverlayTransform;
+		});
+	}
+
+	virtual vr::EVROverlayError GetOverlayTransformTrackedDeviceRelative(vr::VROverlayHandle_t ulOverlayHandle, vr::TrackedDeviceIndex_t* punTrackedDevice,
+		vr::HmdMatrix34_t* pmatTrackedDeviceToOverlayTransform)
+	{
+		STUB_CALL();
+		return Get(ulOverlayHandle, [&](const StubOverlayState& o) { *punTrackedDevice = o.Device; *pmatTrackedDeviceToOverlayTransform = o.Transform; });
+	}
+
+	virtual vr::EVROverlayError SetOverlayTransformTrackedDeviceComponent(vr::VROverlayHandle_t ulOverlayHandle, vr::TrackedDeviceIndex_t unDeviceIndex, const char* pchComponentName)
+	{
+		STUB_CALL();
+		return Set(ulOverlayHandle, [&](StubOverlayState& o)
+		{
+			o.TransformType = vr::VROverlayTransform_TrackedComponent;
+			o.Device = unDeviceIndex;
+		});
+	}
+
+	virtual vr::EVROverlayError GetOverlayTransformTrackedDeviceComponent(vr::VROverlayHandle_t ulOverlayHandle, vr::TrackedDeviceIndex_t* punDeviceIndex,
+		char* pchComponentName, uint32_t unComponentNameSize)
+	{
+		STUB_CALL();
+		return Get(ulOverlayHandle, [&](const StubOverlayState& o) { *punDeviceIndex = o.Device; StubCopyString("", pchComponentName, unComponentNameSize); });
+	}
+
+	virtual vr::EVROverlayError GetOverlayTransformOverlayRelative(vr::VROverlayHandle_t ulOverlayHandle, vr::VROverlayHandle_t* ulOverlayHandleParent,
+		vr::HmdMatrix34_t* pmatParentOverlayToOverlayTransform)
+	{
+		STUB_CALL();
+		return Get(ulOverlayHandle, [&](const StubOverlayState& o) { *ulOverlayHandleParent = o.Parent; *pmatParentOverlayToOverlayTransform = o.Transform; });
+	}
+
+	virtual vr::EVROverlayError SetOverlayTransformOverlayRelative(vr::VROverlayHandle_t ulOverlayHandle, vr::VROverlayHandle_t ulOverlayHandleParent,
+		const vr::HmdMatrix34_t* pmatParentOverlayToOverlayTransform)
+	{
+		STUB_CALL();
+		return Set(ulOverlayHandle, [&](StubOverlayState& o)
+		{
+			o.Parent = ulOverlayHandleParent;
+			o.Transform = *pmatParentOverlayToOverlayTransform;
+		});
+	}
+
+	virtual vr::EVROverlayError SetOverlayTransformCursor(vr::VROverlayHandle_t ulCursorOverlayHandle, const vr::HmdVector2_t* pvHotspot)
+	{
+		STUB_CALL();
+		return Set(ulCursorOverlayHandle, [&](StubOverlayState& o) { o.TransformType = vr::VROverlayTransform_Cursor; });
+	}
+
+	virtual vr::EVROverlayError GetOverlayTransformCursor(vr::VROverlayHandle_t ulOverlayHandle, vr::HmdVector2_t* pvHotspot)
+	{
+		STUB_CALL();
+		return Get(ulOverlayHandle, [&](const StubOverlayState& o) { *pvHotspot = { 0.5f, 0.5f }; });
+	}
+
+	virtual vr::EVROverlayError SetOverlayTransformProjection(vr::VROverlayHandle_t ulOverlayHandle, vr::ETrackingUniverseOrigin eTrackingOrigin,
+		const vr::HmdMatrix34_t* pmatTrackingOriginToOverlayTransform, const vr::VROverlayProjection_t* pProjection, vr::EVREye eEye)
+	{
+		STUB_CALL();
+		return Set(ulOverlayHandle, [&](StubOverlayState& o)
+		{
+			o.TransformType = vr::VROverlayTransform_Projection;
+			o.Origin = eTrackingOrigin;
+			o.Transform = *pmatTrackingOriginToOverlayTransform;
+		});
+	}
+
+	virtual vr::EVROverlayError ShowOverlay(vr::VROverlayHandle_t ulOverlayHandle)
+	{
+		STUB_CALL();
+		return Set(ulOverlayHandle, [&](StubOverlayState& o) { SetVisible(o, true); });
+	}
+
+	virtual vr::EVROverlayError HideOverlay(vr::VROverlayHandle_t ulOverlayHandle)
+	{
+		STUB_CALL();
+		return Set(ulOverlayHandle, [&](StubOverlayState& o) { SetVisible(o, false); });
+	}
+
+	virtual bool IsOverlayVisible(vr::VROverlayHandle_t ulOverlayHandle)
+	{
+		STUB_CALL();
+		bool visible = false;
+		Get(ulOverlayHandle, [&](const StubOverlayState& o) { visible = o.Visible && o.Textured; });
+		return visible;
+	}
+
+	virtual vr::EVROverlayError GetTransformForOverlayCoordinates(vr::VROverlayHandle_t ulOverlayHandle, vr::ETrackingUniverseOrigin eTrackingOrigin,
+		vr::HmdVector2_t coordinatesInOverlay, vr::HmdMatrix34_t* pmatTransform)
+	{
+		STUB_CALL();
+		return Get(ulOverlayHandle, [&](const StubOverlayState& o) { *pmatTransform = o.Transform; });
+	}
+
+	// Overlays never receive input, only the visibility changes are delivered
+	virtual bool PollNextOverlayEvent(vr::VROverlayHandle_t ulOverlayHandle, vr::VREvent_t* pEvent, uint32_t uncbVREvent)
+	{
+		STUB_CALL();
+		bool polled = false;
+		Set(ulOverlayHandle, [&](StubOverlayState& o)
+		{
+			if (o.Events.empty() || !pEvent)
+				return;
+			memcpy(pEvent, &o.Events.front(), std::min<size_t>(uncbVREvent, sizeof(vr::VREvent_t)));
+			o.Events.erase(o.Events.begin());
+			polled = true;
+		});
+		return polled;
+	}
+
+	virtual vr::EVROverlayError GetOverlayInputMethod(vr::VROverlayHandle_t ulOverlayHandle, vr::VROverlayInputMethod* peInputMethod)
+	{
+		STUB_CALL();
+		return Get(ulOverlayHandle, [&](const StubOverlayState& o) { *peInputMethod = o.InputMethod; });
+	}
+
+	virtual vr::EVROverlayError SetOverlayInputMethod(vr::VROverlayHandle_t ulOverlayHandle, vr::VROverlayInputMethod eInputMethod)
+	{
+		STUB_CALL();
+		return Set(ulOverlayHandle, [&](StubOverlayState& o) { o.InputMethod = eInputMethod; });
+	}
+
+	virtual vr::EVROverlayError GetOverlayMouseScale(vr::VROverlayHandle_t ulOverlayHandle, vr::HmdVector2_t* pvecMouseScale)
+	{
+		STUB_CALL();
+		return Get(ulOverlayHandle, [&](const StubOverlayState& o) { *pvecMouseScale = o.MouseScale; });
+	}
+
+	virtual vr::EVROverlayError SetOverlayMouseScale(vr::VROverlayHandle_t ulOverlayHandle, const vr::HmdVector2_t* pvecMouseScale)
+	{
+		STUB_CALL();
+		return Set(ulOverlayHandle, [&](StubOverlayState& o) { o.MouseScale = *pvecMouseScale; });
+	}
+
+	virtual bool ComputeOverlayIntersection(vr::VROverlayHandle_t ulOverlayHandle, const vr::VROverlayIntersectionParams_t* pParams,
+		vr::VROverlayIntersectionResults_t* pResults)
+	{
+		STUB_CALL();
+		return false;
+	}
+
+	virtual bool IsHoverTargetOverlay(vr::VROverlayHandle_t ulOverlayHandle) { STUB_CALL(); return false; }
+
+	virtual vr::EVROverlayError SetOverlayIntersectionMask(vr::VROverlayHandle_t ulOverlayHandle, vr::VROverlayIntersectionMaskPrimitive_t* pMaskPrimitives,
+		uint32_t unNumMaskPrimitives, uint32_t unPrimitiveSize)
+	{
+		STUB_CALL();
+		return Get(ulOverlayHandle, [](const StubOverlayState&) {});
+	}
+
+	virtual vr::EVROverlayError TriggerLaserMouseHapticVibration(vr::VROverlayHandle_t ulOverlayHandle, float fDurationSeconds, float fFrequency, float fAmplitude)
+	{
+		STUB_CALL();
+		return Get(ulOverlayHandle, [](const StubOverlayState&) {});
+	}
+
+	virtual vr::EVROverlayError SetOverlayCursor(vr::VROverlayHandle_t ulOverlayHandle, vr::VROverlayHandle_t ulCursorHandle)
+	{
+		STUB_CALL();
+		return Get(ulOverlayHandle, [](const StubOverlayState&) {});
+	}
+
+	virtual vr::EVROverlayError SetOverlayCursorPositionOverride(vr::VROverlayHandle_t ulOverlayHandle, const vr::HmdVector2_t* pvCursor)
+	{
+		STUB_CALL();
+		return Get(ulOverlayHandle, [](const StubOverlayState&) {});
+	}
+
+	virtual vr::EVROverlayError ClearOverlayCursorPositionOverride(vr::VROverlayHandle_t ulOverlayHandle)
+	{
+		STUB_CALL();
+		return Get(ulOverlayHandle, [](const StubOverlayState&) {});
+	}
+
+	virtual vr::EVROverlayError SetOverlayTexture(vr::VROverlayHandle_t ulOverlayHandle, const vr::Texture_t* pTexture)
+	{
+		STUB_CALL();
+		if (!pTexture || !pTexture->handle)
+			return vr::VROverlayError_InvalidTexture;
+		return Set(ulOverlayHandle, [&](StubOverlayState& o) { o.Textured = true; });
+	}
+
+	virtual vr::EVROverlayError ClearOverlayTexture(vr::VROverlayHandle_t ulOverlayHandle)
+	{
+		STUB_CALL();
+		return Set(ulOverlayHandle, [&](StubOverlayState& o) { o.Textured = false; });
+	}
+
+	virtual vr::EVROverlayError SetOverlayRaw(vr::VROverlayHandle_t ulOverlayHandle, void* pvBuffer, uint32_t unWidth, uint32_t unHeight, uint32_t unBytesPerPixel)
+	{
+		STUB_CALL();
+		if (!pvBuffer || unBytesPerPixel < 1 || unBytesPerPixel > 4)
+			return vr::VROverlayError_InvalidParameter;
+		return Set(ulOverlayHandle, [&](StubOverlayState& o) { o.Textured = true; });
+	}
+
+	virtual vr::EVROverlayError SetOverlayFromFile(vr::VROverlayHandle_t ulOverlayHandle, const char* pchFilePath)
+	{
+		STUB_CALL();
+		return Set(ulOverlayHandle, [&](StubOverlayState& o) { o.Textured = true; });
+	}
+
+	virtual vr::EVROverlayError GetOverlayTexture(vr::VROverlayHandle_t ulOverlayHandle, void** pNativeTextureHandle, void* pNativeTextureRef, uint32_t* pWidth,
+		uint32_t* pHeight, uint32_t* pNativeFormat, vr::ETextureType* pAPIType, vr::EColorSpace* pColorSpace, vr::VRTextureBounds_t* pTextureBounds)
+	{
+		STUB_CALL();
+		return vr::VROverlayError_RequestFailed;
+	}
+
+	virtual vr::EVROverlayError ReleaseNativeOverlayHandle(vr::VROverlayHandle_t ulOverlayHandle, void* pNativeTextureHandle)
+	{
+		STUB_CALL();
+		return vr::VROverlayError_RequestFailed;
+	}
+
+	virtual vr::EVROverlayError GetOverlayTextureSize(vr::VROverlayHandle_t ulOverlayHandle, uint32_t* pWidth, uint32_t* pHeight)
+	{
+		STUB_CALL();
+		return vr::VROverlayError_RequestFailed;
+	}
+
+	virtual vr::EVROverlayError CreateDashboardOverlay(const char* pchOverlayKey, const char* pchOverlayFriendlyName, vr::VROverlayHandle_t* pMainHandle,
+		vr::VROverlayHandle_t* pThumbnailHandle)
+	{
+		STUB_CALL();
+		if (!pchOverlayKey || !pchOverlayFriendlyName || !pMainHandle || !pThumbnailHandle)
+			return vr::VROverlayError_InvalidParameter;
+
+		std::lock_guard<std::mutex> lk(m_Mutex);
+		vr::EVROverlayError err = Create(pchOverlayKey, pchOverlayFriendlyName, pMainHandle);
+		if (err != vr::VROverlayError_None)
+			return err;
+
+		std::string thumbnail = std::string(pchOverlayKey) + ".thumbnail";
+		return Create(thumbnail.c_str(), pchOverlayFriendlyName, pThumbnailHandle);
+	}
+
+	virtual bool IsDashboardVisible() { STUB_CALL(); return false; }
+	virtual bool IsActiveDashboardOverlay(vr::VROverlayHandle_t ulOverlayHandle) { STUB_CALL(); return false; }
+
+	virtual vr::EVROverlayError SetDashboardOverlaySceneProcess(vr::VROverlayHandle_t ulOverlayHandle, uint32_t unProcessId)
+	{
+		STUB_CALL();
+		return Get(ulOverlayHandle, [](const StubOverlayState&) {});
+	}
+
+	virtual vr::EVROverlayError GetDashboardOverlaySceneProcess(vr::VROverlayHandle_t ulOverlayHandle, uint32_t* punProcessId)
+	{
+		STUB_CALL();
+		return Get(ulOverlayHandle, [&](const StubOverlayState&) { *punProcessId = 0; });
+	}
+
+	virtual void ShowDashboard(const char* pchOverlayToShow) { STUB_CALL(); }
+	virtual vr::TrackedDeviceIndex_t GetPrimaryDashboardDevice() { STUB_CALL(); return vr::k_unTrackedDeviceIndexInvalid; }
+
+	virtual vr::EVROverlayError ShowKeyboard(vr::EGamepadTextInputMode eInputMode, vr::EGamepadTextInputLineMode eLineInputMode, uint32_t unFlags,
+		const char* pchDescription, uint32_t unCharMax, const char* pchExistingText, uint64_t uUserValue)
+	{
+		STUB_CALL();
+		return vr::VROverlayError_RequestFailed;
+	}
+
+	virtual vr::EVROverlayError ShowKeyboardForOverlay(vr::VROverlayHandle_t ulOverlayHandle, vr::EGamepadTextInputMode eInputMode,
+		vr::EGamepadTextInputLineMode eLineInputMode, uint32_t unFlags, const char* pchDescription, uint32_t unCharMax, const char* pchExistingText, uint64_t uUserValue)
+	{
+		STUB_CALL();
+		return vr::VROverlayError_RequestFailed;
+	}
+
+	virtual uint32_t GetKeyboardText(char* pchText, uint32_t cchText) { STUB_CALL(); return StubCopyString("", pchText, cchText); }
+	virtual void HideKeyboard() { STUB_CALL(); }
+	virtual void SetKeyboardTransformAbsolute(vr::ETrackingUniverseOrigin eTrackingOrigin, const vr::HmdMatrix34_t* pmatTrackingOriginToKeyboardTransform) { STUB_CALL(); }
+	virtual void SetKeyboardPositionForOverlay(vr::VROverlayHandle_t ulOverlayHandle, vr::HmdRect2_t avoidRect) { STUB_CALL(); }
+
+	// Message boxes are answered immediately with the first button
+	virtual vr::VRMessageOverlayResponse ShowMessageOverlay(const char* pchText, const char* pchCaption, const char* pchButton0Text,
+		const char* pchButton1Text, const char* pchButton2Text, const char* pchButton3Text)
+	{
+		STUB_CALL();
+		return vr::VRMessageOverlayResponse_ButtonPress_0;
+	}
+
+	virtual void CloseMessageOverlay() { STUB_CALL(); }
+
+private:
+	std::mutex m_Mutex;
+	std::map<vr::VROverlayHandle_t, StubOverlayState> m_Overlays;
+	vr::VROverlayHandle_t m_NextHandle;
+
+	// Called with the overlay mutex held
+	vr::EVROverlayError Create(const char* key, const char* name, vr::VROverlayHandle_t* handle)
+	{
+		for (auto& it : m_Overlays)
+		{
+			if (it.second.Key == key)
+				return vr::VROverlayError_KeyInUse;
+		}
+
+		StubOverlayState overlay = {};
+		overlay.Key = key;
+		overlay.Name = name;
+		overlay.Color[0] = overlay.Color[1] = overlay.Color[2] = 1.0f;
+		overlay.Alpha = 1.0f;
+		overlay.TexelAspect = 1.0f;
+		overlay.Width = 1.0f;
+		overlay.ColorSpace = vr::ColorSpace_Auto;
+		overlay.Bounds = { 0.0f, 0.0f, 1.0f, 1.0f };
+		overlay.TransformType = vr::VROverlayTransform_Absolute;
+		overlay.Device = vr::k_unTrackedDeviceIndexInvalid;
+		overlay.Transform = StubMath::ToMatrix(StubMath::Identity());
+		overlay.MouseScale = { 1.0f, 1.0f };
+		*handle = m_NextHandle++;
+		m_Overlays[*handle] = overlay;
+		return vr::VROverlayError_None;
+	}
+
+	// Queues the event the runtime sends when an overlay is shown or hidden
+	static void SetVisible(StubOverlayState& overlay, bool visible)
+	{
+		if (overlay.Visible == visible)
+			return;
+
+		overlay.Visible = visible;
+		if (overlay.Events.size() >= STUB_OVERLAY_EVENTS)
+			overlay.Events.erase(overlay.Events.begin());
+		vr::VREvent_t event = {};
+		event.eventType = visible ? vr::VREvent_OverlayShown : vr::VREvent_OverlayHidden;
+		overlay.Events.push_back(event);
+	}
+
+	StubOverlayState* Find(vr::VROverlayHandle_t handle, vr::EVROverlayError* error)
+	{
+		auto it = m_Overlays.find(handle);
+		if (error)
+			*error = it != m_Overlays.end() ? vr::VROverlayError_None : vr::VROverlayError_InvalidHandle;
+		return it != m_Overlays.end() ? &it->second : nullptr;
+	}
+
+	template<typename F>
+	vr::EVROverlayError Set(vr::VROverlayHandle_t handle, F func)
+	{
+		std::lock_guard<std::mutex> lk(m_Mutex);
+		vr::EVROverlayError error;
+		StubOverlayState* overlay = Find(handle, &error);
+		if (overlay)
+			func(*overlay);
+		return error;
+	}
+
+	template<typename F>
+	vr::EVROverlayError Get(vr::VROverlayHandle_t handle, F func)
+	{
+		std::lock_guard<std::mutex> lk(m_Mutex);
+		vr::EVROverlayError error;
+		const StubOverlayState* overlay = Find(handle, &error);
+		if (overlay)
+			func(*overlay);
+		return error;
+	}
+};
+
+vr::IVROverlay* GetStubOverlay()
+{
+	static StubOverlay s_Overlay;
+	return &s_Overlay;
+}
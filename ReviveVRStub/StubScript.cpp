@@ -0,0 +1,231 @@
+#include "StubScript.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <sstream>
+
+static const struct
+{
+	const char* Name;
+	vr::EVREventType Type;
+} s_events[] = {
+	{ "Quit", vr::VREvent_Quit },
+	{ "TrackedDeviceActivated", vr::VREvent_TrackedDeviceActivated },
+	{ "TrackedDeviceDeactivated", vr::VREvent_TrackedDeviceDeactivated },
+	{ "TrackedDeviceUpdated", vr::VREvent_TrackedDeviceUpdated },
+	{ "TrackedDeviceUserInteractionStarted", vr::VREvent_TrackedDeviceUserInteractionStarted },
+	{ "TrackedDeviceUserInteractionEnded", vr::VREvent_TrackedDeviceUserInteractionEnded },
+	{ "TrackedDeviceRoleChanged", vr::VREvent_TrackedDeviceRoleChanged },
+	{ "IpdChanged", vr::VREvent_IpdChanged },
+	{ "PropertyChanged", vr::VREvent_PropertyChanged },
+	{ "InputFocusChanged", vr::VREvent_InputFocusChanged },
+	{ "SceneApplicationChanged", vr::VREvent_SceneApplicationChanged },
+	{ "DashboardActivated", vr::VREvent_DashboardActivated },
+	{ "DashboardDeactivated", vr::VREvent_DashboardDeactivated },
+};
+
+StubScript::StubScript()
+	: RefreshRate(90.0)
+	, VSync(true)
+	, Width(1440)
+	, Height(1600)
+	, FieldOfView{ -0.82f, 0.82f, 0.87f, -0.87f }
+	, Ipd(0.064f)
+	, FloorHeight(1.6f)
+	, Bounds{ 2.0f, 2.0f }
+	, Loop(0.0)
+{
+	// Default to a headset at the seated origin with both hands held in front of the user
+	StubPose head = StubMath::Identity();
+	StubPose left = StubMath::Identity();
+	StubPose right = StubMath::Identity();
+	left.Position = { -0.2f, -0.3f, -0.3f };
+	right.Position = { 0.2f, -0.3f, -0.3f };
+	m_Poses[vr::k_unTrackedDeviceIndex_Hmd].push_back({ 0.0, head });
+	m_Poses[1].push_back({ 0.0, left });
+	m_Poses[2].push_back({ 0.0, right });
+}
+
+vr::TrackedDeviceIndex_t StubScript::ParseDevice(const std::string& name)
+{
+	if (name == "hmd")
+		return vr::k_unTrackedDeviceIndex_Hmd;
+	if (name == "left")
+		return 1;
+	if (name == "right")
+		return 2;
+	return vr::k_unTrackedDeviceIndexInvalid;
+}
+
+bool StubScript::Load(const char* path)
+{
+	FILE* file = fopen(path, "r");
+	if (!file)
+		return false;
+
+	std::vector<PoseKey> poses[STUB_DEVICE_COUNT];
+	char buffer[1024];
+	while (fgets(buffer, sizeof(buffer), file))
+	{
+		char* comment = strchr(buffer, '#');
+		if (comment)
+			*comment = '\0';
+
+		std::istringstream line(buffer);
+		std::string command;
+		if (!(line >> command))
+			continue;
+
+		if (command == "refresh")
+			line >> RefreshRate;
+		else if (command == "vsync")
+			line >> VSync;
+		else if (command == "resolution")
+			line >> Width >> Height;
+		else if (command == "fov")
+			line >> FieldOfView.Left >> FieldOfView.Right >> FieldOfView.Up >> FieldOfView.Down;
+		else if (command == "ipd")
+			line >> Ipd;
+		else if (command == "floor")
+			line >> FloorHeight;
+		else if (command == "bounds")
+			line >> Bounds[0] >> Bounds[1];
+		else if (command == "loop")
+			line >> Loop;
+		else if (command == "stall")
+		{
+			uint64_t frame;
+			double ms;
+			if (line >> frame >> ms)
+				Stalls[frame] = ms;
+		}
+		else if (command == "latency")
+		{
+			std::string function;
+			double ms;
+			if (line >> function >> ms)
+				Latencies[function] = ms;
+		}
+		else if (command == "pose")
+		{
+			std::string device;
+			PoseKey key = { 0.0, StubMath::Identity() };
+			StubPose& pose = key.Pose;
+			if (!(line >> device >> key.Time >> pose.Position.v[0] >> pose.Position.v[1] >> pose.Position.v[2]))
+				continue;
+			vr::TrackedDeviceIndex_t index = ParseDevice(device);
+			if (index >= STUB_DEVICE_COUNT)
+				continue;
+			if (line >> pose.Orientation.x >> pose.Orientation.y >> pose.Orientation.z >> pose.Orientation.w)
+				pose.Orientation = StubMath::Normalize(pose.Orientation);
+			poses[index].push_back(key);
+		}
+		else if (command == "value")
+		{
+			std::string action;
+			ValueKey key = { 0.0, { 0.0f, 0.0f } };
+			if (!(line >> action >> key.Time >> key.Value.v[0]))
+				continue;
+			line >> key.Value.v[1];
+			m_Values[action].push_back(key);
+		}
+		else if (command == "event")
+		{
+			std::string type, device;
+			Event event = { 0.0, vr::VREvent_None, vr::k_unTrackedDeviceIndexInvalid };
+			if (!(line >> event.Time >> type))
+				continue;
+			if (line >> device)
+				event.Device = ParseDevice(device);
+
+			event.Type = (vr::EVREventType)strtoul(type.c_str(), nullptr, 0);
+			for (const auto& it : s_events)
+			{
+				if (type == it.Name)
+					event.Type = it.Type;
+			}
+			if (event.Type != vr::VREvent_None)
+				Events.push_back(event);
+		}
+		else if (command == "property")
+		{
+			std::string device, value;
+			uint32_t prop;
+			if (!(line >> device >> prop >> std::ws) || !std::getline(line, value))
+				continue;
+			value.erase(value.find_last_not_of(" \t\r\n") + 1);
+			Properties[std::make_pair(ParseDevice(device), (vr::ETrackedDeviceProperty)prop)] = value;
+		}
+		else if (command == "mask")
+		{
+			std::string type;
+			line >> type;
+			vr::EHiddenAreaMeshType meshType = vr::k_eHiddenAreaMesh_Standard;
+			if (type == "visible")
+				meshType = vr::k_eHiddenAreaMesh_Inverse;
+			else if (type == "line")
+				meshType = vr::k_eHiddenAreaMesh_LineLoop;
+
+			std::vector<vr::HmdVector2_t>& vertices = Masks[meshType];
+			vr::HmdVector2_t vertex;
+			while (line >> vertex.v[0] >> vertex.v[1])
+				vertices.push_back(vertex);
+		}
+	}
+	fclose(file);
+
+	// Scripted poses replace the defaults, keys are sorted so they can be written in any order
+	for (int i = 0; i < STUB_DEVICE_COUNT; i++)
+	{
+		if (!poses[i].empty())
+			m_Poses[i] = poses[i];
+		std::stable_sort(m_Poses[i].begin(), m_Poses[i].end(), [](const PoseKey& a, const PoseKey& b) { return a.Time < b.Time; });
+	}
+	for (auto& it : m_Values)
+		std::stable_sort(it.second.begin(), it.second.end(), [](const ValueKey& a, const ValueKey& b) { return a.Time < b.Time; });
+	std::stable_sort(Events.begin(), Events.end(), [](const Event& a, const Event& b) { return a.Time < b.Time; });
+
+	RefreshRate = std::max(RefreshRate, 1.0);
+	return true;
+}
+
+StubPose StubScript::GetPose(vr::TrackedDeviceIndex_t device, double time) const
+{
+	if (device >= STUB_DEVICE_COUNT || m_Poses[device].empty())
+		return StubMath::Identity();
+
+	time = WrapTime(time);
+	const std::vector<PoseKey>& keys = m_Poses[device];
+	auto next = std::upper_bound(keys.begin(), keys.end(), time, [](double t, const PoseKey& key) { return t < key.Time; });
+	if (next == keys.begin())
+		return next->Pose;
+	if (next == keys.end())
+		return keys.back().Pose;
+
+	auto prev = next - 1;
+	float t = (float)((time - prev->Time) / (next->Time - prev->Time));
+	return StubMath::Lerp(prev->Pose, next->Pose, t);
+}
+
+vr::HmdVector2_t StubScript::GetValue(const std::string& action, double time) const
+{
+	auto it = m_Values.find(action);
+	if (it == m_Values.end() || it->second.empty())
+		return { 0.0f, 0.0f };
+
+	time = WrapTime(time);
+	const std::vector<ValueKey>& keys = it->second;
+	auto next = std::upper_bound(keys.begin(), keys.end(), time, [](double t, const ValueKey& key) { return t < key.Time; });
+	if (next == keys.begin())
+		return { 0.0f, 0.0f };
+	return (next - 1)->Value;
+}
+
+double StubScript::WrapTime(double time) const
+{
+	if (Loop <= 0.0 || time < 0.0)
+		return time;
+	return fmod(time, Loop);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "StubMath.h"
+
+#include <openvr.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+// Number of tracked devices simulated by the stub: the headset and both controllers
+#define STUB_DEVICE_COUNT 3
+
+// Deterministic description of the simulated headset, loaded from the file pointed to by the
+// REVIVE_VR_STUB_SCRIPT environment variable. Every line holds one command, '#' starts a comment:
+//
+//   refresh <hz>                        Display refresh rate
+//   vsync <0|1>                         Block in WaitGetPoses, or advance the frame time per call
+//   resolution <width> <height>         Recommended render target size for each eye
+//   fov <left> <right> <up> <down>      Field-of-view angles in radians
+//   ipd <meters>                        Interpupillary distance
+//   floor <meters>                      Height of the seated zero pose above the standing origin
+//   bounds <width> <depth>              Size of the play area
+//   loop <seconds>                      Wraps the script time, zero plays the keys once
+//   stall <frame> <ms>                  Delays the given frame in WaitGetPoses
+//   latency <IVRInterface::Method> <ms> Injected latency on every call to the method
+//   pose <hmd|left|right> <t> <x> <y> <z> [<qx> <qy> <qz> <qw>]
+//                                       Pose key of a device in the seated space
+//   value <action>[@<source>] <t> <x> [<y>]
+//                                       Input key of an action, optionally restricted to an input source
+//   event <t> <type> [<hmd|left|right>] Event delivered by PollNextEvent, the type is a number or the
+//                                       name without the VREvent_ prefix
+//   property <hmd|left|right> <prop> <value>
+//                                       Overrides a tracked device property by its number
+//   mask <hidden|visible|line> <x> <y>...
+//                                       Hidden area mesh vertices for both eyes
+//
+// Poses are interpolated between keys, input values hold until the next key. Events are
+// delivered once and are not affected by the loop.
+class StubScript
+{
+public:
+	StubScript();
+
+	bool Load(const char* path);
+
+	struct Fov
+	{
+		float Left, Right, Up, Down;
+	};
+
+	struct Event
+	{
+		double Time;
+		vr::EVREventType Type;
+		vr::TrackedDeviceIndex_t Device;
+	};
+
+	double RefreshRate;
+	bool VSync;
+	uint32_t Width;
+	uint32_t Height;
+	Fov FieldOfView;
+	float Ipd;
+	float FloorHeight;
+	float Bounds[2];
+	double Loop;
+
+	std::map<uint64_t, double> Stalls;
+	std::map<std::string, double> Latencies;
+	std::map<vr::EHiddenAreaMeshType, std::vector<vr::HmdVector2_t>> Masks;
+	std::map<std::pair<vr::TrackedDeviceIndex_t, vr::ETrackedDeviceProperty>, std::string> Properties;
+	std::vector<Event> Events;
+
+	StubPose GetPose(vr::TrackedDeviceIndex_t device, double time) const;
+	vr::HmdVector2_t GetValue(const std::string& action, double time) const;
+
+	static vr::TrackedDeviceIndex_t ParseDevice(const std::string& name);
+
+private:
+	struct PoseKey
+	{
+		double Time;
+		StubPose Pose;
+	};
+
+	struct ValueKey
+	{
+		double Time;
+		vr::HmdVector2_t Value;
+	};
+
+	std::vector<PoseKey> m_Poses[STUB_DEVICE_COUNT];
+	std::map<std::string, std::vector<ValueKey>> m_Values;
+
+	double WrapTime(double time) const;
+};
@@ -0,0 +1,276 @@
+#include "StubCore.h"
+
+#include <Windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <map>
+#include <string>
+
+// Settings are kept in memory for the lifetime of the process, unknown keys report an error so
+// the application falls back to its defaults
+class StubSettings : public vr::IVRSettings
+{
+public:
+	virtual const char* GetSettingsErrorNameFromEnum(vr::EVRSettingsError eError)
+	{
+		STUB_CALL();
+		return eError == vr::VRSettingsError_None ? "VRSettingsError_None" : "VRSettingsError";
+	}
+
+	virtual void SetBool(const char* pchSection, const char* pchSettingsKey, bool bValue, vr::EVRSettingsError* peError)
+	{
+		STUB_CALL();
+		Set(pchSection, pchSettingsKey, bValue ? "1" : "0", peError);
+	}
+
+	virtual void SetInt32(const char* pchSection, const char* pchSettingsKey, int32_t nValue, vr::EVRSettingsError* peError)
+	{
+		STUB_CALL();
+		Set(pchSection, pchSettingsKey, std::to_string(nValue), peError);
+	}
+
+	virtual void SetFloat(const char* pchSection, const char* pchSettingsKey, float flValue, vr::EVRSettingsError* peError)
+	{
+		STUB_CALL();
+		char value[32];
+		snprintf(value, sizeof(value), "%.9g", flValue);
+		Set(pchSection, pchSettingsKey, value, peError);
+	}
+
+	virtual void SetString(const char* pchSection, const char* pchSettingsKey, const char* pchValue, vr::EVRSettingsError* peError)
+	{
+		STUB_CALL();
+		Set(pchSection, pchSettingsKey, pchValue ? pchValue : "", peError);
+	}
+
+	virtual bool GetBool(const char* pchSection, const char* pchSettingsKey, vr::EVRSettingsError* peError)
+	{
+		STUB_CALL();
+		std::string value;
+		return Get(pchSection, pchSettingsKey, value, peError) && strtol(value.c_str(), nullptr, 0) != 0;
+	}
+
+	virtual int32_t GetInt32(const char* pchSection, const char* pchSettingsKey, vr::EVRSettingsError* peError)
+	{
+		STUB_CALL();
+		std::string value;
+		return Get(pchSection, pchSettingsKey, value, peError) ? strtol(value.c_str(), nullptr, 0) : 0;
+	}
+
+	virtual float GetFloat(const char* pchSection, const char* pchSettingsKey, vr::EVRSettingsError* peError)
+	{
+		STUB_CALL();
+		std::string value;
+		return Get(pchSection, pchSettingsKey, value, peError) ? strtof(value.c_str(), nullptr) : 0.0f;
+	}
+
+	virtual void GetString(const char* pchSection, const char* pchSettingsKey, char* pchValue, uint32_t unValueLen, vr::EVRSettingsError* peError)
+	{
+		STUB_CALL();
+		std::string value;
+		Get(pchSection, pchSettingsKey, value, peError);
+		if (StubCopyString(value, pchValue, unValueLen) > unValueLen && peError)
+			*peError = vr::VRSettingsError_BufferTooSmall;
+	}
+
+	virtual void RemoveSection(const char* pchSection, vr::EVRSettingsError* peError)
+	{
+		STUB_CALL();
+		std::lock_guard<std::mutex> lk(m_Mutex);
+		m_Sections.erase(pchSection);
+		if (peError)
+			*peError = vr::VRSettingsError_None;
+	}
+
+	virtual void RemoveKeyInSection(const char* pchSection, const char* pchSettingsKey, vr::EVRSettingsError* peError)
+	{
+		STUB_CALL();
+		std::lock_guard<std::mutex> lk(m_Mutex);
+		auto it = m_Sections.find(pchSection);
+		if (it != m_Sections.end())
+			it->second.erase(pchSettingsKey);
+		if (peError)
+			*peError = vr::VRSettingsError_None;
+	}
+
+private:
+	std::mutex m_Mutex;
+	std::map<std::string, std::map<std::string, std::string>> m_Sections;
+
+	void Set(const char* section, const char* key, const std::string& value, vr::EVRSettingsError* error)
+	{
+		if (!section || !key)
+		{
+			if (error)
+				*error = vr::VRSettingsError_ReadFailed;
+			return;
+		}
+
+		std::lock_guard<std::mutex> lk(m_Mutex);
+		m_Sections[section][key] = value;
+		if (error)
+			*error = vr::VRSettingsError_None;
+	}
+
+	bool Get(const char* section, const char* key, std::string& value, vr::EVRSettingsError* error)
+	{
+		std::lock_guard<std::mutex> lk(m_Mutex);
+		auto it = section && key ? m_Sections.find(section) : m_Sections.end();
+		if (it != m_Sections.end())
+		{
+			auto setting = it->second.find(key);
+			if (setting != it->second.end())
+			{
+				value = setting->second;
+				if (error)
+					*error = vr::VRSettingsError_None;
+				return true;
+			}
+		}
+
+		if (error)
+			*error = vr::VRSettingsError_UnsetSettingHasNoDefault;
+		return false;
+	}
+};
+
+// Only the calling process is known to the stub, it is identified by its executable name
+class StubApplications : public vr::IVRApplications
+{
+public:
+	virtual vr::EVRApplicationError AddApplicationManifest(const char* pchApplicationManifestFullPath, bool bTemporary) { STUB_CALL(); return vr::VRApplicationError_None; }
+	virtual vr::EVRApplicationError RemoveApplicationManifest(const char* pchApplicationManifestFullPath) { STUB_CALL(); return vr::VRApplicationError_None; }
+	virtual bool IsApplicationInstalled(const char* pchAppKey) { STUB_CALL(); return GetAppKey() == pchAppKey; }
+	virtual uint32_t GetApplicationCount() { STUB_CALL(); return 1; }
+
+	virtual vr::EVRApplicationError GetApplicationKeyByIndex(uint32_t unApplicationIndex, char* pchAppKeyBuffer, uint32_t unAppKeyBufferLen)
+	{
+		STUB_CALL();
+		if (unApplicationIndex > 0)
+			return vr::VRApplicationError_InvalidIndex;
+		return CopyAppKey(pchAppKeyBuffer, unAppKeyBufferLen);
+	}
+
+	virtual vr::EVRApplicationError GetApplicationKeyByProcessId(uint32_t unProcessId, char* pchAppKeyBuffer, uint32_t unAppKeyBufferLen)
+	{
+		STUB_CALL();
+		if (unProcessId != GetCurrentProcessId())
+			return vr::VRApplicationError_UnknownApplication;
+		return CopyAppKey(pchAppKeyBuffer, unAppKeyBufferLen);
+	}
+
+	virtual vr::EVRApplicationError LaunchApplication(const char* pchAppKey) { STUB_CALL(); return vr::VRApplicationError_LaunchFailed; }
+
+	virtual vr::EVRApplicationError LaunchTemplateApplication(const char* pchTemplateAppKey, const char* pchNewAppKey, const vr::AppOverrideKeys_t* pKeys, uint32_t unKeys)
+	{
+		STUB_CALL();
+		return vr::VRApplicationError_LaunchFailed;
+	}
+
+	virtual vr::EVRApplicationError LaunchApplicationFromMimeType(const char* pchMimeType, const char* pchArgs) { STUB_CALL(); return vr::VRApplicationError_LaunchFailed; }
+	virtual vr::EVRApplicationError LaunchDashboardOverlay(const char* pchAppKey) { STUB_CALL(); return vr::VRApplicationError_LaunchFailed; }
+	virtual bool CancelApplicationLaunch(const char* pchAppKey) { STUB_CALL(); return false; }
+	virtual vr::EVRApplicationError IdentifyApplication(uint32_t unProcessId, const char* pchAppKey) { STUB_CALL(); return vr::VRApplicationError_None; }
+	virtual uint32_t GetApplicationProcessId(const char* pchAppKey) { STUB_CALL(); return GetAppKey() == pchAppKey ? GetCurrentProcessId() : 0; }
+
+	virtual const char* GetApplicationsErrorNameFromEnum(vr::EVRApplicationError error)
+	{
+		STUB_CALL();
+		return error == vr::VRApplicationError_None ? "VRApplicationError_None" : "VRApplicationError";
+	}
+
+	virtual uint32_t GetApplicationPropertyString(const char* pchAppKey, vr::EVRApplicationProperty eProperty, char* pchPropertyValueBuffer,
+		uint32_t unPropertyValueBufferLen, vr::EVRApplicationError* peError)
+	{
+		STUB_CALL();
+		if (peError)
+			*peError = vr::VRApplicationError_UnknownProperty;
+		return 0;
+	}
+
+	virtual bool GetApplicationPropertyBool(const char* pchAppKey, vr::EVRApplicationProperty eProperty, vr::EVRApplicationError* peError)
+	{
+		STUB_CALL();
+		if (peError)
+			*peError = vr::VRApplicationError_UnknownProperty;
+		return false;
+	}
+
+	virtual uint64_t GetApplicationPropertyUint64(const char* pchAppKey, vr::EVRApplicationProperty eProperty, vr::EVRApplicationError* peError)
+	{
+		STUB_CALL();
+		if (peError)
+			*peError = vr::VRApplicationError_UnknownProperty;
+		return 0;
+	}
+
+	virtual vr::EVRApplicationError SetApplicationAutoLaunch(const char* pchAppKey, bool bAutoLaunch) { STUB_CALL(); return vr::VRApplicationError_None; }
+	virtual bool GetApplicationAutoLaunch(const char* pchAppKey) { STUB_CALL(); return false; }
+	virtual vr::EVRApplicationError SetDefaultApplicationForMimeType(const char* pchAppKey, const char* pchMimeType) { STUB_CALL(); return vr::VRApplicationError_None; }
+	virtual bool GetDefaultApplicationForMimeType(const char* pchMimeType, char* pchAppKeyBuffer, uint32_t unAppKeyBufferLen) { STUB_CALL(); return false; }
+	virtual bool GetApplicationSupportedMimeTypes(const char* pchAppKey, char* pchMimeTypesBuffer, uint32_t unMimeTypesBuffer) { STUB_CALL(); return false; }
+
+	virtual uint32_t GetApplicationsThatSupportMimeType(const char* pchMimeType, char* pchAppKeysThatSupportBuffer, uint32_t unAppKeysThatSupportBuffer)
+	{
+		STUB_CALL();
+		return StubCopyString("", pchAppKeysThatSupportBuffer, unAppKeysThatSupportBuffer);
+	}
+
+	virtual uint32_t GetApplicationLaunchArguments(uint32_t unHandle, char* pchArgs, uint32_t unArgs) { STUB_CALL(); return StubCopyString("", pchArgs, unArgs); }
+
+	virtual vr::EVRApplicationError GetStartingApplication(char* pchAppKeyBuffer, uint32_t unAppKeyBufferLen)
+	{
+		STUB_CALL();
+		return vr::VRApplicationError_NoApplication;
+	}
+
+	virtual vr::EVRSceneApplicationState GetSceneApplicationState() { STUB_CALL(); return vr::EVRSceneApplicationState_Running; }
+	virtual vr::EVRApplicationError PerformApplicationPrelaunchCheck(const char* pchAppKey) { STUB_CALL(); return vr::VRApplicationError_None; }
+
+	virtual const char* GetSceneApplicationStateNameFromEnum(vr::EVRSceneApplicationState state)
+	{
+		STUB_CALL();
+		return state == vr::EVRSceneApplicationState_Running ? "EVRSceneApplicationState_Running" : "EVRSceneApplicationState";
+	}
+
+	virtual vr::EVRApplicationError LaunchInternalProcess(const char* pchBinaryPath, const char* pchArguments, const char* pchWorkingDirectory)
+	{
+		STUB_CALL();
+		return vr::VRApplicationError_LaunchFailed;
+	}
+
+	virtual uint32_t GetCurrentSceneProcessId() { STUB_CALL(); return GetCurrentProcessId(); }
+
+private:
+	static std::string GetAppKey()
+	{
+		char path[MAX_PATH];
+		if (!GetModuleFileNameA(NULL, path, MAX_PATH))
+			return "revive.stub.unknown";
+
+		std::string name(path);
+		size_t slash = name.find_last_of("\\/");
+		if (slash != std::string::npos)
+			name.erase(0, slash + 1);
+		return "revive.stub." + name;
+	}
+
+	static vr::EVRApplicationError CopyAppKey(char* buffer, uint32_t size)
+	{
+		if (StubCopyString(GetAppKey(), buffer, size) > size)
+			return vr::VRApplicationError_BufferTooSmall;
+		return vr::VRApplicationError_None;
+	}
+};
+
+vr::IVRSettings* GetStubSettings()
+{
+	static StubSettings s_Settings;
+	return &s_Settings;
+}
+
+vr::IVRApplications* GetStubApplications()
+{
+	static StubApplications s_Applications;
+	return &s_Applications;
+}
@@ -0,0 +1,452 @@
+#include "StubCore.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+class StubSystem : public vr::IVRSystem
+{
+public:
+	virtual void GetRecommendedRenderTargetSize(uint32_t* pnWidth, uint32_t* pnHeight)
+	{
+		STUB_CALL();
+		const StubScript& script = StubCore::Get().Script;
+		if (pnWidth)
+			*pnWidth = script.Width;
+		if (pnHeight)
+			*pnHeight = script.Height;
+	}
+
+	virtual vr::HmdMatrix44_t GetProjectionMatrix(vr::EVREye eEye, float fNearZ, float fFarZ)
+	{
+		STUB_CALL();
+		float left, right, top, bottom;
+		GetTangents(eEye, &left, &right, &top, &bottom);
+
+		float idx = 1.0f / (right - left);
+		float idy = 1.0f / (bottom - top);
+		float idz = 1.0f / (fFarZ - fNearZ);
+		float sx = right + left;
+		float sy = bottom + top;
+
+		vr::HmdMatrix44_t m = {};
+		m.m[0][0] = 2.0f * idx; m.m[0][2] = sx * idx;
+		m.m[1][1] = 2.0f * idy; m.m[1][2] = sy * idy;
+		m.m[2][2] = -fFarZ * idz; m.m[2][3] = -fFarZ * fNearZ * idz;
+		m.m[3][2] = -1.0f;
+		return m;
+	}
+
+	virtual void GetProjectionRaw(vr::EVREye eEye, float* pfLeft, float* pfRight, float* pfTop, float* pfBottom)
+	{
+		STUB_CALL();
+		GetTangents(eEye, pfLeft, pfRight, pfTop, pfBottom);
+	}
+
+	virtual bool ComputeDistortion(vr::EVREye eEye, float fU, float fV, vr::DistortionCoordinates_t* pDistortionCoordinates)
+	{
+		STUB_CALL();
+		if (!pDistortionCoordinates)
+			return false;
+
+		// The simulated lenses have no distortion
+		for (int i = 0; i < 2; i++)
+		{
+			pDistortionCoordinates->rfRed[i] = i ? fV : fU;
+			pDistortionCoordinates->rfGreen[i] = i ? fV : fU;
+			pDistortionCoordinates->rfBlue[i] = i ? fV : fU;
+		}
+		return true;
+	}
+
+	virtual vr::HmdMatrix34_t GetEyeToHeadTransform(vr::EVREye eEye)
+	{
+		STUB_CALL();
+		float offset = StubCore::Get().Script.Ipd / 2.0f;
+		return StubMath::Translation(eEye == vr::Eye_Left ? -offset : offset, 0.0f, 0.0f);
+	}
+
+	virtual bool GetTimeSinceLastVsync(float* pfSecondsSinceLastVsync, uint64_t* pulFrameCounter)
+	{
+		STUB_CALL();
+		StubCore& core = StubCore::Get();
+		double vsync = core.GetLastVsync();
+		if (pfSecondsSinceLastVsync)
+			*pfSecondsSinceLastVsync = (float)std::max(core.Now() - vsync, 0.0);
+		if (pulFrameCounter)
+			*pulFrameCounter = (uint64_t)floor(vsync / core.GetPeriod() + 0.5);
+		return true;
+	}
+
+	virtual int32_t GetD3D9AdapterIndex() { STUB_CALL(); return 0; }
+	virtual void GetDXGIOutputInfo(int32_t* pnAdapterIndex) { STUB_CALL(); if (pnAdapterIndex) *pnAdapterIndex = 0; }
+
+	virtual void GetOutputDevice(uint64_t* pnDevice, vr::ETextureType textureType, VkInstance_T* pInstance)
+	{
+		STUB_CALL();
+		// There is no display, leave the choice of adapter to the application
+		if (pnDevice)
+			*pnDevice = 0;
+	}
+
+	virtual bool IsDisplayOnDesktop() { STUB_CALL(); return false; }
+	virtual bool SetDisplayVisibility(bool bIsVisibleOnDesktop) { STUB_CALL(); return false; }
+
+	virtual void GetDeviceToAbsoluteTrackingPose(vr::ETrackingUniverseOrigin eOrigin, float fPredictedSecondsToPhotonsFromNow,
+		vr::TrackedDevicePose_t* pTrackedDevicePoseArray, uint32_t unTrackedDevicePoseArrayCount)
+	{
+		STUB_CALL();
+		StubCore& core = StubCore::Get();
+		double time = core.Now() + fPredictedSecondsToPhotonsFromNow;
+		std::lock_guard<std::mutex> lk(core.Mutex);
+		for (uint32_t i = 0; i < unTrackedDevicePoseArrayCount; i++)
+			pTrackedDevicePoseArray[i] = core.GetPose(i, eOrigin, time);
+	}
+
+	virtual vr::HmdMatrix34_t GetSeatedZeroPoseToStandingAbsoluteTrackingPose()
+	{
+		STUB_CALL();
+		return StubCore::Get().GetSeatedToStanding();
+	}
+
+	virtual vr::HmdMatrix34_t GetRawZeroPoseToStandingAbsoluteTrackingPose()
+	{
+		STUB_CALL();
+		return StubMath::ToMatrix(StubMath::Identity());
+	}
+
+	virtual uint32_t GetSortedTrackedDeviceIndicesOfClass(vr::ETrackedDeviceClass eTrackedDeviceClass, vr::TrackedDeviceIndex_t* punTrackedDeviceIndexArray,
+		uint32_t unTrackedDeviceIndexArrayCount, vr::TrackedDeviceIndex_t unRelativeToTrackedDeviceIndex)
+	{
+		STUB_CALL();
+		StubCore& core = StubCore::Get();
+		std::lock_guard<std::mutex> lk(core.Mutex);
+		uint32_t count = 0;
+		for (vr::TrackedDeviceIndex_t i = 0; i < STUB_DEVICE_COUNT; i++)
+		{
+			if (!core.Connected[i] || GetClass(i) != eTrackedDeviceClass)
+				continue;
+			if (punTrackedDeviceIndexArray && count < unTrackedDeviceIndexArrayCount)
+				punTrackedDeviceIndexArray[count] = i;
+			count++;
+		}
+		return count;
+	}
+
+	virtual vr::EDeviceActivityLevel GetTrackedDeviceActivityLevel(vr::TrackedDeviceIndex_t unDeviceId)
+	{
+		STUB_CALL();
+		return unDeviceId < STUB_DEVICE_COUNT ? vr::k_EDeviceActivityLevel_UserInteraction : vr::k_EDeviceActivityLevel_Unknown;
+	}
+
+	virtual void ApplyTransform(vr::TrackedDevicePose_t* pOutputPose, const vr::TrackedDevicePose_t* pTrackedDevicePose, const vr::HmdMatrix34_t* pTransform)
+	{
+		STUB_CALL();
+		// Transform the pose into the space of the transform, including its velocities
+		vr::TrackedDevicePose_t pose = *pTrackedDevicePose;
+		const vr::HmdMatrix34_t& a = *pTransform;
+		const vr::HmdMatrix34_t& b = pTrackedDevicePose->mDeviceToAbsoluteTracking;
+		for (int i = 0; i < 3; i++)
+		{
+			for (int j = 0; j < 4; j++)
+				pose.mDeviceToAbsoluteTracking.m[i][j] = a.m[i][0] * b.m[0][j] + a.m[i][1] * b.m[1][j] + a.m[i][2] * b.m[2][j] + (j == 3 ? a.m[i][3] : 0.0f);
+
+			const vr::HmdVector3_t& v = pTrackedDevicePose->vVelocity;
+			const vr::HmdVector3_t& w = pTrackedDevicePose->vAngularVelocity;
+			pose.vVelocity.v[i] = a.m[i][0] * v.v[0] + a.m[i][1] * v.v[1] + a.m[i][2] * v.v[2];
+			pose.vAngularVelocity.v[i] = a.m[i][0] * w.v[0] + a.m[i][1] * w.v[1] + a.m[i][2] * w.v[2];
+		}
+		*pOutputPose = pose;
+	}
+
+	virtual vr::TrackedDeviceIndex_t GetTrackedDeviceIndexForControllerRole(vr::ETrackedControllerRole unDeviceType)
+	{
+		STUB_CALL();
+		StubCore& core = StubCore::Get();
+		std::lock_guard<std::mutex> lk(core.Mutex);
+		for (vr::TrackedDeviceIndex_t i = 1; i < STUB_DEVICE_COUNT; i++)
+		{
+			if (core.Connected[i] && GetRole(i) == unDeviceType)
+				return i;
+		}
+		return vr::k_unTrackedDeviceIndexInvalid;
+	}
+
+	virtual vr::ETrackedControllerRole GetControllerRoleForTrackedDeviceIndex(vr::TrackedDeviceIndex_t unDeviceIndex)
+	{
+		STUB_CALL();
+		return GetRole(unDeviceIndex);
+	}
+
+	virtual vr::ETrackedDeviceClass GetTrackedDeviceClass(vr::TrackedDeviceIndex_t unDeviceIndex)
+	{
+		STUB_CALL();
+		return GetClass(unDeviceIndex);
+	}
+
+	virtual bool IsTrackedDeviceConnected(vr::TrackedDeviceIndex_t unDeviceIndex)
+	{
+		STUB_CALL();
+		StubCore& core = StubCore::Get();
+		std::lock_guard<std::mutex> lk(core.Mutex);
+		return unDeviceIndex < STUB_DEVICE_COUNT && core.Connected[unDeviceIndex];
+	}
+
+	virtual bool GetBoolTrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError* pError)
+	{
+		STUB_CALL();
+		std::string value;
+		return GetProperty(unDeviceIndex, prop, value, pError) && (value == "1" || value == "true");
+	}
+
+	virtual float GetFloatTrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError* pError)
+	{
+		STUB_CALL();
+		std::string value;
+		return GetProperty(unDeviceIndex, prop, value, pError) ? strtof(value.c_str(), nullptr) : 0.0f;
+	}
+
+	virtual int32_t GetInt32TrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError* pError)
+	{
+		STUB_CALL();
+		std::string value;
+		return GetProperty(unDeviceIndex, prop, value, pError) ? strtol(value.c_str(), nullptr, 0) : 0;
+	}
+
+	virtual uint64_t GetUint64TrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError* pError)
+	{
+		STUB_CALL();
+		std::string value;
+		return GetProperty(unDeviceIndex, prop, value, pError) ? strtoull(value.c_str(), nullptr, 0) : 0;
+	}
+
+	virtual vr::HmdMatrix34_t GetMatrix34TrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError* pError)
+	{
+		STUB_CALL();
+		if (pError)
+			*pError = vr::TrackedProp_UnknownProperty;
+		return StubMath::ToMatrix(StubMath::Identity());
+	}
+
+	virtual uint32_t GetArrayTrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, vr::PropertyTypeTag_t propType,
+		void* pBuffer, uint32_t unBufferSize, vr::ETrackedPropertyError* pError)
+	{
+		STUB_CALL();
+		if (pError)
+			*pError = vr::TrackedProp_UnknownProperty;
+		return 0;
+	}
+
+	virtual uint32_t GetStringTrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop,
+		char* pchValue, uint32_t unBufferSize, vr::ETrackedPropertyError* pError)
+	{
+		STUB_CALL();
+		std::string value;
+		if (!GetProperty(unDeviceIndex, prop, value, pError))
+			return 0;
+
+		uint32_t required = StubCopyString(value, pchValue, unBufferSize);
+		if (pError && required > unBufferSize)
+			*pError = vr::TrackedProp_BufferTooSmall;
+		return required;
+	}
+
+	virtual const char* GetPropErrorNameFromEnum(vr::ETrackedPropertyError error)
+	{
+		STUB_CALL();
+		return error == vr::TrackedProp_Success ? "TrackedProp_Success" : "TrackedProp_Error";
+	}
+
+	virtual bool PollNextEvent(vr::VREvent_t* pEvent, uint32_t uncbVREvent)
+	{
+		STUB_CALL();
+		return StubCore::Get().PollEvent(pEvent, uncbVREvent);
+	}
+
+	virtual bool PollNextEventWithPose(vr::ETrackingUniverseOrigin eOrigin, vr::VREvent_t* pEvent, uint32_t uncbVREvent, vr::TrackedDevicePose_t* pTrackedDevicePose)
+	{
+		STUB_CALL();
+		StubCore& core = StubCore::Get();
+		if (!core.PollEvent(pEvent, uncbVREvent))
+			return false;
+
+		if (pTrackedDevicePose)
+		{
+			std::lock_guard<std::mutex> lk(core.Mutex);
+			*pTrackedDevicePose = core.GetPose(pEvent->trackedDeviceIndex, eOrigin, core.Now());
+		}
+		return true;
+	}
+
+	virtual const char* GetEventTypeNameFromEnum(vr::EVREventType eType)
+	{
+		STUB_CALL();
+		static char s_name[32];
+		snprintf(s_name, sizeof(s_name), "VREvent_%d", (int)eType);
+		return s_name;
+	}
+
+	virtual vr::HiddenAreaMesh_t GetHiddenAreaMesh(vr::EVREye eEye, vr::EHiddenAreaMeshType type)
+	{
+		STUB_CALL();
+		vr::HiddenAreaMesh_t mesh = { nullptr, 0 };
+		const StubScript& script = StubCore::Get().Script;
+		auto it = script.Masks.find(type);
+		if (it == script.Masks.end() || it->second.empty())
+			return mesh;
+
+		// Line loops are counted in vertices, meshes in triangles
+		mesh.pVertexData = it->second.data();
+		mesh.unTriangleCount = (uint32_t)it->second.size();
+		if (type != vr::k_eHiddenAreaMesh_LineLoop)
+			mesh.unTriangleCount /= 3;
+		return mesh;
+	}
+
+	virtual bool GetControllerState(vr::TrackedDeviceIndex_t unControllerDeviceIndex, vr::VRControllerState_t* pControllerState, uint32_t unControllerStateSize)
+	{
+		STUB_CALL();
+		if (!pControllerState || unControllerDeviceIndex >= STUB_DEVICE_COUNT)
+			return false;
+
+		// Legacy input is not simulated, the action system carries the scripted values
+		memset(pControllerState, 0, std::min(unControllerStateSize, (uint32_t)sizeof(vr::VRControllerState_t)));
+		pControllerState->unPacketNum = StubCore::Get().GetFrameIndex();
+		return true;
+	}
+
+	virtual bool GetControllerStateWithPose(vr::ETrackingUniverseOrigin eOrigin, vr::TrackedDeviceIndex_t unControllerDeviceIndex,
+		vr::VRControllerState_t* pControllerState, uint32_t unControllerStateSize, vr::TrackedDevicePose_t* pTrackedDevicePose)
+	{
+		STUB_CALL();
+		if (!pControllerState || unControllerDeviceIndex >= STUB_DEVICE_COUNT)
+			return false;
+
+		StubCore& core = StubCore::Get();
+		memset(pControllerState, 0, std::min(unControllerStateSize, (uint32_t)sizeof(vr::VRControllerState_t)));
+		pControllerState->unPacketNum = core.GetFrameIndex();
+		if (pTrackedDevicePose)
+		{
+			std::lock_guard<std::mutex> lk(core.Mutex);
+			*pTrackedDevicePose = core.GetPose(unControllerDeviceIndex, eOrigin, core.Now());
+		}
+		return true;
+	}
+
+	virtual void TriggerHapticPulse(vr::TrackedDeviceIndex_t unControllerDeviceIndex, uint32_t unAxisId, unsigned short usDurationMicroSec) { STUB_CALL(); }
+	virtual const char* GetButtonIdNameFromEnum(vr::EVRButtonId eButtonId) { STUB_CALL(); return "k_EButton"; }
+	virtual const char* GetControllerAxisTypeNameFromEnum(vr::EVRControllerAxisType eAxisType) { STUB_CALL(); return "k_eControllerAxis"; }
+	virtual bool IsInputAvailable() { STUB_CALL(); return true; }
+	virtual bool IsSteamVRDrawingControllers() { STUB_CALL(); return false; }
+	virtual bool ShouldApplicationPause() { STUB_CALL(); return false; }
+	virtual bool ShouldApplicationReduceRenderingWork() { STUB_CALL(); return false; }
+	virtual vr::EVRFirmwareError PerformFirmwareUpdate(vr::TrackedDeviceIndex_t unDeviceIndex) { STUB_CALL(); return vr::VRFirmwareError_None; }
+	virtual void AcknowledgeQuit_Exiting() { STUB_CALL(); }
+	virtual uint32_t GetAppContainerFilePaths(char* pchBuffer, uint32_t unBufferSize) { STUB_CALL(); return StubCopyString("", pchBuffer, unBufferSize); }
+	virtual const char* GetRuntimeVersion() { STUB_CALL(); return "1.0.0-stub"; }
+
+private:
+	static vr::ETrackedDeviceClass GetClass(vr::TrackedDeviceIndex_t index)
+	{
+		if (index == vr::k_unTrackedDeviceIndex_Hmd)
+			return vr::TrackedDeviceClass_HMD;
+		if (index < STUB_DEVICE_COUNT)
+			return vr::TrackedDeviceClass_Controller;
+		return vr::TrackedDeviceClass_Invalid;
+	}
+
+	static vr::ETrackedControllerRole GetRole(vr::TrackedDeviceIndex_t index)
+	{
+		if (index == 1)
+			return vr::TrackedControllerRole_LeftHand;
+		if (index == 2)
+			return vr::TrackedControllerRole_RightHand;
+		return vr::TrackedControllerRole_Invalid;
+	}
+
+	static void GetTangents(vr::EVREye eye, float* left, float* right, float* top, float* bottom)
+	{
+		// OpenVR reports the vertical tangents with the y-axis pointing down
+		const StubScript::Fov& fov = StubCore::Get().Script.FieldOfView;
+		if (left)
+			*left = tanf(fov.Left);
+		if (right)
+			*right = tanf(fov.Right);
+		if (top)
+			*top = tanf(fov.Down);
+		if (bottom)
+			*bottom = tanf(fov.Up);
+	}
+
+	// Properties are stored as text so the script can override any of them
+	static bool GetProperty(vr::TrackedDeviceIndex_t index, vr::ETrackedDeviceProperty prop, std::string& value, vr::ETrackedPropertyError* error)
+	{
+		if (error)
+			*error = vr::TrackedProp_Success;
+		if (index >= STUB_DEVICE_COUNT)
+		{
+			if (error)
+				*error = vr::TrackedProp_InvalidDevice;
+			return false;
+		}
+
+		const StubScript& script = StubCore::Get().Script;
+		auto it = script.Properties.find(std::make_pair(index, prop));
+		if (it != script.Properties.end())
+		{
+			value = it->second;
+			return true;
+		}
+
+		char buffer[64];
+		switch (prop)
+		{
+		case vr::Prop_TrackingSystemName_String: value = "stub"; break;
+		case vr::Prop_ManufacturerName_String: value = "Revive"; break;
+		case vr::Prop_ModelNumber_String: value = index == vr::k_unTrackedDeviceIndex_Hmd ? "Stub HMD" : "Stub Controller"; break;
+		case vr::Prop_ControllerType_String: value = index == vr::k_unTrackedDeviceIndex_Hmd ? "stub_hmd" : "oculus_touch"; break;
+		case vr::Prop_RenderModelName_String: value = index == vr::k_unTrackedDeviceIndex_Hmd ? "generic_hmd" : "generic_controller"; break;
+		case vr::Prop_SerialNumber_String:
+			snprintf(buffer, sizeof(buffer), "STUB-%u", index);
+			value = buffer;
+			break;
+		case vr::Prop_DeviceClass_Int32: value = std::to_string((int)GetClass(index)); break;
+		case vr::Prop_ControllerRoleHint_Int32: value = std::to_string((int)GetRole(index)); break;
+		case vr::Prop_DeviceProvidesBatteryStatus_Bool: value = index == vr::k_unTrackedDeviceIndex_Hmd ? "0" : "1"; break;
+		case vr::Prop_DeviceBatteryPercentage_Float: value = "1"; break;
+		default:
+			if (index != vr::k_unTrackedDeviceIndex_Hmd)
+			{
+				if (error)
+					*error = vr::TrackedProp_UnknownProperty;
+				return false;
+			}
+
+			// Display properties only apply to the headset
+			switch (prop)
+			{
+			case vr::Prop_DisplayFrequency_Float: value = std::to_string(script.RefreshRate); break;
+			case vr::Prop_UserIpdMeters_Float: value = std::to_string(script.Ipd); break;
+			case vr::Prop_SecondsFromVsyncToPhotons_Float: value = "0"; break;
+			case vr::Prop_UserHeadToEyeDepthMeters_Float: value = "0"; break;
+			case vr::Prop_DisplayMCImageWidth_Int32: value = std::to_string(script.Width * 2); break;
+			case vr::Prop_DisplayMCImageHeight_Int32: value = std::to_string(script.Height); break;
+			case vr::Prop_EdidVendorID_Int32: value = "0"; break;
+			case vr::Prop_EdidProductID_Int32: value = "0"; break;
+			default:
+				if (error)
+					*error = vr::TrackedProp_UnknownProperty;
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+vr::IVRSystem* GetStubSystem()
+{
+	static StubSystem s_System;
+	return &s_System;
+}
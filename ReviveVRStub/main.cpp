@@ -0,0 +1,121 @@
+#include "StubCore.h"
+
+#include <ivrclientcore.h>
+#include <string.h>
+
+struct StubInterface
+{
+	const char* Version;
+	void* (*Get)();
+};
+
+// Interfaces implemented by the stub, any other version is reported as not found
+static const StubInterface s_interfaces[] = {
+	{ vr::IVRSystem_Version, []() -> void* { return GetStubSystem(); } },
+	{ vr::IVRCompositor_Version, []() -> void* { return GetStubCompositor(); } },
+	{ vr::IVROverlay_Version, []() -> void* { return GetStubOverlay(); } },
+	{ vr::IVRInput_Version, []() -> void* { return GetStubInput(); } },
+	{ vr::IVRChaperone_Version, []() -> void* { return GetStubChaperone(); } },
+	{ vr::IVRChaperoneSetup_Version, []() -> void* { return GetStubChaperoneSetup(); } },
+	{ vr::IVRSettings_Version, []() -> void* { return GetStubSettings(); } },
+	{ vr::IVRApplications_Version, []() -> void* { return GetStubApplications(); } },
+};
+
+class StubClientCore : public vr::IVRClientCore
+{
+public:
+	StubClientCore()
+		: m_Initialized(false)
+	{
+	}
+
+	virtual vr::EVRInitError Init(vr::EVRApplicationType eApplicationType, const char* pStartupInfo)
+	{
+		if (m_Initialized)
+			return vr::VRInitError_None;
+
+		StubCore::Get().Init();
+		m_Initialized = true;
+		return vr::VRInitError_None;
+	}
+
+	virtual void Cleanup()
+	{
+		if (!m_Initialized)
+			return;
+
+		StubCore::Get().Shutdown();
+		m_Initialized = false;
+	}
+
+	virtual vr::EVRInitError IsInterfaceVersionValid(const char* pchInterfaceVersion)
+	{
+		return Find(pchInterfaceVersion) ? vr::VRInitError_None : vr::VRInitError_Init_InterfaceNotFound;
+	}
+
+	virtual void* GetGenericInterface(const char* pchNameAndVersion, vr::EVRInitError* peError)
+	{
+		const StubInterface* stub = m_Initialized ? Find(pchNameAndVersion) : nullptr;
+		if (peError)
+			*peError = !m_Initialized ? vr::VRInitError_Init_NotInitialized : stub ? vr::VRInitError_None : vr::VRInitError_Init_InterfaceNotFound;
+		return stub ? stub->Get() : nullptr;
+	}
+
+	// The simulated headset is always present
+	virtual bool BIsHmdPresent() { return true; }
+
+	virtual const char* GetEnglishStringForHmdError(vr::EVRInitError eError)
+	{
+		switch (eError)
+		{
+		case vr::VRInitError_None: return "No Error";
+		case vr::VRInitError_Init_InterfaceNotFound: return "Interface not implemented by the stub runtime";
+		case vr::VRInitError_Init_NotInitialized: return "Stub runtime not initialized";
+		default: return "Stub runtime error";
+		}
+	}
+
+	virtual const char* GetIDForVRInitError(vr::EVRInitError eError)
+	{
+		switch (eError)
+		{
+		case vr::VRInitError_None: return "VRInitError_None";
+		case vr::VRInitError_Init_InterfaceNotFound: return "VRInitError_Init_InterfaceNotFound";
+		case vr::VRInitError_Init_NotInitialized: return "VRInitError_Init_NotInitialized";
+		default: return "VRInitError_Unknown";
+		}
+	}
+
+private:
+	bool m_Initialized;
+
+	static const StubInterface* Find(const char* version)
+	{
+		if (!version)
+			return nullptr;
+
+		// The flat C interfaces are requested with a FnTable: prefix and are not supported
+		for (const StubInterface& stub : s_interfaces)
+		{
+			if (strcmp(stub.Version, version) == 0)
+				return &stub;
+		}
+		return nullptr;
+	}
+};
+
+// Set VR_OVERRIDE to the ReviveVRStub output folder to make openvr_api load the stub from its bin folder
+extern "C" void* VRClientCoreFactory(const char* pInterfaceName, int* pReturnCode)
+{
+	static StubClientCore s_ClientCore;
+	if (pInterfaceName && strcmp(pInterfaceName, vr::IVRClientCore_Version) == 0)
+	{
+		if (pReturnCode)
+			*pReturnCode = vr::VRInitError_None;
+		return &s_ClientCore;
+	}
+
+	if (pReturnCode)
+		*pReturnCode = vr::VRInitError_Init_InterfaceNotFound;
+	return nullptr;
+}
@@ -0,0 +1,68 @@
+#include "AudioEndpoints.h"
+
+#include <wctype.h>
+
+static bool EqualsNoCase(const std::wstring& a, const std::wstring& b)
+{
+	if (a.size() != b.size())
+		return false;
+
+	for (size_t i = 0; i < a.size(); i++)
+	{
+		if (towlower(a[i]) != towlower(b[i]))
+			return false;
+	}
+	return true;
+}
+
+AudioEndpoints::AudioEndpoints(std::unique_ptr<AudioDeviceSource> source)
+	: m_Source(std::move(source))
+	, m_Valid(false)
+{
+}
+
+AudioEndpoint AudioEndpoints::Get(AudioFlow flow)
+{
+	std::lock_guard<std::mutex> lk(m_Mutex);
+	if (!m_Valid)
+	{
+		// Mark the endpoints as valid first, so a change during the resolution isn't lost
+		m_Valid = true;
+		for (int i = 0; i < AudioFlow_Count; i++)
+			Resolve((AudioFlow)i, m_Endpoints[i]);
+	}
+	return m_Endpoints[flow];
+}
+
+void AudioEndpoints::Resolve(AudioFlow flow, AudioEndpoint& endpoint)
+{
+	endpoint = AudioEndpoint();
+
+	if (!m_Source->HasHeadsetEndpoints())
+	{
+		// Without the headset endpoints we can only fall back to the default devices
+		endpoint.HasId = m_Source->GetDefaultEndpoint(flow, endpoint.Id);
+		endpoint.HasGuid = m_Source->GetEndpointGuid(flow, std::wstring(), endpoint.Guid);
+		endpoint.HasWaveId = m_Source->GetPreferredWaveDevice(flow, endpoint.WaveId);
+		return;
+	}
+
+	endpoint.HasId = m_Source->GetHeadsetEndpoint(flow, endpoint.Id);
+	if (!endpoint.HasId)
+		return;
+
+	endpoint.HasGuid = m_Source->GetEndpointGuid(flow, endpoint.Id, endpoint.Guid);
+
+	// Find the WinMM device that belongs to the endpoint
+	std::wstring waveEndpoint;
+	uint32_t count = m_Source->GetWaveDeviceCount(flow);
+	for (uint32_t i = 0; i < count; i++)
+	{
+		if (m_Source->GetWaveDeviceEndpoint(flow, i, waveEndpoint) && EqualsNoCase(waveEndpoint, endpoint.Id))
+		{
+			endpoint.WaveId = i;
+			endpoint.HasWaveId = true;
+			break;
+		}
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+
+enum AudioFlow
+{
+	AudioFlow_Out,
+	AudioFlow_In,
+	AudioFlow_Count
+};
+
+// Abstracts the system audio APIs, so the endpoint resolution doesn't depend on any audio devices
+// and can be exercised with a fake source.
+class AudioDeviceSource
+{
+public:
+	virtual ~AudioDeviceSource() {}
+
+	// Whether the runtime reports the headset endpoints, otherwise the default devices are used
+	virtual bool HasHeadsetEndpoints() = 0;
+	// Endpoint id of the headset reported by the runtime
+	virtual bool GetHeadsetEndpoint(AudioFlow flow, std::wstring& id) = 0;
+	// Endpoint id of the default device
+	virtual bool GetDefaultEndpoint(AudioFlow flow, std::wstring& id) = 0;
+	// String form of the GUID of an endpoint, or of the default device if the id is empty
+	virtual bool GetEndpointGuid(AudioFlow flow, const std::wstring& id, std::wstring& guid) = 0;
+
+	// Enumerates the WinMM devices, which are matched against the endpoint by their ids
+	virtual uint32_t GetWaveDeviceCount(AudioFlow flow) = 0;
+	virtual bool GetWaveDeviceEndpoint(AudioFlow flow, uint32_t index, std::wstring& id) = 0;
+	// WinMM device preferred by the wave mapper, used if the runtime doesn't report the headset
+	virtual bool GetPreferredWaveDevice(AudioFlow flow, uint32_t& index) = 0;
+};
+
+// All identifiers of an audio endpoint, the flags tell which ones could be resolved
+struct AudioEndpoint
+{
+	bool HasId;
+	bool HasGuid;
+	bool HasWaveId;
+	std::wstring Id;
+	std::wstring Guid;
+	uint32_t WaveId;
+};
+
+// Resolves the identifiers of the headset audio endpoints once and answers all queries from memory.
+// The source should call Invalidate() when the audio devices change, the next query then resolves
+// all identifiers again.
+class AudioEndpoints
+{
+public:
+	AudioEndpoints(std::unique_ptr<AudioDeviceSource> source);
+
+	AudioEndpoint Get(AudioFlow flow);
+	// Safe to call from any thread, including device notification callbacks
+	void Invalidate() { m_Valid = false; }
+
+private:
+	void Resolve(AudioFlow flow, AudioEndpoint& endpoint);
+
+	std::unique_ptr<AudioDeviceSource> m_Source;
+	std::mutex m_Mutex;
+	std::atomic_bool m_Valid;
+	AudioEndpoint m_Endpoints[AudioFlow_Count];
+};
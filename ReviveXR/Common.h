@@ -2,17 +2,24 @@
 
 #include "OVR_CAPI.h"
 #include "microprofile.h"
+#include "../Revive/Trace.h"
+#include "../Revive/StartupTrace.h"
 
 #include <openxr/openxr.h>
 #include <openxr/openxr_reflection.h>
 #include <assert.h>
 #include <string>
 
+#define REV_TRACE_PASTE0(a, b) a ## b
+#define REV_TRACE_PASTE(a, b) REV_TRACE_PASTE0(a, b)
+
 #if 0
 #include <Windows.h>
 #define REV_TRACE(x) OutputDebugStringA("Revive: " #x "\n");
 #else
-#define REV_TRACE(x) MICROPROFILE_SCOPEI("Revive", #x, 0xff0000);
+#define REV_TRACE(x) \
+	struct REV_TRACE_PASTE(rev_trace_tag_, __LINE__) { static const char* Name() { return #x; } }; \
+	TraceScope<REV_TRACE_PASTE(rev_trace_tag_, __LINE__)> REV_TRACE_PASTE(rev_trace_scope_, __LINE__);
 #endif
 
 #define XR_ENUM_CASE_STR(name, val) case name: return L#name;
@@ -0,0 +1,158 @@
+#include "FlightRecorder.h"
+#include "Common.h"
+
+#include <Windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+
+// Number of events in the ring. A frame records about a dozen events, so this covers the dump window
+// of five seconds at 120Hz as long as a frame records less than a hundred events. Applications that
+// locate more often get a dump that starts later than the window.
+#define REV_FLIGHT_BUFFER_SIZE 0x10000
+// A frame counts as a hitch when the display interval exceeds this many display periods
+#define REV_FLIGHT_HITCH_THRESHOLD 1.5
+// Seconds of events preceding and following the hitch that are written to the dump
+#define REV_FLIGHT_PRE_WINDOW 4
+#define REV_FLIGHT_POST_WINDOW 1
+// Minimum number of seconds between dumps and the maximum number of dumps per session
+#define REV_FLIGHT_COOLDOWN 10
+#define REV_FLIGHT_MAX_DUMPS 16
+
+const uint32_t FlightRecorder::s_magic = 'RFVR';
+const uint32_t FlightRecorder::s_version = 1;
+
+FlightRecorder::FlightRecorder()
+	: m_Events(REV_FLIGHT_BUFFER_SIZE)
+	, m_Index(0)
+	, m_Frequency(1)
+	, m_LastDisplayTime(0)
+	, m_HitchTicks(0)
+	, m_LastDump(0)
+	, m_HitchPeriod(0)
+	, m_HitchFrame(0)
+	, m_Dumps(0)
+{
+	LARGE_INTEGER freq;
+	if (QueryPerformanceFrequency(&freq))
+		m_Frequency = freq.QuadPart;
+}
+
+FlightRecorder::~FlightRecorder()
+{
+	if (m_Writer.joinable())
+		m_Writer.join();
+}
+
+bool FlightRecorder::IsEnabled()
+{
+	const char* env = getenv("REVIVE_FLIGHT_RECORDER");
+	if (env)
+		return atoi(env) != 0;
+
+	DWORD value = 0, size = sizeof(DWORD);
+	RegGetValueA(HKEY_CURRENT_USER, "Software\\Revive", "FlightRecorder", RRF_RT_REG_DWORD, NULL, &value, &size);
+	return value != 0;
+}
+
+void FlightRecorder::Record(FlightEventType type, long long frame, int64_t start, int64_t end)
+{
+	uint64_t index = m_Index.fetch_add(1, std::memory_order_relaxed);
+	FlightEvent& event = m_Events[index % REV_FLIGHT_BUFFER_SIZE];
+	event.Start = start;
+	event.End = end;
+	event.Frame = (uint32_t)frame;
+	event.Type = type;
+}
+
+void FlightRecorder::FrameWaited(long long frame, const XrFrameState& state)
+{
+	int64_t now = Trace::GetTicks();
+
+	// Only arm the detector when there's no dump pending and we haven't exhausted our budget
+	XrDuration interval = state.predictedDisplayTime - m_LastDisplayTime;
+	if (m_LastDisplayTime && !m_HitchTicks && m_Dumps < REV_FLIGHT_MAX_DUMPS &&
+		interval > state.predictedDisplayPeriod * REV_FLIGHT_HITCH_THRESHOLD &&
+		(!m_LastDump || now - m_LastDump > REV_FLIGHT_COOLDOWN * m_Frequency))
+	{
+		m_HitchTicks = now;
+		m_HitchFrame = frame;
+		m_HitchPeriod = state.predictedDisplayPeriod;
+	}
+	m_LastDisplayTime = state.predictedDisplayTime;
+
+	// Wait until the frames following the hitch are recorded as well
+	if (m_HitchTicks && now - m_HitchTicks > REV_FLIGHT_POST_WINDOW * m_Frequency)
+		Dump(now);
+}
+
+void FlightRecorder::Dump(int64_t now)
+{
+	MICROPROFILE_SCOPEI("Revive", "FlightRecorder::Dump", 0xff0000);
+
+	Header header = {};
+	header.Magic = s_magic;
+	header.Version = s_version;
+	header.Frequency = m_Frequency;
+	header.HitchTicks = m_HitchTicks;
+	header.DisplayPeriod = m_HitchPeriod;
+	header.HitchFrame = (uint32_t)m_HitchFrame;
+
+	// Other threads may still be writing the newest slots, those events are only used for
+	// diagnostics so a torn event is acceptable and we don't pay for a sequence lock
+	int64_t windowStart = m_HitchTicks - REV_FLIGHT_PRE_WINDOW * m_Frequency;
+	uint64_t end = m_Index.load(std::memory_order_acquire);
+	uint64_t begin = end > REV_FLIGHT_BUFFER_SIZE ? end - REV_FLIGHT_BUFFER_SIZE : 0;
+	std::vector<FlightEvent> events;
+	events.reserve((size_t)(end - begin));
+	for (uint64_t i = begin; i < end; i++)
+	{
+		const FlightEvent& event = m_Events[i % REV_FLIGHT_BUFFER_SIZE];
+		if (event.End >= windowStart && event.Start <= now)
+			events.push_back(event);
+	}
+	header.Count = (uint32_t)events.size();
+
+	// Write the file on a separate thread so the dump itself doesn't cause another hitch
+	if (m_Writer.joinable())
+		m_Writer.join();
+	m_Writer = std::thread(Write, header, std::move(events));
+
+	m_LastDump = now;
+	m_HitchTicks = 0;
+	m_Dumps++;
+}
+
+void FlightRecorder::Write(Header header, std::vector<FlightEvent> events)
+{
+	char path[MAX_PATH];
+	if (!Trace::GetDefaultPath("Hitch", "bin", path, sizeof(path)))
+		return;
+
+	// Write to a temporary file first, so a reader never sees a partially written dump
+	std::string temp = std::string(path) + ".tmp";
+	FILE* file = fopen(temp.c_str(), "wb");
+	if (!file)
+		return;
+
+	bool success = fwrite(&header, sizeof(Header), 1, file) == 1 &&
+		(events.empty() || fwrite(events.data(), sizeof(FlightEvent), events.size(), file) == events.size());
+	fclose(file);
+
+	if (!success || !MoveFileExA(temp.c_str(), path, MOVEFILE_REPLACE_EXISTING))
+		DeleteFileA(temp.c_str());
+}
+
+FlightScope::FlightScope(FlightRecorder* recorder, FlightEventType type, long long frame)
+	: m_Recorder(recorder)
+	, m_Type(type)
+	, m_Frame(frame)
+	, m_Start(recorder ? Trace::GetTicks() : 0)
+{
+}
+
+FlightScope::~FlightScope()
+{
+	if (m_Recorder)
+		m_Recorder->Record(m_Type, m_Frame, m_Start, Trace::GetTicks());
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <openxr/openxr.h>
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+enum FlightEventType : uint32_t
+{
+	FlightEvent_Wait,
+	FlightEvent_Begin,
+	FlightEvent_End,
+	FlightEvent_Commit,
+	FlightEvent_Sync,
+	FlightEvent_Locate,
+};
+
+struct FlightEvent
+{
+	int64_t Start;
+	int64_t End;
+	uint32_t Frame;
+	FlightEventType Type;
+};
+
+// Keeps the last few seconds of frame events in a fixed ring, recording an event is a single
+// atomic increment and a copy so it's cheap enough to be left on while playing. When the predicted
+// display times show a missed frame, the window surrounding the hitch is written to a binary file.
+class FlightRecorder
+{
+public:
+	FlightRecorder();
+	~FlightRecorder();
+
+	// Reads REVIVE_FLIGHT_RECORDER or the HKCU\Software\Revive\FlightRecorder registry value,
+	// the recorder is disabled unless it's set to a non-zero value
+	static bool IsEnabled();
+
+	void Record(FlightEventType type, long long frame, int64_t start, int64_t end);
+
+	// Compares the interval between predicted display times against the display period,
+	// should be called on the render thread after every xrWaitFrame
+	void FrameWaited(long long frame, const XrFrameState& state);
+
+private:
+	struct Header
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		int64_t Frequency;
+		int64_t HitchTicks;
+		int64_t DisplayPeriod;
+		uint32_t HitchFrame;
+		uint32_t Count;
+	};
+
+	static const uint32_t s_magic;
+	static const uint32_t s_version;
+
+	std::vector<FlightEvent> m_Events;
+	std::atomic_uint64_t m_Index;
+	int64_t m_Frequency;
+
+	// Detector state, only accessed on the render thread
+	XrTime m_LastDisplayTime;
+	int64_t m_HitchTicks;
+	int64_t m_LastDump;
+	XrDuration m_HitchPeriod;
+	long long m_HitchFrame;
+	uint32_t m_Dumps;
+
+	std::thread m_Writer;
+
+	void Dump(int64_t now);
+	static void Write(Header header, std::vector<FlightEvent> events);
+};
+
+class FlightScope
+{
+public:
+	FlightScope(FlightRecorder* recorder, FlightEventType type, long long frame);
+	~FlightScope();
+
+private:
+	FlightRecorder* m_Recorder;
+	FlightEventType m_Type;
+	long long m_Frame;
+	int64_t m_Start;
+};
@@ -9,6 +9,8 @@
 #include "Runtime.h"
 #include "InputManager.h"
 #include "Swapchain.h"
+#include "FlightRecorder.h"
+#include "SessionRegistry.h"
 
 #include <Windows.h>
 #include <openxr/openxr.h>
@@ -16,13 +18,13 @@
 #include <list>
 #include <vector>
 #include <algorithm>
+#include <mutex>
 #include <shared_mutex>
 #include <thread>
 #include <chrono>
 #include <detours/detours.h>
 
 XrInstance g_Instance = XR_NULL_HANDLE;
-std::list<ovrHmdStruct> g_Sessions;
 
 using namespace std::chrono_literals;
 
@@ -54,25 +56,30 @@ bool LoadRenderDoc()
 
 void AttachDetours();
 void DetachDetours();
+void InvalidateAudioEndpoints();
+void ShutdownAudioEndpoints();
 
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_Initialize(const ovrInitParams* params)
 {
 	if (g_Instance)
 		return ovrSuccess;
 
+	StartupTrace::Stamp("ovr_Initialize");
+
 #if 0
 	LoadRenderDoc();
 #endif
 
-	MicroProfileOnThreadCreate("Main");
-	MicroProfileSetForceEnable(true);
-	MicroProfileSetEnableAllGroups(true);
-	MicroProfileSetForceMetaCounters(true);
-	MicroProfileWebServerStart();
+	Trace::Initialize();
+	Capture::Initialize(params);
 
 	DetachDetours();
 	ovrResult rs = Runtime::Get().CreateInstance(&g_Instance, params);
 	AttachDetours();
+
+	// Any audio endpoints queried before the instance existed were resolved to the default devices
+	InvalidateAudioEndpoints();
+	StartupTrace::Stamp("Initialized");
 	return rs;
 }
 
@@ -81,21 +88,17 @@ OVR_PUBLIC_FUNCTION(void) ovr_Shutdown()
 	REV_TRACE(ovr_Shutdown);
 
 	// End all sessions
-	std::vector<XrSession> ToDestroy;
-	auto it = g_Sessions.begin();
-	while (it != g_Sessions.end())
-	{
-		// After years of work I have perfected my most unmaintainable line of
-		// code. It's very important that the iterator is incremented after the
-		// pointer is taken but before ovr_Destroy() is called or we *will* crash.
-		ovr_Destroy(&*it++);
-	}
+	for (ovrSession session : g_Sessions.GetAll())
+		ovr_Destroy(session);
 
 	// Destroy and reset the instance
 	XrResult rs = xrDestroyInstance(g_Instance);
 	assert(XR_SUCCEEDED(rs));
 	g_Instance = XR_NULL_HANDLE;
 
+	ShutdownAudioEndpoints();
+	Trace::Shutdown();
+	Capture::Shutdown();
 	MicroProfileShutdown();
 }
 
@@ -124,6 +127,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_IdentifyClient(const char* identity) { return
 OVR_PUBLIC_FUNCTION(ovrHmdDesc) ovr_GetHmdDesc(ovrSession session)
 {
 	REV_TRACE(ovr_GetHmdDesc);
+	REV_SESSION(session);
 
 	ovrHmdDesc desc = { ovrHmd_None };
 
@@ -176,6 +180,7 @@ OVR_PUBLIC_FUNCTION(ovrHmdDesc) ovr_GetHmdDesc(ovrSession session)
 OVR_PUBLIC_FUNCTION(unsigned int) ovr_GetTrackerCount(ovrSession session)
 {
 	REV_TRACE(ovr_GetTrackerCount);
+	REV_SESSION(session);
 
 	if (!session)
 		return ovrError_InvalidSession;
@@ -208,15 +213,25 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_Create(ovrSession* pSession, ovrGraphicsLuid*
 
 	*pSession = nullptr;
 
-	// Initialize the opaque pointer with our own OpenXR-specific struct
-	g_Sessions.emplace_back();
-	ovrSession session = &g_Sessions.back();
+	// Allocate our own OpenXR-specific struct, the application only gets a handle to it
+	ovrHmdStruct* session = g_Sessions.Create();
+	if (!session)
+		return ovrError_RuntimeException;
 
 	// Initialize session, it will not be fully usable until a swapchain is created
-	CHK_OVR(session->InitSession(g_Instance));
+	StartupTrace::Stamp("ovr_Create");
+	ovrResult rs = session->InitSession(g_Instance);
+	if (OVR_FAILURE(rs))
+	{
+		g_Sessions.Release(session->Handle)->DestroySession();
+		return rs;
+	}
+
 	if (pLuid)
 		*pLuid = session->Adapter;
-	*pSession = session;
+	*pSession = session->Handle;
+	REV_CAPTURE(CaptureHandle(session->Handle));
+	StartupTrace::Stamp("Created session");
 	return ovrSuccess;
 }
 
@@ -224,6 +239,13 @@ OVR_PUBLIC_FUNCTION(void) ovr_Destroy(ovrSession session)
 {
 	REV_TRACE(ovr_Destroy);
 
+	// Release the slot first, any handle to this session is rejected and no more events are routed to it.
+	// This waits for other threads that are still using the session, so don't take a reference here.
+	std::shared_ptr<ovrHmdStruct> owned = g_Sessions.Release(session);
+	if (!owned)
+		return;
+
+	session = owned.get();
 	session->DestroySession();
 
 	if (!session->HookedFunctions.empty())
@@ -234,14 +256,12 @@ OVR_PUBLIC_FUNCTION(void) ovr_Destroy(ovrSession session)
 		DetourDetach(it.first, it.second);
 		DetourTransactionCommit();
 	}
-
-	// Delete the session from the list of sessions
-	g_Sessions.erase(std::find_if(g_Sessions.begin(), g_Sessions.end(), [session](ovrHmdStruct const& o) { return &o == session; }));
 }
 
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetSessionStatus(ovrSession session, ovrSessionStatus* sessionStatus)
 {
 	REV_TRACE(ovr_GetSessionStatus);
+	REV_SESSION(session);
 
 	if (!session)
 		return ovrError_InvalidSession;
@@ -249,8 +269,8 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetSessionStatus(ovrSession session, ovrSessi
 	if (!sessionStatus)
 		return ovrError_InvalidParameter;
 
+	// The event queue is shared by all sessions, so events are routed to the session they belong to
 	assert(session->SessionStatus.is_lock_free());
-	SessionStatusBits status = session->SessionStatus;
 	XrEventDataBuffer event = XR_TYPE(EVENT_DATA_BUFFER);
 	while (XR_UNQUALIFIED_SUCCESS(xrPollEvent(session->Instance, &event)))
 	{
@@ -260,8 +280,9 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetSessionStatus(ovrSession session, ovrSessi
 		{
 			const XrEventDataSessionStateChanged& stateChanged =
 				reinterpret_cast<XrEventDataSessionStateChanged&>(event);
-			if (stateChanged.session == session->Session)
+			g_Sessions.Dispatch(stateChanged.session, [&stateChanged](ovrHmdStruct* target)
 			{
+				SessionStatusBits status = target->SessionStatus;
 				switch (stateChanged.state)
 				{
 				case XR_SESSION_STATE_IDLE:
@@ -292,29 +313,40 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetSessionStatus(ovrSession session, ovrSessi
 					status.ShouldQuit = true;
 					break;
 				}
-				session->SessionStatus = status;
+				target->SessionStatus = status;
 
 				if (stateChanged.state == XR_SESSION_STATE_READY)
-					session->BeginSession();
+				{
+					StartupTrace::StampOnce("Session ready");
+					target->BeginSession();
+				}
 				if (stateChanged.state == XR_SESSION_STATE_STOPPING)
-					session->EndSession();
-			}
+					target->EndSession();
+			});
 			break;
 		}
 		case XR_TYPE_EVENT_DATA_INSTANCE_LOSS_PENDING:
 		{
 			const XrEventDataInstanceLossPending& lossPending =
 				reinterpret_cast<XrEventDataInstanceLossPending&>(event);
-			status.ShouldQuit = true;
-			session->SessionStatus = status;
+			g_Sessions.DispatchAll([](ovrHmdStruct* target)
+			{
+				SessionStatusBits status = target->SessionStatus;
+				status.ShouldQuit = true;
+				target->SessionStatus = status;
+			});
 			break;
 		}
 		case XR_TYPE_EVENT_DATA_REFERENCE_SPACE_CHANGE_PENDING:
 		{
 			const XrEventDataReferenceSpaceChangePending& spaceChange =
 				reinterpret_cast<XrEventDataReferenceSpaceChangePending&>(event);
-			status.ShouldRecenter = true;
-			session->SessionStatus = status;
+			g_Sessions.Dispatch(spaceChange.session, [](ovrHmdStruct* target)
+			{
+				SessionStatusBits status = target->SessionStatus;
+				status.ShouldRecenter = true;
+				target->SessionStatus = status;
+			});
 			break;
 		}
 		case XR_TYPE_EVENT_DATA_VISIBILITY_MASK_CHANGED_KHR:
@@ -325,9 +357,12 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetSessionStatus(ovrSession session, ovrSessi
 			if (maskChange.viewConfigurationType == XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO
 				&& maskChange.viewIndex < ovrEye_Count)
 			{
-				session->UpdateStencil((ovrEyeType)maskChange.viewIndex, XR_VISIBILITY_MASK_TYPE_HIDDEN_TRIANGLE_MESH_KHR);
-				session->UpdateStencil((ovrEyeType)maskChange.viewIndex, XR_VISIBILITY_MASK_TYPE_VISIBLE_TRIANGLE_MESH_KHR);
-				session->UpdateStencil((ovrEyeType)maskChange.viewIndex, XR_VISIBILITY_MASK_TYPE_LINE_LOOP_KHR);
+				g_Sessions.Dispatch(maskChange.session, [&maskChange](ovrHmdStruct* target)
+				{
+					target->UpdateStencil((ovrEyeType)maskChange.viewIndex, XR_VISIBILITY_MASK_TYPE_HIDDEN_TRIANGLE_MESH_KHR);
+					target->UpdateStencil((ovrEyeType)maskChange.viewIndex, XR_VISIBILITY_MASK_TYPE_VISIBLE_TRIANGLE_MESH_KHR);
+					target->UpdateStencil((ovrEyeType)maskChange.viewIndex, XR_VISIBILITY_MASK_TYPE_LINE_LOOP_KHR);
+				});
 			}
 			break;
 		}
@@ -335,6 +370,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetSessionStatus(ovrSession session, ovrSessi
 		event = XR_TYPE(EVENT_DATA_BUFFER);
 	}
 
+	SessionStatusBits status = session->SessionStatus;
 	sessionStatus->IsVisible = status.IsVisible;
 	sessionStatus->HmdPresent = status.HmdPresent;
 	sessionStatus->HmdMounted = status.HmdMounted;
@@ -352,6 +388,8 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetSessionStatus(ovrSession session, ovrSessi
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_SetTrackingOriginType(ovrSession session, ovrTrackingOrigin origin)
 {
 	REV_TRACE(ovr_SetTrackingOriginType);
+	REV_CAPTURE(origin);
+	REV_SESSION(session);
 
 	if (!session)
 		return ovrError_InvalidSession;
@@ -364,6 +402,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_SetTrackingOriginType(ovrSession session, ovr
 OVR_PUBLIC_FUNCTION(ovrTrackingOrigin) ovr_GetTrackingOriginType(ovrSession session)
 {
 	REV_TRACE(ovr_GetTrackingOriginType);
+	REV_SESSION(session);
 
 	if (!session)
 		return ovrTrackingOrigin_EyeLevel;
@@ -374,6 +413,7 @@ OVR_PUBLIC_FUNCTION(ovrTrackingOrigin) ovr_GetTrackingOriginType(ovrSession sess
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_RecenterTrackingOrigin(ovrSession session)
 {
 	REV_TRACE(ovr_RecenterTrackingOrigin);
+	REV_SESSION(session);
 
 	if (!session)
 		return ovrError_InvalidSession;
@@ -381,22 +421,28 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_RecenterTrackingOrigin(ovrSession session)
 	if (session->ViewSpace == XR_NULL_HANDLE)
 		return ovrSuccess;
 
-	ovr_ClearShouldRecenterFlag(session); 
+	ovr_ClearShouldRecenterFlag(session->Handle); 
 	return session->RecenterSpace(session->TrackingOrigin, session->ViewSpace);
 }
 
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_SpecifyTrackingOrigin(ovrSession session, ovrPosef originPose)
 {
+	REV_TRACE(ovr_SpecifyTrackingOrigin);
+	REV_SESSION(session);
+
 	if (!session)
 		return ovrError_InvalidSession;
 
-	ovr_ClearShouldRecenterFlag(session);
+	ovr_ClearShouldRecenterFlag(session->Handle);
 	XrSpace anchor = session->TrackingSpaces[session->TrackingOrigin];
 	return session->RecenterSpace(session->TrackingOrigin, anchor, originPose);
 }
 
 OVR_PUBLIC_FUNCTION(void) ovr_ClearShouldRecenterFlag(ovrSession session)
 {
+	REV_TRACE(ovr_ClearShouldRecenterFlag);
+	REV_SESSION(session);
+
 	if (!session)
 		return;
 
@@ -408,24 +454,29 @@ OVR_PUBLIC_FUNCTION(void) ovr_ClearShouldRecenterFlag(ovrSession session)
 OVR_PUBLIC_FUNCTION(ovrTrackingState) ovr_GetTrackingState(ovrSession session, double absTime, ovrBool latencyMarker)
 {
 	REV_TRACE(ovr_GetTrackingState);
+	REV_SESSION(session);
 
 	ovrTrackingState state = { 0 };
 	if (session && session->Input)
 	{
 		std::shared_lock<std::shared_mutex> lk(session->TrackingMutex);
+		FlightScope scope(session->Recorder.get(), FlightEvent_Locate, (*session->CurrentFrame).frameIndex);
 		session->Input->GetTrackingState(session, &state, absTime);
 	}
+	REV_CAPTURE(absTime, latencyMarker, state);
 	return state;
 }
 
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetDevicePoses(ovrSession session, ovrTrackedDeviceType* deviceTypes, int deviceCount, double absTime, ovrPoseStatef* outDevicePoses)
 {
 	REV_TRACE(ovr_GetDevicePoses);
+	REV_SESSION(session);
 
 	if (!session || !session->Input)
 		return ovrError_InvalidSession;
 
 	std::shared_lock<std::shared_mutex> lk(session->TrackingMutex);
+	FlightScope scope(session->Recorder.get(), FlightEvent_Locate, (*session->CurrentFrame).frameIndex);
 	return session->Input->GetDevicePoses(session, deviceTypes, deviceCount, absTime, outDevicePoses);
 }
 
@@ -445,13 +496,14 @@ OVR_PUBLIC_FUNCTION(ovrTrackingState) ovr_GetTrackingStateWithSensorData(ovrSess
 OVR_PUBLIC_FUNCTION(ovrTrackerPose) ovr_GetTrackerPose(ovrSession session, unsigned int trackerPoseIndex)
 {
 	REV_TRACE(ovr_GetTrackerPose);
+	REV_SESSION(session);
 
 	ovrTrackerPose tracker = { 0 };
 
 	if (!session)
 		return tracker;
 
-	if (trackerPoseIndex < ovr_GetTrackerCount(session))
+	if (trackerPoseIndex < ovr_GetTrackerCount(session->Handle))
 	{
 		const OVR::Posef poses[] = {
 			OVR::Posef(OVR::Quatf(OVR::Axis_Y, OVR::DegreeToRad(90.0f)), OVR::Vector3f(-2.0f, 0.0f, 0.2f)),
@@ -517,6 +569,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetInputState(ovrSession session, ovrControll
 {
 	REV_TRACE(ovr_GetInputState);
 	MICROPROFILE_META_CPU("Controller Type", controllerType);
+	REV_SESSION(session);
 
 	if (!session)
 		return ovrError_InvalidSession;
@@ -539,6 +592,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetInputState(ovrSession session, ovrControll
 	else
 		memcpy(inputState, &state, sizeof(ovrInputState));
 
+	REV_CAPTURE(controllerType, state);
 	return result;
 }
 
@@ -553,6 +607,7 @@ OVR_PUBLIC_FUNCTION(ovrTouchHapticsDesc) ovr_GetTouchHapticsDesc(ovrSession sess
 {
 	REV_TRACE(ovr_GetTouchHapticsDesc);
 	MICROPROFILE_META_CPU("Controller Type", controllerType);
+	REV_SESSION(session);
 
 	ovrTouchHapticsDesc desc = { 0 };
 	if (session && controllerType & ovrControllerType_Touch)
@@ -574,6 +629,8 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_SetControllerVibration(ovrSession session, ov
 {
 	REV_TRACE(ovr_SetControllerVibration);
 	MICROPROFILE_META_CPU("Controller Type", controllerType);
+	REV_CAPTURE(controllerType, frequency, amplitude);
+	REV_SESSION(session);
 
 	if (!session || !session->Input)
 		return ovrError_InvalidSession;
@@ -585,6 +642,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_SubmitControllerVibration(ovrSession session,
 {
 	REV_TRACE(ovr_SubmitControllerVibration);
 	MICROPROFILE_META_CPU("Controller Type", controllerType);
+	REV_SESSION(session);
 
 	if (!session || !session->Input)
 		return ovrError_InvalidSession;
@@ -596,6 +654,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetControllerVibrationState(ovrSession sessio
 {
 	REV_TRACE(ovr_GetControllerVibrationState);
 	MICROPROFILE_META_CPU("Controller Type", controllerType);
+	REV_SESSION(session);
 
 	if (!session || !session->Input)
 		return ovrError_InvalidSession;
@@ -635,13 +694,17 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_TestBoundaryPoint(ovrSession session, const o
 	ovrBoundaryType singleBoundaryType, ovrBoundaryTestResult* outTestResult)
 {
 	REV_TRACE(ovr_TestBoundaryPoint);
+	REV_SESSION(session);
+
+	if (!session)
+		return ovrError_InvalidSession;
 
 	ovrBoundaryTestResult result = { 0 };
 
 	result.IsTriggering = ovrFalse;
 
 	ovrVector3f bounds;
-	CHK_OVR(ovr_GetBoundaryDimensions(session, singleBoundaryType, &bounds));
+	CHK_OVR(ovr_GetBoundaryDimensions(session->Handle, singleBoundaryType, &bounds));
 
 	// Clamp the point to the AABB
 	OVR::Vector2f p(point->x, point->z);
@@ -693,6 +756,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_ResetBoundaryLookAndFeel(ovrSession session)
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetBoundaryGeometry(ovrSession session, ovrBoundaryType boundaryType, ovrVector3f* outFloorPoints, int* outFloorPointsCount)
 {
 	REV_TRACE(ovr_GetBoundaryGeometry);
+	REV_SESSION(session);
 
 	if (!session)
 		return ovrError_InvalidSession;
@@ -700,7 +764,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetBoundaryGeometry(ovrSession session, ovrBo
 	if (outFloorPoints)
 	{
 		ovrVector3f bounds;
-		CHK_OVR(ovr_GetBoundaryDimensions(session, boundaryType, &bounds));
+		CHK_OVR(ovr_GetBoundaryDimensions(session->Handle, boundaryType, &bounds));
 		ovrVector3f floorPoints[] = {
 			{ bounds.x / -2.0f, bounds.y, bounds.z /  2.0f},
 			{ bounds.x /  2.0f, bounds.y, bounds.z /  2.0f},
@@ -717,6 +781,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetBoundaryGeometry(ovrSession session, ovrBo
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetBoundaryDimensions(ovrSession session, ovrBoundaryType boundaryType, ovrVector3f* outDimensions)
 {
 	REV_TRACE(ovr_GetBoundaryDimensions);
+	REV_SESSION(session);
 
 	if (!session)
 		return ovrError_InvalidSession;
@@ -792,6 +857,8 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetTextureSwapChainDesc(ovrSession session, o
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_CommitTextureSwapChain(ovrSession session, ovrTextureSwapChain chain)
 {
 	REV_TRACE(ovr_CommitTextureSwapChain);
+	REV_CAPTURE(CaptureHandle(chain));
+	REV_SESSION(session);
 
 	if (!session)
 		return ovrError_InvalidSession;
@@ -802,6 +869,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_CommitTextureSwapChain(ovrSession session, ov
 	MICROPROFILE_META_CPU("Identifier", PtrToInt(chain->Swapchain));
 	MICROPROFILE_META_CPU("CurrentIndex", chain->CurrentIndex);
 
+	FlightScope scope(session->Recorder.get(), FlightEvent_Commit, (*session->CurrentFrame).frameIndex);
 	CHK_OVR(chain->Commit(session));
 
 	return ovrSuccess;
@@ -810,6 +878,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_CommitTextureSwapChain(ovrSession session, ov
 OVR_PUBLIC_FUNCTION(void) ovr_DestroyTextureSwapChain(ovrSession session, ovrTextureSwapChain chain)
 {
 	REV_TRACE(ovr_DestroyTextureSwapChain);
+	REV_CAPTURE(CaptureHandle(chain));
 
 	if (!chain)
 		return;
@@ -834,6 +903,10 @@ OVR_PUBLIC_FUNCTION(void) ovr_DestroyMirrorTexture(ovrSession session, ovrMirror
 OVR_PUBLIC_FUNCTION(ovrSizei) ovr_GetFovTextureSize(ovrSession session, ovrEyeType eye, ovrFovPort fov, float pixelsPerDisplayPixel)
 {
 	REV_TRACE(ovr_GetFovTextureSize);
+	REV_SESSION(session);
+
+	if (!session)
+		return ovrSizei{ 0, 0 };
 
 	// TODO: Add support for pixelsPerDisplayPixel
 	ovrSizei size = {
@@ -846,6 +919,7 @@ OVR_PUBLIC_FUNCTION(ovrSizei) ovr_GetFovTextureSize(ovrSession session, ovrEyeTy
 OVR_PUBLIC_FUNCTION(ovrEyeRenderDesc) ovr_GetRenderDesc2(ovrSession session, ovrEyeType eyeType, ovrFovPort fov)
 {
 	REV_TRACE(ovr_GetRenderDesc);
+	REV_SESSION(session);
 
 	if (!session)
 		return ovrEyeRenderDesc();
@@ -872,6 +946,8 @@ typedef struct OVR_ALIGNAS(4) ovrEyeRenderDesc1_ {
 
 OVR_PUBLIC_FUNCTION(ovrEyeRenderDesc1) ovr_GetRenderDesc(ovrSession session, ovrEyeType eyeType, ovrFovPort fov)
 {
+	REV_TRACE(ovr_GetRenderDesc);
+
 	ovrEyeRenderDesc1 legacy = {};
 	ovrEyeRenderDesc desc = ovr_GetRenderDesc2(session, eyeType, fov);
 	memcpy(&legacy, &desc, sizeof(ovrEyeRenderDesc1));
@@ -883,6 +959,8 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_WaitToBeginFrame(ovrSession session, long lon
 {
 	REV_TRACE(ovr_WaitToBeginFrame);
 	MICROPROFILE_META_CPU("Wait Frame", (int)frameIndex);
+	REV_CAPTURE(frameIndex);
+	REV_SESSION(session);
 
 	if (!session)
 		return ovrError_InvalidSession;
@@ -901,12 +979,21 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_WaitToBeginFrame(ovrSession session, long lon
 	assert(session->CurrentFrame.is_lock_free());
 	XrIndexedFrameState* frameState = &session->FrameStats[frameIndex % ovrMaxProvidedFrameStats];
 	XrFrameWaitInfo waitInfo = XR_TYPE(FRAME_WAIT_INFO);
-	CHK_XR(xrWaitFrame(session->Session, &waitInfo, frameState));
+	{
+		FlightScope scope(session->Recorder.get(), FlightEvent_Wait, frameIndex);
+		CHK_XR(xrWaitFrame(session->Session, &waitInfo, frameState));
+	}
 	frameState->frameIndex = frameIndex;
 	session->CurrentFrame = frameState;
 
+	if (session->Recorder)
+		session->Recorder->FrameWaited(frameIndex, *frameState);
+
 	if (session->Input)
+	{
+		FlightScope scope(session->Recorder.get(), FlightEvent_Sync, frameIndex);
 		session->Input->SyncInputState(session->Session, frameState->predictedDisplayPeriod);
+	}
 	return ovrSuccess;
 }
 
@@ -914,6 +1001,8 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_BeginFrame(ovrSession session, long long fram
 {
 	REV_TRACE(ovr_BeginFrame);
 	MICROPROFILE_META_CPU("Begin Frame", (int)frameIndex);
+	REV_CAPTURE(frameIndex);
+	REV_SESSION(session);
 
 	if (!session)
 		return ovrError_InvalidSession;
@@ -925,6 +1014,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_BeginFrame(ovrSession session, long long fram
 	assert(frameIndex == (*session->CurrentFrame).frameIndex);
 
 	XrFrameBeginInfo beginInfo = XR_TYPE(FRAME_BEGIN_INFO);
+	FlightScope scope(session->Recorder.get(), FlightEvent_Begin, frameIndex);
 	CHK_XR(xrBeginFrame(session->Session, &beginInfo));
 	return ovrSuccess;
 }
@@ -948,6 +1038,12 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_EndFrame(ovrSession session, long long frameI
 {
 	REV_TRACE(ovr_EndFrame);
 	MICROPROFILE_META_CPU("End Frame", (int)frameIndex);
+	REV_SESSION(session);
+	if (g_CaptureEnabled)
+	{
+		Capture::Write(frameIndex, (uint32_t)(viewScaleDesc != nullptr), viewScaleDesc ? *viewScaleDesc : ovrViewScaleDesc());
+		Capture::WriteLayers(layerPtrList, layerCount);
+	}
 
 	if (!session)
 		return ovrError_InvalidSession;
@@ -1154,7 +1250,9 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_EndFrame(ovrSession session, long long frameI
 	endInfo.environmentBlendMode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
 	endInfo.layerCount = (uint32_t)layers.size();
 	endInfo.layers = layers.data();
+	FlightScope scope(session->Recorder.get(), FlightEvent_End, frameIndex);
 	CHK_XR(xrEndFrame(session->Session, &endInfo));
+	StartupTrace::Finish("First ovr_EndFrame");
 
 	MicroProfileFlip();
 
@@ -1164,8 +1262,14 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_EndFrame(ovrSession session, long long frameI
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_SubmitFrame2(ovrSession session, long long frameIndex, const ovrViewScaleDesc* viewScaleDesc,
 	ovrLayerHeader const * const * layerPtrList, unsigned int layerCount)
 {
-	REV_TRACE(ovr_SubmitFrame);
+	REV_TRACE(ovr_SubmitFrame2);
 	MICROPROFILE_META_CPU("Submit Frame", (int)frameIndex);
+	REV_SESSION(session);
+	if (g_CaptureEnabled)
+	{
+		Capture::Write(frameIndex, (uint32_t)(viewScaleDesc != nullptr), viewScaleDesc ? *viewScaleDesc : ovrViewScaleDesc());
+		Capture::WriteLayers(layerPtrList, layerCount);
+	}
 
 	if (!session)
 		return ovrError_InvalidSession;
@@ -1176,9 +1280,9 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_SubmitFrame2(ovrSession session, long long fr
 
 	// Some older games submit frames redundantly, so we discard old frames in the legacy call
 	if (frameIndex >= currentIndex)
-		CHK_OVR(ovr_EndFrame(session, frameIndex, viewScaleDesc, layerPtrList, layerCount));
-	CHK_OVR(ovr_WaitToBeginFrame(session, frameIndex + 1));
-	CHK_OVR(ovr_BeginFrame(session, frameIndex + 1));
+		CHK_OVR(ovr_EndFrame(session->Handle, frameIndex, viewScaleDesc, layerPtrList, layerCount));
+	CHK_OVR(ovr_WaitToBeginFrame(session->Handle, frameIndex + 1));
+	CHK_OVR(ovr_BeginFrame(session->Handle, frameIndex + 1));
 	return frameIndex < currentIndex ? ovrSuccess_NotVisible : ovrSuccess;
 }
 
@@ -1190,6 +1294,8 @@ typedef struct OVR_ALIGNAS(4) ovrViewScaleDesc1_ {
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_SubmitFrame(ovrSession session, long long frameIndex, const ovrViewScaleDesc1* viewScaleDesc,
 	ovrLayerHeader const * const * layerPtrList, unsigned int layerCount)
 {
+	REV_TRACE(ovr_SubmitFrame);
+
 	// TODO: We don't ever use viewScaleDesc so no need to do any conversion.
 	return ovr_SubmitFrame2(session, frameIndex, nullptr, layerPtrList, layerCount);
 }
@@ -1240,10 +1346,13 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_ResetPerfStats(ovrSession session)
 
 OVR_PUBLIC_FUNCTION(double) ovr_GetPredictedDisplayTime(ovrSession session, long long frameIndex)
 {
+	REV_TRACE(ovr_GetPredictedDisplayTime);
+	REV_CAPTURE(frameIndex);
+	REV_SESSION(session);
+
 	if (!session)
 		return ovr_GetTimeInSeconds();
 
-	REV_TRACE(ovr_GetPredictedDisplayTime);
 	XR_FUNCTION(session->Instance, ConvertTimeToWin32PerformanceCounterKHR);
 
 	MICROPROFILE_META_CPU("Predict Frame", (int)frameIndex);
@@ -1333,6 +1442,7 @@ OVR_PUBLIC_FUNCTION(ovrBool) ovr_SetInt(ovrSession session, const char* property
 OVR_PUBLIC_FUNCTION(float) ovr_GetFloat(ovrSession session, const char* propertyName, float defaultVal)
 {
 	REV_TRACE(ovr_GetFloat);
+	REV_SESSION(session);
 
 	if (session)
 	{
@@ -1387,6 +1497,17 @@ OVR_PUBLIC_FUNCTION(ovrBool) ovr_SetFloatArray(ovrSession session, const char* p
 OVR_PUBLIC_FUNCTION(const char*) ovr_GetString(ovrSession session, const char* propertyName, const char* defaultVal)
 {
 	REV_TRACE(ovr_GetString);
+	REV_SESSION(session);
+
+	if (strcmp(propertyName, REV_KEY_API_STATS) == 0)
+	{
+		// The string stays valid until the next time the statistics are queried
+		static std::mutex statsMutex;
+		static std::string stats;
+		std::lock_guard<std::mutex> lk(statsMutex);
+		stats = Trace::GetStats();
+		return stats.c_str();
+	}
 
 	if (!session)
 		return defaultVal;
@@ -1407,32 +1528,43 @@ OVR_PUBLIC_FUNCTION(ovrBool) ovr_SetString(ovrSession session, const char* prope
 
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_Lookup(const char* name, void** data)
 {
+	REV_TRACE(ovr_Lookup);
+
 	// We don't communicate with the ovrServer.
 	return ovrError_ServiceError;
 }
 
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetExternalCameras(ovrSession session, ovrExternalCamera* cameras, unsigned int* inoutCameraCount)
 {
+	REV_TRACE(ovr_GetExternalCameras);
+
 	// TODO: Support externalcamera.cfg used by the SteamVR Unity plugin
 	return ovrError_NoExternalCameraInfo;
 }
 
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_SetExternalCameraProperties(ovrSession session, const char* name, const ovrCameraIntrinsics* const intrinsics, const ovrCameraExtrinsics* const extrinsics)
 {
+	REV_TRACE(ovr_SetExternalCameraProperties);
+
 	return ovrError_NoExternalCameraInfo;
 }
 
 OVR_PUBLIC_FUNCTION(unsigned int) ovr_GetEnabledCaps(ovrSession session)
 {
+	REV_TRACE(ovr_GetEnabledCaps);
+
 	return 0;
 }
 
 OVR_PUBLIC_FUNCTION(void) ovr_SetEnabledCaps(ovrSession session, unsigned int hmdCaps)
 {
+	REV_TRACE(ovr_SetEnabledCaps);
 }
 
 OVR_PUBLIC_FUNCTION(unsigned int) ovr_GetTrackingCaps(ovrSession session)
 {
+	REV_TRACE(ovr_GetTrackingCaps);
+
 	return 0;
 }
 
@@ -1494,6 +1626,7 @@ ovr_GetFovStencil(
 	const ovrFovStencilDesc* fovStencilDesc,
 	ovrFovStencilMeshBuffer* meshBuffer)
 {
+	REV_SESSION(session);
 	if (!Runtime::Get().VisibilityMask)
 		return ovrError_Unsupported;
 
@@ -1657,6 +1790,7 @@ ovr_GetFovStencil(
 OVR_PUBLIC_FUNCTION(ovrHmdColorDesc)
 ovr_GetHmdColorDesc(ovrSession session)
 {
+	REV_SESSION(session);
 	ovrHmdColorDesc desc = { ovrColorSpace_Unknown };
 	if (session && Runtime::Get().ColorSpace)
 	{
@@ -1688,6 +1822,7 @@ ovr_GetHmdColorDesc(ovrSession session)
 OVR_PUBLIC_FUNCTION(ovrResult)
 ovr_SetClientColorDesc(ovrSession session, const ovrHmdColorDesc* colorDesc)
 {
+	REV_SESSION(session);
 	if (!Runtime::Get().ColorSpace)
 		return ovrError_Unsupported;
 
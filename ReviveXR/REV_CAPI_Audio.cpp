@@ -1,6 +1,7 @@
 #include "OVR_CAPI_Audio.h"
 #include "Common.h"
 #include "Runtime.h"
+#include "AudioEndpoints.h"
 
 #include <openxr/openxr.h>
 #include <openxr/openxr_platform.h>
@@ -10,80 +11,252 @@
 #include <initguid.h>
 #include <Mmddk.h>
 #include <Mmdeviceapi.h>
+#include <mutex>
 
 extern XrInstance g_Instance;
 
 static_assert(XR_MAX_AUDIO_DEVICE_STR_SIZE_OCULUS == OVR_AUDIO_MAX_DEVICE_STR_SIZE,
 	"OpenXR maximum audio device string size should match OVR");
 
-ovrResult AudioEndPointToGuid(WCHAR* deviceStrBuffer, GUID* deviceGuid)
+class WindowsAudioSource : public AudioDeviceSource
 {
-	if (!deviceGuid)
-		return ovrError_InvalidParameter;
+public:
+	WindowsAudioSource()
+		: m_Cookie(nullptr)
+	{
+		// Keep the multi-threaded apartment alive as long as the source, so the enumerator and its
+		// notifications don't depend on the COM initialization of the thread that created them
+		if (SUCCEEDED(CoIncrementMTAUsage(&m_Cookie)))
+			CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL, IID_PPV_ARGS(&m_Enumerator));
+	}
 
-	Microsoft::WRL::ComPtr<IMMDeviceEnumerator> pEnumerator;
-	const CLSID CLSID_MMDeviceEnumerator = __uuidof(MMDeviceEnumerator);
-	const IID IID_IMMDeviceEnumerator = __uuidof(IMMDeviceEnumerator);
-	HRESULT hr = CoCreateInstance(
-		CLSID_MMDeviceEnumerator, nullptr,
-		CLSCTX_ALL, IID_IMMDeviceEnumerator,
-		&pEnumerator);
-	if (FAILED(hr))
-		return ovrError_AudioComError;
-
-	Microsoft::WRL::ComPtr<IMMDevice> pDevice;
-	hr = pEnumerator->GetDevice(deviceStrBuffer, &pDevice);
-	if (FAILED(hr))
+	virtual ~WindowsAudioSource()
 	{
-		return ovrError_AudioOutputDeviceNotFound;
+		m_Enumerator.Reset();
+		if (m_Cookie)
+			CoDecrementMTAUsage(m_Cookie);
+	}
+
+	IMMDeviceEnumerator* GetEnumerator() { return m_Enumerator.Get(); }
+
+	virtual bool HasHeadsetEndpoints()
+	{
+		return Runtime::Get().AudioDevice;
 	}
 
-	Microsoft::WRL::ComPtr<IPropertyStore> pPropertyStore;
-	hr = pDevice->OpenPropertyStore(STGM_READ, &pPropertyStore);
-	if (FAILED(hr))
+	virtual bool GetHeadsetEndpoint(AudioFlow flow, std::wstring& id)
 	{
-		return ovrError_AccessDenied;
+		if (!g_Instance)
+			return false;
+
+		PFN_xrGetAudioOutputDeviceGuidOculus GetAudioDeviceGuid = nullptr;
+		const char* name = flow == AudioFlow_Out ? "xrGetAudioOutputDeviceGuidOculus" : "xrGetAudioInputDeviceGuidOculus";
+		if (XR_FAILED(xrGetInstanceProcAddr(g_Instance, name, (PFN_xrVoidFunction*)&GetAudioDeviceGuid)))
+			return false;
+
+		WCHAR endpoint[OVR_AUDIO_MAX_DEVICE_STR_SIZE] = {};
+		if (XR_FAILED(GetAudioDeviceGuid(g_Instance, endpoint)))
+			return false;
+
+		id = endpoint;
+		return true;
 	}
 
-	PROPVARIANT pv;
-	hr = pPropertyStore->GetValue(PKEY_AudioEndpoint_GUID, &pv);
-	if (FAILED(hr))
+	virtual bool GetDefaultEndpoint(AudioFlow flow, std::wstring& id)
 	{
-		return ovrError_AccessDenied;
+		if (!m_Enumerator)
+			return false;
+
+		Microsoft::WRL::ComPtr<IMMDevice> pDevice;
+		HRESULT hr = m_Enumerator->GetDefaultAudioEndpoint(flow == AudioFlow_Out ? eRender : eCapture, eConsole, &pDevice);
+		if (FAILED(hr))
+			return false;
+
+		LPWSTR pId;
+		hr = pDevice->GetId(&pId);
+		if (FAILED(hr))
+			return false;
+
+		id = pId;
+		CoTaskMemFree(pId);
+		return true;
 	}
 
-	hr = IIDFromString(pv.pwszVal, deviceGuid);
-	if (FAILED(hr))
-		return ovrError_RuntimeException;
-	return ovrSuccess;
+	virtual bool GetEndpointGuid(AudioFlow flow, const std::wstring& id, std::wstring& guid)
+	{
+		if (id.empty())
+		{
+			GUID deviceGuid;
+			if (FAILED(GetDeviceID(flow == AudioFlow_Out ? &DSDEVID_DefaultPlayback : &DSDEVID_DefaultCapture, &deviceGuid)))
+				return false;
+
+			WCHAR str[64];
+			if (!StringFromGUID2(deviceGuid, str, 64))
+				return false;
+			guid = str;
+			return true;
+		}
+
+		if (!m_Enumerator)
+			return false;
+
+		Microsoft::WRL::ComPtr<IMMDevice> pDevice;
+		HRESULT hr = m_Enumerator->GetDevice(id.c_str(), &pDevice);
+		if (FAILED(hr))
+			return false;
+
+		Microsoft::WRL::ComPtr<IPropertyStore> pPropertyStore;
+		hr = pDevice->OpenPropertyStore(STGM_READ, &pPropertyStore);
+		if (FAILED(hr))
+			return false;
+
+		PROPVARIANT pv;
+		PropVariantInit(&pv);
+		hr = pPropertyStore->GetValue(PKEY_AudioEndpoint_GUID, &pv);
+		if (FAILED(hr))
+			return false;
+
+		bool found = pv.vt == VT_LPWSTR && pv.pwszVal;
+		if (found)
+			guid = pv.pwszVal;
+		PropVariantClear(&pv);
+		return found;
+	}
+
+	virtual uint32_t GetWaveDeviceCount(AudioFlow flow)
+	{
+		return flow == AudioFlow_Out ? waveOutGetNumDevs() : waveInGetNumDevs();
+	}
+
+	virtual bool GetWaveDeviceEndpoint(AudioFlow flow, uint32_t index, std::wstring& id)
+	{
+		// Get the size (including the terminating null) of the endpoint ID string of the device
+		size_t cbEndpointId = 0;
+		if (Message(flow, index, DRV_QUERYFUNCTIONINSTANCEIDSIZE, (DWORD_PTR)&cbEndpointId, NULL) != MMSYSERR_NOERROR ||
+			cbEndpointId == 0 || cbEndpointId > OVR_AUDIO_MAX_DEVICE_STR_SIZE * sizeof(WCHAR))
+			return false;
+
+		WCHAR strEndpointId[OVR_AUDIO_MAX_DEVICE_STR_SIZE] = {};
+		if (Message(flow, index, DRV_QUERYFUNCTIONINSTANCEID, (DWORD_PTR)strEndpointId, cbEndpointId) != MMSYSERR_NOERROR)
+			return false;
+
+		id = strEndpointId;
+		return true;
+	}
+
+	virtual bool GetPreferredWaveDevice(AudioFlow flow, uint32_t& index)
+	{
+		UINT id = 0;
+		if (Message(flow, WAVE_MAPPER, DRVM_MAPPER_PREFERRED_GET, (DWORD_PTR)&id, NULL) != MMSYSERR_NOERROR)
+			return false;
+
+		index = id;
+		return true;
+	}
+
+private:
+	Microsoft::WRL::ComPtr<IMMDeviceEnumerator> m_Enumerator;
+	CO_MTA_USAGE_COOKIE m_Cookie;
+
+	static MMRESULT Message(AudioFlow flow, UINT id, UINT msg, DWORD_PTR param1, DWORD_PTR param2)
+	{
+		if (flow == AudioFlow_Out)
+			return waveOutMessage((HWAVEOUT)UIntToPtr(id), msg, param1, param2);
+		return waveInMessage((HWAVEIN)UIntToPtr(id), msg, param1, param2);
+	}
+};
+
+// Invalidates the cached endpoints whenever an audio device is added, removed or changed
+class AudioNotificationClient : public IMMNotificationClient
+{
+public:
+	AudioNotificationClient(const std::shared_ptr<AudioEndpoints>& endpoints)
+		: m_Endpoints(endpoints)
+		, m_RefCount(1)
+	{
+	}
+
+	virtual ULONG STDMETHODCALLTYPE AddRef() { return InterlockedIncrement(&m_RefCount); }
+	virtual ULONG STDMETHODCALLTYPE Release()
+	{
+		ULONG count = InterlockedDecrement(&m_RefCount);
+		if (count == 0)
+			delete this;
+		return count;
+	}
+
+	virtual HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppvInterface)
+	{
+		if (riid == __uuidof(IUnknown) || riid == __uuidof(IMMNotificationClient))
+		{
+			AddRef();
+			*ppvInterface = (IMMNotificationClient*)this;
+			return S_OK;
+		}
+		*ppvInterface = nullptr;
+		return E_NOINTERFACE;
+	}
+
+	virtual HRESULT STDMETHODCALLTYPE OnDeviceStateChanged(LPCWSTR pwstrDeviceId, DWORD dwNewState) { Invalidate(); return S_OK; }
+	virtual HRESULT STDMETHODCALLTYPE OnDeviceAdded(LPCWSTR pwstrDeviceId) { Invalidate(); return S_OK; }
+	virtual HRESULT STDMETHODCALLTYPE OnDeviceRemoved(LPCWSTR pwstrDeviceId) { Invalidate(); return S_OK; }
+	virtual HRESULT STDMETHODCALLTYPE OnDefaultDeviceChanged(EDataFlow flow, ERole role, LPCWSTR pwstrDefaultDeviceId) { Invalidate(); return S_OK; }
+	virtual HRESULT STDMETHODCALLTYPE OnPropertyValueChanged(LPCWSTR pwstrDeviceId, const PROPERTYKEY key) { return S_OK; }
+
+private:
+	// A notification can still arrive while the endpoints are being shut down
+	void Invalidate()
+	{
+		std::shared_ptr<AudioEndpoints> endpoints = m_Endpoints.lock();
+		if (endpoints)
+			endpoints->Invalidate();
+	}
+
+	std::weak_ptr<AudioEndpoints> m_Endpoints;
+	ULONG m_RefCount;
+};
+
+// Callers get their own reference to the endpoints, so a shutdown on another thread can't free them while in use
+std::mutex g_AudioMutex;
+std::shared_ptr<AudioEndpoints> g_AudioEndpoints;
+Microsoft::WRL::ComPtr<IMMDeviceEnumerator> g_AudioEnumerator;
+Microsoft::WRL::ComPtr<AudioNotificationClient> g_AudioClient;
+
+std::shared_ptr<AudioEndpoints> GetAudioEndpoints()
+{
+	std::lock_guard<std::mutex> lk(g_AudioMutex);
+	if (g_AudioEndpoints)
+		return g_AudioEndpoints;
+
+	std::unique_ptr<WindowsAudioSource> source = std::make_unique<WindowsAudioSource>();
+	Microsoft::WRL::ComPtr<IMMDeviceEnumerator> enumerator = source->GetEnumerator();
+	g_AudioEndpoints = std::make_shared<AudioEndpoints>(std::move(source));
+	if (enumerator)
+	{
+		g_AudioClient.Attach(new AudioNotificationClient(g_AudioEndpoints));
+		if (SUCCEEDED(enumerator->RegisterEndpointNotificationCallback(g_AudioClient.Get())))
+			g_AudioEnumerator = enumerator;
+		else
+			g_AudioClient.Reset();
+	}
+	return g_AudioEndpoints;
 }
 
-ovrResult GetDefaultAudioEndpoint(EDataFlow endpoint, WCHAR deviceStrBuffer[OVR_AUDIO_MAX_DEVICE_STR_SIZE])
+void InvalidateAudioEndpoints()
 {
-	if (!deviceStrBuffer)
-		return ovrError_InvalidParameter;
+	std::lock_guard<std::mutex> lk(g_AudioMutex);
+	if (g_AudioEndpoints)
+		g_AudioEndpoints->Invalidate();
+}
 
-	Microsoft::WRL::ComPtr<IMMDeviceEnumerator> pEnumerator;
-	const CLSID CLSID_MMDeviceEnumerator = __uuidof(MMDeviceEnumerator);
-	const IID IID_IMMDeviceEnumerator = __uuidof(IMMDeviceEnumerator);
-	HRESULT hr = CoCreateInstance(
-		CLSID_MMDeviceEnumerator, NULL,
-		CLSCTX_ALL, IID_IMMDeviceEnumerator,
-		&pEnumerator);
-	if (FAILED(hr))
-		return ovrError_AudioComError;
-
-	Microsoft::WRL::ComPtr<IMMDevice> pDevice;
-	hr = pEnumerator->GetDefaultAudioEndpoint(eRender, eConsole, &pDevice);
-	if (FAILED(hr))
-		return ovrError_AudioDeviceNotFound;
-
-	LPWSTR pGuid;
-	hr = pDevice->GetId(&pGuid);
-	if (FAILED(hr))
-		return ovrError_AudioComError;
-	wcscpy_s(deviceStrBuffer, OVR_AUDIO_MAX_DEVICE_STR_SIZE, pGuid);
-	return ovrSuccess;
+void ShutdownAudioEndpoints()
+{
+	std::lock_guard<std::mutex> lk(g_AudioMutex);
+	if (g_AudioClient)
+		g_AudioEnumerator->UnregisterEndpointNotificationCallback(g_AudioClient.Get());
+	g_AudioClient.Reset();
+	g_AudioEnumerator.Reset();
+	g_AudioEndpoints.reset();
 }
 
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetAudioDeviceOutWaveId(UINT* deviceOutId)
@@ -93,81 +266,11 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetAudioDeviceOutWaveId(UINT* deviceOutId)
 	if (!deviceOutId)
 		return ovrError_InvalidParameter;
 
-	// Query and cache the result
-	static UINT cachedId = 0;
-	if (!cachedId && Runtime::Get().AudioDevice)
-	{
-		XR_FUNCTION(g_Instance, GetAudioOutputDeviceGuidOculus);
-
-		MMRESULT mmr;
-		WCHAR strEndpointIdKey[OVR_AUDIO_MAX_DEVICE_STR_SIZE] = {};
-		XrResult result = GetAudioOutputDeviceGuidOculus(g_Instance, strEndpointIdKey);
-		if (XR_FAILED(result))
-			return ovrError_AudioOutputDeviceNotFound;
-
-		// Get the size of the endpoint ID string.
-		size_t cbEndpointIdKey = wcsnlen_s(strEndpointIdKey, OVR_AUDIO_MAX_DEVICE_STR_SIZE) * sizeof(WCHAR);
-
-		// Include terminating null in string size.
-		cbEndpointIdKey += sizeof(WCHAR);
-
-		// Each for-loop iteration below compares the endpoint ID
-		// string of the audio endpoint device to the endpoint ID
-		// string of an enumerated waveOut device. If the strings
-		// match, then we've found the waveOut device that is
-		// assigned to the specified device role.
-		UINT waveOutId;
-		UINT cWaveOutDevices = waveOutGetNumDevs();
-		WCHAR strEndpointId[OVR_AUDIO_MAX_DEVICE_STR_SIZE] = {};
-		for (waveOutId = 0; waveOutId < cWaveOutDevices; waveOutId++)
-		{
-			size_t cbEndpointId = 0;
-
-			// Get the size (including the terminating null) of
-			// the endpoint ID string of the waveOut device.
-			mmr = waveOutMessage((HWAVEOUT)UIntToPtr(waveOutId),
-				DRV_QUERYFUNCTIONINSTANCEIDSIZE,
-				(DWORD_PTR)&cbEndpointId, NULL);
-			if (mmr != MMSYSERR_NOERROR ||
-				cbEndpointIdKey != cbEndpointId)  // do sizes match?
-			{
-				continue;  // not a matching device
-			}
-
-			// Get the endpoint ID string for this waveOut device.
-			mmr = waveOutMessage((HWAVEOUT)UIntToPtr(waveOutId),
-				DRV_QUERYFUNCTIONINSTANCEID,
-				(DWORD_PTR)strEndpointId,
-				cbEndpointId);
-			if (mmr != MMSYSERR_NOERROR)
-			{
-				continue;
-			}
-
-			// Check whether the endpoint ID string of this waveOut
-			// device matches that of the audio endpoint device.
-			if (lstrcmpi(strEndpointId, strEndpointIdKey) == 0)
-			{
-				cachedId = waveOutId;  // found match
-				break;
-			}
-		}
+	AudioEndpoint endpoint = GetAudioEndpoints()->Get(AudioFlow_Out);
+	if (!endpoint.HasWaveId)
+		return ovrError_AudioOutputDeviceNotFound;
 
-		if (waveOutId == cWaveOutDevices)
-		{
-			// We reached the end of the for-loop above without
-			// finding a waveOut device with a matching endpoint
-			// ID string. This behavior is quite unexpected.
-			return ovrError_AudioOutputDeviceNotFound;
-		}
-	}
-	else if (!cachedId)
-	{
-		MMRESULT mmr = waveOutMessage((HWAVEOUT)UIntToPtr(WAVE_MAPPER), DRVM_MAPPER_PREFERRED_GET, (DWORD_PTR)&cachedId, NULL);
-		if (mmr != MMSYSERR_NOERROR)
-			return ovrError_AudioOutputDeviceNotFound;
-	}
-	*deviceOutId = cachedId;
+	*deviceOutId = endpoint.WaveId;
 	return ovrSuccess;
 }
 
@@ -178,81 +281,11 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetAudioDeviceInWaveId(UINT* deviceInId)
 	if (!deviceInId)
 		return ovrError_InvalidParameter;
 
-	// Query and cache the result
-	static UINT cachedId = 0;
-	if (!cachedId && Runtime::Get().AudioDevice)
-	{
-		XR_FUNCTION(g_Instance, GetAudioInputDeviceGuidOculus);
-
-		MMRESULT mmr;
-		WCHAR strEndpointIdKey[OVR_AUDIO_MAX_DEVICE_STR_SIZE] = {};
-		XrResult result = GetAudioInputDeviceGuidOculus(g_Instance, strEndpointIdKey);
-		if (XR_FAILED(result))
-			return ovrError_AudioInputDeviceNotFound;
-
-		// Get the size of the endpoint ID string.
-		size_t cbEndpointIdKey = wcsnlen_s(strEndpointIdKey, OVR_AUDIO_MAX_DEVICE_STR_SIZE) * sizeof(WCHAR);
-
-		// Include terminating null in string size.
-		cbEndpointIdKey += sizeof(WCHAR);
-
-		// Each for-loop iteration below compares the endpoint ID
-		// string of the audio endpoint device to the endpoint ID
-		// string of an enumerated waveOut device. If the strings
-		// match, then we've found the waveIn device that is
-		// assigned to the specified device role.
-		UINT waveInId;
-		UINT cWaveInDevices = waveInGetNumDevs();
-		WCHAR strEndpointId[OVR_AUDIO_MAX_DEVICE_STR_SIZE] = {};
-		for (waveInId = 0; waveInId < cWaveInDevices; waveInId++)
-		{
-			size_t cbEndpointId = 0;
-
-			// Get the size (including the terminating null) of
-			// the endpoint ID string of the waveOut device.
-			mmr = waveInMessage((HWAVEIN)UIntToPtr(waveInId),
-				DRV_QUERYFUNCTIONINSTANCEIDSIZE,
-				(DWORD_PTR)&cbEndpointId, NULL);
-			if (mmr != MMSYSERR_NOERROR ||
-				cbEndpointIdKey != cbEndpointId)  // do sizes match?
-			{
-				continue;  // not a matching device
-			}
-
-			// Get the endpoint ID string for this waveOut device.
-			mmr = waveInMessage((HWAVEIN)UIntToPtr(waveInId),
-				DRV_QUERYFUNCTIONINSTANCEID,
-				(DWORD_PTR)strEndpointId,
-				cbEndpointId);
-			if (mmr != MMSYSERR_NOERROR)
-			{
-				continue;
-			}
-
-			// Check whether the endpoint ID string of this waveOut
-			// device matches that of the audio endpoint device.
-			if (lstrcmpi(strEndpointId, strEndpointIdKey) == 0)
-			{
-				cachedId = waveInId;  // found match
-				break;
-			}
-		}
+	AudioEndpoint endpoint = GetAudioEndpoints()->Get(AudioFlow_In);
+	if (!endpoint.HasWaveId)
+		return ovrError_AudioInputDeviceNotFound;
 
-		if (waveInId == cWaveInDevices)
-		{
-			// We reached the end of the for-loop above without
-			// finding a waveOut device with a matching endpoint
-			// ID string. This behavior is quite unexpected.
-			return ovrError_AudioInputDeviceNotFound;
-		}
-	}
-	else if (!cachedId)
-	{
-		MMRESULT mmr = waveInMessage((HWAVEIN)UIntToPtr(WAVE_MAPPER), DRVM_MAPPER_PREFERRED_GET, (DWORD_PTR)&cachedId, NULL);
-		if (mmr != MMSYSERR_NOERROR)
-			return ovrError_AudioInputDeviceNotFound;
-	}
-	*deviceInId = cachedId;
+	*deviceInId = endpoint.WaveId;
 	return ovrSuccess;
 }
 
@@ -263,18 +296,12 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetAudioDeviceOutGuidStr(WCHAR deviceOutStrBu
 	if (!deviceOutStrBuffer)
 		return ovrError_InvalidParameter;
 
-	if (Runtime::Get().AudioDevice)
-	{
-		XR_FUNCTION(g_Instance, GetAudioOutputDeviceGuidOculus);
-		XrResult result = GetAudioOutputDeviceGuidOculus(g_Instance, deviceOutStrBuffer);
-		return XR_SUCCEEDED(result) ? ovrSuccess : ovrError_AudioOutputDeviceNotFound;
-	}
+	AudioEndpoint endpoint = GetAudioEndpoints()->Get(AudioFlow_Out);
+	if (!endpoint.HasId)
+		return ovrError_AudioOutputDeviceNotFound;
 
-	HRESULT com = CoInitializeEx(NULL, COINIT_APARTMENTTHREADED);
-	ovrResult result = GetDefaultAudioEndpoint(eRender, deviceOutStrBuffer);
-	if (SUCCEEDED(com))
-		CoUninitialize();
-	return result;
+	wcscpy_s(deviceOutStrBuffer, OVR_AUDIO_MAX_DEVICE_STR_SIZE, endpoint.Id.c_str());
+	return ovrSuccess;
 }
 
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetAudioDeviceOutGuid(GUID* deviceOutGuid)
@@ -284,33 +311,12 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetAudioDeviceOutGuid(GUID* deviceOutGuid)
 	if (!deviceOutGuid)
 		return ovrError_InvalidParameter;
 
-	// Query and cache the result
-	static GUID cachedGuid = GUID_NULL;
-	if (cachedGuid == GUID_NULL)
-	{
-		if (Runtime::Get().AudioDevice)
-		{
-			XR_FUNCTION(g_Instance, GetAudioOutputDeviceGuidOculus);
-
-			WCHAR endpoint[OVR_AUDIO_MAX_DEVICE_STR_SIZE];
-			if (XR_FAILED(GetAudioOutputDeviceGuidOculus(g_Instance, endpoint)))
-				return ovrError_AudioOutputDeviceNotFound;
-
-			HRESULT com = CoInitializeEx(NULL, COINIT_APARTMENTTHREADED);
-			ovrResult result = AudioEndPointToGuid(endpoint, &cachedGuid);
-			if (SUCCEEDED(com))
-				CoUninitialize();
-			if (OVR_FAILURE(result))
-				return result;
-		}
-		else
-		{
-			HRESULT hr = GetDeviceID(&DSDEVID_DefaultPlayback, &cachedGuid);
-			if (FAILED(hr))
-				ovrError_AudioOutputDeviceNotFound;
-		}
-	}
-	*deviceOutGuid = cachedGuid;
+	AudioEndpoint endpoint = GetAudioEndpoints()->Get(AudioFlow_Out);
+	if (!endpoint.HasGuid)
+		return ovrError_AudioOutputDeviceNotFound;
+
+	if (FAILED(IIDFromString(endpoint.Guid.c_str(), deviceOutGuid)))
+		return ovrError_RuntimeException;
 	return ovrSuccess;
 }
 
@@ -321,18 +327,12 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetAudioDeviceInGuidStr(WCHAR deviceInStrBuff
 	if (!deviceInStrBuffer)
 		return ovrError_InvalidParameter;
 
-	if (Runtime::Get().AudioDevice)
-	{
-		XR_FUNCTION(g_Instance, GetAudioInputDeviceGuidOculus);
-		XrResult result = GetAudioInputDeviceGuidOculus(g_Instance, deviceInStrBuffer);
-		return XR_SUCCEEDED(result) ? ovrSuccess : ovrError_AudioOutputDeviceNotFound;
-	}
+	AudioEndpoint endpoint = GetAudioEndpoints()->Get(AudioFlow_In);
+	if (!endpoint.HasId)
+		return ovrError_AudioInputDeviceNotFound;
 
-	HRESULT com = CoInitializeEx(NULL, COINIT_APARTMENTTHREADED);
-	ovrResult result = GetDefaultAudioEndpoint(eCapture, deviceInStrBuffer);
-	if (SUCCEEDED(com))
-		CoUninitialize();
-	return result;
+	wcscpy_s(deviceInStrBuffer, OVR_AUDIO_MAX_DEVICE_STR_SIZE, endpoint.Id.c_str());
+	return ovrSuccess;
 }
 
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetAudioDeviceInGuid(GUID* deviceInGuid)
@@ -342,32 +342,11 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetAudioDeviceInGuid(GUID* deviceInGuid)
 	if (!deviceInGuid)
 		return ovrError_InvalidParameter;
 
-	// Query and cache the result
-	static GUID cachedGuid = GUID_NULL;
-	if (cachedGuid == GUID_NULL)
-	{
-		if (Runtime::Get().AudioDevice)
-		{
-			XR_FUNCTION(g_Instance, GetAudioInputDeviceGuidOculus);
-
-			WCHAR endpoint[OVR_AUDIO_MAX_DEVICE_STR_SIZE];
-			if (XR_FAILED(GetAudioInputDeviceGuidOculus(g_Instance, endpoint)))
-				return ovrError_AudioInputDeviceNotFound;
-
-			HRESULT com = CoInitializeEx(NULL, COINIT_APARTMENTTHREADED);
-			ovrResult result = AudioEndPointToGuid(endpoint, &cachedGuid);
-			if (SUCCEEDED(com))
-				CoUninitialize();
-			if (OVR_FAILURE(result))
-				return result;
-		}
-		else
-		{
-			HRESULT hr = GetDeviceID(&DSDEVID_DefaultCapture, &cachedGuid);
-			if (FAILED(hr))
-				return ovrError_AudioInputDeviceNotFound;
-		}
-	}
-	*deviceInGuid = cachedGuid;
+	AudioEndpoint endpoint = GetAudioEndpoints()->Get(AudioFlow_In);
+	if (!endpoint.HasGuid)
+		return ovrError_AudioInputDeviceNotFound;
+
+	if (FAILED(IIDFromString(endpoint.Guid.c_str(), deviceInGuid)))
+		return ovrError_RuntimeException;
 	return ovrSuccess;
 }
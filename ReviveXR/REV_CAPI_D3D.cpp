@@ -133,6 +133,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_CreateTextureSwapChainDX(ovrSession session,
                                                             ovrTextureSwapChain* out_TextureSwapChain)
 {
 	REV_TRACE(ovr_CreateTextureSwapChainDX);
+	REV_SESSION(session);
 
 	if (!session)
 		return ovrError_InvalidSession;
@@ -175,7 +176,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_CreateTextureSwapChainDX(ovrSession session,
 		}
 		else if (pQueue)
 		{
-			if (!Runtime::Get().Supports(XR_KHR_D3D12_ENABLE_EXTENSION_NAME))
+			if (!Runtime::Get().Supports(Runtime::EXT_D3D12_ENABLE))
 				return ovrError_Unsupported;
 
 			ComPtr<ID3D12Device> pDevice12 = nullptr;
@@ -214,18 +215,18 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_CreateTextureSwapChainDX(ovrSession session,
 		}
 	}
 
+	ovrResult result = ovrError_RuntimeException;
 	if (pDevice)
-	{
-		return ovrTextureSwapChainD3D11::Create(session, desc, out_TextureSwapChain);
-	}
+		result = ovrTextureSwapChainD3D11::Create(session, desc, out_TextureSwapChain);
 	else if (pQueue)
+		result = ovrTextureSwapChainD3D12::Create(session, pQueue.Get(), desc, out_TextureSwapChain);
+
+	if (OVR_SUCCESS(result))
 	{
-		return ovrTextureSwapChainD3D12::Create(session, pQueue.Get(), desc, out_TextureSwapChain);
-	}
-	else
-	{
-		return ovrError_RuntimeException;
+		REV_CAPTURE(*desc, CaptureHandle(*out_TextureSwapChain));
+		StartupTrace::StampOnce("First swapchain");
 	}
+	return result;
 }
 
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetTextureSwapChainBufferDX(ovrSession session,
@@ -235,6 +236,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetTextureSwapChainBufferDX(ovrSession sessio
                                                                void** out_Buffer)
 {
 	REV_TRACE(ovr_GetTextureSwapChainBufferDX);
+	REV_SESSION(session);
 
 	if (!session)
 		return ovrError_InvalidSession;
@@ -260,6 +262,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_CreateMirrorTextureDX(ovrSession session,
                                                          ovrMirrorTexture* out_MirrorTexture)
 {
 	REV_TRACE(ovr_CreateMirrorTextureDX);
+	REV_SESSION(session);
 
 	if (!session)
 		return ovrError_InvalidSession;
@@ -282,7 +285,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_CreateMirrorTextureDX(ovrSession session,
 	swapDesc.StaticImage = ovrTrue;
 	swapDesc.MiscFlags = desc->MiscFlags;
 	swapDesc.BindFlags = 0;
-	return ovr_CreateTextureSwapChainDX(session, d3dPtr, &swapDesc, &mirrorTexture->Dummy);
+	return ovr_CreateTextureSwapChainDX(session->Handle, d3dPtr, &swapDesc, &mirrorTexture->Dummy);
 }
 
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_CreateMirrorTextureWithOptionsDX(ovrSession session,
@@ -299,6 +302,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetMirrorTextureBufferDX(ovrSession session,
                                                             void** out_Buffer)
 {
 	REV_TRACE(ovr_GetMirrorTextureBufferDX);
+	REV_SESSION(session);
 
 	if (!session)
 		return ovrError_InvalidSession;
@@ -306,5 +310,5 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetMirrorTextureBufferDX(ovrSession session,
 	if (!mirrorTexture || !out_Buffer)
 		return ovrError_InvalidParameter;
 
-	return ovr_GetTextureSwapChainBufferDX(session, mirrorTexture->Dummy, 0, iid, out_Buffer);
+	return ovr_GetTextureSwapChainBufferDX(session->Handle, mirrorTexture->Dummy, 0, iid, out_Buffer);
 }
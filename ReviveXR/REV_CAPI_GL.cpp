@@ -16,6 +16,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_CreateTextureSwapChainGL(ovrSession session,
                                                             ovrTextureSwapChain* out_TextureSwapChain)
 {
 	REV_TRACE(ovr_CreateTextureSwapChainGL);
+	REV_SESSION(session);
 
 	if (!session)
 		return ovrError_InvalidSession;
@@ -25,7 +26,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_CreateTextureSwapChainGL(ovrSession session,
 
 	if (!session->Session)
 	{
-		if (!Runtime::Get().Supports(XR_KHR_OPENGL_ENABLE_EXTENSION_NAME))
+		if (!Runtime::Get().Supports(Runtime::EXT_OPENGL_ENABLE))
 			return ovrError_Unsupported;
 
 		XR_FUNCTION(session->Instance, GetOpenGLGraphicsRequirementsKHR);
@@ -47,7 +48,14 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_CreateTextureSwapChainGL(ovrSession session,
 		graphicsBinding.hGLRC = wglGetCurrentContext();
 		session->StartSession(&graphicsBinding);
 	}
-	return ovrTextureSwapChainGL::Create(session, desc, out_TextureSwapChain);
+
+	ovrResult result = ovrTextureSwapChainGL::Create(session, desc, out_TextureSwapChain);
+	if (OVR_SUCCESS(result))
+	{
+		REV_CAPTURE(*desc, CaptureHandle(*out_TextureSwapChain));
+		StartupTrace::StampOnce("First swapchain");
+	}
+	return result;
 }
 
 OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetTextureSwapChainBufferGL(ovrSession session,
@@ -56,6 +64,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetTextureSwapChainBufferGL(ovrSession sessio
                                                                unsigned int* out_TexId)
 {
 	REV_TRACE(ovr_GetTextureSwapChainBufferGL);
+	REV_SESSION(session);
 
 	if (!session)
 		return ovrError_InvalidSession;
@@ -75,6 +84,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_CreateMirrorTextureGL(ovrSession session,
                                                          ovrMirrorTexture* out_MirrorTexture)
 {
 	REV_TRACE(ovr_CreateMirrorTextureGL);
+	REV_SESSION(session);
 
 	if (!session)
 		return ovrError_InvalidSession;
@@ -97,7 +107,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_CreateMirrorTextureGL(ovrSession session,
 	swapDesc.StaticImage = ovrTrue;
 	swapDesc.MiscFlags = desc->MiscFlags;
 	swapDesc.BindFlags = 0;
-	return ovr_CreateTextureSwapChainGL(session, &swapDesc, &mirrorTexture->Dummy);
+	return ovr_CreateTextureSwapChainGL(session->Handle, &swapDesc, &mirrorTexture->Dummy);
 }
 
 
@@ -113,6 +123,7 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetMirrorTextureBufferGL(ovrSession session,
                                                             unsigned int* out_TexId)
 {
 	REV_TRACE(ovr_GetMirrorTextureBufferGL);
+	REV_SESSION(session);
 
 	if (!session)
 		return ovrError_InvalidSession;
@@ -120,5 +131,5 @@ OVR_PUBLIC_FUNCTION(ovrResult) ovr_GetMirrorTextureBufferGL(ovrSession session,
 	if (!mirrorTexture || !out_TexId)
 		return ovrError_InvalidParameter;
 
-	return ovr_GetTextureSwapChainBufferGL(session, mirrorTexture->Dummy, 0, out_TexId);
+	return ovr_GetTextureSwapChainBufferGL(session->Handle, mirrorTexture->Dummy, 0, out_TexId);
 }
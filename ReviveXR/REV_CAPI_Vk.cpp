@@ -34,7 +34,7 @@ ovr_GetInstanceExtensionsVk(
 	if (!inoutExtensionNamesSize)
 		ovrError_InvalidParameter;
 
-	if (Runtime::Get().Supports(XR_KHR_VULKAN_ENABLE_EXTENSION_NAME))
+	if (Runtime::Get().Supports(Runtime::EXT_VULKAN_ENABLE))
 	{
 		XR_FUNCTION(g_Instance, GetVulkanInstanceExtensionsKHR);
 
@@ -66,7 +66,7 @@ ovr_GetDeviceExtensionsVk(
 	if (!inoutExtensionNamesSize)
 		ovrError_InvalidParameter;
 
-	if (Runtime::Get().Supports(XR_KHR_VULKAN_ENABLE_EXTENSION_NAME))
+	if (Runtime::Get().Supports(Runtime::EXT_VULKAN_ENABLE))
 	{
 		XR_FUNCTION(g_Instance, GetVulkanDeviceExtensionsKHR);
 
@@ -96,6 +96,11 @@ ovr_GetSessionPhysicalDeviceVk(
 	VkInstance instance,
 	VkPhysicalDevice* out_physicalDevice)
 {
+	REV_SESSION(session);
+
+	if (!session)
+		return ovrError_InvalidSession;
+
 	XR_FUNCTION(session->Instance, GetVulkanGraphicsDeviceKHR);
 
 	if (!out_physicalDevice)
@@ -154,6 +159,7 @@ ovr_CreateTextureSwapChainVk(
 	ovrTextureSwapChain* out_TextureSwapChain)
 {
 	REV_TRACE(ovr_CreateTextureSwapChainVk);
+	REV_SESSION(session);
 
 	if (!session)
 		return ovrError_InvalidSession;
@@ -163,7 +169,7 @@ ovr_CreateTextureSwapChainVk(
 
 	if (!session->Session)
 	{
-		if (!Runtime::Get().Supports(XR_KHR_VULKAN_ENABLE_EXTENSION_NAME))
+		if (!Runtime::Get().Supports(Runtime::EXT_VULKAN_ENABLE))
 			return ovrError_Unsupported;
 
 		VK_DEVICE_FUNCTION(device, vkGetDeviceQueue);
@@ -203,7 +209,13 @@ ovr_CreateTextureSwapChainVk(
 		session->StartSession(&g_Binding);
 	}
 
-	return ovrTextureSwapChainVk::Create(session, desc, out_TextureSwapChain);
+	ovrResult result = ovrTextureSwapChainVk::Create(session, desc, out_TextureSwapChain);
+	if (OVR_SUCCESS(result))
+	{
+		REV_CAPTURE(*desc, CaptureHandle(*out_TextureSwapChain));
+		StartupTrace::StampOnce("First swapchain");
+	}
+	return result;
 }
 
 OVR_PUBLIC_FUNCTION(ovrResult)
@@ -214,6 +226,7 @@ ovr_GetTextureSwapChainBufferVk(
 	VkImage* out_Image)
 {
 	REV_TRACE(ovr_GetTextureSwapChainBufferVk);
+	REV_SESSION(session);
 
 	if (!session)
 		return ovrError_InvalidSession;
@@ -236,6 +249,7 @@ ovr_CreateMirrorTextureWithOptionsVk(
 	ovrMirrorTexture* out_MirrorTexture)
 {
 	REV_TRACE(ovr_CreateMirrorTextureWithOptionsVk);
+	REV_SESSION(session);
 
 	if (!session)
 		return ovrError_InvalidSession;
@@ -258,7 +272,7 @@ ovr_CreateMirrorTextureWithOptionsVk(
 	swapDesc.StaticImage = ovrTrue;
 	swapDesc.MiscFlags = desc->MiscFlags;
 	swapDesc.BindFlags = 0;
-	return ovr_CreateTextureSwapChainVk(session, device, &swapDesc, &mirrorTexture->Dummy);
+	return ovr_CreateTextureSwapChainVk(session->Handle, device, &swapDesc, &mirrorTexture->Dummy);
 }
 
 OVR_PUBLIC_FUNCTION(ovrResult)
@@ -268,6 +282,7 @@ ovr_GetMirrorTextureBufferVk(
 	VkImage* out_Image)
 {
 	REV_TRACE(ovr_GetMirrorTextureBufferVk);
+	REV_SESSION(session);
 
 	if (!session)
 		return ovrError_InvalidSession;
@@ -275,6 +290,6 @@ ovr_GetMirrorTextureBufferVk(
 	if (!mirrorTexture || !out_Image)
 		return ovrError_InvalidParameter;
 
-	return ovr_GetTextureSwapChainBufferVk(session, mirrorTexture->Dummy, 0, out_Image);
+	return ovr_GetTextureSwapChainBufferVk(session->Handle, mirrorTexture->Dummy, 0, out_Image);
 }
 
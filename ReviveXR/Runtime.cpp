@@ -1,6 +1,7 @@
 #include "Runtime.h"
 #include "Common.h"
 #include "version.h"
+#include "../Revive/HackDatabase.h"
 
 #include <Windows.h>
 #include <Shlwapi.h>
@@ -16,7 +17,7 @@ const char* Runtime::s_required_extensions[] = {
 	"XR_KHR_D3D11_enable"
 };
 
-const char* Runtime::s_optional_extensions[] = {
+const char* Runtime::s_optional_extensions[EXT_COUNT] = {
 	"XR_KHR_D3D12_enable",
 	"XR_KHR_vulkan_enable",
 	"XR_KHR_opengl_enable",
@@ -29,13 +30,14 @@ const char* Runtime::s_optional_extensions[] = {
 	XR_FB_COLOR_SPACE_EXTENSION_NAME
 };
 
-Runtime::HackInfo Runtime::s_known_hacks[] = {
-	{ nullptr, "SteamVR/OpenXR", HACK_VALVE_INDEX_PROFILE, 0, 0, true },
-	{ nullptr, "SteamVR/OpenXR", HACK_BROKEN_LINE_LOOP, 0, 0x100000000, true },
-	{ nullptr, "SteamVR/OpenXR", HACK_MIN_HAPTIC_DURATION, 0, 0, true },
-	{ nullptr, "Windows Mixed Reality Runtime", HACK_WAIT_FOR_SESSION_READY, 0, 0, true },
-	{ "echovr.exe", nullptr, HACK_FORCE_FOV_FALLBACK, 0, 0, true },
-	{ "loneecho.exe", nullptr, HACK_FORCE_FOV_FALLBACK, 0, 0, true },
+const char* Runtime::s_hack_names[HACK_COUNT] = {
+	"HACK_VALVE_INDEX_PROFILE",
+	"HACK_WMR_PROFILE",
+	"HACK_FORCE_FOV_FALLBACK",
+	"HACK_BROKEN_LINE_LOOP",
+	"HACK_NDC_MASKS",
+	"HACK_MIN_HAPTIC_DURATION",
+	"HACK_WAIT_FOR_SESSION_READY",
 };
 
 Runtime& Runtime::Get()
@@ -58,33 +60,39 @@ ovrResult Runtime::CreateInstance(XrInstance* out_Instance, const ovrInitParams*
 	CHK_XR(xrEnumerateInstanceExtensionProperties(nullptr, (uint32_t)properties.size(), &size, properties.data()));
 
 	m_extensions.clear();
+	m_supported.reset();
 
 	for (const char* extension : s_required_extensions)
 		m_extensions.push_back(extension);
 
-	for (const char* extension : s_optional_extensions)
+	for (int i = 0; i < EXT_COUNT; i++)
 	{
+		const char* extension = s_optional_extensions[i];
 		auto findExtension = [extension](XrExtensionProperties props)
 		{
 			return strcmp(props.extensionName, extension) == 0;
 		};
 
 		if (std::any_of(properties.begin(), properties.end(), findExtension))
+		{
 			m_extensions.push_back(extension);
+			m_supported.set(i);
+		}
 	}
 
-	VisibilityMask = Supports(XR_KHR_VISIBILITY_MASK_EXTENSION_NAME);
-	CompositionDepth = Supports(XR_KHR_COMPOSITION_LAYER_DEPTH_EXTENSION_NAME);
-	CompositionCube = Supports(XR_KHR_COMPOSITION_LAYER_CUBE_EXTENSION_NAME);
-	CompositionCylinder = Supports(XR_KHR_COMPOSITION_LAYER_CYLINDER_EXTENSION_NAME);
-	AudioDevice = Supports(XR_OCULUS_AUDIO_DEVICE_GUID_EXTENSION_NAME);
-	ColorSpace = Supports(XR_FB_COLOR_SPACE_EXTENSION_NAME);
+	VisibilityMask = Supports(EXT_VISIBILITY_MASK);
+	CompositionDepth = Supports(EXT_COMPOSITION_LAYER_DEPTH);
+	CompositionCube = Supports(EXT_COMPOSITION_LAYER_CUBE);
+	CompositionCylinder = Supports(EXT_COMPOSITION_LAYER_CYLINDER);
+	AudioDevice = Supports(EXT_AUDIO_DEVICE_GUID);
+	ColorSpace = Supports(EXT_COLOR_SPACE);
 
 	XrInstanceCreateInfo createInfo = XR_TYPE(INSTANCE_CREATE_INFO);
 	createInfo.applicationInfo = { "Revive", REV_VERSION_INT, "Revive", REV_VERSION_INT, XR_CURRENT_API_VERSION };
 	createInfo.enabledExtensionCount = (uint32_t)m_extensions.size();
 	createInfo.enabledExtensionNames = m_extensions.data();
 	CHK_XR(xrCreateInstance(&createInfo, out_Instance));
+	StartupTrace::Stamp("xrCreateInstance");
 
 	char filepath[MAX_PATH];
 	GetModuleFileNameA(NULL, filepath, MAX_PATH);
@@ -93,35 +101,9 @@ ovrResult Runtime::CreateInstance(XrInstance* out_Instance, const ovrInitParams*
 	XrInstanceProperties props = XR_TYPE(INSTANCE_PROPERTIES);
 	CHK_XR(xrGetInstanceProperties(*out_Instance, &props));
 
-	for (auto& hack : s_known_hacks)
-	{
-		if ((!hack.m_filename || _stricmp(filename, hack.m_filename) == 0) &&
-			(!hack.m_runtime || strcmp(props.runtimeName, hack.m_runtime) == 0) &&
-			(!hack.m_versionend || hack.m_versionstart <= props.runtimeVersion &&
-				props.runtimeVersion < hack.m_versionend))
-		{
-			if (hack.m_usehack)
-				m_hacks.emplace(hack.m_hack, hack);
-		}
-		else if (!hack.m_usehack)
-		{
-			m_hacks.emplace(hack.m_hack, hack);
-		}
-	}
+	HackDatabase database;
+	if (!database.Load(HackDatabase::GetDefaultPath()))
+		database.LoadEmbedded();
+	m_hacks = database.Evaluate("xr", s_hack_names, filename, props.runtimeName, props.runtimeVersion);
 	return ovrSuccess;
 }
-
-bool Runtime::UseHack(Hack hack)
-{
-	return m_hacks.find(hack) != m_hacks.end();
-}
-
-bool Runtime::Supports(const char* extensionName)
-{
-	auto findExtension = [extensionName](const char* extension)
-	{
-		return strcmp(extension, extensionName) == 0;
-	};
-
-	return std::any_of(m_extensions.begin(), m_extensions.end(), findExtension);
-}
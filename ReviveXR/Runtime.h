@@ -4,7 +4,7 @@
 #include "OVR_ErrorCode.h"
 
 #include <openxr/openxr.h>
-#include <map>
+#include <bitset>
 #include <vector>
 
 class Runtime
@@ -35,11 +35,28 @@ public:
 		// Hack: WMR runtime doesn't allow views to be located without the session running.
 		// Wait for the session to become ready instead.
 		HACK_WAIT_FOR_SESSION_READY,
+		HACK_COUNT
 	};
 
-	bool UseHack(Hack hack);
+	// Optional extensions, in the same order as s_optional_extensions
+	enum Extension
+	{
+		EXT_D3D12_ENABLE,
+		EXT_VULKAN_ENABLE,
+		EXT_OPENGL_ENABLE,
+		EXT_VISIBILITY_MASK,
+		EXT_COMPOSITION_LAYER_DEPTH,
+		EXT_COMPOSITION_LAYER_CUBE,
+		EXT_COMPOSITION_LAYER_CYLINDER,
+		EXT_VIEW_CONFIGURATION_FOV,
+		EXT_AUDIO_DEVICE_GUID,
+		EXT_COLOR_SPACE,
+		EXT_COUNT
+	};
+
+	bool UseHack(Hack hack) const { return m_hacks[hack]; }
 	ovrResult CreateInstance(XrInstance* out_Instance, const ovrInitParams* params);
-	bool Supports(const char* extensionName);
+	bool Supports(Extension extension) const { return m_supported[extension]; }
 
 	bool VisibilityMask;
 	bool CompositionDepth;
@@ -51,20 +68,11 @@ public:
 	uint32_t MinorVersion;
 
 private:
-	struct HackInfo
-	{
-		const char* m_filename;		// The filename of the main executable
-		const char* m_runtime;		// The name of the runtime
-		Hack m_hack;				// Which hack is it?
-		XrVersion m_versionstart;	// When it started
-		XrVersion m_versionend;		// When it ended
-		bool m_usehack;				// Should it use the hack?
-	};
-
 	static const char* s_required_extensions[];
-	static const char* s_optional_extensions[];
-	static HackInfo s_known_hacks[];
+	static const char* s_optional_extensions[EXT_COUNT];
+	static const char* s_hack_names[HACK_COUNT];
 
-	std::map<Hack, HackInfo> m_hacks;
+	std::bitset<HACK_COUNT> m_hacks;
+	std::bitset<EXT_COUNT> m_supported;
 	std::vector<const char*> m_extensions;
 };
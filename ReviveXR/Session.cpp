@@ -4,6 +4,8 @@
 #include "Session.h"
 #include "Runtime.h"
 #include "InputManager.h"
+#include "ViewCache.h"
+#include "FlightRecorder.h"
 
 #define XR_USE_GRAPHICS_API_D3D11
 #include <d3d11.h>
@@ -27,6 +29,8 @@ ovrResult ovrHmdStruct::InitSession(XrInstance instance)
 	TrackingOrigin = ovrTrackingOrigin_EyeLevel;
 	SystemProperties = XR_TYPE(SYSTEM_PROPERTIES);
 	SystemColorSpace = XR_TYPE(SYSTEM_COLOR_SPACE_PROPERTIES_FB);
+	if (FlightRecorder::IsEnabled())
+		Recorder = std::make_unique<FlightRecorder>();
 
 	// Initialize view structures
 	for (int i = 0; i < ovrEye_Count; i++)
@@ -43,6 +47,7 @@ ovrResult ovrHmdStruct::InitSession(XrInstance instance)
 	if (Runtime::Get().ColorSpace)
 		SystemProperties.next = &SystemColorSpace;
 	CHK_XR(xrGetSystemProperties(Instance, System, &SystemProperties));
+	StartupTrace::Stamp("xrGetSystem");
 
 	uint32_t numViews;
 	CHK_XR(xrEnumerateViewConfigurationViews(Instance, System, XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO, ovrEye_Count, &numViews, ViewConfigs));
@@ -56,9 +61,9 @@ ovrResult ovrHmdStruct::InitSession(XrInstance instance)
 		"The adapter LUID needs to fit in ovrGraphicsLuid");
 	memcpy(&Adapter, &graphicsReq.adapterLuid, sizeof(ovrGraphicsLuid));
 
-	// Create a temporary session to retrieve the headset field-of-view
+	// Create a temporary session to retrieve the headset field-of-view, unless we have it cached
 	Microsoft::WRL::ComPtr<IDXGIFactory1> pFactory = NULL;
-	if (Runtime::Get().MinorVersion >= 17 && Runtime::Get().Supports(XR_EPIC_VIEW_CONFIGURATION_FOV_EXTENSION_NAME) &&
+	if (Runtime::Get().MinorVersion >= 17 && Runtime::Get().Supports(Runtime::EXT_VIEW_CONFIGURATION_FOV) &&
 		!Runtime::Get().UseHack(Runtime::HACK_FORCE_FOV_FALLBACK))
 	{
 		for (int i = 0; i < ovrEye_Count; i++)
@@ -67,6 +72,10 @@ ovrResult ovrHmdStruct::InitSession(XrInstance instance)
 			ViewPoses[i].pose = XR::Posef::Identity();
 		}
 	}
+	else if ((Cache = std::make_unique<ViewCache>(Instance, System))->Load(this))
+	{
+		// The cached entry is validated against the real session in BeginSession()
+	}
 	else if (SUCCEEDED(CreateDXGIFactory1(__uuidof(IDXGIFactory1), (void**)&pFactory)))
 	{
 		Microsoft::WRL::ComPtr<IDXGIAdapter1> pAdapter;
@@ -88,9 +97,12 @@ ovrResult ovrHmdStruct::InitSession(XrInstance instance)
 			&pDevice, nullptr, nullptr);
 		assert(SUCCEEDED(hr));
 
+		StartupTrace::Stamp("FOV fallback device");
+
 		XrGraphicsBindingD3D11KHR graphicsBinding = XR_TYPE(GRAPHICS_BINDING_D3D11_KHR);
 		graphicsBinding.device = pDevice.Get();
 		CHK_OVR(StartSession(&graphicsBinding));
+		StartupTrace::Stamp("FOV fallback session");
 
 		if (Runtime::Get().UseHack(Runtime::HACK_WAIT_FOR_SESSION_READY))
 		{
@@ -113,6 +125,7 @@ ovrResult ovrHmdStruct::InitSession(XrInstance instance)
 			XrSessionBeginInfo beginInfo = XR_TYPE(SESSION_BEGIN_INFO);
 			beginInfo.primaryViewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
 			CHK_XR(xrBeginSession(Session, &beginInfo));
+			StartupTrace::Stamp("FOV fallback session ready");
 		}
 
 		CHK_OVR(LocateViews(ViewPoses));
@@ -124,17 +137,11 @@ ovrResult ovrHmdStruct::InitSession(XrInstance instance)
 
 		CHK_XR(xrGetReferenceSpaceBoundsRect(Session, XR_REFERENCE_SPACE_TYPE_STAGE, &bounds));
 		CHK_OVR(DestroySession());
+		Cache->Store(this);
+		StartupTrace::Stamp("FOV fallback finished");
 	}
 
-	// Calculate the pixels per tan angle
-	for (int i = 0; i < ovrEye_Count; i++)
-	{
-		const XR::FovPort fov(ViewFov[i].recommendedFov);
-		PixelsPerTan[i] = OVR::Vector2f(
-			(float)ViewConfigs[i].recommendedImageRectWidth / (fov.LeftTan + fov.RightTan),
-			(float)ViewConfigs[i].recommendedImageRectHeight / (fov.UpTan + fov.DownTan)
-		);
-	}
+	UpdatePixelsPerTan();
 
 	// Initialize input manager
 	Input.reset(new InputManager(Instance));
@@ -150,6 +157,7 @@ ovrResult ovrHmdStruct::StartSession(void* graphicsBinding)
 	createInfo.next = graphicsBinding;
 	createInfo.systemId = System;
 	CHK_XR(xrCreateSession(Instance, &createInfo, &Session));
+	StartupTrace::Stamp("xrCreateSession");
 	memset(&SessionStatus, 0, sizeof(SessionStatus));
 
 	// Attach it to the InputManager
@@ -197,14 +205,52 @@ ovrResult ovrHmdStruct::BeginSession()
 	beginInfo.primaryViewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
 	CHK_XR(xrBeginSession(Session, &beginInfo));
 
+	// Make sure the cached view configuration still matches the runtime
+	if (Cache && Cache->IsHit())
+	{
+		// Runtimes may not report valid views until the first frame, those can't invalidate the cache
+		XrView views[ovrEye_Count] = { XR_TYPE(VIEW), XR_TYPE(VIEW) };
+		XrViewStateFlags flags = 0;
+		const XrViewStateFlags valid = XR_VIEW_STATE_ORIENTATION_VALID_BIT | XR_VIEW_STATE_POSITION_VALID_BIT;
+		if (OVR_SUCCESS(LocateViews(views, &flags)) && (flags & valid) == valid)
+		{
+			xrGetReferenceSpaceBoundsRect(Session, XR_REFERENCE_SPACE_TYPE_STAGE, &bounds);
+			if (!Cache->Validate(this, views))
+			{
+				// The cache was stale, continue with the values reported by the runtime
+				for (int i = 0; i < ovrEye_Count; i++)
+				{
+					ViewFov[i].recommendedFov = views[i].fov;
+					ViewFov[i].maxMutableFov = views[i].fov;
+					ViewPoses[i].fov = views[i].fov;
+					ViewPoses[i].pose = views[i].pose;
+				}
+				UpdatePixelsPerTan();
+			}
+		}
+	}
+
 	// Start the first frame immediately in case the app uses SubmitFrame().
 	long long currentIndex = (*CurrentFrame).frameIndex;
-	CHK_OVR(ovr_WaitToBeginFrame(this, currentIndex));
+	CHK_OVR(ovr_WaitToBeginFrame(Handle, currentIndex));
 	RecenterSpace(ovrTrackingOrigin_EyeLevel, ViewSpace);
-	CHK_OVR(ovr_BeginFrame(this, currentIndex));
+	CHK_OVR(ovr_BeginFrame(Handle, currentIndex));
 	return ovrSuccess;
 }
 
+void ovrHmdStruct::UpdatePixelsPerTan()
+{
+	// Calculate the pixels per tan angle
+	for (int i = 0; i < ovrEye_Count; i++)
+	{
+		const XR::FovPort fov(ViewFov[i].recommendedFov);
+		PixelsPerTan[i] = OVR::Vector2f(
+			(float)ViewConfigs[i].recommendedImageRectWidth / (fov.LeftTan + fov.RightTan),
+			(float)ViewConfigs[i].recommendedImageRectHeight / (fov.UpTan + fov.DownTan)
+		);
+	}
+}
+
 ovrResult ovrHmdStruct::EndSession()
 {
 	CHK_XR(xrEndSession(Session));
@@ -241,6 +287,7 @@ ovrResult ovrHmdStruct::LocateViews(XrView out_Views[ovrEye_Count], XrViewStateF
 	locateInfo.space = ViewSpace;
 	locateInfo.viewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
 	locateInfo.displayTime = AbsTimeToXrTime(Instance, ovr_GetTimeInSeconds());
+	FlightScope scope(Recorder.get(), FlightEvent_Locate, (*CurrentFrame).frameIndex);
 	CHK_XR(xrLocateViews(Session, &locateInfo, &viewState, ovrEye_Count, &numViews, out_Views));
 	assert(numViews == ovrEye_Count);
 	if (out_Flags)
@@ -16,6 +16,8 @@
 
 class Runtime;
 class InputManager;
+class ViewCache;
+class FlightRecorder;
 
 struct SessionStatusBits {
 	bool IsVisible : 1;
@@ -38,6 +40,9 @@ typedef std::pair<std::vector<XrVector2f>,
 
 struct ovrHmdStruct
 {
+	// Generation-tagged handle given to the application, see SessionRegistry
+	ovrSession Handle;
+
 	std::map<void**, void*> HookedFunctions;
 
 	// Synchronization
@@ -77,9 +82,15 @@ struct ovrHmdStruct
 	// Field-of-view stencil
 	std::map<XrVisibilityMaskTypeKHR, VisibilityMask> VisibilityMasks[ovrEye_Count];
 
+	// View configuration cache
+	std::unique_ptr<ViewCache> Cache;
+
 	// Input
 	std::unique_ptr<InputManager> Input;
 
+	// Frame event ring for hitch dumps, null if disabled
+	std::unique_ptr<FlightRecorder> Recorder;
+
 	ovrResult InitSession(XrInstance instance);
 	ovrResult StartSession(void* graphicsBinding);
 	ovrResult BeginSession();
@@ -90,4 +101,5 @@ struct ovrHmdStruct
 	ovrResult LocateViews(XrView out_Views[ovrEye_Count], XrViewStateFlags* out_Flags = nullptr) const;
 	ovrResult RecenterSpace(ovrTrackingOrigin origin, XrSpace anchor, ovrPosef offset = OVR::Posef::Identity());
 	bool SupportsFormat(int64_t format) const;
+	void UpdatePixelsPerTan();
 };
@@ -0,0 +1,29 @@
+#include "SessionRegistry.h"
+
+SessionRegistry g_Sessions;
+
+ovrHmdStruct* SessionRegistry::Create()
+{
+	std::shared_ptr<ovrHmdStruct> session = std::make_shared<ovrHmdStruct>();
+
+	// The handle isn't known to anyone else until it's returned from ovr_Create
+	SessionMap::Handle handle = m_Sessions.Insert(session);
+	if (!handle)
+		return nullptr;
+
+	session->Handle = (ovrSession)handle;
+	return session.get();
+}
+
+std::shared_ptr<ovrHmdStruct> SessionRegistry::Release(ovrSession handle)
+{
+	return m_Sessions.Remove((SessionMap::Handle)handle);
+}
+
+std::vector<ovrSession> SessionRegistry::GetAll() const
+{
+	std::vector<ovrSession> handles;
+	for (SessionMap::Handle handle : m_Sessions.GetHandles())
+		handles.push_back((ovrSession)handle);
+	return handles;
+}
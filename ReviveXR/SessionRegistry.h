@@ -0,0 +1,70 @@
+#pragma once
+
+#include "OVR_CAPI.h"
+#include "Session.h"
+#include "SlotMap.h"
+
+#include <openxr/openxr.h>
+#include <memory>
+#include <vector>
+
+// Maximum number of sessions that can exist at the same time
+#define REV_MAX_SESSIONS 64
+
+// Owns all sessions, the ovrSession handles given to the application are slot map handles rather
+// than pointers. Every entry point holds a reference to its session while it runs, so a session
+// can't be freed by ovr_Destroy on another thread while it's still in use.
+class SessionRegistry
+{
+public:
+	// Allocates a slot for a new session, returns null if all slots are in use
+	ovrHmdStruct* Create();
+	// Invalidates the handle and releases the slot, the caller then holds the only reference to the
+	// session. Returns null if the handle is invalid or stale, e.g. when a session is destroyed twice.
+	std::shared_ptr<ovrHmdStruct> Release(ovrSession handle);
+
+	// Returns the session a handle refers to, or null if the handle is invalid or stale
+	std::shared_ptr<ovrHmdStruct> Get(ovrSession handle) const { return m_Sessions.Get((SessionMap::Handle)handle); }
+	// Returns the handles of all live sessions
+	std::vector<ovrSession> GetAll() const;
+
+	// Calls the function with the session that owns an OpenXR session, used to route events to
+	// their session. The function is called without holding the registry lock.
+	template<typename F>
+	bool Dispatch(XrSession session, F function)
+	{
+		if (session == XR_NULL_HANDLE)
+			return false;
+
+		std::shared_ptr<ovrHmdStruct> target = m_Sessions.Find([session](const ovrHmdStruct& candidate)
+		{
+			return candidate.Session == session;
+		});
+		if (!target)
+			return false;
+
+		function(target.get());
+		return true;
+	}
+
+	// Calls the function with every live session
+	template<typename F>
+	void DispatchAll(F function)
+	{
+		for (const std::shared_ptr<ovrHmdStruct>& target : m_Sessions.GetAll())
+			function(target.get());
+	}
+
+private:
+	typedef SlotMap<ovrHmdStruct, REV_MAX_SESSIONS> SessionMap;
+
+	SessionMap m_Sessions;
+};
+
+extern SessionRegistry g_Sessions;
+
+// Replaces the handle passed to an entry point with the session it refers to, so the existing null
+// checks also reject invalid and stale handles. The session is kept alive until the entry point returns.
+#define REV_SESSION(session) \
+	std::shared_ptr<ovrHmdStruct> session##Ref = g_Sessions.Get(session); \
+	session = session##Ref.get()
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <stdint.h>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+// Owns objects in a fixed array of slots and hands out handles instead of pointers. A handle encodes
+// the slot together with its generation, so every handle can be validated in constant time and a
+// stale handle is rejected, even if its slot has been reused. Lookups return a reference that keeps
+// the object alive, so it can't be freed while another thread is still using it. The references share
+// a lease on the object that signals its removal once the last of them is released.
+template<typename T, uint32_t Capacity, uint32_t SlotBits = 8>
+class SlotMap
+{
+	static_assert((1u << SlotBits) >= Capacity, "The slot index needs to fit in the handle");
+
+public:
+	typedef uintptr_t Handle;
+
+	SlotMap()
+	{
+		for (uint32_t i = Capacity; i > 0; i--)
+			m_Free.push_back(i - 1);
+		for (Slot& slot : m_Slots)
+			slot.Generation = 0;
+	}
+
+	// Stores a new object, returns its handle or zero if all slots are in use
+	Handle Insert(std::shared_ptr<T> object)
+	{
+		std::unique_lock<std::shared_mutex> lk(m_Mutex);
+		if (m_Free.empty())
+			return 0;
+
+		uint32_t index = m_Free.back();
+		m_Free.pop_back();
+
+		Slot& slot = m_Slots[index];
+		slot.Generation++;
+		slot.ObjectLease = std::make_shared<Lease>();
+		slot.Object = std::shared_ptr<T>(object.get(), [lease = slot.ObjectLease](T*)
+		{
+			std::lock_guard<std::mutex> lk(lease->Mutex);
+			lease->Released = true;
+			lease->Condition.notify_all();
+		});
+		slot.Owner = std::move(object);
+		return MakeHandle(index, slot.Generation);
+	}
+
+	// Invalidates the handle and releases the slot, returns null if the handle is invalid or stale.
+	// Waits until no other thread holds a reference, so the caller must not hold one itself.
+	std::shared_ptr<T> Remove(Handle handle)
+	{
+		std::shared_ptr<T> object;
+		std::shared_ptr<Lease> lease;
+		{
+			std::unique_lock<std::shared_mutex> lk(m_Mutex);
+			if (!IsValid(handle))
+				return nullptr;
+
+			Slot& slot = m_Slots[GetIndex(handle)];
+			slot.Generation++;
+			slot.Object.reset();
+			object = std::move(slot.Owner);
+			lease = std::move(slot.ObjectLease);
+			m_Free.push_back(GetIndex(handle));
+		}
+
+		// No new references can be taken, so only wait for the ones that are already out
+		std::unique_lock<std::mutex> lk(lease->Mutex);
+		lease->Condition.wait(lk, [&lease]() { return lease->Released; });
+		return object;
+	}
+
+	// Returns the object a handle refers to, or null if the handle is invalid or stale
+	std::shared_ptr<T> Get(Handle handle) const
+	{
+		std::shared_lock<std::shared_mutex> lk(m_Mutex);
+		if (!IsValid(handle))
+			return nullptr;
+		return m_Slots[GetIndex(handle)].Object;
+	}
+
+	// Returns the first object the predicate is true for, the predicate is called while locked
+	template<typename F>
+	std::shared_ptr<T> Find(F predicate) const
+	{
+		std::shared_lock<std::shared_mutex> lk(m_Mutex);
+		for (const Slot& slot : m_Slots)
+		{
+			if (slot.Object && predicate(*slot.Object))
+				return slot.Object;
+		}
+		return nullptr;
+	}
+
+	// Returns all live objects
+	std::vector<std::shared_ptr<T>> GetAll() const
+	{
+		std::shared_lock<std::shared_mutex> lk(m_Mutex);
+		std::vector<std::shared_ptr<T>> objects;
+		for (const Slot& slot : m_Slots)
+		{
+			if (slot.Object)
+				objects.push_back(slot.Object);
+		}
+		return objects;
+	}
+
+	// Returns the handles of all live objects
+	std::vector<Handle> GetHandles() const
+	{
+		std::shared_lock<std::shared_mutex> lk(m_Mutex);
+		std::vector<Handle> handles;
+		for (uint32_t i = 0; i < Capacity; i++)
+		{
+			if (m_Slots[i].Object)
+				handles.push_back(MakeHandle(i, m_Slots[i].Generation));
+		}
+		return handles;
+	}
+
+private:
+	struct Lease
+	{
+		std::mutex Mutex;
+		std::condition_variable Condition;
+		bool Released = false;
+	};
+
+	struct Slot
+	{
+		// Odd while the slot holds an object, incremented on every allocation and release
+		uint32_t Generation;
+		// Shares the object with lookups without owning it, the lease is released with its last reference
+		std::shared_ptr<T> Object;
+		std::shared_ptr<T> Owner;
+		std::shared_ptr<Lease> ObjectLease;
+	};
+
+	static Handle MakeHandle(uint32_t index, uint32_t generation)
+	{
+		// The lowest bit is always set, so a handle can never be mistaken for a pointer. On 32-bit
+		// builds only the lower bits of the generation are kept, which is still plenty to catch reuse.
+		return ((Handle)generation << (SlotBits + 1)) | ((Handle)index << 1) | 1;
+	}
+
+	static uint32_t GetIndex(Handle handle)
+	{
+		return (handle >> 1) & ((1u << SlotBits) - 1);
+	}
+
+	// Needs to be called while the slots are locked
+	bool IsValid(Handle handle) const
+	{
+		if (!(handle & 1))
+			return false;
+
+		uint32_t index = GetIndex(handle);
+		if (index >= Capacity)
+			return false;
+
+		const Slot& slot = m_Slots[index];
+		return (slot.Generation & 1) && MakeHandle(index, slot.Generation) == handle;
+	}
+
+	mutable std::shared_mutex m_Mutex;
+	Slot m_Slots[Capacity];
+	std::vector<uint32_t> m_Free;
+};
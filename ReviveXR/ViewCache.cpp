@@ -0,0 +1,261 @@
+#include "ViewCache.h"
+#include "Common.h"
+#include "Session.h"
+
+#include <Windows.h>
+#include <Shlobj.h>
+#include <Shlwapi.h>
+#include <math.h>
+#include <stdio.h>
+#include <functional>
+#include <vector>
+
+const uint32_t ViewCache::s_magic = 'CVVR';
+const uint32_t ViewCache::s_version = 1;
+
+// Tolerance used when comparing cached values against the values reported by the runtime
+#define REV_CACHE_EPSILON 1e-4f
+
+template<typename T>
+static bool Write(FILE* file, const T* data, size_t count = 1)
+{
+	return fwrite(data, sizeof(T), count, file) == count;
+}
+
+template<typename T>
+static bool Read(FILE* file, T* data, size_t count = 1)
+{
+	return fread(data, sizeof(T), count, file) == count;
+}
+
+template<typename T>
+static bool WriteVector(FILE* file, const std::vector<T>& vec)
+{
+	uint32_t size = (uint32_t)vec.size();
+	return Write(file, &size) && (size == 0 || Write(file, vec.data(), size));
+}
+
+template<typename T>
+static bool ReadVector(FILE* file, std::vector<T>& vec)
+{
+	uint32_t size;
+	if (!Read(file, &size) || size > 0x10000)
+		return false;
+	vec.resize(size);
+	return size == 0 || Read(file, vec.data(), size);
+}
+
+static bool Equals(float a, float b)
+{
+	return fabsf(a - b) < REV_CACHE_EPSILON;
+}
+
+static bool Equals(const XrFovf& a, const XrFovf& b)
+{
+	return Equals(a.angleLeft, b.angleLeft) && Equals(a.angleRight, b.angleRight) &&
+		Equals(a.angleUp, b.angleUp) && Equals(a.angleDown, b.angleDown);
+}
+
+static bool Equals(const XrPosef& a, const XrPosef& b)
+{
+	return Equals(a.position.x, b.position.x) && Equals(a.position.y, b.position.y) &&
+		Equals(a.position.z, b.position.z) && Equals(a.orientation.x, b.orientation.x) &&
+		Equals(a.orientation.y, b.orientation.y) && Equals(a.orientation.z, b.orientation.z) &&
+		Equals(a.orientation.w, b.orientation.w);
+}
+
+static bool Equals(const std::map<XrVisibilityMaskTypeKHR, VisibilityMask>& a,
+	const std::map<XrVisibilityMaskTypeKHR, VisibilityMask>& b)
+{
+	if (a.size() != b.size())
+		return false;
+
+	for (auto it = a.begin(), jt = b.begin(); it != a.end(); it++, jt++)
+	{
+		const VisibilityMask& x = it->second;
+		const VisibilityMask& y = jt->second;
+		if (it->first != jt->first || x.first.size() != y.first.size() || x.second != y.second)
+			return false;
+		for (size_t i = 0; i < x.first.size(); i++)
+		{
+			if (!Equals(x.first[i].x, y.first[i].x) || !Equals(x.first[i].y, y.first[i].y))
+				return false;
+		}
+	}
+	return true;
+}
+
+ViewCache::ViewCache(XrInstance instance, XrSystemId system)
+	: m_Key()
+	, m_Path()
+	, m_Hit(false)
+	, m_Bounds()
+	, m_Formats()
+	, m_Masks()
+{
+	XrInstanceProperties props = XR_TYPE(INSTANCE_PROPERTIES);
+	if (XR_SUCCEEDED(xrGetInstanceProperties(instance, &props)))
+	{
+		strcpy_s(m_Key.RuntimeName, props.runtimeName);
+		m_Key.RuntimeVersion = props.runtimeVersion;
+	}
+	m_Key.SystemId = system;
+
+	WCHAR path[MAX_PATH];
+	if (SUCCEEDED(SHGetFolderPathW(NULL, CSIDL_LOCAL_APPDATA, NULL, 0, path)))
+	{
+		wcsncat(path, L"\\Revive", MAX_PATH);
+		if (!PathFileExistsW(path))
+			CreateDirectoryW(path, NULL);
+
+		// Every runtime gets its own cache file, so switching runtimes doesn't thrash the cache
+		std::string key = std::string(m_Key.RuntimeName) + "/" + std::to_string(m_Key.RuntimeVersion) + "/" + std::to_string(m_Key.SystemId);
+		WCHAR filename[MAX_PATH];
+		swprintf(filename, MAX_PATH, L"\\ViewCache-%016llx.bin", (unsigned long long)std::hash<std::string>()(key));
+		m_Path = std::wstring(path) + filename;
+	}
+}
+
+bool ViewCache::Load(ovrHmdStruct* session)
+{
+	m_Hit = false;
+	if (m_Path.empty())
+		return false;
+
+	FILE* file = _wfopen(m_Path.c_str(), L"rb");
+	if (!file)
+		return false;
+
+	uint32_t magic = 0, version = 0;
+	Key key;
+	ViewEntry views[ovrEye_Count];
+	XrExtent2Df bounds;
+	std::vector<int64_t> formats;
+	std::map<XrVisibilityMaskTypeKHR, VisibilityMask> masks[ovrEye_Count];
+
+	bool valid = Read(file, &magic) && magic == s_magic &&
+		Read(file, &version) && version == s_version &&
+		Read(file, &key) && memcmp(&key, &m_Key, sizeof(Key)) == 0 &&
+		Read(file, views, ovrEye_Count) && Read(file, &bounds) &&
+		ReadVector(file, formats);
+
+	for (int i = 0; valid && i < ovrEye_Count; i++)
+	{
+		uint32_t count;
+		valid = Read(file, &count) && count <= XR_VISIBILITY_MASK_TYPE_LINE_LOOP_KHR;
+		for (uint32_t j = 0; valid && j < count; j++)
+		{
+			XrVisibilityMaskTypeKHR type;
+			valid = Read(file, &type);
+			if (valid)
+			{
+				VisibilityMask& mask = masks[i][type];
+				valid = ReadVector(file, mask.first) && ReadVector(file, mask.second);
+			}
+		}
+	}
+	fclose(file);
+
+	if (!valid)
+		return false;
+
+	// The view configuration views are cheap to query, so if those changed we know the entry is stale
+	for (int i = 0; i < ovrEye_Count; i++)
+	{
+		const XrViewConfigurationView& config = session->ViewConfigs[i];
+		if (config.recommendedImageRectWidth != views[i].RecommendedImageRectWidth ||
+			config.recommendedImageRectHeight != views[i].RecommendedImageRectHeight ||
+			config.maxImageRectWidth != views[i].MaxImageRectWidth ||
+			config.maxImageRectHeight != views[i].MaxImageRectHeight)
+			return false;
+	}
+
+	for (int i = 0; i < ovrEye_Count; i++)
+	{
+		session->ViewFov[i].recommendedFov = views[i].RecommendedFov;
+		session->ViewFov[i].maxMutableFov = views[i].MaxMutableFov;
+		session->ViewPoses[i].fov = views[i].RecommendedFov;
+		session->ViewPoses[i].pose = views[i].Pose;
+		session->VisibilityMasks[i] = masks[i];
+		m_Masks[i] = std::move(masks[i]);
+	}
+	session->bounds = m_Bounds = bounds;
+	session->SupportedFormats = m_Formats = std::move(formats);
+
+	m_Hit = true;
+	return true;
+}
+
+bool ViewCache::Store(const ovrHmdStruct* session, const XrView* views)
+{
+	if (m_Path.empty())
+		return false;
+
+	if (!views)
+		views = session->ViewPoses;
+
+	// Write to a temporary file first, so a crash never leaves a partially written cache behind
+	std::wstring tempPath = m_Path + L".tmp";
+	FILE* file = _wfopen(tempPath.c_str(), L"wb");
+	if (!file)
+		return false;
+
+	ViewEntry entries[ovrEye_Count];
+	for (int i = 0; i < ovrEye_Count; i++)
+	{
+		const XrViewConfigurationView& config = session->ViewConfigs[i];
+		entries[i].RecommendedImageRectWidth = config.recommendedImageRectWidth;
+		entries[i].MaxImageRectWidth = config.maxImageRectWidth;
+		entries[i].RecommendedImageRectHeight = config.recommendedImageRectHeight;
+		entries[i].MaxImageRectHeight = config.maxImageRectHeight;
+		entries[i].RecommendedSwapchainSampleCount = config.recommendedSwapchainSampleCount;
+		entries[i].MaxSwapchainSampleCount = config.maxSwapchainSampleCount;
+		entries[i].RecommendedFov = views[i].fov;
+		entries[i].MaxMutableFov = views[i].fov;
+		entries[i].Pose = views[i].pose;
+	}
+
+	bool valid = Write(file, &s_magic) && Write(file, &s_version) &&
+		Write(file, &m_Key) && Write(file, entries, ovrEye_Count) &&
+		Write(file, &session->bounds) && WriteVector(file, session->SupportedFormats);
+
+	for (int i = 0; valid && i < ovrEye_Count; i++)
+	{
+		uint32_t count = (uint32_t)session->VisibilityMasks[i].size();
+		valid = Write(file, &count);
+		for (auto it = session->VisibilityMasks[i].begin(); valid && it != session->VisibilityMasks[i].end(); it++)
+			valid = Write(file, &it->first) && WriteVector(file, it->second.first) && WriteVector(file, it->second.second);
+	}
+	fclose(file);
+
+	if (!valid || !MoveFileExW(tempPath.c_str(), m_Path.c_str(), MOVEFILE_REPLACE_EXISTING))
+	{
+		DeleteFileW(tempPath.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool ViewCache::Validate(const ovrHmdStruct* session, const XrView views[ovrEye_Count])
+{
+	if (!m_Hit)
+		return true;
+
+	bool valid = Equals(session->bounds.width, m_Bounds.width) &&
+		Equals(session->bounds.height, m_Bounds.height) &&
+		session->SupportedFormats == m_Formats;
+	for (int i = 0; valid && i < ovrEye_Count; i++)
+	{
+		valid = Equals(session->VisibilityMasks[i], m_Masks[i]) &&
+			Equals(session->ViewPoses[i].fov, views[i].fov) &&
+			Equals(session->ViewPoses[i].pose, views[i].pose);
+	}
+
+	if (!valid)
+	{
+		// Replace the stale entry so the next launch picks up the new values
+		m_Hit = false;
+		Store(session, views);
+	}
+	return valid;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "OVR_CAPI.h"
+#include "Session.h"
+
+#include <openxr/openxr.h>
+#include <map>
+#include <string>
+#include <vector>
+
+// Persistent cache of the view configuration reported by a runtime.
+// Allows us to skip the temporary session that is otherwise needed to query the field-of-view.
+class ViewCache
+{
+public:
+	ViewCache(XrInstance instance, XrSystemId system);
+
+	// Restores the cached view configuration into the session, returns false on a cache miss
+	bool Load(ovrHmdStruct* session);
+	// Stores the view configuration of the session, replacing any previous entry
+	bool Store(const ovrHmdStruct* session, const XrView* views = nullptr);
+	// Compares the cached entry against the views located in the real session,
+	// the entry is replaced if the runtime reported different values
+	bool Validate(const ovrHmdStruct* session, const XrView views[ovrEye_Count]);
+
+	bool IsHit() const { return m_Hit; }
+
+private:
+	static const uint32_t s_magic;
+	static const uint32_t s_version;
+
+	struct Key
+	{
+		char RuntimeName[XR_MAX_RUNTIME_NAME_SIZE];
+		XrVersion RuntimeVersion;
+		XrSystemId SystemId;
+	};
+
+	struct ViewEntry
+	{
+		uint32_t RecommendedImageRectWidth;
+		uint32_t MaxImageRectWidth;
+		uint32_t RecommendedImageRectHeight;
+		uint32_t MaxImageRectHeight;
+		uint32_t RecommendedSwapchainSampleCount;
+		uint32_t MaxSwapchainSampleCount;
+		XrFovf RecommendedFov;
+		XrFovf MaxMutableFov;
+		XrPosef Pose;
+	};
+
+	Key m_Key;
+	std::wstring m_Path;
+	bool m_Hit;
+
+	// Cached values that are also queried from the real session
+	XrExtent2Df m_Bounds;
+	std::vector<int64_t> m_Formats;
+	std::map<XrVisibilityMaskTypeKHR, VisibilityMask> m_Masks[ovrEye_Count];
+};
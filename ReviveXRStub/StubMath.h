@@ -0,0 +1,85 @@
+#pragma once
+
+#include <openxr/openxr.h>
+#include <math.h>
+
+namespace StubMath
+{
+	inline XrPosef Identity()
+	{
+		XrPosef pose = { { 0.0f, 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, 0.0f } };
+		return pose;
+	}
+
+	inline XrQuaternionf Multiply(const XrQuaternionf& a, const XrQuaternionf& b)
+	{
+		XrQuaternionf q;
+		q.x = a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y;
+		q.y = a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x;
+		q.z = a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w;
+		q.w = a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z;
+		return q;
+	}
+
+	inline XrQuaternionf Conjugate(const XrQuaternionf& q)
+	{
+		XrQuaternionf c = { -q.x, -q.y, -q.z, q.w };
+		return c;
+	}
+
+	inline XrVector3f Rotate(const XrQuaternionf& q, const XrVector3f& v)
+	{
+		XrQuaternionf p = { v.x, v.y, v.z, 0.0f };
+		XrQuaternionf r = Multiply(Multiply(q, p), Conjugate(q));
+		XrVector3f result = { r.x, r.y, r.z };
+		return result;
+	}
+
+	// Transforms the child pose from the parent space into the space the parent is expressed in
+	inline XrPosef Transform(const XrPosef& parent, const XrPosef& child)
+	{
+		XrPosef pose;
+		XrVector3f p = Rotate(parent.orientation, child.position);
+		pose.position = { parent.position.x + p.x, parent.position.y + p.y, parent.position.z + p.z };
+		pose.orientation = Multiply(parent.orientation, child.orientation);
+		return pose;
+	}
+
+	inline XrPosef Inverse(const XrPosef& pose)
+	{
+		XrPosef inverse;
+		inverse.orientation = Conjugate(pose.orientation);
+		XrVector3f p = Rotate(inverse.orientation, pose.position);
+		inverse.position = { -p.x, -p.y, -p.z };
+		return inverse;
+	}
+
+	inline XrQuaternionf Normalize(const XrQuaternionf& q)
+	{
+		float length = sqrtf(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+		if (length <= 0.0f)
+			return Identity().orientation;
+		XrQuaternionf n = { q.x / length, q.y / length, q.z / length, q.w / length };
+		return n;
+	}
+
+	// Linear interpolation of the position and normalized interpolation of the orientation
+	inline XrPosef Lerp(const XrPosef& a, const XrPosef& b, float t)
+	{
+		// Take the shortest path between the orientations
+		float dot = a.orientation.x * b.orientation.x + a.orientation.y * b.orientation.y +
+			a.orientation.z * b.orientation.z + a.orientation.w * b.orientation.w;
+		float s = dot < 0.0f ? -1.0f : 1.0f;
+
+		XrPosef pose;
+		pose.position.x = a.position.x + (b.position.x - a.position.x) * t;
+		pose.position.y = a.position.y + (b.position.y - a.position.y) * t;
+		pose.position.z = a.position.z + (b.position.z - a.position.z) * t;
+		pose.orientation.x = a.orientation.x + (s * b.orientation.x - a.orientation.x) * t;
+		pose.orientation.y = a.orientation.y + (s * b.orientation.y - a.orientation.y) * t;
+		pose.orientation.z = a.orientation.z + (s * b.orientation.z - a.orientation.z) * t;
+		pose.orientation.w = a.orientation.w + (s * b.orientation.w - a.orientation.w) * t;
+		pose.orientation = Normalize(pose.orientation);
+		return pose;
+	}
+}
@@ -0,0 +1,1478 @@
+#include "StubRuntime.h"
+#include "StubMath.h"
+
+#include <Windows.h>
+#include <GL/gl.h>
+#include <d3d11.h>
+#include <dxgi.h>
+#include <wrl/client.h>
+
+#define XR_USE_PLATFORM_WIN32
+#define XR_USE_GRAPHICS_API_D3D11
+#define XR_USE_GRAPHICS_API_D3D12
+#define XR_USE_GRAPHICS_API_OPENGL
+#include <d3d12.h>
+#include <openxr/openxr_platform.h>
+#include <openxr/openxr_reflection.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <memory>
+
+// Number of images in every swapchain
+#define STUB_SWAPCHAIN_LENGTH 3
+// Maximum number of layers accepted by xrEndFrame
+#define STUB_MAX_LAYERS 16
+
+static const char* s_extensions[] = {
+	XR_KHR_WIN32_CONVERT_PERFORMANCE_COUNTER_TIME_EXTENSION_NAME,
+	XR_KHR_D3D11_ENABLE_EXTENSION_NAME,
+	XR_KHR_D3D12_ENABLE_EXTENSION_NAME,
+	XR_KHR_OPENGL_ENABLE_EXTENSION_NAME,
+	XR_KHR_VISIBILITY_MASK_EXTENSION_NAME,
+	XR_KHR_COMPOSITION_LAYER_DEPTH_EXTENSION_NAME,
+	XR_KHR_COMPOSITION_LAYER_CUBE_EXTENSION_NAME,
+	XR_KHR_COMPOSITION_LAYER_CYLINDER_EXTENSION_NAME,
+	XR_EPIC_VIEW_CONFIGURATION_FOV_EXTENSION_NAME,
+};
+
+static const int64_t s_dxgiFormats[] = {
+	DXGI_FORMAT_R8G8B8A8_UNORM_SRGB,
+	DXGI_FORMAT_B8G8R8A8_UNORM_SRGB,
+	DXGI_FORMAT_R8G8B8A8_UNORM,
+	DXGI_FORMAT_B8G8R8A8_UNORM,
+	DXGI_FORMAT_R16G16B16A16_FLOAT,
+	DXGI_FORMAT_R11G11B10_FLOAT,
+	DXGI_FORMAT_R10G10B10A2_UNORM,
+	DXGI_FORMAT_D32_FLOAT,
+	DXGI_FORMAT_D32_FLOAT_S8X24_UINT,
+	DXGI_FORMAT_D24_UNORM_S8_UINT,
+	DXGI_FORMAT_D16_UNORM,
+};
+
+static const int64_t s_glFormats[] = {
+	0x8C43, // GL_SRGB8_ALPHA8
+	0x8058, // GL_RGBA8
+	0x881A, // GL_RGBA16F
+	0x8C3A, // GL_R11F_G11F_B10F
+	0x8CAC, // GL_DEPTH_COMPONENT32F
+	0x8CAD, // GL_DEPTH32F_STENCIL8
+	0x88F0, // GL_DEPTH24_STENCIL8
+	0x81A5, // GL_DEPTH_COMPONENT16
+};
+
+static std::mutex s_CallMutex;
+static std::map<std::string, std::unique_ptr<StubCall>> s_Calls;
+static StubInstance* s_Instance = nullptr;
+static int64_t s_Frequency = 0;
+
+/* Timing */
+
+static int64_t GetFrequency()
+{
+	if (!s_Frequency)
+	{
+		LARGE_INTEGER freq;
+		QueryPerformanceFrequency(&freq);
+		s_Frequency = freq.QuadPart;
+	}
+	return s_Frequency;
+}
+
+static XrTime TicksToTime(int64_t ticks)
+{
+	int64_t freq = GetFrequency();
+	return (ticks / freq) * 1000000000LL + (ticks % freq) * 1000000000LL / freq;
+}
+
+static int64_t TimeToTicks(XrTime time)
+{
+	int64_t freq = GetFrequency();
+	return (time / 1000000000LL) * freq + (time % 1000000000LL) * freq / 1000000000LL;
+}
+
+XrTime GetStubTime()
+{
+	LARGE_INTEGER ticks;
+	QueryPerformanceCounter(&ticks);
+	return TicksToTime(ticks.QuadPart);
+}
+
+// Sleeps for most of the interval and spins for the remainder, Sleep() alone is far too coarse
+static void DelayUntil(XrTime target)
+{
+	XrTime now = GetStubTime();
+	if (target - now > 2000000)
+		Sleep((DWORD)((target - now) / 1000000 - 1));
+	while (GetStubTime() < target)
+		YieldProcessor();
+}
+
+static double ToSeconds(const StubSession* session, XrTime time)
+{
+	return (double)(time - session->Start) / 1e9;
+}
+
+/* Call statistics */
+
+void StubCall::Enter()
+{
+	Count.fetch_add(1, std::memory_order_relaxed);
+	int64_t latency = Latency.load(std::memory_order_relaxed);
+	if (latency > 0)
+		DelayUntil(GetStubTime() + latency);
+}
+
+StubCall& GetStubCall(const char* name)
+{
+	std::lock_guard<std::mutex> lk(s_CallMutex);
+	std::unique_ptr<StubCall>& call = s_Calls[name];
+	if (!call)
+		call.reset(new StubCall());
+	return *call;
+}
+
+/* Instance helpers */
+
+void StubInstance::QueueState(StubSession* session, XrSessionState state)
+{
+	XrEventDataBuffer buffer = { XR_TYPE_EVENT_DATA_BUFFER };
+	XrEventDataSessionStateChanged& event = reinterpret_cast<XrEventDataSessionStateChanged&>(buffer);
+	event.type = XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED;
+	event.session = ToHandle<XrSession>(session);
+	event.state = state;
+	event.time = GetStubTime();
+	Events.push_back(buffer);
+	session->State = state;
+}
+
+XrPath StubInstance::GetPath(const std::string& path)
+{
+	auto it = PathIds.find(path);
+	if (it != PathIds.end())
+		return it->second;
+
+	Paths.push_back(path);
+	XrPath id = (XrPath)Paths.size();
+	PathIds[path] = id;
+	return id;
+}
+
+const std::string& StubInstance::GetString(XrPath path) const
+{
+	static const std::string empty;
+	if (path == XR_NULL_PATH || path > Paths.size())
+		return empty;
+	return Paths[path - 1];
+}
+
+template<typename T>
+static XrResult Enumerate(const T* data, uint32_t count, uint32_t capacity, uint32_t* out_Count, T* out_Data)
+{
+	if (!out_Count)
+		return XR_ERROR_VALIDATION_FAILURE;
+
+	*out_Count = count;
+	if (capacity == 0)
+		return XR_SUCCESS;
+	if (capacity < count)
+		return XR_ERROR_SIZE_INSUFFICIENT;
+	std::copy(data, data + count, out_Data);
+	return XR_SUCCESS;
+}
+
+static XrResult CopyString(const std::string& str, uint32_t capacity, uint32_t* out_Count, char* buffer)
+{
+	if (!out_Count)
+		return XR_ERROR_VALIDATION_FAILURE;
+
+	*out_Count = (uint32_t)str.size() + 1;
+	if (capacity == 0)
+		return XR_SUCCESS;
+	if (capacity < *out_Count)
+		return XR_ERROR_SIZE_INSUFFICIENT;
+	strcpy_s(buffer, capacity, str.c_str());
+	return XR_SUCCESS;
+}
+
+static bool GetAdapterLuid(LUID* luid)
+{
+	Microsoft::WRL::ComPtr<IDXGIFactory1> pFactory;
+	Microsoft::WRL::ComPtr<IDXGIAdapter1> pAdapter;
+	DXGI_ADAPTER_DESC1 desc;
+	if (FAILED(CreateDXGIFactory1(__uuidof(IDXGIFactory1), (void**)&pFactory)) ||
+		FAILED(pFactory->EnumAdapters1(0, &pAdapter)) || FAILED(pAdapter->GetDesc1(&desc)))
+		return false;
+	*luid = desc.AdapterLuid;
+	return true;
+}
+
+// Returns the top level user path of a binding, such as /user/hand/left for /user/hand/left/input/grip/pose
+static std::string GetUserPath(const std::string& binding)
+{
+	size_t start = binding.compare(0, 11, "/user/hand/") == 0 ? 11 : 6;
+	size_t end = binding.find('/', start);
+	return binding.substr(0, end);
+}
+
+static bool MatchesSubaction(const StubInstance* instance, XrPath binding, XrPath subaction)
+{
+	if (subaction == XR_NULL_PATH)
+		return true;
+	const std::string& prefix = instance->GetString(subaction);
+	return instance->GetString(binding).compare(0, prefix.size(), prefix) == 0;
+}
+
+/* Core functions */
+
+static XrResult XRAPI_CALL StubEnumerateApiLayerProperties(uint32_t capacity, uint32_t* out_Count, XrApiLayerProperties* properties)
+{
+	STUB_CALL(xrEnumerateApiLayerProperties);
+	return Enumerate<XrApiLayerProperties>(nullptr, 0, capacity, out_Count, properties);
+}
+
+static XrResult XRAPI_CALL StubEnumerateInstanceExtensionProperties(const char* layerName, uint32_t capacity, uint32_t* out_Count, XrExtensionProperties* properties)
+{
+	STUB_CALL(xrEnumerateInstanceExtensionProperties);
+
+	if (layerName)
+		return XR_ERROR_API_LAYER_NOT_PRESENT;
+	if (!out_Count)
+		return XR_ERROR_VALIDATION_FAILURE;
+
+	uint32_t count = (uint32_t)(sizeof(s_extensions) / sizeof(const char*));
+	*out_Count = count;
+	if (capacity == 0)
+		return XR_SUCCESS;
+	if (capacity < count)
+		return XR_ERROR_SIZE_INSUFFICIENT;
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		strcpy_s(properties[i].extensionName, s_extensions[i]);
+		properties[i].extensionVersion = 1;
+	}
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubCreateInstance(const XrInstanceCreateInfo* createInfo, XrInstance* instance)
+{
+	STUB_CALL(xrCreateInstance);
+
+	if (s_Instance)
+		return XR_ERROR_LIMIT_REACHED;
+
+	for (uint32_t i = 0; i < createInfo->enabledExtensionCount; i++)
+	{
+		auto it = std::find_if(std::begin(s_extensions), std::end(s_extensions),
+			[&](const char* ext) { return strcmp(ext, createInfo->enabledExtensionNames[i]) == 0; });
+		if (it == std::end(s_extensions))
+			return XR_ERROR_EXTENSION_NOT_PRESENT;
+	}
+
+	StubInstance* stub = new StubInstance();
+	stub->InteractionProfile = XR_NULL_PATH;
+	const char* script = getenv("REVIVE_STUB_SCRIPT");
+	if (script && !stub->Script.Load(script))
+	{
+		delete stub;
+		return XR_ERROR_INITIALIZATION_FAILED;
+	}
+
+	{
+		std::lock_guard<std::mutex> lk(s_CallMutex);
+		for (auto& it : s_Calls)
+			it.second->Latency = 0;
+	}
+	for (auto& it : stub->Script.Latencies)
+		GetStubCall(it.first.c_str()).Latency = (int64_t)(it.second * 1e6);
+
+	s_Instance = stub;
+	*instance = ToHandle<XrInstance>(stub);
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubDestroyInstance(XrInstance instance)
+{
+	STUB_CALL(xrDestroyInstance);
+
+	StubInstance* stub = FromHandle<StubInstance>(instance);
+	if (!stub || stub != s_Instance)
+		return XR_ERROR_HANDLE_INVALID;
+
+	// Write the call counts so a test harness can inspect the runtime traffic after the process exits
+	const char* stats = getenv("REVIVE_STUB_STATS");
+	FILE* file = stats ? fopen(stats, "w") : nullptr;
+	{
+		std::lock_guard<std::mutex> lk(s_CallMutex);
+		for (auto& it : s_Calls)
+		{
+			if (file)
+				fprintf(file, "%s %llu\n", it.first.c_str(), (unsigned long long)it.second->Count.load());
+
+			// The next instance starts with fresh counters, so the traffic of a single run can be asserted on
+			it.second->Count = 0;
+		}
+	}
+	if (file)
+		fclose(file);
+
+	s_Instance = nullptr;
+	delete stub;
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubGetInstanceProperties(XrInstance instance, XrInstanceProperties* properties)
+{
+	STUB_CALL(xrGetInstanceProperties);
+
+	properties->runtimeVersion = XR_MAKE_VERSION(1, 0, 0);
+	strcpy_s(properties->runtimeName, "Revive Stub");
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubPollEvent(XrInstance instance, XrEventDataBuffer* eventData)
+{
+	STUB_CALL(xrPollEvent);
+
+	StubInstance* stub = FromHandle<StubInstance>(instance);
+	std::lock_guard<std::mutex> lk(stub->Mutex);
+	if (stub->Events.empty())
+		return XR_EVENT_UNAVAILABLE;
+
+	*eventData = stub->Events.front();
+	stub->Events.pop_front();
+	return XR_SUCCESS;
+}
+
+#define STUB_ENUM_CASE_STR(name, val) case name: strcpy_s(buffer, XR_MAX_RESULT_STRING_SIZE, #name); break;
+static XrResult XRAPI_CALL StubResultToString(XrInstance instance, XrResult value, char buffer[XR_MAX_RESULT_STRING_SIZE])
+{
+	STUB_CALL(xrResultToString);
+
+	switch (value)
+	{
+		XR_LIST_ENUM_XrResult(STUB_ENUM_CASE_STR)
+		default: sprintf_s(buffer, XR_MAX_RESULT_STRING_SIZE, "XR_UNKNOWN_%d", value); break;
+	}
+	return XR_SUCCESS;
+}
+#undef STUB_ENUM_CASE_STR
+
+#define STUB_ENUM_CASE_STR(name, val) case name: strcpy_s(buffer, XR_MAX_STRUCTURE_NAME_SIZE, #name); break;
+static XrResult XRAPI_CALL StubStructureTypeToString(XrInstance instance, XrStructureType value, char buffer[XR_MAX_STRUCTURE_NAME_SIZE])
+{
+	STUB_CALL(xrStructureTypeToString);
+
+	switch (value)
+	{
+		XR_LIST_ENUM_XrStructureType(STUB_ENUM_CASE_STR)
+		default: sprintf_s(buffer, XR_MAX_STRUCTURE_NAME_SIZE, "XR_UNKNOWN_%d", value); break;
+	}
+	return XR_SUCCESS;
+}
+#undef STUB_ENUM_CASE_STR
+
+static XrResult XRAPI_CALL StubGetSystem(XrInstance instance, const XrSystemGetInfo* getInfo, XrSystemId* systemId)
+{
+	STUB_CALL(xrGetSystem);
+
+	if (getInfo->formFactor != XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY)
+		return XR_ERROR_FORM_FACTOR_UNSUPPORTED;
+	*systemId = 1;
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubGetSystemProperties(XrInstance instance, XrSystemId systemId, XrSystemProperties* properties)
+{
+	STUB_CALL(xrGetSystemProperties);
+
+	if (systemId != 1)
+		return XR_ERROR_SYSTEM_INVALID;
+
+	properties->systemId = systemId;
+	properties->vendorId = 0;
+	strcpy_s(properties->systemName, "Revive Stub HMD");
+	properties->graphicsProperties.maxSwapchainImageWidth = 4096;
+	properties->graphicsProperties.maxSwapchainImageHeight = 4096;
+	properties->graphicsProperties.maxLayerCount = STUB_MAX_LAYERS;
+	properties->trackingProperties.orientationTracking = XR_TRUE;
+	properties->trackingProperties.positionTracking = XR_TRUE;
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubEnumerateEnvironmentBlendModes(XrInstance instance, XrSystemId systemId, XrViewConfigurationType viewConfigurationType,
+	uint32_t capacity, uint32_t* out_Count, XrEnvironmentBlendMode* modes)
+{
+	STUB_CALL(xrEnumerateEnvironmentBlendModes);
+
+	const XrEnvironmentBlendMode mode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
+	return Enumerate(&mode, 1, capacity, out_Count, modes);
+}
+
+static XrResult XRAPI_CALL StubEnumerateViewConfigurations(XrInstance instance, XrSystemId systemId,
+	uint32_t capacity, uint32_t* out_Count, XrViewConfigurationType* types)
+{
+	STUB_CALL(xrEnumerateViewConfigurations);
+
+	const XrViewConfigurationType type = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+	return Enumerate(&type, 1, capacity, out_Count, types);
+}
+
+static XrResult XRAPI_CALL StubGetViewConfigurationProperties(XrInstance instance, XrSystemId systemId,
+	XrViewConfigurationType viewConfigurationType, XrViewConfigurationProperties* properties)
+{
+	STUB_CALL(xrGetViewConfigurationProperties);
+
+	if (viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO)
+		return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+	properties->viewConfigurationType = viewConfigurationType;
+	properties->fovMutable = XR_TRUE;
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubEnumerateViewConfigurationViews(XrInstance instance, XrSystemId systemId, XrViewConfigurationType viewConfigurationType,
+	uint32_t capacity, uint32_t* out_Count, XrViewConfigurationView* views)
+{
+	STUB_CALL(xrEnumerateViewConfigurationViews);
+
+	if (viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO)
+		return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+
+	*out_Count = 2;
+	if (capacity == 0)
+		return XR_SUCCESS;
+	if (capacity < 2)
+		return XR_ERROR_SIZE_INSUFFICIENT;
+
+	const StubScript& script = FromHandle<StubInstance>(instance)->Script;
+	for (uint32_t i = 0; i < 2; i++)
+	{
+		views[i].recommendedImageRectWidth = script.Width;
+		views[i].recommendedImageRectHeight = script.Height;
+		views[i].maxImageRectWidth = script.Width * 2;
+		views[i].maxImageRectHeight = script.Height * 2;
+		views[i].recommendedSwapchainSampleCount = 1;
+		views[i].maxSwapchainSampleCount = 4;
+
+		for (XrBaseOutStructure* next = (XrBaseOutStructure*)views[i].next; next; next = next->next)
+		{
+			if (next->type == XR_TYPE_VIEW_CONFIGURATION_VIEW_FOV_EPIC)
+			{
+				XrViewConfigurationViewFovEPIC* fov = (XrViewConfigurationViewFovEPIC*)next;
+				fov->recommendedFov = script.Fov;
+				fov->maxMutableFov = script.Fov;
+			}
+		}
+	}
+	return XR_SUCCESS;
+}
+
+/* Session functions */
+
+static XrResult XRAPI_CALL StubCreateSession(XrInstance instance, const XrSessionCreateInfo* createInfo, XrSession* session)
+{
+	STUB_CALL(xrCreateSession);
+
+	if (createInfo->systemId != 1)
+		return XR_ERROR_SYSTEM_INVALID;
+
+	StubInstance* stub = FromHandle<StubInstance>(instance);
+	StubSession* s = new StubSession();
+	s->Instance = stub;
+	s->Graphics = StubGraphics_None;
+	s->Device = nullptr;
+	s->Start = GetStubTime();
+	s->DisplayTime = 0;
+	s->SyncTime = s->Start;
+	s->FrameIndex = 0;
+	s->FrameBegun = false;
+
+	// We don't render anything, but keep the D3D11 device so we can hand out real textures
+	const XrBaseInStructure* binding = (const XrBaseInStructure*)createInfo->next;
+	if (binding && binding->type == XR_TYPE_GRAPHICS_BINDING_D3D11_KHR)
+	{
+		s->Graphics = StubGraphics_D3D11;
+		s->Device = ((const XrGraphicsBindingD3D11KHR*)binding)->device;
+		if (s->Device)
+			s->Device->AddRef();
+	}
+	else if (binding && binding->type == XR_TYPE_GRAPHICS_BINDING_D3D12_KHR)
+		s->Graphics = StubGraphics_D3D12;
+	else if (binding && binding->type == XR_TYPE_GRAPHICS_BINDING_OPENGL_WIN32_KHR)
+		s->Graphics = StubGraphics_OpenGL;
+
+	std::lock_guard<std::mutex> lk(stub->Mutex);
+	stub->QueueState(s, XR_SESSION_STATE_IDLE);
+	stub->QueueState(s, XR_SESSION_STATE_READY);
+	*session = ToHandle<XrSession>(s);
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubDestroySession(XrSession session)
+{
+	STUB_CALL(xrDestroySession);
+
+	StubSession* s = FromHandle<StubSession>(session);
+	if (!s)
+		return XR_ERROR_HANDLE_INVALID;
+
+	// Drop any events that still refer to this session
+	{
+		std::lock_guard<std::mutex> lk(s->Instance->Mutex);
+		auto& events = s->Instance->Events;
+		events.erase(std::remove_if(events.begin(), events.end(), [session](const XrEventDataBuffer& event) {
+			return event.type == XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED &&
+				reinterpret_cast<const XrEventDataSessionStateChanged&>(event).session == session;
+		}), events.end());
+	}
+
+	if (s->Device)
+		s->Device->Release();
+	delete s;
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubBeginSession(XrSession session, const XrSessionBeginInfo* beginInfo)
+{
+	STUB_CALL(xrBeginSession);
+
+	StubSession* s = FromHandle<StubSession>(session);
+	if (beginInfo->primaryViewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO)
+		return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+
+	std::lock_guard<std::mutex> lk(s->Instance->Mutex);
+	if (s->State != XR_SESSION_STATE_READY)
+		return XR_ERROR_SESSION_NOT_READY;
+
+	s->Instance->QueueState(s, XR_SESSION_STATE_SYNCHRONIZED);
+	s->Instance->QueueState(s, XR_SESSION_STATE_VISIBLE);
+	s->Instance->QueueState(s, XR_SESSION_STATE_FOCUSED);
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubEndSession(XrSession session)
+{
+	STUB_CALL(xrEndSession);
+
+	StubSession* s = FromHandle<StubSession>(session);
+	std::lock_guard<std::mutex> lk(s->Instance->Mutex);
+	if (s->State == XR_SESSION_STATE_IDLE || s->State == XR_SESSION_STATE_READY)
+		return XR_ERROR_SESSION_NOT_RUNNING;
+
+	s->Instance->QueueState(s, XR_SESSION_STATE_IDLE);
+	s->Instance->QueueState(s, XR_SESSION_STATE_EXITING);
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubRequestExitSession(XrSession session)
+{
+	STUB_CALL(xrRequestExitSession);
+
+	StubSession* s = FromHandle<StubSession>(session);
+	std::lock_guard<std::mutex> lk(s->Instance->Mutex);
+	s->Instance->QueueState(s, XR_SESSION_STATE_STOPPING);
+	return XR_SUCCESS;
+}
+
+/* Space functions */
+
+static XrPosef GetActionPose(const StubSession* session, const StubSpace* space, double time)
+{
+	const StubInstance* stub = session->Instance;
+	for (XrPath binding : space->Action->Bindings)
+	{
+		if (MatchesSubaction(stub, binding, space->Subaction))
+			return stub->Script.GetPose(GetUserPath(stub->GetString(binding)), time);
+	}
+	return StubMath::Identity();
+}
+
+// Returns the pose of the space in the local reference space
+static XrPosef GetSpacePose(const StubSpace* space, XrTime time)
+{
+	const StubSession* session = space->Session;
+	const StubScript& script = session->Instance->Script;
+	double seconds = ToSeconds(session, time);
+
+	XrPosef pose = StubMath::Identity();
+	if (space->Action)
+		pose = GetActionPose(session, space, seconds);
+	else if (space->Type == XR_REFERENCE_SPACE_TYPE_VIEW)
+		pose = script.GetPose("/user/head", seconds);
+	else if (space->Type == XR_REFERENCE_SPACE_TYPE_STAGE)
+		pose.position.y = -script.FloorHeight;
+	return StubMath::Transform(pose, space->Offset);
+}
+
+static XrResult XRAPI_CALL StubEnumerateReferenceSpaces(XrSession session, uint32_t capacity, uint32_t* out_Count, XrReferenceSpaceType* spaces)
+{
+	STUB_CALL(xrEnumerateReferenceSpaces);
+
+	const XrReferenceSpaceType types[] = { XR_REFERENCE_SPACE_TYPE_VIEW, XR_REFERENCE_SPACE_TYPE_LOCAL, XR_REFERENCE_SPACE_TYPE_STAGE };
+	return Enumerate(types, 3, capacity, out_Count, spaces);
+}
+
+static XrResult XRAPI_CALL StubCreateReferenceSpace(XrSession session, const XrReferenceSpaceCreateInfo* createInfo, XrSpace* space)
+{
+	STUB_CALL(xrCreateReferenceSpace);
+
+	if (createInfo->referenceSpaceType < XR_REFERENCE_SPACE_TYPE_VIEW || createInfo->referenceSpaceType > XR_REFERENCE_SPACE_TYPE_STAGE)
+		return XR_ERROR_REFERENCE_SPACE_UNSUPPORTED;
+
+	StubSpace* s = new StubSpace();
+	s->Session = FromHandle<StubSession>(session);
+	s->Type = createInfo->referenceSpaceType;
+	s->Action = nullptr;
+	s->Subaction = XR_NULL_PATH;
+	s->Offset = createInfo->poseInReferenceSpace;
+	*space = ToHandle<XrSpace>(s);
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubCreateActionSpace(XrSession session, const XrActionSpaceCreateInfo* createInfo, XrSpace* space)
+{
+	STUB_CALL(xrCreateActionSpace);
+
+	StubAction* action = FromHandle<StubAction>(createInfo->action);
+	if (!action || action->Type != XR_ACTION_TYPE_POSE_INPUT)
+		return XR_ERROR_ACTION_TYPE_MISMATCH;
+
+	StubSpace* s = new StubSpace();
+	s->Session = FromHandle<StubSession>(session);
+	s->Type = XR_REFERENCE_SPACE_TYPE_LOCAL;
+	s->Action = action;
+	s->Subaction = createInfo->subactionPath;
+	s->Offset = createInfo->poseInActionSpace;
+	*space = ToHandle<XrSpace>(s);
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubDestroySpace(XrSpace space)
+{
+	STUB_CALL(xrDestroySpace);
+
+	delete FromHandle<StubSpace>(space);
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubGetReferenceSpaceBoundsRect(XrSession session, XrReferenceSpaceType referenceSpaceType, XrExtent2Df* bounds)
+{
+	STUB_CALL(xrGetReferenceSpaceBoundsRect);
+
+	if (referenceSpaceType != XR_REFERENCE_SPACE_TYPE_STAGE)
+	{
+		*bounds = { 0.0f, 0.0f };
+		return XR_SPACE_BOUNDS_UNAVAILABLE;
+	}
+	*bounds = FromHandle<StubSession>(session)->Instance->Script.Bounds;
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubLocateSpace(XrSpace space, XrSpace baseSpace, XrTime time, XrSpaceLocation* location)
+{
+	STUB_CALL(xrLocateSpace);
+
+	StubSpace* s = FromHandle<StubSpace>(space);
+	StubSpace* base = FromHandle<StubSpace>(baseSpace);
+	if (!s || !base)
+		return XR_ERROR_HANDLE_INVALID;
+	if (time <= 0)
+		return XR_ERROR_TIME_INVALID;
+
+	// Action spaces look up the binding paths, which may be added concurrently
+	std::lock_guard<std::mutex> lk(s->Session->Instance->Mutex);
+	location->pose = StubMath::Transform(StubMath::Inverse(GetSpacePose(base, time)), GetSpacePose(s, time));
+	location->locationFlags = XR_SPACE_LOCATION_ORIENTATION_VALID_BIT | XR_SPACE_LOCATION_POSITION_VALID_BIT |
+		XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT | XR_SPACE_LOCATION_POSITION_TRACKED_BIT;
+
+	// Scripted poses are not differentiated, the velocity is always reported as zero
+	for (XrBaseOutStructure* next = (XrBaseOutStructure*)location->next; next; next = next->next)
+	{
+		if (next->type == XR_TYPE_SPACE_VELOCITY)
+		{
+			XrSpaceVelocity* velocity = (XrSpaceVelocity*)next;
+			velocity->velocityFlags = XR_SPACE_VELOCITY_LINEAR_VALID_BIT | XR_SPACE_VELOCITY_ANGULAR_VALID_BIT;
+			velocity->linearVelocity = { 0.0f, 0.0f, 0.0f };
+			velocity->angularVelocity = { 0.0f, 0.0f, 0.0f };
+		}
+	}
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubLocateViews(XrSession session, const XrViewLocateInfo* viewLocateInfo, XrViewState* viewState,
+	uint32_t capacity, uint32_t* out_Count, XrView* views)
+{
+	STUB_CALL(xrLocateViews);
+
+	if (viewLocateInfo->viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO)
+		return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+
+	*out_Count = 2;
+	if (capacity == 0)
+		return XR_SUCCESS;
+	if (capacity < 2)
+		return XR_ERROR_SIZE_INSUFFICIENT;
+
+	StubSession* s = FromHandle<StubSession>(session);
+	StubSpace* base = FromHandle<StubSpace>(viewLocateInfo->space);
+	const StubScript& script = s->Instance->Script;
+	XrPosef head = script.GetPose("/user/head", ToSeconds(s, viewLocateInfo->displayTime));
+	XrPosef inverse = StubMath::Inverse(GetSpacePose(base, viewLocateInfo->displayTime));
+
+	for (uint32_t i = 0; i < 2; i++)
+	{
+		XrPosef eye = StubMath::Identity();
+		eye.position.x = i == 0 ? -script.Ipd / 2.0f : script.Ipd / 2.0f;
+		views[i].pose = StubMath::Transform(inverse, StubMath::Transform(head, eye));
+		views[i].fov = script.Fov;
+	}
+	viewState->viewStateFlags = XR_VIEW_STATE_ORIENTATION_VALID_BIT | XR_VIEW_STATE_POSITION_VALID_BIT |
+		XR_VIEW_STATE_ORIENTATION_TRACKED_BIT | XR_VIEW_STATE_POSITION_TRACKED_BIT;
+	return XR_SUCCESS;
+}
+
+/* Swapchain functions */
+
+static XrResult XRAPI_CALL StubEnumerateSwapchainFormats(XrSession session, uint32_t capacity, uint32_t* out_Count, int64_t* formats)
+{
+	STUB_CALL(xrEnumerateSwapchainFormats);
+
+	StubSession* s = FromHandle<StubSession>(session);
+	if (s->Graphics == StubGraphics_OpenGL)
+		return Enumerate(s_glFormats, (uint32_t)(sizeof(s_glFormats) / sizeof(int64_t)), capacity, out_Count, formats);
+	return Enumerate(s_dxgiFormats, (uint32_t)(sizeof(s_dxgiFormats) / sizeof(int64_t)), capacity, out_Count, formats);
+}
+
+static XrResult XRAPI_CALL StubCreateSwapchain(XrSession session, const XrSwapchainCreateInfo* createInfo, XrSwapchain* swapchain)
+{
+	STUB_CALL(xrCreateSwapchain);
+
+	StubSession* s = FromHandle<StubSession>(session);
+	std::unique_ptr<StubSwapchain> chain(new StubSwapchain());
+	chain->Session = s;
+	chain->Info = *createInfo;
+	chain->Info.next = nullptr;
+	chain->Length = createInfo->createFlags & XR_SWAPCHAIN_CREATE_STATIC_IMAGE_BIT ? 1 : STUB_SWAPCHAIN_LENGTH;
+	chain->Index = 0;
+	chain->Acquired = 0;
+	chain->Textures.resize(chain->Length, nullptr);
+
+	// Other graphics APIs get null images, so only the D3D11 swapchains are backed by textures
+	if (s->Device)
+	{
+		D3D11_TEXTURE2D_DESC desc = {};
+		desc.Width = createInfo->width;
+		desc.Height = createInfo->height;
+		desc.MipLevels = createInfo->mipCount;
+		desc.ArraySize = createInfo->arraySize * createInfo->faceCount;
+		desc.Format = (DXGI_FORMAT)createInfo->format;
+		desc.SampleDesc.Count = createInfo->sampleCount;
+		desc.Usage = D3D11_USAGE_DEFAULT;
+		if (createInfo->usageFlags & XR_SWAPCHAIN_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)
+			desc.BindFlags = D3D11_BIND_DEPTH_STENCIL;
+		else
+			desc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+		if (createInfo->faceCount == 6)
+			desc.MiscFlags = D3D11_RESOURCE_MISC_TEXTURECUBE;
+
+		for (uint32_t i = 0; i < chain->Length; i++)
+		{
+			if (FAILED(s->Device->CreateTexture2D(&desc, nullptr, &chain->Textures[i])))
+			{
+				for (ID3D11Texture2D* texture : chain->Textures)
+				{
+					if (texture)
+						texture->Release();
+				}
+				return XR_ERROR_SWAPCHAIN_FORMAT_UNSUPPORTED;
+			}
+		}
+	}
+
+	*swapchain = ToHandle<XrSwapchain>(chain.release());
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubDestroySwapchain(XrSwapchain swapchain)
+{
+	STUB_CALL(xrDestroySwapchain);
+
+	StubSwapchain* chain = FromHandle<StubSwapchain>(swapchain);
+	if (!chain)
+		return XR_ERROR_HANDLE_INVALID;
+
+	for (ID3D11Texture2D* texture : chain->Textures)
+	{
+		if (texture)
+			texture->Release();
+	}
+	delete chain;
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubEnumerateSwapchainImages(XrSwapchain swapchain, uint32_t capacity, uint32_t* out_Count, XrSwapchainImageBaseHeader* images)
+{
+	STUB_CALL(xrEnumerateSwapchainImages);
+
+	StubSwapchain* chain = FromHandle<StubSwapchain>(swapchain);
+	*out_Count = chain->Length;
+	if (capacity == 0)
+		return XR_SUCCESS;
+	if (capacity < chain->Length)
+		return XR_ERROR_SIZE_INSUFFICIENT;
+
+	for (uint32_t i = 0; i < chain->Length; i++)
+	{
+		switch (images->type)
+		{
+		case XR_TYPE_SWAPCHAIN_IMAGE_D3D11_KHR:
+			((XrSwapchainImageD3D11KHR*)images)[i].texture = chain->Textures[i];
+			break;
+		case XR_TYPE_SWAPCHAIN_IMAGE_D3D12_KHR:
+			((XrSwapchainImageD3D12KHR*)images)[i].texture = nullptr;
+			break;
+		case XR_TYPE_SWAPCHAIN_IMAGE_OPENGL_KHR:
+			((XrSwapchainImageOpenGLKHR*)images)[i].image = 0;
+			break;
+		default:
+			return XR_ERROR_VALIDATION_FAILURE;
+		}
+	}
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubAcquireSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageAcquireInfo* acquireInfo, uint32_t* index)
+{
+	STUB_CALL(xrAcquireSwapchainImage);
+
+	StubSwapchain* chain = FromHandle<StubSwapchain>(swapchain);
+	if (chain->Acquired >= chain->Length)
+		return XR_ERROR_CALL_ORDER_INVALID;
+
+	*index = (chain->Index + chain->Acquired++) % chain->Length;
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubWaitSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageWaitInfo* waitInfo)
+{
+	STUB_CALL(xrWaitSwapchainImage);
+
+	StubSwapchain* chain = FromHandle<StubSwapchain>(swapchain);
+	return chain->Acquired > 0 ? XR_SUCCESS : XR_ERROR_CALL_ORDER_INVALID;
+}
+
+static XrResult XRAPI_CALL StubReleaseSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageReleaseInfo* releaseInfo)
+{
+	STUB_CALL(xrReleaseSwapchainImage);
+
+	StubSwapchain* chain = FromHandle<StubSwapchain>(swapchain);
+	if (chain->Acquired == 0)
+		return XR_ERROR_CALL_ORDER_INVALID;
+
+	chain->Acquired--;
+	chain->Index = (chain->Index + 1) % chain->Length;
+	return XR_SUCCESS;
+}
+
+/* Frame functions */
+
+static XrResult XRAPI_CALL StubWaitFrame(XrSession session, const XrFrameWaitInfo* frameWaitInfo, XrFrameState* frameState)
+{
+	STUB_CALL(xrWaitFrame);
+
+	StubSession* s = FromHandle<StubSession>(session);
+	const StubScript& script = s->Instance->Script;
+	XrDuration period = (XrDuration)(1e9 / script.RefreshRate);
+
+	XrDuration stall = 0;
+	auto it = script.Stalls.find(s->FrameIndex++);
+	if (it != script.Stalls.end())
+		stall = (XrDuration)(it->second * 1e6);
+
+	if (script.VSync)
+	{
+		// Block until the next vsync, a stall will naturally cause us to miss one or more of them
+		if (stall)
+			DelayUntil(GetStubTime() + stall);
+		XrTime now = GetStubTime();
+		XrTime next = s->Start + ((now - s->Start) / period + 1) * period;
+		DelayUntil(next);
+		s->DisplayTime = next + period;
+	}
+	else
+	{
+		// Free running frames are deterministic, every frame advances the display time by one period
+		if (!s->DisplayTime)
+			s->DisplayTime = s->Start + period;
+		s->DisplayTime += period * (1 + stall / period);
+	}
+
+	frameState->predictedDisplayTime = s->DisplayTime;
+	frameState->predictedDisplayPeriod = period;
+	frameState->shouldRender = s->State == XR_SESSION_STATE_VISIBLE || s->State == XR_SESSION_STATE_FOCUSED;
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubBeginFrame(XrSession session, const XrFrameBeginInfo* frameBeginInfo)
+{
+	STUB_CALL(xrBeginFrame);
+
+	StubSession* s = FromHandle<StubSession>(session);
+	if (s->FrameBegun)
+		return XR_FRAME_DISCARDED;
+	s->FrameBegun = true;
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubEndFrame(XrSession session, const XrFrameEndInfo* frameEndInfo)
+{
+	STUB_CALL(xrEndFrame);
+
+	StubSession* s = FromHandle<StubSession>(session);
+	if (!s->FrameBegun)
+		return XR_ERROR_CALL_ORDER_INVALID;
+	if (frameEndInfo->layerCount > STUB_MAX_LAYERS)
+		return XR_ERROR_LAYER_LIMIT_EXCEEDED;
+	if (frameEndInfo->environmentBlendMode != XR_ENVIRONMENT_BLEND_MODE_OPAQUE)
+		return XR_ERROR_ENVIRONMENT_BLEND_MODE_UNSUPPORTED;
+
+	for (uint32_t i = 0; i < frameEndInfo->layerCount; i++)
+	{
+		if (!frameEndInfo->layers[i])
+			return XR_ERROR_LAYER_INVALID;
+	}
+
+	s->FrameBegun = false;
+	return XR_SUCCESS;
+}
+
+/* Path functions */
+
+static XrResult XRAPI_CALL StubStringToPath(XrInstance instance, const char* pathString, XrPath* path)
+{
+	STUB_CALL(xrStringToPath);
+
+	if (!pathString || pathString[0] != '/')
+		return XR_ERROR_PATH_FORMAT_INVALID;
+
+	StubInstance* stub = FromHandle<StubInstance>(instance);
+	std::lock_guard<std::mutex> lk(stub->Mutex);
+	*path = stub->GetPath(pathString);
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubPathToString(XrInstance instance, XrPath path, uint32_t capacity, uint32_t* out_Count, char* buffer)
+{
+	STUB_CALL(xrPathToString);
+
+	StubInstance* stub = FromHandle<StubInstance>(instance);
+	std::lock_guard<std::mutex> lk(stub->Mutex);
+	if (path == XR_NULL_PATH || path > stub->Paths.size())
+		return XR_ERROR_PATH_INVALID;
+	return CopyString(stub->GetString(path), capacity, out_Count, buffer);
+}
+
+/* Action functions */
+
+static XrResult XRAPI_CALL StubCreateActionSet(XrInstance instance, const XrActionSetCreateInfo* createInfo, XrActionSet* actionSet)
+{
+	STUB_CALL(xrCreateActionSet);
+
+	StubActionSet* set = new StubActionSet();
+	set->Instance = FromHandle<StubInstance>(instance);
+	set->Name = createInfo->actionSetName;
+	set->Attached = false;
+	*actionSet = ToHandle<XrActionSet>(set);
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubDestroyActionSet(XrActionSet actionSet)
+{
+	STUB_CALL(xrDestroyActionSet);
+
+	StubActionSet* set = FromHandle<StubActionSet>(actionSet);
+	if (!set)
+		return XR_ERROR_HANDLE_INVALID;
+
+	for (StubAction* action : set->Actions)
+		delete action;
+	delete set;
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubCreateAction(XrActionSet actionSet, const XrActionCreateInfo* createInfo, XrAction* action)
+{
+	STUB_CALL(xrCreateAction);
+
+	StubActionSet* set = FromHandle<StubActionSet>(actionSet);
+	if (set->Attached)
+		return XR_ERROR_ACTIONSETS_ALREADY_ATTACHED;
+
+	StubAction* a = new StubAction();
+	a->Set = set;
+	a->Type = createInfo->actionType;
+	a->Name = createInfo->actionName;
+	a->Subactions.assign(createInfo->subactionPaths, createInfo->subactionPaths + createInfo->countSubactionPaths);
+	set->Actions.push_back(a);
+	*action = ToHandle<XrAction>(a);
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubDestroyAction(XrAction action)
+{
+	STUB_CALL(xrDestroyAction);
+
+	// Actions are owned by their action set, destroying them early only removes them from the set
+	StubAction* a = FromHandle<StubAction>(action);
+	if (!a)
+		return XR_ERROR_HANDLE_INVALID;
+
+	std::vector<StubAction*>& actions = a->Set->Actions;
+	actions.erase(std::remove(actions.begin(), actions.end(), a), actions.end());
+	delete a;
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubSuggestInteractionProfileBindings(XrInstance instance, const XrInteractionProfileSuggestedBinding* suggestedBindings)
+{
+	STUB_CALL(xrSuggestInteractionProfileBindings);
+
+	StubInstance* stub = FromHandle<StubInstance>(instance);
+	std::lock_guard<std::mutex> lk(stub->Mutex);
+
+	// Suggesting bindings again for a profile replaces the previous suggestion
+	std::map<StubAction*, std::vector<XrPath>>& bindings = stub->SuggestedBindings[suggestedBindings->interactionProfile];
+	bindings.clear();
+	for (uint32_t i = 0; i < suggestedBindings->countSuggestedBindings; i++)
+	{
+		const XrActionSuggestedBinding& binding = suggestedBindings->suggestedBindings[i];
+		bindings[FromHandle<StubAction>(binding.action)].push_back(binding.binding);
+	}
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubAttachSessionActionSets(XrSession session, const XrSessionActionSetsAttachInfo* attachInfo)
+{
+	STUB_CALL(xrAttachSessionActionSets);
+
+	StubSession* s = FromHandle<StubSession>(session);
+	StubInstance* stub = s->Instance;
+	std::lock_guard<std::mutex> lk(stub->Mutex);
+	if (!s->ActionSets.empty())
+		return XR_ERROR_ACTIONSETS_ALREADY_ATTACHED;
+
+	// Prefer the Touch profile, since that's what Revive is emulating, otherwise take the first suggestion
+	auto profile = stub->SuggestedBindings.find(stub->GetPath("/interaction_profiles/oculus/touch_controller"));
+	if (profile == stub->SuggestedBindings.end())
+		profile = stub->SuggestedBindings.begin();
+
+	for (uint32_t i = 0; i < attachInfo->countActionSets; i++)
+	{
+		StubActionSet* set = FromHandle<StubActionSet>(attachInfo->actionSets[i]);
+		set->Attached = true;
+		s->ActionSets.push_back(set);
+
+		for (StubAction* action : set->Actions)
+		{
+			action->Bindings.clear();
+			if (profile != stub->SuggestedBindings.end())
+			{
+				auto it = profile->second.find(action);
+				if (it != profile->second.end())
+					action->Bindings = it->second;
+			}
+		}
+	}
+
+	if (profile != stub->SuggestedBindings.end())
+	{
+		stub->InteractionProfile = profile->first;
+		XrEventDataBuffer buffer = { XR_TYPE_EVENT_DATA_BUFFER };
+		XrEventDataInteractionProfileChanged& event = reinterpret_cast<XrEventDataInteractionProfileChanged&>(buffer);
+		event.type = XR_TYPE_EVENT_DATA_INTERACTION_PROFILE_CHANGED;
+		event.session = session;
+		stub->Events.push_back(buffer);
+	}
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubGetCurrentInteractionProfile(XrSession session, XrPath topLevelUserPath, XrInteractionProfileState* interactionProfile)
+{
+	STUB_CALL(xrGetCurrentInteractionProfile);
+
+	StubSession* s = FromHandle<StubSession>(session);
+	if (s->ActionSets.empty())
+		return XR_ERROR_ACTIONSET_NOT_ATTACHED;
+
+	std::lock_guard<std::mutex> lk(s->Instance->Mutex);
+	interactionProfile->interactionProfile = s->Instance->InteractionProfile;
+	return XR_SUCCESS;
+}
+
+// Combines the scripted values of all bindings that match the subaction path
+static XrVector2f EvaluateAction(const StubSession* session, const StubAction* action, XrPath subaction, double time)
+{
+	const StubInstance* stub = session->Instance;
+	XrVector2f result = { 0.0f, 0.0f };
+	for (XrPath binding : action->Bindings)
+	{
+		if (!MatchesSubaction(stub, binding, subaction))
+			continue;
+
+		XrVector2f value = stub->Script.GetValue(stub->GetString(binding), time);
+		if (value.x * value.x + value.y * value.y > result.x * result.x + result.y * result.y)
+			result = value;
+	}
+	return result;
+}
+
+static XrResult XRAPI_CALL StubSyncActions(XrSession session, const XrActionsSyncInfo* syncInfo)
+{
+	STUB_CALL(xrSyncActions);
+
+	StubSession* s = FromHandle<StubSession>(session);
+	if (s->ActionSets.empty())
+		return XR_ERROR_ACTIONSET_NOT_ATTACHED;
+	if (s->State != XR_SESSION_STATE_FOCUSED)
+		return XR_SESSION_NOT_FOCUSED;
+
+	// Free running sessions sample the input at the display time, so replays are deterministic
+	s->SyncTime = s->Instance->Script.VSync ? GetStubTime() : s->DisplayTime;
+	double time = ToSeconds(s, s->SyncTime);
+
+	std::lock_guard<std::mutex> lk(s->Instance->Mutex);
+	for (uint32_t i = 0; i < syncInfo->countActiveActionSets; i++)
+	{
+		const XrActiveActionSet& active = syncInfo->activeActionSets[i];
+		StubActionSet* set = FromHandle<StubActionSet>(active.actionSet);
+		for (StubAction* action : set->Actions)
+		{
+			std::pair<XrVector2f, XrVector2f>& state = action->States[XR_NULL_PATH];
+			state.second = state.first;
+			state.first = EvaluateAction(s, action, active.subactionPath, time);
+
+			for (XrPath subaction : action->Subactions)
+			{
+				std::pair<XrVector2f, XrVector2f>& subState = action->States[subaction];
+				subState.second = subState.first;
+				subState.first = EvaluateAction(s, action, subaction, time);
+			}
+		}
+	}
+	return XR_SUCCESS;
+}
+
+static const std::pair<XrVector2f, XrVector2f>* GetActionState(const XrActionStateGetInfo* getInfo)
+{
+	StubAction* action = FromHandle<StubAction>(getInfo->action);
+	if (!action)
+		return nullptr;
+
+	static const std::pair<XrVector2f, XrVector2f> empty = {};
+	auto it = action->States.find(getInfo->subactionPath);
+	return it != action->States.end() ? &it->second : &empty;
+}
+
+static XrResult XRAPI_CALL StubGetActionStateBoolean(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStateBoolean* state)
+{
+	STUB_CALL(xrGetActionStateBoolean);
+
+	StubSession* s = FromHandle<StubSession>(session);
+	StubAction* action = FromHandle<StubAction>(getInfo->action);
+	if (!action || action->Type != XR_ACTION_TYPE_BOOLEAN_INPUT)
+		return XR_ERROR_ACTION_TYPE_MISMATCH;
+
+	std::lock_guard<std::mutex> lk(s->Instance->Mutex);
+	const std::pair<XrVector2f, XrVector2f>* values = GetActionState(getInfo);
+	state->currentState = values->first.x > 0.5f;
+	state->changedSinceLastSync = state->currentState != (values->second.x > 0.5f);
+	state->lastChangeTime = state->changedSinceLastSync ? s->SyncTime : 0;
+	state->isActive = !action->Bindings.empty();
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubGetActionStateFloat(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStateFloat* state)
+{
+	STUB_CALL(xrGetActionStateFloat);
+
+	StubSession* s = FromHandle<StubSession>(session);
+	StubAction* action = FromHandle<StubAction>(getInfo->action);
+	if (!action || action->Type != XR_ACTION_TYPE_FLOAT_INPUT)
+		return XR_ERROR_ACTION_TYPE_MISMATCH;
+
+	std::lock_guard<std::mutex> lk(s->Instance->Mutex);
+	const std::pair<XrVector2f, XrVector2f>* values = GetActionState(getInfo);
+	state->currentState = values->first.x;
+	state->changedSinceLastSync = values->first.x != values->second.x;
+	state->lastChangeTime = state->changedSinceLastSync ? s->SyncTime : 0;
+	state->isActive = !action->Bindings.empty();
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubGetActionStateVector2f(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStateVector2f* state)
+{
+	STUB_CALL(xrGetActionStateVector2f);
+
+	StubSession* s = FromHandle<StubSession>(session);
+	StubAction* action = FromHandle<StubAction>(getInfo->action);
+	if (!action || action->Type != XR_ACTION_TYPE_VECTOR2F_INPUT)
+		return XR_ERROR_ACTION_TYPE_MISMATCH;
+
+	std::lock_guard<std::mutex> lk(s->Instance->Mutex);
+	const std::pair<XrVector2f, XrVector2f>* values = GetActionState(getInfo);
+	state->currentState = values->first;
+	state->changedSinceLastSync = values->first.x != values->second.x || values->first.y != values->second.y;
+	state->lastChangeTime = state->changedSinceLastSync ? s->SyncTime : 0;
+	state->isActive = !action->Bindings.empty();
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubGetActionStatePose(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStatePose* state)
+{
+	STUB_CALL(xrGetActionStatePose);
+
+	StubAction* action = FromHandle<StubAction>(getInfo->action);
+	if (!action || action->Type != XR_ACTION_TYPE_POSE_INPUT)
+		return XR_ERROR_ACTION_TYPE_MISMATCH;
+
+	state->isActive = !action->Bindings.empty();
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubEnumerateBoundSourcesForAction(XrSession session, const XrBoundSourcesForActionEnumerateInfo* enumerateInfo,
+	uint32_t capacity, uint32_t* out_Count, XrPath* sources)
+{
+	STUB_CALL(xrEnumerateBoundSourcesForAction);
+
+	StubAction* action = FromHandle<StubAction>(enumerateInfo->action);
+	if (!action)
+		return XR_ERROR_HANDLE_INVALID;
+	return Enumerate(action->Bindings.data(), (uint32_t)action->Bindings.size(), capacity, out_Count, sources);
+}
+
+static XrResult XRAPI_CALL StubGetInputSourceLocalizedName(XrSession session, const XrInputSourceLocalizedNameGetInfo* getInfo,
+	uint32_t capacity, uint32_t* out_Count, char* buffer)
+{
+	STUB_CALL(xrGetInputSourceLocalizedName);
+
+	StubInstance* stub = FromHandle<StubSession>(session)->Instance;
+	std::lock_guard<std::mutex> lk(stub->Mutex);
+	return CopyString(stub->GetString(getInfo->sourcePath), capacity, out_Count, buffer);
+}
+
+static XrResult XRAPI_CALL StubApplyHapticFeedback(XrSession session, const XrHapticActionInfo* hapticActionInfo, const XrHapticBaseHeader* hapticFeedback)
+{
+	STUB_CALL(xrApplyHapticFeedback);
+
+	StubAction* action = FromHandle<StubAction>(hapticActionInfo->action);
+	if (!action || action->Type != XR_ACTION_TYPE_VIBRATION_OUTPUT)
+		return XR_ERROR_ACTION_TYPE_MISMATCH;
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubStopHapticFeedback(XrSession session, const XrHapticActionInfo* hapticActionInfo)
+{
+	STUB_CALL(xrStopHapticFeedback);
+
+	StubAction* action = FromHandle<StubAction>(hapticActionInfo->action);
+	if (!action || action->Type != XR_ACTION_TYPE_VIBRATION_OUTPUT)
+		return XR_ERROR_ACTION_TYPE_MISMATCH;
+	return XR_SUCCESS;
+}
+
+/* Extension functions */
+
+static XrResult XRAPI_CALL StubConvertWin32PerformanceCounterToTimeKHR(XrInstance instance, const LARGE_INTEGER* performanceCounter, XrTime* time)
+{
+	STUB_CALL(xrConvertWin32PerformanceCounterToTimeKHR);
+
+	*time = TicksToTime(performanceCounter->QuadPart);
+	return *time > 0 ? XR_SUCCESS : XR_ERROR_TIME_INVALID;
+}
+
+static XrResult XRAPI_CALL StubConvertTimeToWin32PerformanceCounterKHR(XrInstance instance, XrTime time, LARGE_INTEGER* performanceCounter)
+{
+	STUB_CALL(xrConvertTimeToWin32PerformanceCounterKHR);
+
+	if (time <= 0)
+		return XR_ERROR_TIME_INVALID;
+	performanceCounter->QuadPart = TimeToTicks(time);
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubGetD3D11GraphicsRequirementsKHR(XrInstance instance, XrSystemId systemId, XrGraphicsRequirementsD3D11KHR* graphicsRequirements)
+{
+	STUB_CALL(xrGetD3D11GraphicsRequirementsKHR);
+
+	// Any adapter will do, including the software rasterizer on machines without a GPU
+	if (!GetAdapterLuid(&graphicsRequirements->adapterLuid))
+		return XR_ERROR_RUNTIME_FAILURE;
+	graphicsRequirements->minFeatureLevel = D3D_FEATURE_LEVEL_11_0;
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubGetD3D12GraphicsRequirementsKHR(XrInstance instance, XrSystemId systemId, XrGraphicsRequirementsD3D12KHR* graphicsRequirements)
+{
+	STUB_CALL(xrGetD3D12GraphicsRequirementsKHR);
+
+	if (!GetAdapterLuid(&graphicsRequirements->adapterLuid))
+		return XR_ERROR_RUNTIME_FAILURE;
+	graphicsRequirements->minFeatureLevel = D3D_FEATURE_LEVEL_11_0;
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubGetOpenGLGraphicsRequirementsKHR(XrInstance instance, XrSystemId systemId, XrGraphicsRequirementsOpenGLKHR* graphicsRequirements)
+{
+	STUB_CALL(xrGetOpenGLGraphicsRequirementsKHR);
+
+	graphicsRequirements->minApiVersionSupported = XR_MAKE_VERSION(4, 0, 0);
+	graphicsRequirements->maxApiVersionSupported = XR_MAKE_VERSION(4, 6, 0);
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubGetVisibilityMaskKHR(XrSession session, XrViewConfigurationType viewConfigurationType, uint32_t viewIndex,
+	XrVisibilityMaskTypeKHR visibilityMaskType, XrVisibilityMaskKHR* visibilityMask)
+{
+	STUB_CALL(xrGetVisibilityMaskKHR);
+
+	if (viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO)
+		return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+	if (viewIndex >= 2)
+		return XR_ERROR_INDEX_OUT_OF_RANGE;
+
+	static const std::vector<XrVector2f> empty;
+	const StubScript& script = FromHandle<StubSession>(session)->Instance->Script;
+	auto it = script.Masks.find(visibilityMaskType);
+	const std::vector<XrVector2f>& vertices = it != script.Masks.end() ? it->second : empty;
+
+	// The triangle meshes are fans around the first vertex, the line loop simply visits every vertex
+	std::vector<uint32_t> indices;
+	if (visibilityMaskType == XR_VISIBILITY_MASK_TYPE_LINE_LOOP_KHR)
+	{
+		for (uint32_t i = 0; i < vertices.size(); i++)
+			indices.push_back(i);
+	}
+	else
+	{
+		for (uint32_t i = 1; i + 1 < vertices.size(); i++)
+		{
+			indices.push_back(0);
+			indices.push_back(i);
+			indices.push_back(i + 1);
+		}
+	}
+
+	visibilityMask->vertexCountOutput = (uint32_t)vertices.size();
+	visibilityMask->indexCountOutput = (uint32_t)indices.size();
+	if (visibilityMask->vertexCapacityInput == 0 && visibilityMask->indexCapacityInput == 0)
+		return XR_SUCCESS;
+	if (visibilityMask->vertexCapacityInput < vertices.size() || visibilityMask->indexCapacityInput < indices.size())
+		return XR_ERROR_SIZE_INSUFFICIENT;
+
+	std::copy(vertices.begin(), vertices.end(), visibilityMask->vertices);
+	std::copy(indices.begin(), indices.end(), visibilityMask->indices);
+	return XR_SUCCESS;
+}
+
+static XrResult XRAPI_CALL StubGetStubCallCountREVIVE(XrInstance instance, const char* name, uint64_t* count)
+{
+	if (!name || !count)
+		return XR_ERROR_VALIDATION_FAILURE;
+
+	std::lock_guard<std::mutex> lk(s_CallMutex);
+	auto it = s_Calls.find(name);
+	*count = it != s_Calls.end() ? it->second->Count.load() : 0;
+	return XR_SUCCESS;
+}
+
+/* Dispatch */
+
+#define STUB_FUNCTION(x) { "xr" #x, (PFN_xrVoidFunction)Stub##x }
+
+static const std::pair<const char*, PFN_xrVoidFunction> s_functions[] = {
+	{ "xrGetInstanceProcAddr", (PFN_xrVoidFunction)StubGetInstanceProcAddr },
+	STUB_FUNCTION(EnumerateApiLayerProperties),
+	STUB_FUNCTION(EnumerateInstanceExtensionProperties),
+	STUB_FUNCTION(CreateInstance),
+	STUB_FUNCTION(DestroyInstance),
+	STUB_FUNCTION(GetInstanceProperties),
+	STUB_FUNCTION(PollEvent),
+	STUB_FUNCTION(ResultToString),
+	STUB_FUNCTION(StructureTypeToString),
+	STUB_FUNCTION(GetSystem),
+	STUB_FUNCTION(GetSystemProperties),
+	STUB_FUNCTION(EnumerateEnvironmentBlendModes),
+	STUB_FUNCTION(EnumerateViewConfigurations),
+	STUB_FUNCTION(GetViewConfigurationProperties),
+	STUB_FUNCTION(EnumerateViewConfigurationViews),
+	STUB_FUNCTION(CreateSession),
+	STUB_FUNCTION(DestroySession),
+	STUB_FUNCTION(BeginSession),
+	STUB_FUNCTION(EndSession),
+	STUB_FUNCTION(RequestExitSession),
+	STUB_FUNCTION(EnumerateReferenceSpaces),
+	STUB_FUNCTION(CreateReferenceSpace),
+	STUB_FUNCTION(CreateActionSpace),
+	STUB_FUNCTION(DestroySpace),
+	STUB_FUNCTION(GetReferenceSpaceBoundsRect),
+	STUB_FUNCTION(LocateSpace),
+	STUB_FUNCTION(LocateViews),
+	STUB_FUNCTION(EnumerateSwapchainFormats),
+	STUB_FUNCTION(CreateSwapchain),
+	STUB_FUNCTION(DestroySwapchain),
+	STUB_FUNCTION(EnumerateSwapchainImages),
+	STUB_FUNCTION(AcquireSwapchainImage),
+	STUB_FUNCTION(WaitSwapchainImage),
+	STUB_FUNCTION(ReleaseSwapchainImage),
+	STUB_FUNCTION(WaitFrame),
+	STUB_FUNCTION(BeginFrame),
+	STUB_FUNCTION(EndFrame),
+	STUB_FUNCTION(StringToPath),
+	STUB_FUNCTION(PathToString),
+	STUB_FUNCTION(CreateActionSet),
+	STUB_FUNCTION(DestroyActionSet),
+	STUB_FUNCTION(CreateAction),
+	STUB_FUNCTION(DestroyAction),
+	STUB_FUNCTION(SuggestInteractionProfileBindings),
+	STUB_FUNCTION(AttachSessionActionSets),
+	STUB_FUNCTION(GetCurrentInteractionProfile),
+	STUB_FUNCTION(SyncActions),
+	STUB_FUNCTION(GetActionStateBoolean),
+	STUB_FUNCTION(GetActionStateFloat),
+	STUB_FUNCTION(GetActionStateVector2f),
+	STUB_FUNCTION(GetActionStatePose),
+	STUB_FUNCTION(EnumerateBoundSourcesForAction),
+	STUB_FUNCTION(GetInputSourceLocalizedName),
+	STUB_FUNCTION(ApplyHapticFeedback),
+	STUB_FUNCTION(StopHapticFeedback),
+	STUB_FUNCTION(ConvertWin32PerformanceCounterToTimeKHR),
+	STUB_FUNCTION(ConvertTimeToWin32PerformanceCounterKHR),
+	STUB_FUNCTION(GetD3D11GraphicsRequirementsKHR),
+	STUB_FUNCTION(GetD3D12GraphicsRequirementsKHR),
+	STUB_FUNCTION(GetOpenGLGraphicsRequirementsKHR),
+	STUB_FUNCTION(GetVisibilityMaskKHR),
+	STUB_FUNCTION(GetStubCallCountREVIVE),
+};
+
+XrResult XRAPI_CALL StubGetInstanceProcAddr(XrInstance instance, const char* name, PFN_xrVoidFunction* function)
+{
+	STUB_CALL(xrGetInstanceProcAddr);
+
+	if (!name || !function)
+		return XR_ERROR_VALIDATION_FAILURE;
+
+	for (const auto& it : s_functions)
+	{
+		if (strcmp(it.first, name) == 0)
+		{
+			*function = it.second;
+			return XR_SUCCESS;
+		}
+	}
+
+	*function = nullptr;
+	return XR_ERROR_FUNCTION_UNSUPPORTED;
+}
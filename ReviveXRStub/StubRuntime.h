@@ -0,0 +1,132 @@
+#pragma once
+
+#include "StubScript.h"
+
+#include <openxr/openxr.h>
+#include <atomic>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct ID3D11Device;
+struct ID3D11Texture2D;
+
+// Name of the extension function that returns the number of calls made to an xr* function
+#define XR_REVIVE_STUB_CALL_COUNT_NAME "xrGetStubCallCountREVIVE"
+typedef XrResult (XRAPI_PTR *PFN_xrGetStubCallCountREVIVE)(XrInstance instance, const char* name, uint64_t* count);
+
+// Per-function call counter and injected latency
+struct StubCall
+{
+	std::atomic_uint64_t Count;
+	std::atomic_int64_t Latency;
+
+	void Enter();
+};
+
+// Counters are never freed, so the static references held by the entry points stay valid
+StubCall& GetStubCall(const char* name);
+
+#define STUB_CALL(x) \
+	static StubCall& __stub_call = GetStubCall(#x); \
+	__stub_call.Enter();
+
+struct StubInstance;
+struct StubSession;
+struct StubActionSet;
+
+struct StubAction
+{
+	StubActionSet* Set;
+	XrActionType Type;
+	std::string Name;
+	std::vector<XrPath> Subactions;
+	std::vector<XrPath> Bindings;
+
+	// Input values of the current and previous sync for every subaction path, including XR_NULL_PATH
+	std::map<XrPath, std::pair<XrVector2f, XrVector2f>> States;
+};
+
+struct StubActionSet
+{
+	StubInstance* Instance;
+	std::string Name;
+	std::vector<StubAction*> Actions;
+	bool Attached;
+};
+
+struct StubSpace
+{
+	StubSession* Session;
+	XrReferenceSpaceType Type;
+	StubAction* Action;
+	XrPath Subaction;
+	XrPosef Offset;
+};
+
+struct StubSwapchain
+{
+	StubSession* Session;
+	XrSwapchainCreateInfo Info;
+	std::vector<ID3D11Texture2D*> Textures;
+	uint32_t Length;
+	uint32_t Index;
+	uint32_t Acquired;
+};
+
+enum StubGraphics
+{
+	StubGraphics_None,
+	StubGraphics_D3D11,
+	StubGraphics_D3D12,
+	StubGraphics_OpenGL,
+};
+
+struct StubSession
+{
+	StubInstance* Instance;
+	XrSessionState State;
+	StubGraphics Graphics;
+	ID3D11Device* Device;
+	std::vector<StubActionSet*> ActionSets;
+
+	// Frame timing in runtime time
+	XrTime Start;
+	XrTime DisplayTime;
+	XrTime SyncTime;
+	uint64_t FrameIndex;
+	bool FrameBegun;
+};
+
+struct StubInstance
+{
+	std::mutex Mutex;
+	StubScript Script;
+	std::deque<XrEventDataBuffer> Events;
+	std::vector<std::string> Paths;
+	std::map<std::string, XrPath> PathIds;
+	std::map<XrPath, std::map<StubAction*, std::vector<XrPath>>> SuggestedBindings;
+	XrPath InteractionProfile;
+
+	void QueueState(StubSession* session, XrSessionState state);
+	XrPath GetPath(const std::string& path);
+	const std::string& GetString(XrPath path) const;
+};
+
+// Converts between the stub objects and the opaque handles handed to the application
+template<typename H, typename T>
+inline H ToHandle(T* object)
+{
+	return (H)(uint64_t)(uintptr_t)object;
+}
+
+template<typename T, typename H>
+inline T* FromHandle(H handle)
+{
+	return (T*)(uintptr_t)(uint64_t)handle;
+}
+
+XrTime GetStubTime();
+XrResult XRAPI_CALL StubGetInstanceProcAddr(XrInstance instance, const char* name, PFN_xrVoidFunction* function);
@@ -0,0 +1,169 @@
+#include "StubScript.h"
+#include "StubMath.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <sstream>
+
+StubScript::StubScript()
+	: RefreshRate(90.0)
+	, VSync(true)
+	, Width(1440)
+	, Height(1600)
+	, Fov{ -0.82f, 0.82f, 0.87f, -0.87f }
+	, Ipd(0.064f)
+	, FloorHeight(1.6f)
+	, Bounds{ 2.0f, 2.0f }
+	, Loop(0.0)
+{
+	// Default to a headset at the local origin with both hands held in front of the user
+	XrPosef head = StubMath::Identity();
+	XrPosef left = StubMath::Identity();
+	XrPosef right = StubMath::Identity();
+	left.position = { -0.2f, -0.3f, -0.3f };
+	right.position = { 0.2f, -0.3f, -0.3f };
+	m_Poses["/user/head"].push_back({ 0.0, head });
+	m_Poses["/user/hand/left"].push_back({ 0.0, left });
+	m_Poses["/user/hand/right"].push_back({ 0.0, right });
+}
+
+bool StubScript::Load(const char* path)
+{
+	FILE* file = fopen(path, "r");
+	if (!file)
+		return false;
+
+	std::map<std::string, std::vector<PoseKey>> poses;
+	char buffer[1024];
+	while (fgets(buffer, sizeof(buffer), file))
+	{
+		char* comment = strchr(buffer, '#');
+		if (comment)
+			*comment = '\0';
+
+		std::istringstream line(buffer);
+		std::string command;
+		if (!(line >> command))
+			continue;
+
+		if (command == "refresh")
+			line >> RefreshRate;
+		else if (command == "vsync")
+			line >> VSync;
+		else if (command == "resolution")
+			line >> Width >> Height;
+		else if (command == "fov")
+			line >> Fov.angleLeft >> Fov.angleRight >> Fov.angleUp >> Fov.angleDown;
+		else if (command == "ipd")
+			line >> Ipd;
+		else if (command == "floor")
+			line >> FloorHeight;
+		else if (command == "bounds")
+			line >> Bounds.width >> Bounds.height;
+		else if (command == "loop")
+			line >> Loop;
+		else if (command == "stall")
+		{
+			uint64_t frame;
+			double ms;
+			if (line >> frame >> ms)
+				Stalls[frame] = ms;
+		}
+		else if (command == "latency")
+		{
+			std::string function;
+			double ms;
+			if (line >> function >> ms)
+				Latencies[function] = ms;
+		}
+		else if (command == "pose")
+		{
+			std::string user;
+			PoseKey key = { 0.0, StubMath::Identity() };
+			XrPosef& pose = key.Pose;
+			if (!(line >> user >> key.Time >> pose.position.x >> pose.position.y >> pose.position.z))
+				continue;
+			if (line >> pose.orientation.x >> pose.orientation.y >> pose.orientation.z >> pose.orientation.w)
+				pose.orientation = StubMath::Normalize(pose.orientation);
+			poses[user].push_back(key);
+		}
+		else if (command == "value")
+		{
+			std::string binding;
+			ValueKey key = { 0.0, { 0.0f, 0.0f } };
+			if (!(line >> binding >> key.Time >> key.Value.x))
+				continue;
+			line >> key.Value.y;
+			m_Values[binding].push_back(key);
+		}
+		else if (command == "mask")
+		{
+			std::string type;
+			line >> type;
+			XrVisibilityMaskTypeKHR maskType = XR_VISIBILITY_MASK_TYPE_HIDDEN_TRIANGLE_MESH_KHR;
+			if (type == "visible")
+				maskType = XR_VISIBILITY_MASK_TYPE_VISIBLE_TRIANGLE_MESH_KHR;
+			else if (type == "line")
+				maskType = XR_VISIBILITY_MASK_TYPE_LINE_LOOP_KHR;
+
+			std::vector<XrVector2f>& vertices = Masks[maskType];
+			XrVector2f vertex;
+			while (line >> vertex.x >> vertex.y)
+				vertices.push_back(vertex);
+		}
+	}
+	fclose(file);
+
+	// Scripted poses replace the defaults, keys are sorted so they can be written in any order
+	for (auto& it : poses)
+		m_Poses[it.first] = it.second;
+	for (auto& it : m_Poses)
+		std::stable_sort(it.second.begin(), it.second.end(), [](const PoseKey& a, const PoseKey& b) { return a.Time < b.Time; });
+	for (auto& it : m_Values)
+		std::stable_sort(it.second.begin(), it.second.end(), [](const ValueKey& a, const ValueKey& b) { return a.Time < b.Time; });
+
+	RefreshRate = std::max(RefreshRate, 1.0);
+	return true;
+}
+
+XrPosef StubScript::GetPose(const std::string& path, double time) const
+{
+	auto it = m_Poses.find(path);
+	if (it == m_Poses.end() || it->second.empty())
+		return StubMath::Identity();
+
+	time = WrapTime(time);
+	const std::vector<PoseKey>& keys = it->second;
+	auto next = std::upper_bound(keys.begin(), keys.end(), time, [](double t, const PoseKey& key) { return t < key.Time; });
+	if (next == keys.begin())
+		return next->Pose;
+	if (next == keys.end())
+		return keys.back().Pose;
+
+	auto prev = next - 1;
+	float t = (float)((time - prev->Time) / (next->Time - prev->Time));
+	return StubMath::Lerp(prev->Pose, next->Pose, t);
+}
+
+XrVector2f StubScript::GetValue(const std::string& path, double time) const
+{
+	auto it = m_Values.find(path);
+	if (it == m_Values.end() || it->second.empty())
+		return { 0.0f, 0.0f };
+
+	time = WrapTime(time);
+	const std::vector<ValueKey>& keys = it->second;
+	auto next = std::upper_bound(keys.begin(), keys.end(), time, [](double t, const ValueKey& key) { return t < key.Time; });
+	if (next == keys.begin())
+		return { 0.0f, 0.0f };
+	return (next - 1)->Value;
+}
+
+double StubScript::WrapTime(double time) const
+{
+	if (Loop <= 0.0 || time < 0.0)
+		return time;
+	return fmod(time, Loop);
+}
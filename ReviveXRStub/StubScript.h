@@ -0,0 +1,70 @@
+#pragma once
+
+#include <openxr/openxr.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+// Deterministic description of the simulated headset, loaded from the file pointed to by the
+// REVIVE_STUB_SCRIPT environment variable. Every line holds one command, '#' starts a comment:
+//
+//   refresh <hz>                        Display refresh rate
+//   vsync <0|1>                         Block in xrWaitFrame, or advance the display time per frame
+//   resolution <width> <height>         Recommended image size for each eye
+//   fov <left> <right> <up> <down>      Field-of-view angles in radians
+//   ipd <meters>                        Interpupillary distance
+//   floor <meters>                      Height of the local space above the stage
+//   bounds <width> <depth>              Size of the stage bounds
+//   loop <seconds>                      Wraps the script time, zero plays the keys once
+//   stall <frame> <ms>                  Delays the given frame in xrWaitFrame
+//   latency <xrFunction> <ms>           Injected latency on every call to the function
+//   pose <path> <t> <x> <y> <z> [<qx> <qy> <qz> <qw>]
+//                                       Pose key of a top level user path in the local space
+//   value <path> <t> <x> [<y>]          Input key of a binding path, boolean inputs use x
+//   mask <hidden|visible|line> <x> <y>...
+//                                       Visibility mask vertices for both eyes
+//
+// Poses are interpolated between keys, input values hold until the next key.
+class StubScript
+{
+public:
+	StubScript();
+
+	bool Load(const char* path);
+
+	double RefreshRate;
+	bool VSync;
+	uint32_t Width;
+	uint32_t Height;
+	XrFovf Fov;
+	float Ipd;
+	float FloorHeight;
+	XrExtent2Df Bounds;
+	double Loop;
+
+	std::map<uint64_t, double> Stalls;
+	std::map<std::string, double> Latencies;
+	std::map<XrVisibilityMaskTypeKHR, std::vector<XrVector2f>> Masks;
+
+	XrPosef GetPose(const std::string& path, double time) const;
+	XrVector2f GetValue(const std::string& path, double time) const;
+
+private:
+	struct PoseKey
+	{
+		double Time;
+		XrPosef Pose;
+	};
+
+	struct ValueKey
+	{
+		double Time;
+		XrVector2f Value;
+	};
+
+	std::map<std::string, std::vector<PoseKey>> m_Poses;
+	std::map<std::string, std::vector<ValueKey>> m_Values;
+
+	double WrapTime(double time) const;
+};
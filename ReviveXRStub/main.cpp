@@ -0,0 +1,26 @@
+#include "StubRuntime.h"
+
+#include <openxr/openxr_loader_negotiation.h>
+
+// Point XR_RUNTIME_JSON to ReviveXRStub64.json to make the OpenXR loader pick up the stub runtime
+extern "C" XrResult XRAPI_CALL xrNegotiateLoaderRuntimeInterface(const XrNegotiateLoaderInfo* loaderInfo, XrNegotiateRuntimeRequest* runtimeRequest)
+{
+	if (!loaderInfo || !runtimeRequest ||
+		loaderInfo->structType != XR_LOADER_INTERFACE_STRUCT_LOADER_INFO ||
+		loaderInfo->structVersion != XR_LOADER_INFO_STRUCT_VERSION ||
+		loaderInfo->structSize != sizeof(XrNegotiateLoaderInfo) ||
+		runtimeRequest->structType != XR_LOADER_INTERFACE_STRUCT_RUNTIME_REQUEST ||
+		runtimeRequest->structVersion != XR_RUNTIME_INFO_STRUCT_VERSION ||
+		runtimeRequest->structSize != sizeof(XrNegotiateRuntimeRequest))
+		return XR_ERROR_INITIALIZATION_FAILED;
+
+	if (loaderInfo->minInterfaceVersion > XR_CURRENT_LOADER_RUNTIME_VERSION ||
+		loaderInfo->maxInterfaceVersion < XR_CURRENT_LOADER_RUNTIME_VERSION ||
+		loaderInfo->minApiVersion > XR_CURRENT_API_VERSION)
+		return XR_ERROR_INITIALIZATION_FAILED;
+
+	runtimeRequest->runtimeInterfaceVersion = XR_CURRENT_LOADER_RUNTIME_VERSION;
+	runtimeRequest->runtimeApiVersion = XR_CURRENT_API_VERSION;
+	runtimeRequest->getInstanceProcAddr = StubGetInstanceProcAddr;
+	return XR_SUCCESS;
+}
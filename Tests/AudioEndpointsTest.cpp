@@ -0,0 +1,173 @@
+#include "AudioEndpoints.h"
+#include "Test.h"
+
+#include <thread>
+#include <vector>
+
+// Number of threads querying the endpoints while the devices change
+#define QUERY_THREADS 4
+// Number of device changes during the concurrent queries
+#define DEVICE_CHANGES 1000
+
+// Stands in for the runtime, MMDevice and WinMM, counts the resolutions
+class FakeAudioSource : public AudioDeviceSource
+{
+public:
+	std::atomic<int> Resolutions{ 0 };
+	std::atomic<bool> Headset{ true };
+	std::wstring HeadsetId[AudioFlow_Count] = { L"{0.0.0.00000000}.{headset-out}", L"{0.0.1.00000000}.{headset-in}" };
+	std::wstring DefaultId[AudioFlow_Count] = { L"{0.0.0.00000000}.{speakers}", L"{0.0.1.00000000}.{microphone}" };
+	// WinMM reports the endpoint ids in a different case than the runtime
+	std::vector<std::wstring> WaveDevices[AudioFlow_Count] = {
+		{ L"{0.0.0.00000000}.{SPEAKERS}", L"{0.0.0.00000000}.{HEADSET-OUT}" },
+		{ L"{0.0.1.00000000}.{HEADSET-IN}" }
+	};
+
+	bool HasHeadsetEndpoints() override
+	{
+		Resolutions++;
+		return Headset;
+	}
+
+	bool GetHeadsetEndpoint(AudioFlow flow, std::wstring& id) override
+	{
+		id = HeadsetId[flow];
+		return !id.empty();
+	}
+
+	bool GetDefaultEndpoint(AudioFlow flow, std::wstring& id) override
+	{
+		id = DefaultId[flow];
+		return !id.empty();
+	}
+
+	bool GetEndpointGuid(AudioFlow flow, const std::wstring& id, std::wstring& guid) override
+	{
+		guid = L"guid:" + (id.empty() ? DefaultId[flow] : id);
+		return true;
+	}
+
+	uint32_t GetWaveDeviceCount(AudioFlow flow) override { return (uint32_t)WaveDevices[flow].size(); }
+
+	bool GetWaveDeviceEndpoint(AudioFlow flow, uint32_t index, std::wstring& id) override
+	{
+		id = WaveDevices[flow][index];
+		return true;
+	}
+
+	bool GetPreferredWaveDevice(AudioFlow flow, uint32_t& index) override
+	{
+		index = 0;
+		return true;
+	}
+};
+
+static void TestHeadset()
+{
+	FakeAudioSource* source = new FakeAudioSource();
+	AudioEndpoints endpoints{ std::unique_ptr<AudioDeviceSource>(source) };
+
+	AudioEndpoint out = endpoints.Get(AudioFlow_Out);
+	CHECK(out.HasId && out.Id == source->HeadsetId[AudioFlow_Out]);
+	CHECK(out.HasGuid && out.Guid == L"guid:" + source->HeadsetId[AudioFlow_Out]);
+	CHECK(out.HasWaveId && out.WaveId == 1);
+
+	AudioEndpoint in = endpoints.Get(AudioFlow_In);
+	CHECK(in.HasId && in.Id == source->HeadsetId[AudioFlow_In]);
+	CHECK(in.HasWaveId && in.WaveId == 0);
+
+	// Both flows are resolved once and answered from memory afterwards
+	CHECK(source->Resolutions == AudioFlow_Count);
+	for (int i = 0; i < 10; i++)
+		endpoints.Get(AudioFlow_Out);
+	CHECK(source->Resolutions == AudioFlow_Count);
+
+	// A headset without a WinMM device still has its other identifiers
+	source->WaveDevices[AudioFlow_Out].pop_back();
+	endpoints.Invalidate();
+	out = endpoints.Get(AudioFlow_Out);
+	CHECK(source->Resolutions == AudioFlow_Count * 2);
+	CHECK(out.HasId && out.HasGuid && !out.HasWaveId);
+
+	// A headset the runtime doesn't know the endpoint of has no identifiers at all
+	source->HeadsetId[AudioFlow_In].clear();
+	endpoints.Invalidate();
+	in = endpoints.Get(AudioFlow_In);
+	CHECK(!in.HasId && !in.HasGuid && !in.HasWaveId);
+}
+
+static void TestDefaultDevices()
+{
+	FakeAudioSource* source = new FakeAudioSource();
+	source->Headset = false;
+	AudioEndpoints endpoints{ std::unique_ptr<AudioDeviceSource>(source) };
+
+	AudioEndpoint out = endpoints.Get(AudioFlow_Out);
+	CHECK(out.HasId && out.Id == source->DefaultId[AudioFlow_Out]);
+	CHECK(out.HasGuid && out.Guid == L"guid:" + source->DefaultId[AudioFlow_Out]);
+	CHECK(out.HasWaveId && out.WaveId == 0);
+
+	// The runtime starts reporting the headset once the instance exists
+	source->Headset = true;
+	CHECK(endpoints.Get(AudioFlow_Out).Id == source->DefaultId[AudioFlow_Out]);
+	endpoints.Invalidate();
+	CHECK(endpoints.Get(AudioFlow_Out).Id == source->HeadsetId[AudioFlow_Out]);
+}
+
+static void TestConcurrentChanges()
+{
+	FakeAudioSource* source = new FakeAudioSource();
+	std::shared_ptr<AudioEndpoints> endpoints = std::make_shared<AudioEndpoints>(std::unique_ptr<AudioDeviceSource>(source));
+
+	// The queries hold their own reference, like the callers of GetAudioEndpoints()
+	std::atomic<bool> running{ true };
+	std::atomic<int> mismatches{ 0 };
+	std::vector<std::thread> threads;
+	for (int i = 0; i < QUERY_THREADS; i++)
+	{
+		threads.emplace_back([ref = endpoints, &running, &mismatches, source]()
+		{
+			while (running)
+			{
+				AudioEndpoint out = ref->Get(AudioFlow_Out);
+				if (out.Id != source->HeadsetId[AudioFlow_Out] && out.Id != source->DefaultId[AudioFlow_Out])
+					mismatches++;
+			}
+		});
+	}
+
+	// Device notifications arrive on their own thread
+	for (int i = 0; i < DEVICE_CHANGES; i++)
+	{
+		source->Headset = (i % 2) == 0;
+		endpoints->Invalidate();
+		std::this_thread::yield();
+	}
+
+	// Dropping the shared reference, like a shutdown, doesn't free the endpoints while they're queried
+	std::weak_ptr<AudioEndpoints> weak = endpoints;
+	endpoints.reset();
+	CHECK(!weak.expired());
+	running = false;
+	for (std::thread& thread : threads)
+		thread.join();
+	CHECK(weak.expired());
+	CHECK(mismatches == 0);
+
+	// The last change is never lost
+	FakeAudioSource* last = new FakeAudioSource();
+	AudioEndpoints final{ std::unique_ptr<AudioDeviceSource>(last) };
+	last->Headset = false;
+	CHECK(final.Get(AudioFlow_Out).Id == last->DefaultId[AudioFlow_Out]);
+	last->Headset = true;
+	final.Invalidate();
+	CHECK(final.Get(AudioFlow_Out).Id == last->HeadsetId[AudioFlow_Out]);
+}
+
+int main(int argc, char* argv[])
+{
+	TestHeadset();
+	TestDefaultDevices();
+	TestConcurrentChanges();
+	return TestResult();
+}
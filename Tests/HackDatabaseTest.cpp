@@ -0,0 +1,156 @@
+#include "HackDatabase.h"
+#include "Test.h"
+
+static uint64_t Version(const char* str)
+{
+	return HackDatabase::ParseVersion(str);
+}
+
+static HackDatabase::Rule ParseRule(const char* line)
+{
+	HackDatabase database;
+	std::string str = std::string("version 1\n") + line;
+	CHECK(database.Parse(str.c_str()));
+	CHECK(database.Rules.size() == 1);
+	return database.Rules.empty() ? HackDatabase::Rule() : database.Rules[0];
+}
+
+static void TestParse()
+{
+	HackDatabase database;
+	CHECK(!database.Parse("xr HACK_A"));
+	CHECK(!database.Parse("version 2\nxr HACK_A"));
+	CHECK(!database.Parse("version 1\nxr"));
+	CHECK(!database.Parse("version 1\nxr HACK_A unknown=1"));
+	CHECK(!database.Parse("version 1\nxr HACK_A exe"));
+	CHECK(!database.Parse("version 1\nxr HACK_A version=1.0.0"));
+	CHECK(!database.Parse("version 1\nxr HACK_A runtime=\"unterminated"));
+	CHECK(database.Parse("# comment only\nversion 1\n\n   \nxr HACK_A # trailing comment"));
+	CHECK(database.Rules.size() == 1);
+
+	// A failed parse keeps the previous rules
+	CHECK(!database.Parse("version 1\nxr HACK_B bad"));
+	CHECK(database.Rules.size() == 1 && database.Rules[0].Hack == "HACK_A");
+
+	HackDatabase::Rule rule = ParseRule("vr HACK_A exe=Game.exe runtime=\"Windows Mixed Reality Runtime\" version=1.2-2 enable=0");
+	CHECK(rule.Backend == "vr");
+	CHECK(rule.Hack == "HACK_A");
+	CHECK(rule.Filename == "Game.exe");
+	CHECK(rule.Runtime == "Windows Mixed Reality Runtime");
+	CHECK(rule.VersionStart == Version("1.2.0"));
+	CHECK(rule.VersionEnd == Version("2.0.0"));
+	CHECK(!rule.UseHack);
+}
+
+static void TestVersion()
+{
+	CHECK(Version("1") == Version("1.0.0"));
+	CHECK(Version("1.2") == Version("1.2.0"));
+	CHECK(Version("0.9.99") < Version("1.0.0"));
+	CHECK(Version("1.10.0") > Version("1.9.0"));
+	CHECK(Version("1.2.3") == ((1ULL << 48) | (2ULL << 32) | 3ULL));
+}
+
+static void TestMatches()
+{
+	// Without matchers a rule applies everywhere
+	HackDatabase::Rule any = ParseRule("xr HACK_A");
+	CHECK(HackDatabase::Matches(any, "game.exe", "runtime", Version("0.0.1")));
+
+	// The executable is matched without regard to case, the runtime name is not
+	HackDatabase::Rule exe = ParseRule("xr HACK_A exe=EchoVR.exe");
+	CHECK(HackDatabase::Matches(exe, "echovr.exe", "runtime", 0));
+	CHECK(HackDatabase::Matches(exe, "ECHOVR.EXE", "runtime", 0));
+	CHECK(!HackDatabase::Matches(exe, "echovr.exe.bak", "runtime", 0));
+	CHECK(!HackDatabase::Matches(exe, "echo.exe", "runtime", 0));
+
+	HackDatabase::Rule runtime = ParseRule("xr HACK_A runtime=SteamVR/OpenXR");
+	CHECK(HackDatabase::Matches(runtime, "game.exe", "SteamVR/OpenXR", 0));
+	CHECK(!HackDatabase::Matches(runtime, "game.exe", "steamvr/openxr", 0));
+	CHECK(!HackDatabase::Matches(runtime, "game.exe", "Oculus", 0));
+
+	// Version ranges are half-open
+	HackDatabase::Rule range = ParseRule("xr HACK_A version=1.2.0-1.4.0");
+	CHECK(!HackDatabase::Matches(range, "game.exe", "runtime", Version("1.1.9")));
+	CHECK(HackDatabase::Matches(range, "game.exe", "runtime", Version("1.2.0")));
+	CHECK(HackDatabase::Matches(range, "game.exe", "runtime", Version("1.3.7")));
+	CHECK(!HackDatabase::Matches(range, "game.exe", "runtime", Version("1.4.0")));
+
+	// An open end still honors the start of the range
+	HackDatabase::Rule open = ParseRule("xr HACK_A version=1.2.0-");
+	CHECK(open.VersionEnd == 0);
+	CHECK(!HackDatabase::Matches(open, "game.exe", "runtime", Version("0.5.0")));
+	CHECK(!HackDatabase::Matches(open, "game.exe", "runtime", Version("1.1.0")));
+	CHECK(HackDatabase::Matches(open, "game.exe", "runtime", Version("1.2.0")));
+	CHECK(HackDatabase::Matches(open, "game.exe", "runtime", Version("65535.0.0")));
+
+	// All matchers have to match
+	HackDatabase::Rule all = ParseRule("xr HACK_A exe=game.exe runtime=SteamVR/OpenXR version=0.0.0-0.1.0");
+	CHECK(HackDatabase::Matches(all, "game.exe", "SteamVR/OpenXR", Version("0.0.5")));
+	CHECK(!HackDatabase::Matches(all, "other.exe", "SteamVR/OpenXR", Version("0.0.5")));
+	CHECK(!HackDatabase::Matches(all, "game.exe", "Oculus", Version("0.0.5")));
+	CHECK(!HackDatabase::Matches(all, "game.exe", "SteamVR/OpenXR", Version("0.1.0")));
+}
+
+static void TestEvaluate()
+{
+	const char* names[] = { "HACK_A", "HACK_B", "HACK_C" };
+	HackDatabase database;
+	CHECK(database.Parse(
+		"version 1\n"
+		"xr HACK_A exe=game.exe\n"
+		"xr HACK_B runtime=lighthouse enable=0\n"
+		"vr HACK_C\n"
+		"xr HACK_UNKNOWN\n"));
+
+	std::bitset<3> hacks = database.Evaluate("xr", names, "game.exe", "lighthouse", 0);
+	CHECK(hacks.test(0));
+	CHECK(!hacks.test(1));
+	CHECK(!hacks.test(2));
+
+	// A disabling rule enables the hack on everything it doesn't match
+	hacks = database.Evaluate("xr", names, "other.exe", "oculus", 0);
+	CHECK(!hacks.test(0));
+	CHECK(hacks.test(1));
+	CHECK(!hacks.test(2));
+
+	hacks = database.Evaluate("vr", names, "other.exe", "oculus", 0);
+	CHECK(hacks == std::bitset<3>(4));
+}
+
+static void TestShippedDatabase(const char* path)
+{
+	HackDatabase database;
+	CHECK(database.Load(path));
+	CHECK(!database.Rules.empty());
+
+	const char* names[] = { "HACK_BROKEN_LINE_LOOP", "HACK_WAIT_FOR_SESSION_READY", "HACK_FORCE_FOV_FALLBACK" };
+	std::bitset<3> hacks = database.Evaluate("xr", names, "LoneEcho.exe", "SteamVR/OpenXR", Version("0.0.5"));
+	CHECK(hacks.test(0));
+	CHECK(!hacks.test(1));
+	CHECK(hacks.test(2));
+
+	hacks = database.Evaluate("xr", names, "game.exe", "Windows Mixed Reality Runtime", Version("0.0.5"));
+	CHECK(hacks == std::bitset<3>(2));
+
+	hacks = database.Evaluate("xr", names, "game.exe", "SteamVR/OpenXR", Version("0.1.0"));
+	CHECK(hacks.none());
+
+	const char* vrNames[] = { "HACK_SPOOF_SENSORS", "HACK_FAKE_PRODUCT_NAME" };
+	std::bitset<2> vrHacks = database.Evaluate("vr", vrNames, "ultrawings.exe", "oculus", 0);
+	CHECK(vrHacks.test(0));
+	CHECK(vrHacks.test(1));
+	vrHacks = database.Evaluate("vr", vrNames, "game.exe", "lighthouse", 0);
+	CHECK(vrHacks.none());
+}
+
+int main(int argc, char* argv[])
+{
+	TestParse();
+	TestVersion();
+	TestMatches();
+	TestEvaluate();
+	if (argc > 1)
+		TestShippedDatabase(argv[1]);
+	return TestResult();
+}
@@ -0,0 +1,108 @@
+#include "launchservice.h"
+#include "Test.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+
+static QString s_StandIn;
+
+static bool WaitFor(QSignalSpy &spy, int count, int msec = 5000)
+{
+	while (spy.count() < count)
+	{
+		if (!spy.wait(msec))
+			return false;
+	}
+	return true;
+}
+
+static void TestResults()
+{
+	CLaunchService service;
+	QSignalSpy started(&service, &CLaunchService::LaunchStarted);
+	QSignalSpy finished(&service, &CLaunchService::LaunchFinished);
+	QSignalSpy failed(&service, &CLaunchService::LaunchFailed);
+
+	// Launching returns right away and the result is reported through the signals
+	CHECK(service.Launch("success", s_StandIn, "0 100"));
+	CHECK(service.IsLaunching("success"));
+	CHECK(started.count() == 1 && started[0][0].toString() == "success");
+	CHECK(finished.count() == 0);
+	CHECK(WaitFor(finished, 1));
+	CHECK(finished[0][0].toString() == "success");
+	CHECK(!service.IsLaunching("success"));
+
+	CHECK(service.Launch("error", s_StandIn, "3 0"));
+	CHECK(WaitFor(failed, 1));
+	CHECK(failed[0][0].toString() == "error");
+	CHECK(failed[0][1].toString() == "Exited with code 3");
+
+	CHECK(service.Launch("missing", s_StandIn + ".missing", ""));
+	CHECK(WaitFor(failed, 2));
+	CHECK(failed[1][0].toString() == "missing");
+	CHECK(!service.IsLaunching("missing"));
+	CHECK(finished.count() == 1);
+}
+
+static void TestConcurrent()
+{
+	CLaunchService service;
+	QSignalSpy finished(&service, &CLaunchService::LaunchFinished);
+
+	// Launches of different applications run side by side, but every application is only launched once
+	CHECK(service.Launch("a", s_StandIn, "0 300"));
+	CHECK(service.Launch("b", s_StandIn, "0 100"));
+	CHECK(!service.Launch("a", s_StandIn, "0 0"));
+	CHECK(service.IsLaunching("a") && service.IsLaunching("b"));
+
+	CHECK(WaitFor(finished, 2));
+	CHECK(finished[0][0].toString() == "b");
+	CHECK(finished[1][0].toString() == "a");
+
+	// The application can be launched again once the previous launch finished
+	CHECK(service.Launch("a", s_StandIn, "0 0"));
+	CHECK(WaitFor(finished, 3));
+}
+
+static void TestTimeout(const QString &marker)
+{
+	CLaunchService service;
+	service.SetTimeout(200);
+	QSignalSpy finished(&service, &CLaunchService::LaunchFinished);
+	QSignalSpy failed(&service, &CLaunchService::LaunchFailed);
+
+	// A launcher that outlives the timeout is no longer tracked, but it isn't killed either
+	CHECK(service.Launch("slow", s_StandIn, "0 1000 " + marker));
+	CHECK(WaitFor(finished, 1, 900));
+	CHECK(!service.IsLaunching("slow"));
+	CHECK(failed.count() == 0);
+	CHECK(!QFile::exists(marker));
+
+	CHECK(service.Launch("slow", s_StandIn, "0 0"));
+	CHECK(WaitFor(finished, 2));
+
+	QTest::qWait(1500);
+	CHECK(QFile::exists(marker));
+	CHECK(failed.count() == 0);
+}
+
+int main(int argc, char* argv[])
+{
+	QCoreApplication app(argc, argv);
+	if (argc < 2)
+	{
+		printf("Usage: LaunchServiceTest <stand-in executable>\n");
+		return 1;
+	}
+	s_StandIn = QString::fromLocal8Bit(argv[1]);
+
+	QTemporaryDir dir;
+	CHECK(dir.isValid());
+	TestResults();
+	TestConcurrent();
+	TestTimeout(dir.filePath("finished"));
+	return TestResult();
+}
@@ -0,0 +1,22 @@
+// Stands in for ReviveInjector in the launch service test:
+//
+//   LaunchStandIn <exit code> <duration in ms> [file to create before exiting]
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <thread>
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+		return 2;
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(atoi(argv[2])));
+	if (argc > 3)
+	{
+		FILE* file = fopen(argv[3], "w");
+		if (file)
+			fclose(file);
+	}
+	return atoi(argv[1]);
+}
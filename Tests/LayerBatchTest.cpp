@@ -0,0 +1,125 @@
+#include "LayerBatch.h"
+#include "Test.h"
+
+#include <string>
+#include <vector>
+
+// The batch only passes textures through, so the test can supply its own
+class TextureBase
+{
+public:
+	TextureBase(const char* name) : Name(name) { }
+	std::string Name;
+};
+
+// Records the calls a compositor would turn into graphics API calls
+class RecordingRenderer : public LayerRenderer
+{
+public:
+	std::vector<std::string> Calls;
+	std::vector<LayerBlit> Draws;
+
+	virtual void AcquireLayerTexture(TextureBase* texture) { Calls.push_back("Acquire " + texture->Name); }
+	virtual void ReleaseLayerTexture(TextureBase* texture) { Calls.push_back("Release " + texture->Name); }
+	virtual void BeginLayers() { Calls.push_back("Begin"); }
+	virtual void SetLayerSource(TextureBase* texture) { Calls.push_back("Source " + texture->Name); }
+	virtual void SetLayerTarget(TextureBase* texture) { Calls.push_back("Target " + texture->Name); }
+	virtual void DrawLayer(const LayerBlit& blit) { Calls.push_back("Draw"); Draws.push_back(blit); }
+	virtual void EndLayers() { Calls.push_back("End"); }
+};
+
+static LayerBlit MakeBlit(TextureBase* source, TextureBase* target, int eye)
+{
+	LayerBlit blit = { source, target, { eye * 1000, 0, 1000, 1000 }, { -0.5f, 0.5f, 0.5f, -0.5f }, { 0.0f, 0.0f, 1.0f, 1.0f } };
+	return blit;
+}
+
+static void TestEmpty()
+{
+	LayerBatch batch;
+	RecordingRenderer renderer;
+	CHECK(batch.IsEmpty());
+	batch.Render(&renderer);
+	CHECK(renderer.Calls.empty());
+}
+
+static void TestSingleLayer()
+{
+	TextureBase hud("hud"), scene("scene");
+	LayerBatch batch;
+	batch.Add(MakeBlit(&hud, &scene, 0));
+	batch.Add(MakeBlit(&hud, &scene, 1));
+	CHECK(!batch.IsEmpty());
+
+	RecordingRenderer renderer;
+	batch.Render(&renderer);
+
+	// Both eyes share the textures, so they're only acquired and bound once
+	std::vector<std::string> expected = {
+		"Acquire hud", "Acquire scene", "Begin",
+		"Source hud", "Target scene", "Draw", "Draw",
+		"End", "Release hud", "Release scene"
+	};
+	CHECK(renderer.Calls == expected);
+	CHECK(renderer.Draws.size() == 2);
+	CHECK(renderer.Draws[1].Viewport[0] == 1000);
+	CHECK(renderer.Draws[1].Quad[0] == -0.5f);
+	CHECK(renderer.Draws[1].Bounds[2] == 1.0f);
+}
+
+static void TestManyLayers()
+{
+	// Eye layers with a separate texture per eye, composited onto a single base layer texture
+	TextureBase scene("scene"), left("left"), right("right"), hud("hud");
+	LayerBatch batch;
+	batch.Add(MakeBlit(&left, &scene, 0));
+	batch.Add(MakeBlit(&right, &scene, 1));
+	batch.Add(MakeBlit(&hud, &scene, 0));
+	batch.Add(MakeBlit(&hud, &scene, 1));
+
+	RecordingRenderer renderer;
+	batch.Render(&renderer);
+
+	std::vector<std::string> expected = {
+		"Acquire left", "Acquire scene", "Acquire right", "Acquire hud", "Begin",
+		"Source left", "Target scene", "Draw",
+		"Source right", "Draw",
+		"Source hud", "Draw", "Draw",
+		"End", "Release left", "Release scene", "Release right", "Release hud"
+	};
+	CHECK(renderer.Calls == expected);
+	CHECK(renderer.Draws.size() == 4);
+}
+
+static void TestReuse()
+{
+	TextureBase hud("hud"), scene("scene"), other("other");
+	LayerBatch batch;
+	batch.Add(MakeBlit(&hud, &scene, 0));
+
+	RecordingRenderer first;
+	batch.Render(&first);
+
+	// The next frame starts with an empty batch, none of the textures of the previous frame carry over
+	batch.Clear();
+	CHECK(batch.IsEmpty());
+	batch.Add(MakeBlit(&hud, &other, 0));
+
+	RecordingRenderer second;
+	batch.Render(&second);
+	std::vector<std::string> expected = {
+		"Acquire hud", "Acquire other", "Begin",
+		"Source hud", "Target other", "Draw",
+		"End", "Release hud", "Release other"
+	};
+	CHECK(second.Calls == expected);
+}
+
+int main()
+{
+	TestEmpty();
+	TestSingleLayer();
+	TestManyLayers();
+	TestReuse();
+	return TestResult();
+}
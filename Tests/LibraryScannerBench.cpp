@@ -0,0 +1,147 @@
+#include "libraryscanner.h"
+#include "Test.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QUrl>
+
+// Number of manifests in the synthetic library
+#define LIBRARY_SIZE 1000
+// Number of files listed in each manifest, the scanner searches them for the executable
+#define MANIFEST_FILES 200
+// Covers of the support applications that are always in the model
+#define SUPPORT_COVERS 4
+// Time in milliseconds a scan may take before the benchmark gives up
+#define SCAN_TIMEOUT 60000
+
+static QByteArray Manifest(int i, int version = 1)
+{
+	QString name = QString("game-%1").arg(i, 4, 10, QChar('0'));
+
+	QJsonObject files;
+	for (int j = 0; j < MANIFEST_FILES; j++)
+	{
+		QJsonObject file;
+		file["sha256"] = QString(64, QChar('a' + j % 6));
+		file["size"] = 1024 * j;
+		files[QString("%1/Content/Paks/data-%2.pak").arg(name).arg(j)] = file;
+	}
+	files[QString("%1/Binaries/Win64/%1-Win64-Shipping.exe").arg(name)] = QJsonObject();
+
+	QJsonObject manifest;
+	manifest["canonicalName"] = name;
+	manifest["appId"] = QString::number(1000000000000000ll + i);
+	manifest["packageType"] = "APP";
+	manifest["isCore"] = false;
+	manifest["thirdParty"] = false;
+	manifest["launchFile"] = name + ".exe";
+	manifest["launchParameters"] = "";
+	manifest["version"] = QString::number(version);
+	manifest["files"] = files;
+	return QJsonDocument(manifest).toJson(QJsonDocument::Compact);
+}
+
+static bool WriteFile(const QString &path, const QByteArray &data)
+{
+	QFile file(path);
+	return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+}
+
+// Scans the library and returns the time it took in milliseconds, or -1 if it didn't finish
+static qint64 Scan(CLibraryScanner &scanner, const QString &libraryURL, QSignalSpy &found)
+{
+	QSignalSpy finished(&scanner, &CLibraryScanner::ScanFinished);
+	found.clear();
+
+	QElapsedTimer timer;
+	timer.start();
+	scanner.scanLibrary("library", libraryURL);
+	if (!finished.wait(SCAN_TIMEOUT))
+		return -1;
+	return timer.elapsed();
+}
+
+int main(int argc, char* argv[])
+{
+	QCoreApplication app(argc, argv);
+
+	// Keeps the index out of the user's data folder
+	QStandardPaths::setTestMode(true);
+	QDir(QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/Revive/").removeRecursively();
+
+	QTemporaryDir library;
+	CHECK(library.isValid() && QDir(library.path()).mkpath("Manifests"));
+	QString manifests = library.filePath("Manifests/");
+	QString libraryURL = QUrl::fromLocalFile(library.path() + "/").toString();
+	for (int i = 0; i < LIBRARY_SIZE; i++)
+		CHECK(WriteFile(manifests + QString("game-%1.json").arg(i, 4, 10, QChar('0')), Manifest(i)));
+
+	// Cold scan, every manifest is parsed and written to the index
+	qint64 cold, warm, update;
+	{
+		CLibraryScanner scanner;
+		CHECK(scanner.Init());
+		QSignalSpy found(&scanner, &CLibraryScanner::ApplicationFound);
+		cold = Scan(scanner, libraryURL, found);
+		CHECK(cold >= 0);
+		CHECK(found.size() == LIBRARY_SIZE);
+		CHECK(scanner.rowCount() == SUPPORT_COVERS + LIBRARY_SIZE);
+		CHECK(scanner.get(SUPPORT_COVERS)["coverURL"].toString().startsWith("image://cover/game-"));
+	}
+
+	// Corrupt a manifest without changing its size or modification time, if the warm scan still finds
+	// the application it was answered from the index instead of parsing the manifest
+	QString corrupt = manifests + "game-0000.json";
+	QDateTime modified = QFileInfo(corrupt).lastModified();
+	CHECK(WriteFile(corrupt, QByteArray(Manifest(0).size(), ' ')));
+	{
+		QFile file(corrupt);
+		CHECK(file.open(QIODevice::ReadWrite) && file.setFileTime(modified, QFileDevice::FileModificationTime));
+	}
+
+	// Warm scan in a new instance, as after a restart of the overlay
+	{
+		CLibraryScanner scanner;
+		CHECK(scanner.Init());
+
+		// Thumbnails of applications that are no longer in any library are removed after the scan
+		QString covers = scanner.GetCoverPath();
+		CHECK(QDir().mkpath(covers));
+		CHECK(WriteFile(covers + "game-0002-384x384.jpg", "cover"));
+		CHECK(WriteFile(covers + "game-9999-384x384.jpg", "cover"));
+
+		QSignalSpy found(&scanner, &CLibraryScanner::ApplicationFound);
+		warm = Scan(scanner, libraryURL, found);
+		CHECK(warm >= 0);
+		CHECK(found.size() == LIBRARY_SIZE);
+		CHECK(scanner.rowCount() == SUPPORT_COVERS + LIBRARY_SIZE);
+		CHECK(QFileInfo::exists(covers + "game-0002-384x384.jpg"));
+		CHECK(!QFileInfo::exists(covers + "game-9999-384x384.jpg"));
+
+		// A rescan after an update only reports the updated application, the version also changes the size
+		CHECK(WriteFile(manifests + "game-0001.json", Manifest(1, 10)));
+		update = Scan(scanner, libraryURL, found);
+		CHECK(update >= 0);
+		CHECK(found.size() == 1);
+		if (found.size() == 1)
+		{
+			QVariantMap updated = found[0][0].toMap();
+			CHECK(updated["canonicalName"].toString() == "game-0001");
+			CHECK(updated["updated"].toBool());
+		}
+		CHECK(scanner.rowCount() == SUPPORT_COVERS + LIBRARY_SIZE);
+	}
+
+	printf("%d manifests: cold scan %lld ms, warm scan %lld ms, rescan after update %lld ms\n",
+		LIBRARY_SIZE, cold, warm, update);
+	return TestResult();
+}
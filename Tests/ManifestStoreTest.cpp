@@ -0,0 +1,159 @@
+#include "manifeststore.h"
+#include "Test.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSet>
+#include <QTemporaryDir>
+#include <QTest>
+
+// Number of applications in the simulated library scan
+#define SCAN_SIZE 500
+// Short save delay so the test doesn't have to wait for the real one
+#define SAVE_DELAY 20
+
+// Stands in for IVRApplications and counts the round trips
+class StubRegistrar : public IManifestRegistrar
+{
+public:
+	int Registrations = 0;
+	int Queries = 0;
+	QSet<QString> Installed;
+
+	bool AddApplicationManifest(const QString &path) override
+	{
+		Registrations++;
+
+		// OpenVR reads the whole manifest back on every registration
+		QFile file(path);
+		CHECK(file.open(QIODevice::ReadOnly));
+		Installed.clear();
+		for (QJsonValue app : QJsonDocument::fromJson(file.readAll()).object()["applications"].toArray())
+			Installed.insert(app.toObject()["app_key"].toString());
+		return true;
+	}
+
+	bool IsApplicationInstalled(const QString &appKey) override
+	{
+		Queries++;
+		return Installed.contains(appKey);
+	}
+};
+
+static QJsonObject App(int i)
+{
+	QJsonObject obj;
+	obj["app_key"] = QString("revive.app.game-%1").arg(i);
+	obj["arguments"] = QString("/library Software/game-%1/game.exe").arg(i);
+	return obj;
+}
+
+static void WaitForSave()
+{
+	QTest::qWait(SAVE_DELAY * 5);
+}
+
+static int CountApplications(const QString &path)
+{
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly))
+		return -1;
+	return QJsonDocument::fromJson(file.readAll()).object()["applications"].toArray().size();
+}
+
+static void TestScan(const QString &path)
+{
+	StubRegistrar registrar;
+	CManifestStore store(path, &registrar);
+	store.SetSaveDelay(SAVE_DELAY);
+
+	CHECK(!store.Load());
+	CHECK(store.Save());
+	CHECK(registrar.Registrations == 1);
+	CHECK(CountApplications(path) == 0);
+
+	// A scan only touches memory until the save timer expires
+	for (int i = 0; i < SCAN_SIZE; i++)
+		store.Add(App(i).value("app_key").toString(), App(i));
+	CHECK(registrar.Registrations == 1);
+	CHECK(CountApplications(path) == 0);
+
+	// Unsaved applications are answered from memory
+	CHECK(store.IsInstalled(App(0).value("app_key").toString()));
+	CHECK(registrar.Queries == 0);
+
+	// The whole scan is written and registered once
+	WaitForSave();
+	CHECK(registrar.Registrations == 2);
+	CHECK(CountApplications(path) == SCAN_SIZE);
+	CHECK(store.IsInstalled(App(SCAN_SIZE - 1).value("app_key").toString()));
+	CHECK(registrar.Queries == 1);
+
+	// Nothing is written without changes
+	store.Flush();
+	CHECK(store.Save());
+	CHECK(registrar.Registrations == 2);
+
+	// Re-adding unchanged applications means OpenVR lost them, that's a single registration too
+	for (int i = 0; i < SCAN_SIZE; i++)
+		store.Add(App(i).value("app_key").toString(), App(i));
+	WaitForSave();
+	CHECK(registrar.Registrations == 3);
+
+	store.Remove(App(0).value("app_key").toString());
+	CHECK(!store.HasApplication(App(0).value("app_key").toString()));
+	CHECK(!store.IsInstalled(App(0).value("app_key").toString()));
+	store.Flush();
+	CHECK(registrar.Registrations == 4);
+	CHECK(CountApplications(path) == SCAN_SIZE - 1);
+
+	// The manifest is replaced atomically, so no temporary files are left behind
+	CHECK(QDir(QFileInfo(path).path()).entryList(QDir::Files).size() == 1);
+}
+
+static void TestLoad(const QString &path)
+{
+	QJsonArray apps;
+	apps.append(App(1));
+	apps.append(App(2));
+	apps.append(App(1));
+	QJsonObject manifest;
+	manifest["source"] = "builtin";
+	manifest["applications"] = apps;
+
+	QFile file(path);
+	CHECK(file.open(QIODevice::WriteOnly));
+	file.write(QJsonDocument(manifest).toJson());
+	file.close();
+
+	StubRegistrar registrar;
+	CManifestStore store(path, &registrar);
+	CHECK(store.Load());
+	CHECK(store.HasApplication(App(1).value("app_key").toString()));
+	CHECK(store.GetApplication(App(2).value("app_key").toString()) == App(2));
+	CHECK(registrar.Registrations == 0);
+
+	// Loading drops the duplicate entries and keeps the other properties
+	CHECK(store.Register());
+	store.Add(App(3).value("app_key").toString(), App(3));
+	store.Flush();
+	CHECK(registrar.Registrations == 2);
+	CHECK(CountApplications(path) == 3);
+	CHECK(file.open(QIODevice::ReadOnly));
+	CHECK(QJsonDocument::fromJson(file.readAll()).object()["source"].toString() == "builtin");
+}
+
+int main(int argc, char* argv[])
+{
+	QCoreApplication app(argc, argv);
+
+	QTemporaryDir scanDir, loadDir;
+	CHECK(scanDir.isValid() && loadDir.isValid());
+	TestScan(scanDir.filePath("revive.vrmanifest"));
+	TestLoad(loadDir.filePath("revive.vrmanifest"));
+	return TestResult();
+}
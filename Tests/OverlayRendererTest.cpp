@@ -0,0 +1,263 @@
+#include "overlaypresenter.h"
+#include "overlayrenderer.h"
+#include "StubCore.h"
+#include "Test.h"
+
+#include <QGuiApplication>
+#include <QImage>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLTexture>
+#include <QQmlComponent>
+#include <QQmlEngine>
+#include <QQuickItem>
+#include <QQuickRenderControl>
+#include <QQuickWindow>
+#include <QTest>
+#include <QThread>
+#include <QTimer>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <time.h>
+
+// Exit code that tells CTest the test was skipped
+#define SKIP_TEST 77
+// Duration of every measured phase in milliseconds
+#define PHASE_DURATION 500
+// Time in milliseconds for a visibility change to be polled and the frame in flight to finish
+#define SETTLE_DURATION 100
+// Interval of the event pump, much shorter than the dashboard's so the calls often coincide with a frame
+#define PUMP_INTERVAL 2
+
+// A scene that never stops requesting frames, like the animations in Library.qml
+static const char* s_Scene = R"(
+import QtQuick 2.0
+Rectangle {
+	width: 256; height: 256; color: "black"
+	Rectangle {
+		anchors.centerIn: parent; width: 128; height: 128; color: "red"
+		NumberAnimation on rotation { from: 0; to: 360; duration: 1000; loops: Animation.Infinite }
+	}
+}
+)";
+
+// The stub runtime counts the calls to its IVROverlay, here the counters also check that the calls of the GUI
+// and render threads never overlap. Calls made by the test itself to drive the stub are not checked.
+static std::mutex s_CallMutex;
+static std::map<std::string, std::unique_ptr<StubCall>> s_Calls;
+static std::atomic<int> s_CallsInFlight{ 0 };
+static std::atomic<int> s_OverlappingCalls{ 0 };
+static thread_local bool s_Unchecked = false;
+
+StubCall& GetStubCall(const char* name)
+{
+	// MSVC qualifies the name with the class, GCC doesn't
+	std::string key(name);
+	size_t scope = key.rfind("::");
+	if (scope != std::string::npos)
+		key.erase(0, scope + 2);
+
+	std::lock_guard<std::mutex> lk(s_CallMutex);
+	std::unique_ptr<StubCall>& call = s_Calls[key];
+	if (!call)
+		call.reset(new StubCall());
+	return *call;
+}
+
+void StubCall::Enter()
+{
+	Count.fetch_add(1, std::memory_order_relaxed);
+	if (s_Unchecked)
+		return;
+
+	// Stay in the call for a moment, so an unserialized call on the other thread would run into it
+	if (s_CallsInFlight.fetch_add(1) != 0)
+		s_OverlappingCalls++;
+	std::this_thread::sleep_for(std::chrono::microseconds(200));
+	s_CallsInFlight.fetch_sub(1);
+}
+
+static uint64_t CallCount(const char* name)
+{
+	return GetStubCall(name).Count.load();
+}
+
+// Drives the stub runtime the way the compositor would when the dashboard is opened or closed
+static void SetOverlayVisible(vr::IVROverlay* overlay, vr::VROverlayHandle_t handle, bool visible)
+{
+	s_Unchecked = true;
+	if (visible)
+		overlay->ShowOverlay(handle);
+	else
+		overlay->HideOverlay(handle);
+	s_Unchecked = false;
+}
+
+struct Phase
+{
+	int Frames;
+	uint64_t Submitted;
+	double CpuMs;
+};
+
+int main(int argc, char* argv[])
+{
+	qputenv("QT_QPA_PLATFORM", "offscreen");
+	QGuiApplication app(argc, argv);
+
+	QSurfaceFormat format;
+	format.setDepthBufferSize(16);
+	format.setStencilBufferSize(8);
+	QOpenGLContext* context = new QOpenGLContext();
+	context->setFormat(format);
+	if (!context->create())
+	{
+		printf("No OpenGL support on the offscreen platform, skipping\n");
+		return SKIP_TEST;
+	}
+
+	QOffscreenSurface* surface = new QOffscreenSurface();
+	surface->setFormat(context->format());
+	surface->create();
+	CHECK(context->makeCurrent(surface));
+
+	QQuickRenderControl* renderControl = new QQuickRenderControl();
+	QQuickWindow* window = new QQuickWindow(renderControl);
+	QQmlEngine engine;
+	QQmlComponent component(&engine);
+	component.setData(s_Scene, QUrl());
+	QQuickItem* item = qobject_cast<QQuickItem*>(component.create());
+	CHECK(item);
+	if (!item)
+		return TestResult();
+	item->setParentItem(window->contentItem());
+	window->setGeometry(0, 0, 256, 256);
+
+	// The dashboard overlay and its thumbnail, as created by COpenVROverlayController::Init
+	vr::IVROverlay* overlay = GetStubOverlay();
+	vr::VROverlayHandle_t overlayHandle, thumbnailHandle;
+	s_Unchecked = true;
+	CHECK(overlay->CreateDashboardOverlay("revive.overlay", "revive", &overlayHandle, &thumbnailHandle) == vr::VROverlayError_None);
+	s_Unchecked = false;
+
+	// Same wiring as COpenVROverlayController::Init
+	COverlayPresenter presenter;
+	presenter.SetOverlay(overlay, overlayHandle, thumbnailHandle);
+	QObject::connect(renderControl, &QQuickRenderControl::renderRequested, &presenter, &COverlayPresenter::RequestUpdate);
+	QObject::connect(renderControl, &QQuickRenderControl::sceneChanged, &presenter, &COverlayPresenter::RequestUpdate);
+
+	// The event pump of COpenVROverlayController::OnTimeoutPumpEvents, only the visibility events matter here
+	QTimer pumpTimer;
+	pumpTimer.setInterval(PUMP_INTERVAL);
+	QObject::connect(&pumpTimer, &QTimer::timeout, [&]()
+	{
+		vr::VREvent_t event;
+		while (presenter.PollNextOverlayEvent(overlayHandle, &event)) { }
+		while (presenter.PollNextOverlayEvent(thumbnailHandle, &event)) { }
+		presenter.IsDashboardVisible();
+	});
+	pumpTimer.start();
+
+	// The thumbnail is created on the GUI thread and destroyed by the renderer
+	QOpenGLTexture* thumbnail = new QOpenGLTexture(QImage(16, 16, QImage::Format_RGBA8888));
+	CHECK(thumbnail->textureId() != 0);
+
+	// Same hand-over as COpenVROverlayController::SetQuickItem
+	context->doneCurrent();
+	QThread* thread = new QThread();
+	COverlayRenderer* renderer = new COverlayRenderer(context, surface, renderControl, window, thumbnail);
+	renderer->moveToThread(thread);
+	QObject::connect(renderer, &COverlayRenderer::FrameRendered, &presenter, &COverlayPresenter::SubmitFrame, Qt::DirectConnection);
+	context->moveToThread(thread);
+	renderControl->prepareThread(thread);
+	thread->start();
+	QMetaObject::invokeMethod(renderer, "Initialize", Qt::BlockingQueuedConnection, Q_ARG(QSize, QSize(256, 256)));
+
+	std::atomic<int> frames{ 0 };
+	std::atomic<int> totalFrames{ 0 };
+	std::atomic<int> framesWithoutContext{ 0 };
+	QObject::connect(renderer, &COverlayRenderer::FrameRendered, [&](uint texture)
+	{
+		// The texture can only be submitted while the context is current
+		if (!QOpenGLContext::currentContext() || texture == 0)
+			framesWithoutContext++;
+		frames++;
+		totalFrames++;
+	}, Qt::DirectConnection);
+	QObject::connect(&presenter, &COverlayPresenter::RenderRequested, [&]()
+	{
+		renderControl->polishItems();
+		renderer->RequestRender(false);
+	});
+
+	auto measure = [&]()
+	{
+		// Let the pump pick up the visibility change and the frame in flight finish first
+		QTest::qWait(SETTLE_DURATION);
+		frames = 0;
+		uint64_t submitted = CallCount("SetOverlayTexture");
+		clock_t start = clock();
+		QTest::qWait(PHASE_DURATION);
+		return Phase{ frames, CallCount("SetOverlayTexture") - submitted, (clock() - start) * 1000.0 / CLOCKS_PER_SEC };
+	};
+
+	Phase hidden = measure();
+
+	SetOverlayVisible(overlay, overlayHandle, true);
+	Phase shown = measure();
+	CHECK(presenter.IsOverlayVisible());
+
+	SetOverlayVisible(overlay, overlayHandle, false);
+	Phase hiddenAgain = measure();
+	CHECK(!presenter.IsVisible());
+
+	SetOverlayVisible(overlay, thumbnailHandle, true);
+	Phase thumbnailShown = measure();
+	SetOverlayVisible(overlay, thumbnailHandle, false);
+
+	presenter.SetWindowVisible(true);
+	Phase windowShown = measure();
+	presenter.SetWindowVisible(false);
+	Phase windowHidden = measure();
+
+	printf("hidden:    %d frames, %.1f ms CPU\n", hidden.Frames, hidden.CpuMs);
+	printf("overlay:   %d frames, %.1f ms CPU\n", shown.Frames, shown.CpuMs);
+	printf("thumbnail: %d frames, %.1f ms CPU\n", thumbnailShown.Frames, thumbnailShown.CpuMs);
+	printf("window:    %d frames, %.1f ms CPU\n", windowShown.Frames, windowShown.CpuMs);
+
+	// Nothing is rendered or submitted while the dashboard is hidden, even though the scene keeps animating
+	CHECK(hidden.Frames == 0 && hidden.Submitted == 0);
+	CHECK(hiddenAgain.Frames == 0 && hiddenAgain.Submitted == 0);
+	CHECK(windowHidden.Frames == 0 && windowHidden.Submitted == 0);
+
+	// Every rendered frame is submitted to the overlay while any of them is visible
+	CHECK(shown.Frames > 0 && shown.Submitted > 0);
+	CHECK(thumbnailShown.Frames > 0);
+	CHECK(windowShown.Frames > 0);
+	CHECK(framesWithoutContext == 0);
+	CHECK(CallCount("SetOverlayTexture") == (uint64_t)totalFrames);
+
+	// The frames submitted on the render thread never overlapped with the event pump
+	CHECK(CallCount("PollNextOverlayEvent") > 0);
+	CHECK(s_OverlappingCalls == 0);
+
+	// The renderer releases its resources, including the thumbnail, and hands the context back
+	pumpTimer.stop();
+	QMetaObject::invokeMethod(renderer, "Cleanup", Qt::BlockingQueuedConnection);
+	CHECK(thread->wait(5000));
+	CHECK(context->thread() == app.thread());
+
+	delete renderer;
+	delete thread;
+	delete item;
+	delete window;
+	delete renderControl;
+	delete surface;
+	delete context;
+	return TestResult();
+}
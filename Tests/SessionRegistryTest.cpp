@@ -0,0 +1,218 @@
+#include "SlotMap.h"
+#include "Test.h"
+
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <thread>
+#include <vector>
+
+// Number of applications creating, using and destroying their sessions at the same time
+#define APP_THREADS 4
+// Number of sessions every application goes through
+#define SESSIONS_PER_APP 200
+// Number of frames submitted by every session
+#define FRAMES_PER_SESSION 50
+// Number of sessions in the stub registry, small enough that slots are reused all the time
+#define STUB_CAPACITY 8
+
+// Stands in for ovrHmdStruct, the runtime state is poisoned when the session is destroyed
+struct StubSession
+{
+	enum State { Created, Running, Destroyed };
+
+	std::atomic<State> Runtime{ Created };
+	std::atomic<uint64_t> XrSession{ 0 };
+	std::atomic<int> Frames{ 0 };
+	std::atomic<int> Events{ 0 };
+
+	~StubSession() { Runtime = Destroyed; }
+};
+
+typedef SlotMap<StubSession, STUB_CAPACITY> StubRegistry;
+
+// Entry points validate the handle and only touch the session through the returned reference
+static bool SubmitFrame(StubRegistry& registry, StubRegistry::Handle handle, std::atomic<int>& used)
+{
+	std::shared_ptr<StubSession> session = registry.Get(handle);
+	if (!session)
+		return false;
+
+	if (session->Runtime != StubSession::Running)
+		used++;
+	session->Frames++;
+	return true;
+}
+
+static void DestroySession(StubRegistry& registry, StubRegistry::Handle handle, std::atomic<int>& used)
+{
+	std::shared_ptr<StubSession> session = registry.Remove(handle);
+	if (!session)
+		return;
+
+	// Nobody else holds the session anymore, so its runtime state can be torn down
+	if (session.use_count() != 1)
+		used++;
+	session->Runtime = StubSession::Destroyed;
+}
+
+static void TestHandles()
+{
+	StubRegistry registry;
+	CHECK(!registry.Get(0));
+	CHECK(!registry.Get(2));
+	CHECK(!registry.Remove(0));
+
+	std::vector<StubRegistry::Handle> handles;
+	for (int i = 0; i < STUB_CAPACITY; i++)
+	{
+		StubRegistry::Handle handle = registry.Insert(std::make_shared<StubSession>());
+		CHECK(handle != 0 && (handle & 1));
+		handles.push_back(handle);
+	}
+	CHECK(registry.Insert(std::make_shared<StubSession>()) == 0);
+	CHECK(registry.GetHandles().size() == STUB_CAPACITY);
+	CHECK(std::set<StubRegistry::Handle>(handles.begin(), handles.end()).size() == STUB_CAPACITY);
+
+	// A reused slot gets a new handle and the old one stays invalid
+	std::shared_ptr<StubSession> first = registry.Get(handles[0]);
+	CHECK(first);
+	first.reset();
+	CHECK(registry.Remove(handles[0]));
+	CHECK(!registry.Get(handles[0]));
+	CHECK(!registry.Remove(handles[0]));
+	StubRegistry::Handle reused = registry.Insert(std::make_shared<StubSession>());
+	CHECK(reused != 0 && reused != handles[0]);
+	CHECK(!registry.Get(handles[0]));
+	CHECK(registry.Get(reused));
+
+	// Handles to slots outside the map are rejected
+	CHECK(!registry.Get(((StubRegistry::Handle)STUB_CAPACITY << 1) | 1));
+
+	// Events are routed by the runtime session
+	registry.Get(reused)->XrSession = 42;
+	CHECK(registry.Find([](const StubSession& s) { return s.XrSession == 42; }) == registry.Get(reused));
+	CHECK(!registry.Find([](const StubSession& s) { return s.XrSession == 43; }));
+	CHECK(registry.GetAll().size() == STUB_CAPACITY);
+}
+
+static void TestRemoveWaits()
+{
+	StubRegistry registry;
+	StubRegistry::Handle handle = registry.Insert(std::make_shared<StubSession>());
+	std::shared_ptr<StubSession> held = registry.Get(handle);
+	CHECK(held);
+
+	// Remove only returns once the reference held by the entry point is released
+	std::atomic<bool> released{ false };
+	std::atomic<bool> removed{ false };
+	std::thread destroy([&]()
+	{
+		std::shared_ptr<StubSession> session = registry.Remove(handle);
+		CHECK(released);
+		CHECK(session && session.use_count() == 1);
+		removed = true;
+	});
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	CHECK(!removed);
+	CHECK(!registry.Get(handle));
+	released = true;
+	held.reset();
+	destroy.join();
+	CHECK(removed);
+}
+
+static void TestConcurrentSessions()
+{
+	StubRegistry registry;
+	std::atomic<bool> running{ true };
+	std::atomic<uint64_t> nextXrSession{ 1 };
+	std::atomic<int> useAfterDestroy{ 0 };
+	std::atomic<int> staleFrames{ 0 };
+	std::atomic<int> routed{ 0 };
+
+	// Polls the shared event queue and routes the events to their sessions, like ovr_GetSessionStatus
+	std::thread events([&]()
+	{
+		uint64_t xrSession = 1;
+		while (running)
+		{
+			std::shared_ptr<StubSession> target = registry.Find([xrSession](const StubSession& s) { return s.XrSession == xrSession; });
+			if (target)
+			{
+				if (target->Runtime == StubSession::Destroyed)
+					useAfterDestroy++;
+				target->Events++;
+				routed++;
+			}
+			for (const std::shared_ptr<StubSession>& session : registry.GetAll())
+			{
+				if (session->Runtime == StubSession::Destroyed)
+					useAfterDestroy++;
+			}
+			xrSession = xrSession % nextXrSession + 1;
+		}
+	});
+
+	// Every application runs its frame loop on one thread and keeps submitting with a stale handle
+	// from another, like a render thread that hasn't noticed the session was destroyed
+	std::vector<std::thread> apps;
+	for (int i = 0; i < APP_THREADS; i++)
+	{
+		apps.emplace_back([&]()
+		{
+			for (int s = 0; s < SESSIONS_PER_APP; s++)
+			{
+				std::shared_ptr<StubSession> created = std::make_shared<StubSession>();
+				StubRegistry::Handle handle = registry.Insert(created);
+				if (!handle)
+				{
+					std::this_thread::yield();
+					continue;
+				}
+				created->XrSession = nextXrSession++;
+				created->Runtime = StubSession::Running;
+				created.reset();
+
+				std::atomic<bool> destroyed{ false };
+				std::thread render([&]()
+				{
+					while (!destroyed)
+						SubmitFrame(registry, handle, useAfterDestroy);
+					if (SubmitFrame(registry, handle, useAfterDestroy))
+						staleFrames++;
+				});
+
+				for (int f = 0; f < FRAMES_PER_SESSION; f++)
+					CHECK(SubmitFrame(registry, handle, useAfterDestroy));
+
+				DestroySession(registry, handle, useAfterDestroy);
+				destroyed = true;
+				render.join();
+
+				// The application destroys its session twice
+				DestroySession(registry, handle, useAfterDestroy);
+				CHECK(!registry.Get(handle));
+			}
+		});
+	}
+
+	for (std::thread& app : apps)
+		app.join();
+	running = false;
+	events.join();
+
+	printf("%d events routed\n", routed.load());
+	CHECK(useAfterDestroy == 0);
+	CHECK(staleFrames == 0);
+	CHECK(registry.GetHandles().empty());
+}
+
+int main(int argc, char* argv[])
+{
+	TestHandles();
+	TestRemoveWaits();
+	TestConcurrentSessions();
+	return TestResult();
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdio.h>
+
+// Minimal checks for the portable tests, a failed check is reported and fails the test at exit
+inline int g_TestFailures = 0;
+
+#define CHECK(x) do { if (!(x)) { printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #x); g_TestFailures++; } } while (0)
+
+// Returns the exit code of the test
+inline int TestResult()
+{
+	if (g_TestFailures)
+		printf("%d check(s) failed\n", g_TestFailures);
+	return g_TestFailures ? 1 : 0;
+}
@@ -0,0 +1,208 @@
+#include "libraryscanner.h"
+#include "Test.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QQmlComponent>
+#include <QQmlContext>
+#include <QQmlEngine>
+#include <QScopedPointer>
+#include <QSharedPointer>
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QUrl>
+
+// Time in milliseconds a title lookup may take
+#define TITLE_TIMEOUT 5000
+
+// Stands in for the store pages the titles are scraped from, answers with a 404 for unknown ids
+class TitleServer : public QObject
+{
+	Q_OBJECT
+
+public:
+	int Requests = 0;
+	QMap<QString, QString> Titles;
+
+	bool Listen()
+	{
+		connect(&m_server, &QTcpServer::newConnection, this, &TitleServer::OnConnection);
+		return m_server.listen(QHostAddress::LocalHost);
+	}
+
+	void Close() { m_server.close(); }
+	QString GetURL() const { return QString("http://127.0.0.1:%1/experiences/rift/").arg(m_server.serverPort()); }
+
+private slots:
+	void OnConnection()
+	{
+		while (QTcpSocket *socket = m_server.nextPendingConnection())
+		{
+			QSharedPointer<QByteArray> request(new QByteArray());
+			connect(socket, &QTcpSocket::readyRead, this, [this, socket, request]()
+			{
+				request->append(socket->readAll());
+				if (request->contains("\r\n\r\n"))
+					Respond(socket, *request);
+			});
+			connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+		}
+	}
+
+private:
+	QTcpServer m_server;
+
+	void Respond(QTcpSocket *socket, const QByteArray &request)
+	{
+		// GET /experiences/rift/<appId> HTTP/1.1
+		QString appId = QString::fromUtf8(request.left(request.indexOf("\r\n")).split(' ').value(1)).section('/', -1);
+		Requests++;
+
+		QByteArray status = "404 Not Found";
+		QByteArray body = "<html><head><title>Page not found</title></head></html>";
+		if (Titles.contains(appId))
+		{
+			status = "200 OK";
+			body = "<html><head><title id=\"pageTitle\">" + Titles[appId].toUtf8() + " Rift | Oculus</title></head></html>";
+		}
+
+		socket->write("HTTP/1.1 " + status + "\r\nContent-Type: text/html; charset=utf-8\r\nContent-Length: " +
+			QByteArray::number(body.size()) + "\r\nConnection: close\r\n\r\n" + body);
+		socket->disconnectFromHost();
+	}
+};
+
+// Stands in for the manifest controller, records the manifests generated by Oculus.js
+class StubController : public QObject
+{
+	Q_OBJECT
+	Q_PROPERTY(QString BasePath READ GetBasePath CONSTANT)
+
+public:
+	QMap<QString, QJsonObject> Manifests;
+
+	QString GetBasePath() { return "C:/Program Files/Oculus/"; }
+
+	Q_INVOKABLE bool addManifest(const QString &canonicalName, const QString &manifest)
+	{
+		Manifests[canonicalName] = QJsonDocument::fromJson(manifest.toUtf8()).object();
+		emit ManifestAdded(canonicalName);
+		return true;
+	}
+
+signals:
+	void ManifestAdded(const QString &canonicalName);
+};
+
+// Loads Oculus.js the same way Overlay.qml does, with the scanner and the stub as its context
+class OculusScript
+{
+public:
+	OculusScript(const QString &overlayPath, CLibraryScanner *scanner, StubController *revive)
+		: m_pRevive(revive)
+	{
+		m_engine.rootContext()->setContextProperty("Revive", revive);
+		m_engine.rootContext()->setContextProperty("Scanner", scanner);
+
+		QQmlComponent component(&m_engine);
+		component.setData("import QtQml 2.2\n"
+			"import \"Oculus.js\" as Oculus\n"
+			"QtObject { function generate(manifest, library) { Oculus.generateManifest(manifest, library); } }",
+			QUrl::fromLocalFile(overlayPath + "/TitleLookupTest.qml"));
+		m_pObject.reset(component.create());
+		if (!m_pObject)
+			printf("%s\n", qUtf8Printable(component.errorString()));
+	}
+
+	bool IsValid() const { return !m_pObject.isNull(); }
+
+	// Generates the manifest of an application and returns the title it was given
+	QString Generate(const QString &canonicalName, const QString &appId)
+	{
+		QVariantMap manifest;
+		manifest["canonicalName"] = canonicalName;
+		manifest["appId"] = appId;
+		manifest["launchFile"] = "Game.exe";
+		manifest["launchParameters"] = "";
+
+		QSignalSpy added(m_pRevive, &StubController::ManifestAdded);
+		QMetaObject::invokeMethod(m_pObject.data(), "generate", Q_ARG(QVariant, manifest), Q_ARG(QVariant, QString("library")));
+
+		// Cached titles are added before generateManifest returns
+		if (added.isEmpty() && !added.wait(TITLE_TIMEOUT))
+			return QString();
+		return m_pRevive->Manifests[canonicalName]["strings"].toObject()["en_us"].toObject()["name"].toString();
+	}
+
+private:
+	QQmlEngine m_engine;
+	QScopedPointer<QObject> m_pObject;
+	StubController *m_pRevive;
+};
+
+int main(int argc, char* argv[])
+{
+	QCoreApplication app(argc, argv);
+	if (argc < 2)
+	{
+		printf("Usage: TitleLookupTest <ReviveOverlay folder>\n");
+		return 1;
+	}
+	QString overlayPath = argv[1];
+
+	// Keeps the title cache out of the user's data folder
+	QStandardPaths::setTestMode(true);
+	QDir(QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/Revive/").removeRecursively();
+
+	// The page titles are HTML escaped and use typographic apostrophes
+	TitleServer server;
+	server.Titles["1001"] = QString("Stand-In Game&#58; Director") + QChar(0x2019) + "s Cut";
+	CHECK(server.Listen());
+	qputenv("REVIVE_TITLE_URL", server.GetURL().toUtf8());
+	const QString title = "Stand-In Game: Director's Cut";
+
+	// Online, titles are requested once and cached
+	{
+		StubController revive;
+		CLibraryScanner scanner;
+		CHECK(scanner.Init());
+		CHECK(scanner.GetTitleURL() == server.GetURL());
+		OculusScript oculus(overlayPath, &scanner, &revive);
+		CHECK(oculus.IsValid());
+
+		CHECK(oculus.Generate("stand-in-game", "1001") == title);
+		CHECK(server.Requests == 1);
+		CHECK(scanner.getTitle("stand-in-game") == title);
+
+		// Applications without a store page fall back to their canonical name, which isn't cached
+		CHECK(oculus.Generate("unlisted-game", "1002") == "unlisted-game");
+		CHECK(server.Requests == 2);
+		CHECK(scanner.getTitle("unlisted-game").isEmpty());
+
+		CHECK(oculus.Generate("stand-in-game", "1001") == title);
+		CHECK(server.Requests == 2);
+	}
+
+	// Offline after a restart, the cached titles are loaded from disk
+	server.Close();
+	{
+		StubController revive;
+		CLibraryScanner scanner;
+		CHECK(scanner.Init());
+		OculusScript oculus(overlayPath, &scanner, &revive);
+		CHECK(oculus.IsValid());
+
+		CHECK(oculus.Generate("stand-in-game", "1001") == title);
+		CHECK(oculus.Generate("unlisted-game", "1002") == "unlisted-game");
+		CHECK(server.Requests == 2);
+	}
+
+	return TestResult();
+}
+
+#include "TitleLookupTest.moc"